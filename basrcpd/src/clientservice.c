@@ -43,22 +43,7 @@ void end_client_thread(session_node_t * sn)
     syslog_session(sid, DBG_INFO,
                    "Session entered cancel state (mode = %d sid = %d).", mode, sid);
 
-    if (mode == smInfo) {
-        result = close(sn->pipefd[0]);
-        if (result != 0) {
-            syslog_session(sid, DBG_ERROR,
-                           "Pipe close fd[0] failed: %s (errno = %d).",
-                           strerror(errno), errno);
-        }
-
-        result = close(sn->pipefd[1]);
-        if (result != 0) {
-            syslog_session(sid, DBG_ERROR,
-                           "Pipe close fd[1] failed: %s (errno = %d).",
-                           strerror(errno), errno);
-        }
-    }
-    else if (mode == smCommand) commandsessions--;
+    if (mode == smCommand) commandsessions--;
 
     if (sn->socket != -1) {
         shutdown(sn->socket, SHUT_RDWR);
@@ -89,6 +74,7 @@ void *thr_doClient(void *v)
     int last_cancel_state, last_cancel_type;
     int result;
     ssize_t sresult;
+    bool handedover = false;
 
     session_node_t *sn = (session_node_t *) v;
     sn->thread = pthread_self();
@@ -138,7 +124,7 @@ void *thr_doClient(void *v)
         reply[0] = 0x00;
         memset(line, 0, sizeof(line));
 
-        sresult = socket_readline(sn->socket, line, sizeof(line) - 1);
+        sresult = socket_readline(sn->socket, &sn->rdbuf, line, sizeof(line) - 1);
 
         /* client terminated connection */
         if (0 == sresult) {
@@ -196,12 +182,18 @@ void *thr_doClient(void *v)
                         break;
                     case smInfo:
                         rc = doInfoClient(sn);
+                        /* served by the INFO service from now on */
+                        if (rc == 0)
+                            handedover = true;
                         break;
                     default:
                         syslog_session(sn->session, DBG_ERROR,
                                        "Session mode not set.\n");
                         break;
                 }
+                /* leave without cleanup, the INFO service owns sn */
+                if (handedover)
+                    break;
                 /*exit while loop */
                 pthread_exit((void *) 0);
             }
@@ -249,7 +241,7 @@ void *thr_doClient(void *v)
     }
 
     /*run the cleanup routine */
-    pthread_cleanup_pop(1);
+    pthread_cleanup_pop(!handedover);
     return NULL;
 }
 
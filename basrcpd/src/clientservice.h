@@ -15,6 +15,7 @@
 #include "srcp-session.h"
 
 void* thr_doClient(void *v);
+void end_client_thread(session_node_t *sn);
 int getnbr_commandsessions(void);
 
 #endif
@@ -102,6 +102,8 @@ int bus_has_devicegroup(bus_t bus, int dg)
             return strstr(buses[bus].description, "GL") != NULL;
         case DG_GM:
             return strstr(buses[bus].description, "GM") != NULL;
+        case DG_STAT:
+            return strstr(buses[bus].description, "STAT") != NULL;
         case DG_FB:
             return strstr(buses[bus].description, "FB") != NULL;
         case DG_SM:
@@ -166,6 +168,7 @@ static bus_t register_bus(bus_t busnumber, xmlDocPtr doc, xmlNodePtr node)
     buses[current_bus].init_func = NULL;
     buses[current_bus].init_gl_func = NULL;
     buses[current_bus].describe_gl_func = NULL;
+    buses[current_bus].info_stat_func = NULL;
     buses[current_bus].init_ga_func = NULL;
     buses[current_bus].init_fb_func = NULL;
 
@@ -115,6 +115,7 @@ typedef struct _BUS
   int (*init_fb_func) (bus_t bus, int addr,
           const char protocolb, int index);  /* called to check default init */
   void (*describe_gl_func) (gl_data_t *, char *);  /* called to check default init */
+  int (*info_stat_func) (bus_t, char *, char *);  /* GET <bus> STAT <item> */
 
   int watchdog;                /* watchdog to monitor bus thread */
 
@@ -151,6 +152,7 @@ int bus_supports_protocol(bus_t bus, const char protocol);
 #define DG_SERVER 9
 #define DG_POWER 10
 #define DG_GM 11
+#define DG_STAT 12
 
 int bus_has_devicegroup(bus_t bus, int dg);
 
@@ -105,6 +105,7 @@
 #include "syslogmessage.h"
 //Header für SPI Ausgabe
 #include <stdint.h>
+#include <signal.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <linux/spi/spidev.h>
@@ -366,30 +367,325 @@ int init_lineDDL(bus_t busnumber)
 }
 
 
-/****** routines for Maerklin packet pool *********************/
+/****** routines for refresh scheduler *********************/
 
-static void init_MaerklinPacketPool(bus_t busnumber)
+static long long now_usec(void)
 {
-    int i, j;
-    int result;
+    struct timeval now = { 0, 0 };
+    gettimeofday(&now, NULL);
+    return (long long)now.tv_sec * 1000000 + now.tv_usec;
+}
 
-    result = pthread_mutex_init(&__DDL->maerklin_pktpool_mutex, NULL);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_init() failed: %s (errno = %d). Abort!",
-                   strerror(result), result);
-        exit(EXIT_FAILURE);
+static int protocol_index(int protocol)
+{
+    switch (protocol) {
+        case EP_MAERKLIN:   return STAT_MM;
+        case EP_NMRADCC:    return STAT_DCC;
+        default:            return STAT_MFX;
     }
+}
 
-    result = pthread_mutex_lock(&__DDL->maerklin_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_lock() failed: %s (errno = %d).",
-                   strerror(result), result);
+/* append entry at the end of the ring, which = 1 for the function ring */
+static void rf_link(tRefreshEntry **ring, tRefreshEntry *e, int which)
+{
+    if (*ring == NULL) {
+        e->link[which].prev = e;
+        e->link[which].next = e;
+        *ring = e;
+    }
+    else {
+        e->link[which].next = *ring;
+        e->link[which].prev = (*ring)->link[which].prev;
+        (*ring)->link[which].prev->link[which].next = e;
+        (*ring)->link[which].prev = e;
+    }
+}
+
+static void rf_unlink(tRefreshEntry **ring, tRefreshEntry *e, int which)
+{
+    if (e->link[which].next == e) {
+        *ring = NULL;
+    }
+    else {
+        e->link[which].prev->link[which].next = e->link[which].next;
+        e->link[which].next->link[which].prev = e->link[which].prev;
+        if (*ring == e)
+            *ring = e->link[which].next;
+    }
+}
+
+static void rf_move(bus_t busnumber, tRefreshEntry *e, int rfclass)
+{
+    rf_unlink(&__DDL->rfRing[e->rfclass], e, 0);
+    e->rfclass = rfclass;
+    rf_link(&__DDL->rfRing[rfclass], e, 0);
+}
+
+/**
+ * Lok in den Refresh aufnehmen, zunächst als RF_STALE.
+ * @param functions true wenn die Lok eigene Funktionspakete hat
+ */
+static void rf_insert(bus_t busnumber, tRefreshEntry *e, int protocol, int adr,
+                      bool functions)
+{
+    memset(e, 0, sizeof(*e));
+    e->protocol = protocol;
+    e->adr = adr;
+    e->rfclass = RF_STALE;
+    e->functions = functions;
+    rf_link(&__DDL->rfRing[RF_STALE], e, 0);
+    if (functions)
+        rf_link(&__DDL->rfRing[RF_FUNC], e, 1);
+}
+
+static void rf_remove(bus_t busnumber, tRefreshEntry *e)
+{
+    if (e->rfclass < 0)
+        return;
+    rf_unlink(&__DDL->rfRing[e->rfclass], e, 0);
+    if (e->functions)
+        rf_unlink(&__DDL->rfRing[RF_FUNC], e, 1);
+    e->rfclass = -1;
+}
+
+/* neues Kommando: die nächsten RF_NEW_REPEAT Refreshs mit Vorrang */
+static void rf_command(bus_t busnumber, tRefreshEntry *e)
+{
+    e->lastUpdate = now_usec();
+    e->newcount = RF_NEW_REPEAT;
+    if (e->rfclass != RF_NEW)
+        rf_move(busnumber, e, RF_NEW);
+}
+
+static void init_refresh(bus_t busnumber)
+{
+    int i;
+
+    for (i = 0; i < RF_CLASSES; i++)
+        __DDL->rfRing[i] = NULL;
+    __DDL->rfSlot = 0;
+}
+
+/**
+ * Refresh Intervalle aller Loks melden (DBG_DEBUG je Lok, DBG_INFO je Protokoll)
+ * und für die nächste Periode zurücksetzen.
+ */
+static void report_refresh_statistics(bus_t busnumber)
+{
+    static const char *names[STAT_PROTOCOLS] = { "MM", "DCC", "MFX" };
+    unsigned long locos[STAT_PROTOCOLS] = { 0 };
+    unsigned long late[STAT_PROTOCOLS] = { 0 };
+    long long mean[STAT_PROTOCOLS] = { 0 };
+    long long max[STAT_PROTOCOLS] = { 0 };
+    tRefreshEntry *e;
+    int rfclass, p;
+
+    for (rfclass = RF_NEW; rfclass <= RF_STALE; rfclass++) {
+        e = __DDL->rfRing[rfclass];
+        if (e == NULL)
+            continue;
+        do {
+            if (e->refreshs > 0) {
+                p = protocol_index(e->protocol);
+                syslog_bus(busnumber, DBG_DEBUG,
+                           "Refresh %s %d: %lu times, mean %lld ms, max %lld ms",
+                           names[p], e->adr, e->refreshs,
+                           e->sumInterval / e->refreshs / 1000,
+                           e->maxInterval / 1000);
+                locos[p]++;
+                mean[p] += e->sumInterval / e->refreshs;
+                if (e->maxInterval > max[p])
+                    max[p] = e->maxInterval;
+                if (e->maxInterval > __DDL->rfPeriod[p])
+                    late[p]++;
+            }
+            e->maxInterval = 0;
+            e->sumInterval = 0;
+            e->refreshs = 0;
+            e = e->link[0].next;
+        } while (e != __DDL->rfRing[rfclass]);
+    }
+    for (p = 0; p < STAT_PROTOCOLS; p++) {
+        if (locos[p] == 0)
+            continue;
+        syslog_bus(busnumber, DBG_INFO,
+                   "Refresh %s: %lu locos, mean %lld ms, max %lld ms, "
+                   "%lu over %lld ms", names[p], locos[p],
+                   mean[p] / locos[p] / 1000, max[p] / 1000, late[p],
+                   __DDL->rfPeriod[p] / 1000);
+    }
+}
+
+/****** routines for runtime statistics *********************/
+
+/* nur der Bus Thread schreibt, Leser sehen trotzdem keine halben Werte */
+#define STAT_GET(v)     __atomic_load_n(&(v), __ATOMIC_RELAXED)
+#define STAT_ADD(v, n)  __atomic_store_n(&(v), STAT_GET(v) + (n), __ATOMIC_RELAXED)
+#define STAT_MAX(v, n) \
+    do { \
+        if ((n) > STAT_GET(v)) \
+            __atomic_store_n(&(v), (n), __ATOMIC_RELAXED); \
+    } while (0)
+
+/* von SIGUSR1 hochgezählt, jeder Bus Thread meldet dann seine Statistik */
+static volatile sig_atomic_t stat_dump_request = 0;
+
+static void init_statistics(bus_t busnumber)
+{
+    memset(&__DDL->stat, 0, sizeof(__DDL->stat));
+    __DDL->stat.dumpSeen = stat_dump_request;
+    __DDL->spiBatch.tv_stat.tv_sec = 0;
+    __DDL->spiBatch.ioctls = 0;
+    memset(__DDL->spiBatch.packets, 0, sizeof(__DDL->spiBatch.packets));
+}
+
+/* Zeit in µs in das Histogramm eintragen */
+static void stat_histogram(unsigned long long *hist, unsigned long long usec)
+{
+    int b = (usec == 0) ? 0 : 64 - __builtin_clzll(usec);
+
+    if (b >= STAT_HIST_BUCKETS)
+        b = STAT_HIST_BUCKETS - 1;
+    STAT_ADD(hist[b], 1);
+}
+
+/* Ende eines Durchlaufs der Hauptschleife mit eingeschaltetem Gleis */
+static void stat_cycle(bus_t busnumber)
+{
+    tDdlStat *st = &__DDL->stat;
+    long long now = now_usec();
+    unsigned long long period;
+
+    if (st->lastCycle != 0) {
+        period = now - st->lastCycle;
+        STAT_ADD(st->cycles, 1);
+        STAT_ADD(st->cycleSum, period);
+        STAT_MAX(st->cycleMax, period);
+        stat_histogram(st->cycleHist, period);
+    }
+    st->lastCycle = now;
+}
+
+static void stat_refresh(bus_t busnumber, long long interval)
+{
+    tDdlStat *st = &__DDL->stat;
+
+    STAT_ADD(st->refreshs, 1);
+    STAT_ADD(st->refreshSum, interval);
+    STAT_MAX(st->refreshMax, interval);
+    stat_histogram(st->refreshHist, interval);
+}
+
+static int print_histogram(char *text, size_t len, unsigned long long *hist)
+{
+    int i, n = 0;
+
+    for (i = 0; i < STAT_HIST_BUCKETS && n < (int)len; i++)
+        n += snprintf(text + n, len - n, " %llu", STAT_GET(hist[i]));
+    return n;
+}
+
+/**
+ * Eine Zeile der Statistik ohne Zeitstempel erzeugen, item ist
+ * LOOP, PACKETS, QUEUE oder REFRESH.
+ * @return SRCP_OK oder SRCP_WRONGVALUE bei unbekanntem item
+ */
+static int print_statistics(bus_t busnumber, const char *item,
+                            char *text, size_t len)
+{
+    tDdlStat *st = &__DDL->stat;
+    unsigned long long count;
+    int n;
+
+    if (strcasecmp(item, "LOOP") == 0) {
+        count = STAT_GET(st->cycles);
+        n = snprintf(text, len, "LOOP %llu %llu %llu", count,
+                     count ? STAT_GET(st->cycleSum) / count : 0,
+                     STAT_GET(st->cycleMax));
+        print_histogram(text + n, len - n, st->cycleHist);
+    }
+    else if (strcasecmp(item, "PACKETS") == 0) {
+        snprintf(text, len, "PACKETS %llu %llu %llu %llu",
+                 STAT_GET(st->packets[STAT_MM]),
+                 STAT_GET(st->packets[STAT_DCC]),
+                 STAT_GET(st->packets[STAT_MFX]), STAT_GET(st->ioctls));
+    }
+    else if (strcasecmp(item, "QUEUE") == 0) {
+        snprintf(text, len, "QUEUE %llu %u %llu %u %llu",
+                 STAT_GET(st->glCommands), STAT_GET(st->glDepthMax),
+                 STAT_GET(st->gaCommands), STAT_GET(st->gaDepthMax),
+                 STAT_GET(st->smCommands));
+    }
+    else if (strcasecmp(item, "REFRESH") == 0) {
+        count = STAT_GET(st->refreshs);
+        n = snprintf(text, len, "REFRESH %llu %llu %llu", count,
+                     count ? STAT_GET(st->refreshSum) / count : 0,
+                     STAT_GET(st->refreshMax));
+        print_histogram(text + n, len - n, st->refreshHist);
+    }
+    else
+        return SRCP_WRONGVALUE;
+    return SRCP_OK;
+}
+
+/**
+ * GET <bus> STAT <item>
+ *   LOOP    <Durchläufe> <mittlere µs> <max µs> <Histogramm>
+ *   PACKETS <MM> <DCC> <MFX> <SPI ioctls>
+ *   QUEUE   <GL Kommandos> <max GL Queue> <GA Kommandos> <max GA Queue>
+ *           <SM Kommandos>
+ *   REFRESH <Refreshs> <mittlere µs> <max µs> <Histogramm>
+ * Das Histogramm hat STAT_HIST_BUCKETS Werte wie in ddl.h beschrieben.
+ * Alle Werte zählen seit dem Start des Busses.
+ */
+int info_stat_DDL(bus_t busnumber, char *item, char *msg)
+{
+    char text[MAXSRCPLINELEN - 40], name[12];
+    struct timeval now;
+    int rc;
+
+    if (sscanf(item, "%10s", name) < 1)
+        return SRCP_LISTTOOSHORT;
+    rc = print_statistics(busnumber, name, text, sizeof(text));
+    if (rc != SRCP_OK)
+        return rc;
+    gettimeofday(&now, NULL);
+    sprintf(msg, "%lld.%.3ld 100 INFO %lu STAT %s\n",
+            (long long) now.tv_sec, (long) (now.tv_usec / 1000),
+            busnumber, text);
+    return SRCP_INFO;
+}
+
+/* aus dem Signal Handler, nur ein Zähler wird verändert */
+void request_statistics_DDL(void)
+{
+    stat_dump_request++;
+}
+
+static void dump_statistics(bus_t busnumber)
+{
+    static const char *items[] = { "LOOP", "PACKETS", "QUEUE", "REFRESH" };
+    char text[MAXSRCPLINELEN];
+    int i;
+
+    __DDL->stat.dumpSeen = stat_dump_request;
+    for (i = 0; i < (int)(sizeof(items) / sizeof(items[0])); i++) {
+        print_statistics(busnumber, items[i], text, sizeof(text));
+        syslog_bus(busnumber, DBG_INFO, "STAT %s", text);
     }
+    report_refresh_statistics(busnumber);
+}
 
-    for (i = 0; i <= MAX_MARKLIN_ADDRESS; i++)
+/****** routines for Maerklin packet pool *********************/
+
+static void init_MaerklinPacketPool(bus_t busnumber)
+{
+    int i, j;
+
+    for (i = 0; i <= MAX_MARKLIN_ADDRESS; i++) {
         __DDL->MaerklinPacketPool.knownAddresses[i] = 0;
+        __DDL->MaerklinPacketPool.packets[i].rf.rfclass = -1;
+    }
 
     __DDL->MaerklinPacketPool.NrOfKnownAddresses = 1;
     __DDL->MaerklinPacketPool.knownAddresses[__DDL->MaerklinPacketPool.
@@ -411,13 +707,8 @@ static void init_MaerklinPacketPool(bus_t busnumber)
             __DDL->MaerklinPacketPool.packets[81].f_packets[j][2 * i + 1] = getMaerklinLO();
         }
     }
-
-    result = pthread_mutex_unlock(&__DDL->maerklin_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_unlock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
+    rf_insert(busnumber, &__DDL->MaerklinPacketPool.packets[81].rf,
+              EP_MAERKLIN, 81, false);
 }
 
 char *get_maerklin_packet(bus_t busnumber, int adr, int fx)
@@ -431,7 +722,6 @@ void update_MaerklinPacketPool(bus_t busnumber, int adr,
                                char const *const f3, char const *const f4)
 {
     int i, found;
-    int result;
 
     syslog_bus(busnumber, DBG_INFO, "Update MM packet pool: %d", adr);
     found = 0;
@@ -440,13 +730,6 @@ void update_MaerklinPacketPool(bus_t busnumber, int adr,
         if (__DDL->MaerklinPacketPool.knownAddresses[i] == adr)
             found = true;
 
-    result = pthread_mutex_lock(&__DDL->maerklin_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_lock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
-
     __DDL->MaerklinPacketPool.packets[adr].timeLastUpdate = time(NULL);
     memcpy(__DDL->MaerklinPacketPool.packets[adr].packet, sd_packet, 18);
     memcpy(__DDL->MaerklinPacketPool.packets[adr].f_packets[0], f1, 18);
@@ -454,36 +737,28 @@ void update_MaerklinPacketPool(bus_t busnumber, int adr,
     memcpy(__DDL->MaerklinPacketPool.packets[adr].f_packets[2], f3, 18);
     memcpy(__DDL->MaerklinPacketPool.packets[adr].f_packets[3], f4, 18);
 
-    result = pthread_mutex_unlock(&__DDL->maerklin_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_unlock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
-
     if (__DDL->MaerklinPacketPool.NrOfKnownAddresses == 1
-        && __DDL->MaerklinPacketPool.knownAddresses[0] == 81)
+        && __DDL->MaerklinPacketPool.knownAddresses[0] == 81) {
         __DDL->MaerklinPacketPool.NrOfKnownAddresses = 0;
+        /* no more idle packets */
+        rf_remove(busnumber, &__DDL->MaerklinPacketPool.packets[81].rf);
+    }
 
     if (!found) {
         __DDL->MaerklinPacketPool.knownAddresses[__DDL->MaerklinPacketPool.
                                                  NrOfKnownAddresses] = adr;
         __DDL->MaerklinPacketPool.NrOfKnownAddresses++;
     }
+    if (__DDL->MaerklinPacketPool.packets[adr].rf.rfclass < 0)
+        rf_insert(busnumber, &__DDL->MaerklinPacketPool.packets[adr].rf,
+                  EP_MAERKLIN, adr, true);
+    rf_command(busnumber, &__DDL->MaerklinPacketPool.packets[adr].rf);
 }
 
-
 /****** routines for NMRA packet pool *********************/
 static void reset_NMRAPacketPool(bus_t busnumber)
 {
     int i;
-    int result;
-    result = pthread_mutex_lock(&__DDL->nmra_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_lock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
 
     for (i = 0; i < __DDL->NMRAPacketPool.NrOfKnownAddresses; i++) {
         int nr = __DDL->NMRAPacketPool.knownAddresses[i];
@@ -496,48 +771,54 @@ static void reset_NMRAPacketPool(bus_t busnumber)
        refreshed -> TODO: a better place for this free would be in
        update_NMRAPacketPool */
     free(__DDL->NMRAPacketPool.packets[128]);
+}
 
-    result = pthread_mutex_unlock(&__DDL->nmra_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_unlock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
+// SPI Bytes für jedes mögliche Nibble eines NMRA Packets, das niederwertigste Bit zuerst
+// 1 : 0xFF, 0x00 -> Ein Impuls in 2 Bytes, Baudrate ist so, dass diese Ausgabe 116us dauert
+// 0 : 0xFF, 0xFF, 0x00, 0x00 -> Ein Impuls in 4 Bytes, damit 116us HI, 116us LOW
+static char nmra_spi_nibble[16][16];
+static unsigned char nmra_spi_nibble_len[16];
 
+static unsigned int appendNMRABitToSPIStream(char *spiBuffer, unsigned int len, int bit) {
+  spiBuffer[len++] = 0xFF;
+  if (! bit) spiBuffer[len++] = 0xFF;
+  spiBuffer[len++] = 0x00;
+  if (! bit) spiBuffer[len++] = 0x00;
+  return len;
+}
+
+static void init_NMRASPITable(void) {
+  unsigned int n, i;
+  for (n=0; n<16; n++) {
+    nmra_spi_nibble_len[n] = 0;
+    for (i=0; i<4; i++) {
+      nmra_spi_nibble_len[n] = appendNMRABitToSPIStream(nmra_spi_nibble[n], nmra_spi_nibble_len[n], n & (1 << i));
+    }
+  }
 }
 
 /**
  * Konvertiert ein für SPI Ausgabe bestimmtest NMRA Packet in den zur Ausgabe benötigten Bytestream.
+ * Volle Nibble werden über die Tabelle nmra_spi_nibble kopiert, nur die restlichen Bits einzeln.
+ * Bei 255 Bits wird dabei höchstens bis Byte 1021 geschrieben.
  * @param packet Das zu konvertierende Packet. Im ersten Byte werden die Anzahl Bits angegegebn, die
  *               ab dem 2. Byte folgendes
  * @param spiBuffer Buffer zur Speicherung des SPI Bytestream. Muss mindestens 256*4 Bytes gross sein.
  * @return Länge des spiBuffer.
  */
 static unsigned int convertNMRAPacketToSPIStream(bus_t busnumber, char *packet, char *spiBuffer) {
-  // 1 : 0xFF, 0x00 -> Ein Impuls in 2 Bytes, Baudrate ist so, dass diese Ausgabe 116us dauert
-  // 0 : 0xFF, 0xFF, 0x00, 0x00 -> Ein Impuls in 4 Bytes, damit 116us HI, 116us LOW
   unsigned int len = 0;
-  unsigned int i;
+  unsigned int bits = (unsigned char)packet[0];
+  unsigned int i, nibble;
   spiBuffer[len++] = 0x00;  // BananaPi
-  for (i=0; i<(unsigned char)packet[0]; i++) {
-    if (packet[(i / 8) + 1] & (1 << (i % 8))) {
-      //1
-      spiBuffer[len] = 0xFF;
-      len++;
-      spiBuffer[len] = 0x00;
-      len++;
-    }
-    else {
-      //0
-      spiBuffer[len] = 0xFF;
-      len++;
-      spiBuffer[len] = 0xFF;
-      len++;
-      spiBuffer[len] = 0x00;
-      len++;
-      spiBuffer[len] = 0x00;
-      len++;
-    }
+  for (i=0; i+4<=bits; i+=4) {
+    nibble = ((unsigned char)packet[(i / 8) + 1] >> (i % 8)) & 0x0F;
+    // immer volle 16 Bytes kopieren, der Rest wird vom nächsten Nibble überschrieben
+    memcpy(spiBuffer + len, nmra_spi_nibble[nibble], 16);
+    len += nmra_spi_nibble_len[nibble];
+  }
+  for (; i<bits; i++) {
+    len = appendNMRABitToSPIStream(spiBuffer, len, packet[(i / 8) + 1] & (1 << (i % 8)));
   }
   spiBuffer[len++] = 0xFF;  // RM: noch mindestens eine EINS dranhängen
   spiBuffer[len++] = 0x00;
@@ -552,22 +833,6 @@ static void init_NMRAPacketPool(bus_t busnumber)
     int i, j;
     char idle_packet[] = "1111111111111110111111110000000000111111111";
     char idle_pktstr[PKTSIZE];
-    int result;
-
-    result = pthread_mutex_init(&__DDL->nmra_pktpool_mutex, NULL);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_init() failed: %s (error = %d). Terminating!\n",
-                   strerror(result), result);
-        exit(EXIT_FAILURE);
-    }
-
-    result = pthread_mutex_lock(&__DDL->nmra_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_lock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
 
     for (i = 0; i <= MAX_NMRA_ADDRESS; i++) {
         __DDL->NMRAPacketPool.knownAddresses[i] = 0;
@@ -576,18 +841,12 @@ static void init_NMRAPacketPool(bus_t busnumber)
 
     __DDL->NMRAPacketPool.NrOfKnownAddresses = 0;
 
-    result = pthread_mutex_unlock(&__DDL->nmra_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_unlock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
-
     /* put idle packet in packet pool */
     j = translateBitstream2Packetstream(busnumber, idle_packet, idle_pktstr);
     update_NMRAPacketPool(busnumber, 128, idle_pktstr, j, idle_pktstr, j);
 
     /* generate and override idle_data */
+    init_NMRASPITable();
     memset (&spi_nmra_idle, 0, sizeof (spi_nmra_idle)) ;
     spi_nmra_idle.len = convertNMRAPacketToSPIStream(busnumber, idle_pktstr, __DDL->NMRA_idle_data);
     spi_nmra_idle.tx_buf =  (unsigned long)__DDL->NMRA_idle_data;
@@ -600,7 +859,6 @@ void update_NMRAPacketPool(bus_t busnumber, int adr,
                            char const *const fx_packet, int fx_packet_size)
 {
     int i, found;
-    int result;
 
     found = 0;
     for (i = 0; i <= __DDL->NMRAPacketPool.NrOfKnownAddresses && !found;
@@ -608,12 +866,6 @@ void update_NMRAPacketPool(bus_t busnumber, int adr,
         if (__DDL->NMRAPacketPool.knownAddresses[i] == adr)
             found = true;
 
-    result = pthread_mutex_lock(&__DDL->nmra_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_lock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
     if (!__DDL->NMRAPacketPool.packets[adr]) {
         __DDL->NMRAPacketPool.packets[adr] = malloc(sizeof(tNMRAPacket));
         if (__DDL->NMRAPacketPool.packets[adr] == NULL) {
@@ -621,6 +873,7 @@ void update_NMRAPacketPool(bus_t busnumber, int adr,
                        "Memory allocation error in update_NMRAPacketPool");
             return;
         }
+        __DDL->NMRAPacketPool.packets[adr]->rf.rfclass = -1;
     }
     __DDL->NMRAPacketPool.packets[adr]->timeLastUpdate = time(NULL);
     memcpy(__DDL->NMRAPacketPool.packets[adr]->packet, packet,
@@ -630,53 +883,40 @@ void update_NMRAPacketPool(bus_t busnumber, int adr,
            fx_packet_size);
     __DDL->NMRAPacketPool.packets[adr]->fx_packet_size = fx_packet_size;
 
-
     if (__DDL->NMRAPacketPool.NrOfKnownAddresses == 1
-        && __DDL->NMRAPacketPool.knownAddresses[0] == 128)
+        && __DDL->NMRAPacketPool.knownAddresses[0] == 128) {
         __DDL->NMRAPacketPool.NrOfKnownAddresses = 0;
+        /* no more idle packets */
+        rf_remove(busnumber, &__DDL->NMRAPacketPool.packets[128]->rf);
+    }
 
     if (!found) {
         __DDL->NMRAPacketPool.knownAddresses[__DDL->NMRAPacketPool.
                                              NrOfKnownAddresses] = adr;
         __DDL->NMRAPacketPool.NrOfKnownAddresses++;
     }
-    result = pthread_mutex_unlock(&__DDL->nmra_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_unlock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
+    /* address 128 is the idle packet */
+    if (__DDL->NMRAPacketPool.packets[adr]->rf.rfclass < 0)
+        rf_insert(busnumber, &__DDL->NMRAPacketPool.packets[adr]->rf,
+                  EP_NMRADCC, adr, adr != 128);
+    if (adr != 128)
+        rf_command(busnumber, &__DDL->NMRAPacketPool.packets[adr]->rf);
 }
 
 /****** routines for MFX packet pool *********************/
 static void reset_MFXPacketPool(bus_t busnumber)
 {
     int i;
-    int result;
 
     if (stopMFXThreads() != 0) {
       syslog_bus(busnumber, DBG_ERROR, "stopMFXThreads failed.");
     }
 
-    result = pthread_mutex_lock(&__DDL->mfx_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_lock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
-
     for (i = 0; i < __DDL->MFXPacketPool.NrOfKnownAddresses; i++) {
         int nr = __DDL->MFXPacketPool.knownAddresses[i];
         free(__DDL->MFXPacketPool.packets[nr]);
         __DDL->MFXPacketPool.packets[nr] = 0;
     }
-
-    result = pthread_mutex_unlock(&__DDL->mfx_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_unlock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
 }
 
 /**
@@ -870,22 +1110,6 @@ static unsigned int convertMFXPacketToSPIStream(bus_t busnumber, char *packet, c
 static void init_MFXPacketPool(bus_t busnumber)
 {
     int i;
-    int result;
-
-    result = pthread_mutex_init(&__DDL->mfx_pktpool_mutex, NULL);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_init() failed: %s (error = %d). Terminating!\n",
-                   strerror(result), result);
-        exit(1);
-    }
-
-    result = pthread_mutex_lock(&__DDL->mfx_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_lock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
 
     for (i = 0; i <= MAX_MFX_ADDRESS; i++) {
         __DDL->MFXPacketPool.knownAddresses[i] = 0;
@@ -893,12 +1117,6 @@ static void init_MFXPacketPool(bus_t busnumber)
     }
     __DDL->MFXPacketPool.NrOfKnownAddresses = 0;
 
-    result = pthread_mutex_unlock(&__DDL->mfx_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_unlock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
     if (startMFXThreads(busnumber, __DDL->feedbackPipe[0])!= 0) {
         syslog_bus(busnumber, DBG_ERROR,
                    "startMFXThreads failed.");
@@ -910,7 +1128,6 @@ void update_MFXPacketPool(bus_t busnumber, int adr,
 {
 //  printf("update_MFXPacketPool(busnumber=%d, adr=%d, packet, packet_size=%d\n", busnumber, adr, packet_size);
     int i, found;
-    int result;
 
     found = 0;
     for (i = 0; i <= __DDL->MFXPacketPool.NrOfKnownAddresses && !found; i++) {
@@ -919,12 +1136,6 @@ void update_MFXPacketPool(bus_t busnumber, int adr,
         }
     }
 
-    result = pthread_mutex_lock(&__DDL->mfx_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_lock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
     if (!__DDL->MFXPacketPool.packets[adr]) {
         __DDL->MFXPacketPool.packets[adr] = malloc(sizeof(tMFXPacket));
         if (__DDL->MFXPacketPool.packets[adr] == NULL) {
@@ -932,6 +1143,7 @@ void update_MFXPacketPool(bus_t busnumber, int adr,
                        "Memory allocation error in update_MFXPacketPool");
             return;
         }
+        __DDL->MFXPacketPool.packets[adr]->rf.rfclass = -1;
     }
     memcpy(__DDL->MFXPacketPool.packets[adr]->packet, packet, packet_size);
     __DDL->MFXPacketPool.packets[adr]->packet_size = packet_size;
@@ -941,12 +1153,11 @@ void update_MFXPacketPool(bus_t busnumber, int adr,
         __DDL->MFXPacketPool.knownAddresses[__DDL->MFXPacketPool.NrOfKnownAddresses] = adr;
         __DDL->MFXPacketPool.NrOfKnownAddresses++;
     }
-    result = pthread_mutex_unlock(&__DDL->mfx_pktpool_mutex);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                   "pthread_mutex_unlock() failed: %s (errno = %d).",
-                   strerror(result), result);
-    }
+    /* mfx packets contain the functions */
+    if (__DDL->MFXPacketPool.packets[adr]->rf.rfclass < 0)
+        rf_insert(busnumber, &__DDL->MFXPacketPool.packets[adr]->rf,
+                  EP_MFX, adr, false);
+    rf_command(busnumber, &__DDL->MFXPacketPool.packets[adr]->rf);
 }
 /**************************************************************************/
 
@@ -1007,7 +1218,136 @@ static void set_SerialLine(bus_t busnumber, int line, int mode)
   #endif
 }
 
+/**
+ * Gesammelte SPI Transfers mit einem einzigen ioctl ausgeben.
+ * Alle SPI_STAT_INTERVAL Sekunden werden die erreichten Paketraten gemeldet.
+ */
+void flush_spi_batch(bus_t busnumber)
+{
+    tSpiBatch *batch = &__DDL->spiBatch;
+    long long elapsed;
+    unsigned int i;
+
+    if (batch->count > 0) {
+        int fd = buses[busnumber].device.file.fd;
+        if (ioctl(fd, SPI_IOC_MESSAGE(batch->count), batch->xfer) < 0) {
+            //nicht alle Pakete des Zyklus verlieren, einzeln ausgeben
+            syslog_bus(busnumber, DBG_ERROR,
+                       "SPI batch ioctl failed: %s, sending %u transfers singly.",
+                       strerror(errno), batch->count);
+            for (i = 0; i < batch->count; i++) {
+                if (ioctl(fd, SPI_IOC_MESSAGE(1), &batch->xfer[i]) < 0) {
+                    syslog_bus(busnumber, DBG_FATAL, "Error SPI Transfer ioctl.");
+                }
+                STAT_ADD(__DDL->stat.ioctls, 1);
+            }
+        }
+        else
+            STAT_ADD(__DDL->stat.ioctls, 1);
+        batch->count = 0;
+        batch->used = 0;
+        batch->txbytes = 0;
+    }
+    if (batch->tv_stat.tv_sec == 0) {
+        gettimeofday(&batch->tv_stat, NULL);
+        return;
+    }
+    elapsed = timeSince(batch->tv_stat);
+    if (elapsed >= SPI_STAT_INTERVAL * 1000000LL) {
+        tDdlStat *st = &__DDL->stat;
+        syslog_bus(busnumber, DBG_INFO,
+                   "SPI packets/s: MM %llu, DCC %llu, MFX %llu with %llu ioctl/s",
+                   (st->packets[STAT_MM] - batch->packets[STAT_MM]) * 1000000ULL / elapsed,
+                   (st->packets[STAT_DCC] - batch->packets[STAT_DCC]) * 1000000ULL / elapsed,
+                   (st->packets[STAT_MFX] - batch->packets[STAT_MFX]) * 1000000ULL / elapsed,
+                   (st->ioctls - batch->ioctls) * 1000000ULL / elapsed);
+        report_refresh_statistics(busnumber);
+        memcpy(batch->packets, st->packets, sizeof(batch->packets));
+        batch->ioctls = st->ioctls;
+        gettimeofday(&batch->tv_stat, NULL);
+    }
+}
+
+/**
+ * Leeren Batch anlegen, die Bytes je ioctl begrenzt der bufsiz Parameter
+ * des spidev Moduls.
+ */
+static void init_spi_batch(bus_t busnumber)
+{
+    tSpiBatch *batch = &__DDL->spiBatch;
+    unsigned int bufsiz = 0;
+    FILE *f;
+
+    batch->count = 0;
+    batch->used = 0;
+    batch->txbytes = 0;
+    f = fopen(SPIDEV_BUFSIZ_PARAM, "r");
+    if (f != NULL) {
+        if (fscanf(f, "%u", &bufsiz) != 1)
+            bufsiz = 0;
+        fclose(f);
+    }
+    if (bufsiz < SPI_PKT_MAXSIZE)
+        bufsiz = SPIDEV_BUFSIZ_DEFAULT;
+    batch->maxbytes = bufsiz;
+    syslog_bus(busnumber, DBG_INFO, "SPI batch up to %u bytes per ioctl.",
+               bufsiz);
+}
+
+/**
+ * Platz für ein Paket mit bis zu xmits + 1 Transfers im Batch reservieren,
+ * falls nötig wird der Batch vorher ausgegeben.
+ * @return Buffer mit SPI_PKT_MAXSIZE Bytes für das Paket
+ */
+static char *reserve_spi_batch(bus_t busnumber, int xmits)
+{
+    tSpiBatch *batch = &__DDL->spiBatch;
+
+    if ((batch->count + xmits + 1 > SPI_BATCH_TRANSFERS) ||
+        (batch->used + SPI_PKT_MAXSIZE > SPI_BATCH_BUFSIZE)) {
+        flush_spi_batch(busnumber);
+    }
+    return batch->buffer + batch->used;
+}
+
+/**
+ * Transfer an den Batch anhängen, das Paket wird xmits mal ausgegeben.
+ * Würde der Batch mehr Transfers oder Bytes als ein ioctl erlaubt
+ * enthalten, wird er vorher ausgegeben.
+ * @param spiBuffer von reserve_spi_batch geliefert oder statische Daten
+ * @param reserved true wenn spiBuffer im Batch Buffer liegt
+ */
+static void queue_spi_transfer(bus_t busnumber, char *spiBuffer, unsigned int len,
+                               uint32_t speed, int xmits, bool reserved)
+{
+    tSpiBatch *batch = &__DDL->spiBatch;
+    struct spi_ioc_transfer *spi;
+
+    while (xmits-- > 0) {
+        if (batch->count > 0 && (batch->count >= SPI_BATCH_TRANSFERS ||
+                batch->txbytes + len > batch->maxbytes)) {
+            flush_spi_batch(busnumber);
+        }
+        //nach einem flush seit reserve_spi_batch an den Anfang schieben
+        if (reserved && spiBuffer != batch->buffer + batch->used) {
+            memmove(batch->buffer + batch->used, spiBuffer, len);
+            spiBuffer = batch->buffer + batch->used;
+        }
+        batch->txbytes += len;
+        spi = &batch->xfer[batch->count++];
+        memset(spi, 0, sizeof(*spi));
+        spi->tx_buf = (unsigned long)spiBuffer;
+        spi->len = len;
+        spi->speed_hz = speed;
+        spi->bits_per_word = 8;
+    }
+    if (reserved) batch->used += len;
+}
+
 #define PAUSE_START 2
+// Pause vor dem ersten MM Paket, längste Pause ist pause_end für Funktionen
+static char spi_mm_pause[64];
+
 void send_packet(bus_t busnumber, char *packet,
                         int packet_size, int packet_type, int xmits)
 {
@@ -1018,16 +1358,12 @@ void send_packet(bus_t busnumber, char *packet,
     /* arguments for nanosleep and Maerklin solenoids/function decoders (38KHz) */
 //SID, 04.01.08 : Wartezeit wäre theoretisch schon 850us, dies geht aber mit den LDT Dekodern nicht....
 
-    unsigned int pause_btw, pause_end;
-
-    struct spi_ioc_transfer spi;	// tx_buf; rx_buf; len; speed_hz; delay_usecs;
-									// bits_per_word; cs_change; pad;
-    char spiBuffer[1600]  = { 0 };	// worst case is QMFX32PKT
-
-    memset (&spi, 0, sizeof (spi)) ;
-    spi.bits_per_word = 8;
-    spi.tx_buf = (unsigned long)spiBuffer;
+    unsigned int pause_btw, pause_end, len;
+    uint32_t speed_hz;
+    char *spiBuffer;
 
+    //Die Ausgabe erfolgt gesammelt über flush_spi_batch, nur MFX Pakete mit Rückmeldung
+    //werden sofort ausgegeben.
     switch (packet_type) {
         case QM1LOCOPKT:
         case QM2LOCOPKT:
@@ -1046,21 +1382,20 @@ void send_packet(bus_t busnumber, char *packet,
             if ((packet_type == QM1FUNCPKT) || (packet_type == QM1SOLEPKT)) {
                pause_btw = 12;			// for functions multiples of 52µs
                pause_end = 59;
-               spi.speed_hz = SPI_BAUDRATE_MAERKLIN_FUNC_2;
+               speed_hz = SPI_BAUDRATE_MAERKLIN_FUNC_2;
             }
             else {
                  pause_btw = 12;		// for locos multiples of 104µs
                  pause_end = 42;
-                 spi.speed_hz = SPI_BAUDRATE_MAERKLIN_LOCO_2;
+                 speed_hz = SPI_BAUDRATE_MAERKLIN_LOCO_2;
             }
+            spiBuffer = reserve_spi_batch(busnumber, xmits);
             if (! __DDL->spiLastMM) {
                //Wenn das letzte Paket kein MM Paket war, dann wird am Anfang noch eine Pause eingefügt
-               spi.len = pause_end;
-               if (ioctl(buses[busnumber].device.file.fd, SPI_IOC_MESSAGE(1), &spi) < 0) {
-                  syslog_bus(busnumber, DBG_FATAL, "Error SPI Transfer ioctl.");
-               return;
-               }
+               queue_spi_transfer(busnumber, spi_mm_pause, pause_end, speed_hz, 1, false);
             }
+            len = PAUSE_START + 2 * (packet_size * 2) + pause_btw + pause_end;
+            memset(spiBuffer, 0, len);
             for (i=0; i<packet_size; i++) {
                 if (packet[i]) {
                 //1
@@ -1080,55 +1415,47 @@ void send_packet(bus_t busnumber, char *packet,
             }
             // doubling the MM packet
             memcpy(&(spiBuffer[PAUSE_START + packet_size * 2 + pause_btw]), &(spiBuffer[PAUSE_START]), packet_size * 2);
-            spi.len = PAUSE_START + 2 * (packet_size * 2) + pause_btw + pause_end;
             __DDL->spiLastMM = 1;
-            for (i = 0; i < xmits; i++) {
-                if (ioctl(buses[busnumber].device.file.fd, SPI_IOC_MESSAGE(1), &spi) < 0) {
-                  syslog_bus(busnumber, DBG_FATAL, "Error SPI Transfer ioctl.");
-                  return;
-                }
-            }
+            queue_spi_transfer(busnumber, spiBuffer, len, speed_hz, xmits, true);
+            STAT_ADD(__DDL->stat.packets[STAT_MM], xmits);
             break;
         case QNBLOCOPKT:
         case QNBACCPKT:
             __DDL->spiLastMM = 0;
-            spi.len = convertNMRAPacketToSPIStream(busnumber, packet, spiBuffer);
-            spi.speed_hz = SPI_BAUDRATE_NMRA_2;
-            for (i = 0; i < xmits; i++) {
-            	if (ioctl(buses[busnumber].device.file.fd, SPI_IOC_MESSAGE(1), &spi) < 0) {
-                	syslog_bus(busnumber, DBG_FATAL, "Error SPI Transfer ioctl.");
-                	return;
-                }
-            }
+            spiBuffer = reserve_spi_batch(busnumber, xmits);
+            len = convertNMRAPacketToSPIStream(busnumber, packet, spiBuffer);
+            queue_spi_transfer(busnumber, spiBuffer, len, SPI_BAUDRATE_NMRA_2, xmits, true);
+            STAT_ADD(__DDL->stat.packets[STAT_DCC], xmits);
             break;
         case QMFX1PKTD:
         case QMFX1PKTV:
         case QMFX8PKT:
         case QMFX16PKT:
         case QMFX32PKT:
+            //Bei Rückmeldung muss alles bisherige schon auf dem Gleis sein
+            flush_spi_batch(busnumber);
 			i = rxstartwait_comport(&sercomm_mfx);
 			syslog_bus(busnumber, DBG_DEBUG, "rxstartwait_comport returned %d", i);
             write(__DDL->feedbackPipe[1], &packet_type, 1);
         case QMFX0PKT:
             __DDL->spiLastMM = 0;
-			spi.len = convertMFXPacketToSPIStream(busnumber, packet, spiBuffer, packet_type);
-            spi.speed_hz = SPI_BAUDRATE_MFX_2;
-            if (spi.len > sizeof(spiBuffer)) {
+            spiBuffer = reserve_spi_batch(busnumber, xmits);
+            memset(spiBuffer, 0, SPI_PKT_MAXSIZE);
+			len = convertMFXPacketToSPIStream(busnumber, packet, spiBuffer, packet_type);
+            if (len > SPI_PKT_MAXSIZE) {
                //Buffer war zu klein, es wurde Speicher überschrieben.
                syslog_bus(busnumber, DBG_FATAL,
                        "MFX SPI Buffer Override. Buffersize=%d, Bytes write=%d",
-                       sizeof(spiBuffer), spi.len);
+                       SPI_PKT_MAXSIZE, len);
                /*What to do now ?*/
                exit(1);
             }
             // multiple transmission only if no feedback
-            for (i=0; i<(packet_type == QMFX0PKT ? xmits : 1); i++) {
-              if (ioctl(buses[busnumber].device.file.fd, SPI_IOC_MESSAGE(1), &spi) < 0) {
-                syslog_bus(busnumber, DBG_FATAL, "Error SPI Transfer ioctl.");
-                return;
-              }
-            }
+            i = (packet_type == QMFX0PKT ? xmits : 1);
+            queue_spi_transfer(busnumber, spiBuffer, len, SPI_BAUDRATE_MFX_2, i, true);
+            STAT_ADD(__DDL->stat.packets[STAT_MFX], i);
 			if (packet_type != QMFX0PKT) {
+                flush_spi_batch(busnumber);
 				i = read_comport(busnumber, sizeof(feedbackbuf), feedbackbuf);
 				if (i) serialMFXresult(feedbackbuf, i);
 			}
@@ -1136,146 +1463,97 @@ void send_packet(bus_t busnumber, char *packet,
 	}
 }
 
+/* Verteilung der Refresh Slots auf die Prioritätsklassen */
+static const int rf_slots[] = {
+    RF_NEW, RF_RECENT, RF_NEW, RF_STALE, RF_NEW, RF_RECENT, RF_NEW, RF_FUNC
+};
+
 /**
  * Refresh Paket der nächsten Lok senden.
- * Es werden alle Loks jedes aktivierten Protokolles der Reihe nach berücksichtigt.
+ * Jeder Aufruf belegt einen Slot aus rf_slots. Ist die Klasse des Slots leer,
+ * kommt die nächste Klasse an die Reihe. Loks mit neuem Kommando (RF_NEW)
+ * werden zuerst wiederholt, danach Loks mit Kommando innerhalb der letzten
+ * FAST_REFRESH_TIMEOUT Sekunden (RF_RECENT). Überschreitet die älteste Lok
+ * der übrigen (RF_STALE) die Refresh Periode ihres Protokolls, erhält sie den
+ * Slot von RF_RECENT. Funktionspakete laufen in einem eigenen Ring.
  * @param busnumber
- * @param fast false: alle Loks
- *             true: nur Loks die innerhalb der letzten FAST_REFRESH_TIMEOUT Sekunden
- *                   ein neues Kommando erhielten
  * @return false wenn keine Lok zum Refresh vorhanden sein sollte.
  */
-static bool refresh_loco_one(bus_t busnumber, bool fast) {
-  tRefreshInfo *refreshInfo = fast ? &__DDL->refreshInfoFast : &__DDL->refreshInfo;
-
-  int adr;
-  bool refreshGesendet = false;
-  bool busComplete = false;
-
-  if (refreshInfo -> protocol_refresh & EP_MAERKLIN) {
-    adr = __DDL->MaerklinPacketPool.knownAddresses[refreshInfo -> last_refreshed_maerklin_loco];
-    if (fast != ((time(NULL) - __DDL->MaerklinPacketPool.packets[adr].timeLastUpdate) > FAST_REFRESH_TIMEOUT)) {
-      //Bei "Fast" nur die Loks, die nicht zu alt sind,
-      //bei "nicht fast" / "Normal" nur die Loks, die alt sind
-      refreshGesendet = true;
-      send_packet(busnumber, __DDL->MaerklinPacketPool.packets[adr].packet, 18, QM2LOCOPKT, 1);
-      //bei jeden Durchgang (alle Loks) das nächste Fx Paket
-      send_packet(busnumber, __DDL->MaerklinPacketPool.packets[adr].f_packets
-	  							[refreshInfo -> last_refreshed_maerklin_fx], 18, QM2FXPKT, 1);
-    }
-    do {
-      refreshInfo -> last_refreshed_maerklin_loco++;
-      if (refreshInfo -> last_refreshed_maerklin_loco >= __DDL->MaerklinPacketPool.NrOfKnownAddresses) {
-        refreshInfo -> last_refreshed_maerklin_loco = 0;
-        busComplete = true;
-        //Beim nächsten Durchgang das nächste Fx Paket
-        refreshInfo -> last_refreshed_maerklin_fx++;
-        if (refreshInfo -> last_refreshed_maerklin_fx >= 4) {
-          refreshInfo -> last_refreshed_maerklin_fx = 0;
+static bool refresh_loco(bus_t busnumber)
+{
+    long long now = now_usec();
+    long long interval;
+    tRefreshEntry *e;
+    tMaerklinPacket *mp;
+    tNMRAPacket *np;
+    tMFXPacket *xp;
+    int rfclass, i;
+
+    rfclass = rf_slots[__DDL->rfSlot];
+    if (++__DDL->rfSlot >= (int)(sizeof(rf_slots) / sizeof(rf_slots[0])))
+        __DDL->rfSlot = 0;
+    e = __DDL->rfRing[RF_STALE];
+    if (rfclass == RF_RECENT && e != NULL
+        && now - e->lastRefresh >= __DDL->rfPeriod[protocol_index(e->protocol)])
+        rfclass = RF_STALE;
+    for (i = 0; i < RF_CLASSES; i++) {
+        if (__DDL->rfRing[rfclass] != NULL)
+            break;
+        rfclass = (rfclass + 1) % RF_CLASSES;
+    }
+    e = __DDL->rfRing[rfclass];
+    if (e == NULL)
+        return false;
+
+    if (rfclass == RF_FUNC) {
+        __DDL->rfRing[RF_FUNC] = e->link[1].next;
+        if (e->protocol == EP_MAERKLIN) {
+            mp = &__DDL->MaerklinPacketPool.packets[e->adr];
+            send_packet(busnumber, mp->f_packets[e->fx], 18, QM2FXPKT, 1);
+            //beim nächsten Mal das nächste Fx Paket
+            e->fx = (e->fx + 1) % 4;
         }
-        break;
-      }
-      //Bei Fast Zyklus wird die nächste Lok mit neuem Kommando gesucht,
-      //bei "normal" die nächste Lok ohne neues Kommando
-      adr = __DDL->MaerklinPacketPool.knownAddresses[refreshInfo -> last_refreshed_maerklin_loco];
-    } while (fast != ((time(NULL) - __DDL->MaerklinPacketPool.packets[adr].timeLastUpdate) <= FAST_REFRESH_TIMEOUT));
-  }
-  if (refreshInfo -> protocol_refresh & EP_NMRADCC) {
-    adr = __DDL->NMRAPacketPool.knownAddresses[refreshInfo -> last_refreshed_nmra_loco];
-    if (adr >= 0) {
-      tNMRAPacket* tNp = __DDL->NMRAPacketPool.packets[adr];
-      if (tNp == NULL) return 0;
-      if (fast != ((time(NULL) - tNp->timeLastUpdate) > FAST_REFRESH_TIMEOUT)) {
-        refreshGesendet = true;
-        send_packet(busnumber, tNp->packet, tNp->packet_size, QNBLOCOPKT, 1);
-        send_packet(busnumber, tNp->fx_packet, tNp->fx_packet_size, QNBLOCOPKT, 1);
-      }
-      do {
-        refreshInfo -> last_refreshed_nmra_loco++;
-        if (refreshInfo -> last_refreshed_nmra_loco >= __DDL->NMRAPacketPool.NrOfKnownAddresses) {
-          refreshInfo -> last_refreshed_nmra_loco = 0;
-          busComplete = true;
-          break;
+        else {
+            np = __DDL->NMRAPacketPool.packets[e->adr];
+            send_packet(busnumber, np->fx_packet, np->fx_packet_size,
+                        QNBLOCOPKT, 1);
         }
-        //Bei Fast Zyklus wird die nächste Lok mit neuem Kommando gesucht,
-        //bei "normal" die nächste Lok ohne neues Kommando
-        adr = __DDL->NMRAPacketPool.knownAddresses[refreshInfo -> last_refreshed_nmra_loco];
-      } while (fast != ((time(NULL) - __DDL->NMRAPacketPool.packets[adr] -> timeLastUpdate) <= FAST_REFRESH_TIMEOUT));
+        return true;
     }
-    else {
-      //Keine DCC Lok vorhanden -> mit nächstem Protokoll weitermachen
-      busComplete = true;
-  	}
-  }
 
-  if (refreshInfo -> protocol_refresh & EP_MFX) {
-    //MFX Refresh Cycle
-    adr = __DDL->MFXPacketPool.knownAddresses[refreshInfo -> last_refreshed_mfx_loco];
-    if (adr > 0) {
-      tMFXPacket* tMp = __DDL->MFXPacketPool.packets[adr];
-      if (tMp == NULL) return 0;
-      if (fast != ((time(NULL) - tMp->timeLastUpdate) > FAST_REFRESH_TIMEOUT)) {
-        refreshGesendet = true;
-        send_packet(busnumber, tMp->packet, tMp->packet_size, QMFX0PKT, 1);
-      }
-      do {
-        refreshInfo -> last_refreshed_mfx_loco++;
-        if (refreshInfo -> last_refreshed_mfx_loco >= __DDL->MFXPacketPool.NrOfKnownAddresses) {
-          refreshInfo -> last_refreshed_mfx_loco = 0;
-          busComplete = true;
-          break;
-        }
-        //Bei Fast Zyklus wird die nächste Lok mit neuem Kommando gesucht,
-        //bei "normal" die nächste Lok ohne neues Kommando
-        adr = __DDL->MFXPacketPool.knownAddresses[refreshInfo -> last_refreshed_mfx_loco];
-      } while (fast != ((time(NULL) - __DDL->MFXPacketPool.packets[adr] -> timeLastUpdate) <= FAST_REFRESH_TIMEOUT));
-    }
-    else {
-      //Keine MFX Lok vorhanden -> mit nächstem Protokoll weitermachen
-      busComplete = true;
-    }
-  }
+    if (rfclass == RF_RECENT
+        && now - e->lastUpdate > FAST_REFRESH_TIMEOUT * 1000000LL)
+        rf_move(busnumber, e, RF_STALE);
+    else if (rfclass == RF_NEW && --e->newcount <= 0)
+        rf_move(busnumber, e, RF_RECENT);
+    else
+        __DDL->rfRing[rfclass] = e->link[0].next;
 
-  if (busComplete) {
-    //Im nächsten Zyklus kommt das nächste aktivierte Protokoll an die Reihe
-    do {
-      refreshInfo -> protocol_refresh <<= 1;
-      if (refreshInfo -> protocol_refresh == 0) {
-        //Wieder von vorne beginnen
-        refreshInfo -> protocol_refresh = 1;
-      }
-    } while ((__DDL->ENABLED_PROTOCOLS & refreshInfo -> protocol_refresh) == 0);
-  }
-  return refreshGesendet;
-}
+    switch (e->protocol) {
+        case EP_MAERKLIN:
+            mp = &__DDL->MaerklinPacketPool.packets[e->adr];
+            send_packet(busnumber, mp->packet, 18, QM2LOCOPKT, 1);
+            break;
+        case EP_NMRADCC:
+            np = __DDL->NMRAPacketPool.packets[e->adr];
+            send_packet(busnumber, np->packet, np->packet_size, QNBLOCOPKT, 1);
+            break;
+        default:
+            xp = __DDL->MFXPacketPool.packets[e->adr];
+            send_packet(busnumber, xp->packet, xp->packet_size, QMFX0PKT, 1);
+            break;
+    }
 
-/**
- * Refresh Paket der nächsten Lok senden.
- * Es werden alle Loks jedes aktivierten Protokolles der Reihe nach berücksichtigt.
- * Wenn Loks vorhanden sind, die in den letzten FAST_REFRESH_TIMEOUT ein neues
- * Kommando erhielten (Fast Refresh) werden diese jeden 2. Durchgang berücksichtigt.
- * Grund:
- * Bei Anlagen mit vielen Loks dauert ein ganzer Refresh Durchlauf relativ lange.
- * Da jedoch in der Regel wenig dieser Loks gleichzeitig in Betrieb sind erhaltend
- * diese häufiger einen Refresh.
- * @param busnumber
- * @return false wenn keine Lok zum Refresh vorhanden sein sollte.
- */
-static bool refresh_loco(bus_t busnumber)
-{
-  if (__DDL->lastRefreshFast) {
-    //letzter Refresh war "Fast". "Normaler" Refresh, nächster ist wieder ein "Fast"
-    __DDL->lastRefreshFast = false;
-    return refresh_loco_one(busnumber, false);
-  }
-  //letzter Refresh war kein "Fast" -> "Fast" Refresh versuchen
-  if (refresh_loco_one(busnumber, true)) {
-    //"Fast" Refresh gesendet, nachher kommt wieder ein "normaler".
-    __DDL->lastRefreshFast = true;
+    if (e->lastRefresh != 0) {
+        interval = now - e->lastRefresh;
+        if (interval > e->maxInterval)
+            e->maxInterval = interval;
+        e->sumInterval += interval;
+        e->refreshs++;
+        stat_refresh(busnumber, interval);
+    }
+    e->lastRefresh = now;
     return true;
-  }
-  //Keine Lok für "Fast" Refresh vorhanden, "normalen" refresh senden
-  return refresh_loco_one(busnumber, false);
 }
 
 /* check if shortcut or emergengy break happened
@@ -1332,6 +1610,8 @@ bool power_is_off(bus_t busnumber)
 
 void use_pgtrack(bus_t busnumber, bool use)
 {
+    //bisherige Pakete noch auf das bisherige Gleis
+    flush_spi_batch(busnumber);
     syslog_bus(busnumber, DBG_DEBUG,
 		"Programming track usage: actual %d, requested %d", __DDL->pgtrkonly, use);
     // TODO: complete coding of this procedure, HW access
@@ -1435,10 +1715,11 @@ int readconfig_DDL(xmlDocPtr doc, xmlNodePtr node, bus_t busnumber)
     buses[busnumber].init_gl_func = &init_gl_DDL;
     buses[busnumber].describe_gl_func = &describe_gl_DDL;
     buses[busnumber].init_ga_func = &init_ga_DDL;
+    buses[busnumber].info_stat_func = &info_stat_DDL;
 
     buses[busnumber].thr_func = &thr_Manage_DDL;
 
-    strcpy(buses[busnumber].description, "GA GL SM POWER LOCK");
+    strcpy(buses[busnumber].description, "GA GL SM POWER LOCK STAT");
 
     __DDL->number_gl = 255;
     __DDL->number_ga = 324;
@@ -1454,6 +1735,9 @@ int readconfig_DDL(xmlDocPtr doc, xmlNodePtr node, bus_t busnumber)
     __DDL->MCS_DEVNAME[0] = 0;	/* if empty you do not use such a device */
     __DDL->FWD_M_ACCESSORIES = busnumber;	/* default is own bus */
     __DDL->FWD_N_ACCESSORIES = busnumber;	/* default is own bus */
+    __DDL->rfPeriod[STAT_MM] = RF_PERIOD_DEFAULT * 1000LL;
+    __DDL->rfPeriod[STAT_DCC] = RF_PERIOD_DEFAULT * 1000LL;
+    __DDL->rfPeriod[STAT_MFX] = RF_PERIOD_DEFAULT * 1000LL;
 
     xmlNodePtr child = node->children;
     xmlChar *txt = NULL;
@@ -1596,6 +1880,27 @@ int readconfig_DDL(xmlDocPtr doc, xmlNodePtr node, bus_t busnumber)
                 xmlFree(txt);
             }
         }
+        else if (xmlStrcmp(child->name, BAD_CAST "refresh_period_mm") == 0) {
+            txt = xmlNodeListGetString(doc, child->xmlChildrenNode, 1);
+            if (txt != NULL) {
+                __DDL->rfPeriod[STAT_MM] = atoi((char *) txt) * 1000LL;
+                xmlFree(txt);
+            }
+        }
+        else if (xmlStrcmp(child->name, BAD_CAST "refresh_period_nmra") == 0) {
+            txt = xmlNodeListGetString(doc, child->xmlChildrenNode, 1);
+            if (txt != NULL) {
+                __DDL->rfPeriod[STAT_DCC] = atoi((char *) txt) * 1000LL;
+                xmlFree(txt);
+            }
+        }
+        else if (xmlStrcmp(child->name, BAD_CAST "refresh_period_mfx") == 0) {
+            txt = xmlNodeListGetString(doc, child->xmlChildrenNode, 1);
+            if (txt != NULL) {
+                __DDL->rfPeriod[STAT_MFX] = atoi((char *) txt) * 1000LL;
+                xmlFree(txt);
+            }
+        }
         else
             syslog_bus(busnumber, DBG_WARN,
                        "WARNING, unknown tag found: \"%s\"!\n",
@@ -1667,17 +1972,9 @@ int init_bus_DDL(bus_t busnumber)
 
     __DDL->short_detected = 0;
 
-    __DDL->refreshInfo.last_refreshed_maerklin_loco = 0;
-    __DDL->refreshInfo.last_refreshed_maerklin_fx = -1;
-    __DDL->refreshInfo.last_refreshed_nmra_loco = 0;
-    __DDL->refreshInfo.last_refreshed_mfx_loco = 0;
-    __DDL->refreshInfo.protocol_refresh = 1;
-    __DDL->refreshInfoFast.last_refreshed_maerklin_loco = 0;
-    __DDL->refreshInfoFast.last_refreshed_maerklin_fx = -1;
-    __DDL->refreshInfoFast.last_refreshed_nmra_loco = 0;
-    __DDL->refreshInfoFast.last_refreshed_mfx_loco = 0;
-    __DDL->refreshInfoFast.protocol_refresh = 1;
-    __DDL->lastRefreshFast = false;
+    init_refresh(busnumber);
+    init_spi_batch(busnumber);
+    init_statistics(busnumber);
 
     if (__DDL->ENABLED_PROTOCOLS & EP_MAERKLIN) {
         init_MaerklinPacketPool(busnumber);
@@ -1757,6 +2054,7 @@ static void *thr_Manage_DDL(void *v)
     gl_data_t *glp;
     ga_data_t gatmp;
     int gastep = 0;
+    unsigned int depth;
     int last_cancel_state, last_cancel_type, progwin = 0;
     char * scmd, * sprot, * stype;
     long nextmfxman = 0;
@@ -1782,9 +2080,14 @@ static void *thr_Manage_DDL(void *v)
     while (true) {
         pthread_testcancel();
 
+        /* statistics requested by SIGUSR1 */
+        if (__DDLt->stat.dumpSeen != stat_dump_request)
+            dump_statistics(btd->bus);
+
         /* Service Mode Handling */
         if (__DDLt->allowSM && !queue_SM_isempty(btd->bus)) {
             dequeueNextSM(btd->bus, &smakt);
+            STAT_ADD(__DDLt->stat.smCommands, 1);
 			switch(smakt.protocol) {
     			case PROTO_NMRA:	sprot = "NMRA";	break;
     			case PROTO_MM:		sprot = "MM";   break;
@@ -1988,7 +2291,9 @@ static void *thr_Manage_DDL(void *v)
         buses[btd->bus].watchdog = 4;
 
 		/* Power State Handling */
+        flush_spi_batch(btd->bus);
         if (power_is_off(btd->bus)) {
+            __DDLt->stat.lastCycle = 0;
             usleep(10000);		// wait 10ms before re-test
             continue;
         }
@@ -2009,8 +2314,11 @@ static void *thr_Manage_DDL(void *v)
 		}
 
 		/* Generic Loco Handling */
+        depth = queue_GL_depth(btd->bus);
+        STAT_MAX(__DDLt->stat.glDepthMax, depth);
         glp = dequeueNextGL(btd->bus);
 		if (glp) {
+            STAT_ADD(__DDLt->stat.glCommands, 1);
             char p = glp->protocol;
             switch (p) {
                 case 'M':      /* Motorola Codes */
@@ -2044,7 +2352,10 @@ static void *thr_Manage_DDL(void *v)
 		switch (gastep) {
 			/* activate GA element */
 			case 0:	if (queue_GA_isempty(btd->bus)) break;
+			        depth = queue_GA_depth(btd->bus);
+			        STAT_MAX(__DDLt->stat.gaDepthMax, depth);
 			        dequeueNextGA(btd->bus, &gatmp);
+			        STAT_ADD(__DDLt->stat.gaCommands, 1);
             		syslog_bus(btd->bus, DBG_DEBUG,
 							"Next GA command: %c %d Port %d activated for %d ms",
                        		gatmp.protocol, gatmp.id, gatmp.port, gatmp.activetime);
@@ -2086,6 +2397,10 @@ static void *thr_Manage_DDL(void *v)
                         gastep = 0;
                     }
 		}
+
+        /* all packets of this cycle in one SPI message */
+        flush_spi_batch(btd->bus);
+        stat_cycle(btd->bus);
     }
 
     /*run the cleanup routine */
@@ -20,6 +20,8 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <fcntl.h>
+#include <sys/time.h>
+#include <linux/spi/spidev.h>
 #include <libxml/tree.h>        /*xmlDocPtr, xmlNodePtr */
 
 #include "netservice.h"
@@ -38,8 +40,40 @@
 /* broadcast-addr + 511, nur 9 Bit Adressierung wird unterstützt */
 #define MAX_MFX_ADDRESS 512
 
+/* refresh scheduler: priority classes */
+#define RF_NEW      0           /* new command, a few refreshs with priority */
+#define RF_RECENT   1           /* command within FAST_REFRESH_TIMEOUT */
+#define RF_STALE    2           /* all other locos */
+#define RF_FUNC     3           /* function packets of all locos */
+#define RF_CLASSES  4
+
+/* refreshs with priority after a new command */
+#define RF_NEW_REPEAT   2
+/* default target refresh period per protocol in ms */
+#define RF_PERIOD_DEFAULT 1000
+
+/* refresh state of a loco, part of each packet pool entry */
+typedef struct _tRefreshEntry {
+    struct {
+        struct _tRefreshEntry *prev, *next;
+    } link[2];                  /* [0] ring of the class, [1] function ring */
+    int protocol;               /* EP_xxx */
+    int adr;
+    int rfclass;                /* RF_xxx, -1 if not scheduled */
+    int functions;              /* is in the function ring */
+    int newcount;               /* remaining priority refreshs */
+    int fx;                     /* next MM function packet */
+    long long lastUpdate;       /* µs of the last new command */
+    long long lastRefresh;      /* µs of the last refresh */
+    /* refresh interval statistics */
+    long long maxInterval;
+    long long sumInterval;
+    unsigned long refreshs;
+} tRefreshEntry;
+
 /* data types for maerklin packet pool */
 typedef struct _tMaerklinPacket {
+    tRefreshEntry rf;
     time_t timeLastUpdate;
     char packet[18];
     char f_packets[4][18];
@@ -53,6 +87,7 @@ typedef struct _tMaerklinPacketPool {
 
 /* data types for mfx packet pool */
 typedef struct _tMFXPacket {
+    tRefreshEntry rf;
     time_t timeLastUpdate;
     char packet[PKTSIZE];
     int packet_size;
@@ -66,6 +101,7 @@ typedef struct _tMFXPacketPool {
 
 /* data types for NMRA packet pool */
 typedef struct _tNMRAPacket {
+    tRefreshEntry rf;
     time_t timeLastUpdate;
     char packet[PKTSIZE];
     int packet_size;
@@ -79,15 +115,65 @@ typedef struct _tNMRAPacketPool {
     int NrOfKnownAddresses;
 } tNMRAPacketPool;
 
-typedef struct _tRefreshInfo {
-    //Letzte Lok zu der ein Refresh Kommando gesandt wurde für jedes Protokoll
-    int last_refreshed_maerklin_loco;
-    int last_refreshed_maerklin_fx;
-    int last_refreshed_nmra_loco;
-    int last_refreshed_mfx_loco;
-    //Welches aktivierte Protokoll (EP_xxx) bekommt den nächsten Refresh Cycle
-    int protocol_refresh;
-} tRefreshInfo;
+/* SPI Bytes für ein Paket, worst case ist QMFX32PKT */
+#define SPI_PKT_MAXSIZE     1600
+/* Transfers und Bytes, die gesammelt mit einem ioctl ausgegeben werden */
+#define SPI_BATCH_TRANSFERS 32
+#define SPI_BATCH_BUFSIZE   (10 * SPI_PKT_MAXSIZE)
+/* spidev lehnt ein ioctl mit mehr Bytes als bufsiz ab, Vorgabe des Kernels */
+#define SPIDEV_BUFSIZ_PARAM   "/sys/module/spidev/parameters/bufsiz"
+#define SPIDEV_BUFSIZ_DEFAULT 4096
+/* Intervall der Meldung der Paketraten in Sekunden */
+#define SPI_STAT_INTERVAL   60
+
+/* Index der Protokolle in Statistik und Refresh Perioden */
+#define STAT_MM     0
+#define STAT_DCC    1
+#define STAT_MFX    2
+#define STAT_PROTOCOLS 3
+
+typedef struct _tSpiBatch {
+    struct spi_ioc_transfer xfer[SPI_BATCH_TRANSFERS];
+    unsigned int count;         // gesammelte Transfers
+    unsigned int used;          // davon belegte Bytes in buffer
+    unsigned int txbytes;       // Summe der Transfer Längen
+    unsigned int maxbytes;      // höchstens je ioctl (spidev bufsiz)
+    char buffer[SPI_BATCH_BUFSIZE];
+    // Stand der Zähler in tDdlStat bei tv_stat für die Paketraten
+    struct timeval tv_stat;
+    unsigned long long ioctls;
+    unsigned long long packets[STAT_PROTOCOLS];
+} tSpiBatch;
+
+/* Buckets der Zeit Histogramme, Bucket i zählt Zeiten unter 2^i µs ab
+   2^(i-1) µs, der letzte auch alle längeren */
+#define STAT_HIST_BUCKETS   24
+
+/* Laufzeit Statistik des Bus Threads seit dem Start. Nur der Bus Thread
+   schreibt, GET <bus> STAT und der Dump nach SIGUSR1 lesen ohne Lock. */
+typedef struct _tDdlStat {
+    // Durchläufe der Hauptschleife mit eingeschaltetem Gleis
+    unsigned long long cycles;
+    unsigned long long cycleSum;            // µs
+    unsigned long long cycleMax;            // µs
+    unsigned long long cycleHist[STAT_HIST_BUCKETS];
+    long long lastCycle;                    // µs, 0 nach Power aus
+    // ausgegebene Pakete je Protokoll und SPI ioctls
+    unsigned long long packets[STAT_PROTOCOLS];
+    unsigned long long ioctls;
+    // Kommandos aus den Queues und größte gesehene Queue Länge
+    unsigned long long glCommands;
+    unsigned long long gaCommands;
+    unsigned long long smCommands;
+    unsigned int glDepthMax;
+    unsigned int gaDepthMax;
+    // Refresh Intervalle aller Loks
+    unsigned long long refreshs;
+    unsigned long long refreshSum;          // µs
+    unsigned long long refreshMax;          // µs
+    unsigned long long refreshHist[STAT_HIST_BUCKETS];
+    int dumpSeen;                           // zuletzt bediente Dump Anforderung
+} tDdlStat;
 
 typedef struct _tFbData {			// interfacing several threads
     volatile int pktcode;
@@ -120,30 +206,28 @@ typedef struct _DDL_DATA {
     bus_t FWD_N_ACCESSORIES;	/* bus used for NMRA accessories */
 
     int spiLastMM;              //War das letzte Paket ein Märklin Motorola Paket?
+    tSpiBatch spiBatch;         //noch nicht ausgegebene SPI Transfers
     unsigned int uid;           /* Für MFX die UID der Zentrale */
 
     long long short_detected;
     char NMRA_idle_data[4 * 256]; //Worst Case SPI Mode
 
-    //"Normaler" Refresh Zyklus
-    tRefreshInfo refreshInfo;
-    //Proiorisierter / schneller Refresh bekommen alle Loks, die in den letzten FAST_REFRESH_TIMEOUT Sekunden
-    //ein neues Kommando erhielten.
-    tRefreshInfo refreshInfoFast;
-    //Alternierende Ausgabe "fast" und "normaler" Refresh.
-    bool lastRefreshFast;
+    //Refresh Scheduler: Ring je Prioritätsklasse, RF_FUNC über link[1]
+    tRefreshEntry *rfRing[RF_CLASSES];
+    //nächster Slot im festen Slotmuster
+    int rfSlot;
+    //Ziel Refresh Periode je Protokoll in µs
+    long long rfPeriod[STAT_PROTOCOLS];
+    //Laufzeit Statistik für GET <bus> STAT
+    tDdlStat stat;
 
 	volatile bool allowSM;		/* service mode commands allowed */
 	volatile int resumeSM;		/* service mode commands outstanding */
     bool pgtrkonly;             /* only programming track will be feed */
 
-    pthread_mutex_t nmra_pktpool_mutex;
+    /* packet pools, only used by the bus thread */
     tNMRAPacketPool NMRAPacketPool;
-
-    pthread_mutex_t maerklin_pktpool_mutex;
     tMaerklinPacketPool MaerklinPacketPool;
-
-    pthread_mutex_t mfx_pktpool_mutex;
     tMFXPacketPool MFXPacketPool;
 
     int feedbackPipe[2];        // trigger pipe for feedback thread
@@ -189,6 +273,10 @@ void update_MFXPacketPool(bus_t busnumber, int adr,
 
 void send_packet(bus_t busnumber, char *packet,
                  int packet_size, int packet_type, int xmits);
+/* output all packets collected by send_packet */
+void flush_spi_batch(bus_t busnumber);
+int info_stat_DDL(bus_t busnumber, char *item, char *msg);
+void request_statistics_DDL(void);
 
 /* serial line modes: */
 #define ON  1
@@ -526,6 +526,8 @@ int comp_maerklin_27(bus_t busnumber, int address, int direction,
 
     rtc = comp_maerklin_2(busnumber, address, direction, sFS1, func, f1, f2, f3, f4);
     if ((sFS2 > 0) && (rtc == 0)) {
+        /* the pause has to be on the track */
+        flush_spi_batch(busnumber);
         if (usleep(50000) == -1) {
             syslog_bus(busnumber, DBG_ERROR,
                        "usleep() failed in Märklin line %d: %s (errno = %d)",
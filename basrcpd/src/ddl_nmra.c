@@ -76,8 +76,6 @@
 #include "ddl_nmra.h"
 #include "syslogmessage.h"
 
-static char *preamble = "111111111111111";
-
 /* 230 is needed for all functions F0-F28 */
 static const unsigned int BUFFERSIZE = 256;
 
@@ -136,88 +134,138 @@ static void calc_single_byte(char *byte, int value)
     }
 }
 
-/* calculating address bytes: 11AAAAAA AAAAAAAA */
-static void calc_14bit_address_byte(char *byte1, char *byte2, int address)
+static void xor_two_bytes(char *byte, char *byte1, char *byte2)
 {
-    calc_single_byte(byte2, address);
-    calc_single_byte(byte1, 0xc0 | (address >> 8));
+
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        if (byte1[i] == byte2[i])
+            byte[i] = '0';
+        else
+            byte[i] = '1';
+    }
+    byte[8] = 0;
 }
 
-/* calculating speed byte2: 01DUSSSS  */
-static void calc_baseline_speed_byte(char *byte, int direction, int speed,
-                                     int func)
+/*** table driven builder for packed NMRA-DCC packets ***/
+
+/* length of the preamble in front of every packet */
+static const int PREAMBLE_BITS = 15;
+
+/* between two commands to the same address there has to be a gap
+   of at least 5ms. 5ms are 10 packet bytes. one packet byte can take
+   5 logical "1" (0x55) ==> 50 logical "1" are needed between 2 packets.
+   The preamble holds 15 "1"s, so only 35 additional are needed */
+static const int GAP_BITS = 35;
+
+/* the packet stream is filled lsb first, but NMRA sends the msb of each
+   byte first, so every byte is mirrored by this table */
+#define R2(n) n, n + 2 * 64, n + 1 * 64, n + 3 * 64
+#define R4(n) R2(n), R2(n + 2 * 16), R2(n + 1 * 16), R2(n + 3 * 16)
+#define R6(n) R4(n), R4(n + 2 * 4), R4(n + 1 * 4), R4(n + 3 * 4)
+static const unsigned char reversed_byte[256] = {
+    R6(0), R6(2), R6(1), R6(3)
+};
+#undef R6
+#undef R4
+#undef R2
+
+typedef struct _tPacker {
+    char *stream;               /* length byte, followed by the bits */
+    int bits;                   /* number of bits written so far */
+} tPacker;
+
+static void packer_init(tPacker *pk, char *Packetstream)
 {
-    calc_single_byte(byte, 0x40 | (direction << 5) | speed);
-    if (func & 1)
-        byte[3] = '1';
+    memset(Packetstream, 0, PKTSIZE);
+    pk->stream = Packetstream;
+    pk->bits = 0;
 }
 
-/* calculating speed byte: 01DSSSSS */
-static void calc_28spst_speed_byte(char *byte, int direction, int speed)
+/**
+  Append count bits (at most 24) to the packet stream, the first bit
+  to send is the lsb of bits. Bits beyond the 255 bits a packet stream
+  can describe are counted but not stored.
+*/
+static void put_bits(tPacker *pk, unsigned int bits, int count)
 {
-    /* last significant speed bit is at pos 3 */
+    int pos = pk->bits;
+    unsigned int shifted;
 
-    if (speed > 1) {
-        speed += 2;
-        calc_single_byte(byte, 0x40 | (direction << 5) | (speed >> 1));
-        if (speed & 1) {
-            byte[3] = '1';
-        }
-    }
-    else {
-        calc_single_byte(byte, 0x40 | (direction << 5) | speed);
+    pk->bits += count;
+    if (pk->bits > 255)
+        return;
+    shifted = bits << (pos % 8);
+    count += pos % 8;
+    pos = (pos / 8) + 1;
+    while (count > 0) {
+        pk->stream[pos++] |= shifted & 0xff;
+        shifted >>= 8;
+        count -= 8;
     }
 }
 
-/* calculating function byte: 100DDDDD */
-static void calc_function_group_one_byte(char *byte, int func)
+static void put_ones(tPacker *pk, int count)
 {
-    /* mask out lower 5 function bits */
-    func &= 0x1f;
-    calc_single_byte(byte, 0x80 | (func >> 1));
-
-    /* F0 or FL is out of order */
-    if (func & 1)
-        byte[3] = '1';
+    while (count > 16) {
+        put_bits(pk, 0xffff, 16);
+        count -= 16;
+    }
+    put_bits(pk, (1 << count) - 1, count);
 }
 
-/* calculating function byte: 101SDDDD */
-static void calc_function_group_two_byte(char *byte, int func, int lower)
+/**
+  Append a complete packet: preamble, all data bytes each with its
+  leading start bit, the error detection byte and the end bit
+  @par Input: int preamble number of "1" in front of the packet
+              unsigned char *bytes data bytes of the packet
+              int count number of data bytes
+*/
+static void put_packet(tPacker *pk, int preamble,
+                       const unsigned char *bytes, int count)
 {
-    if (lower) {
-        /* shift func bits to lower 4 bits and mask them */
-        func = (func >> 5) & 0xf;
-        /* set command for F5 to F8 */
-        func |= 0xb0;
-    }
-    else {
-        func = (func >> 9) & 0xf;
-        func |= 0xa0;
+    unsigned char errdbyte = 0;
+    int i;
+
+    put_ones(pk, preamble);
+    for (i = 0; i < count; i++) {
+        put_bits(pk, reversed_byte[bytes[i]] << 1, 9);
+        errdbyte ^= bytes[i];
     }
-    calc_single_byte(byte, func);
+    put_bits(pk, (reversed_byte[errdbyte] << 1) | 0x200, 10);
 }
 
-static void calc_128spst_adv_op_bytes(char *byte1, char *byte2,
-                                      int direction, int speed)
+/**
+  Finish the packet stream like translateBitstream2Packetstream()
+  @return number of bytes including the length byte, 0 if too long
+*/
+static int packer_finish(tPacker *pk)
 {
-    strcpy(byte1, "00111111");
-    calc_single_byte(byte2, speed);
-    if (direction == 1)
-        byte2[0] = '1';
+    if (pk->bits > 255)
+        return 0;
+    pk->stream[0] = (char)pk->bits;
+    return (pk->bits / 8) + 2;
 }
 
-static void xor_two_bytes(char *byte, char *byte1, char *byte2)
+/**
+  Calculate the address byte(s) for 7 and 14 bit addresses
+  @par Input: int address
+              int mode  1 = 7 bit, 2 = 14 bit
+  @par Output: unsigned char *bytes address byte(s)
+  @return number of address bytes
+*/
+static int calc_address_bytes(unsigned char *bytes, int address, int mode)
 {
-
-    int i;
-
-    for (i = 0; i < 8; i++) {
-        if (byte1[i] == byte2[i])
-            byte[i] = '0';
-        else
-            byte[i] = '1';
+    if (mode == 1) {
+        /* 0AAAAAAA */
+        bytes[0] = address & 0x7f;
+        return 1;
     }
-    byte[8] = 0;
+    /* 11AAAAAA AAAAAAAA */
+    bytes[0] = 0xc0 | (address >> 8);
+    bytes[1] = address & 0xff;
+    return 2;
 }
 
 /*** functions to generate NMRA-DCC data packets ***/
@@ -228,12 +276,9 @@ int comp_nmra_accessory(bus_t busnumber, int nr, int output, int activate,
     /* command: NA <nr [0001-2044]> <outp [0,1]> <activate [0,1]>
        example: NA 0012 0 1  */
 
-    char byte1[9];
-    char byte2[9];
-    char byte3[9];
-    char bitstream[BUFFERSIZE];
+    unsigned char bytes[2];
     char packetstream[PKTSIZE];
-//    char *p_packetstream;
+    tPacker pk;
 
     int address = 0;            /* of the decoder                */
     int pairnr = 0;             /* decoders have pair of outputs */
@@ -249,9 +294,6 @@ int comp_nmra_accessory(bus_t busnumber, int nr, int output, int activate,
         activate < 0 || activate > 1)
         return 1;
 
-    /* packet is not available */
-//    p_packetstream = packetstream;
-
     /* calculate the real address of the decoder and the pair number 
      * of the switch */
     /* valid decoder addresses: 0..511 */
@@ -259,27 +301,16 @@ int comp_nmra_accessory(bus_t busnumber, int nr, int output, int activate,
     pairnr = (nr - 1) % 4;
 
     /* address byte: 10AAAAAA (lower 6 bits) */
-    calc_single_byte(byte1, 0x80 | (address & 0x3f));
+    bytes[0] = 0x80 | (address & 0x3f);
 
     /* address and data 1AAACDDO upper 3 address bits are inverted */
     /* C =  activate, DD = pairnr */
-    calc_single_byte(byte2,
-                     0x80 | ((~address) & 0x1c0) >> 2 | activate << 3 |
-                     pairnr << 1 | output);
-    xor_two_bytes(byte3, byte2, byte1);
+    bytes[1] = (0x80 | ((~address) & 0x1c0) >> 2 | activate << 3 |
+                pairnr << 1 | output) & 0xff;
 
-    /* putting all together in a 'bitstream' (char array) */
-    memset(bitstream, 0, BUFFERSIZE);
-    strcat(bitstream, preamble);
-    strcat(bitstream, "0");
-    strcat(bitstream, byte1);
-    strcat(bitstream, "0");
-    strcat(bitstream, byte2);
-    strcat(bitstream, "0");
-    strcat(bitstream, byte3);
-    strcat(bitstream, "1");
-
-    j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
+    packer_init(&pk, packetstream);
+    put_packet(&pk, PREAMBLE_BITS, bytes, 2);
+    j = packer_finish(&pk);
     if (j > 0) {
     	send_packet(busnumber, packetstream, j, QNBACCPKT, 2);    
         return 0;
@@ -288,94 +319,6 @@ int comp_nmra_accessory(bus_t busnumber, int nr, int output, int activate,
     return 1;
 }
 
-/**
-  Calculate up to 4 command sequences depending on the number of possible 
-  functions (taken from INIT <BUS> GL ...) for up to 28 Functions
-  due to the long bitstream in case of 28 functions the bitstream is
-  split into to parts.
-  @par Input: char *addrerrbyte Error detection code for address bytes(s)
-              char *addrstream "bitstream" for preamble and the address byte(s)
-              int func function bits
-              int nfuncs number of functions
-  @par Output: char* bitstream the resulting "bitstream"
-  @par Output: char* bitstream2 the second  "bitstream"
-*/
-static void calc_function_stream(char *bitstream, char *bitstream2,
-                                 char *addrerrbyte, char *addrstream,
-                                 int func, int nfuncs)
-{
-    char funcbyte[9];
-    char errdbyte[9];
-    /* between two commands to the same address there has to be a gap
-       of at least 5ms. 5ms are 10 packet bytes. one packet byte can take
-       5 logical "1" (0x55) ==> 50 logical "1" are needed between 2 packets.
-       The preamble holds 15 "1"s, so only 35 additional are needed
-     */
-    char wait[40] = "11111111111111111111111111111111111";
-
-    calc_function_group_one_byte(funcbyte, func);
-    xor_two_bytes(errdbyte, addrerrbyte, funcbyte);
-
-    /* putting all together in a 'bitstream' (char array) (functions) */
-    memset(bitstream2, 0, BUFFERSIZE);
-    strcat(bitstream2, addrstream);
-    strcat(bitstream2, funcbyte);
-    strcat(bitstream2, "0");
-    strcat(bitstream2, errdbyte);
-    strcat(bitstream2, "1");
-    if (nfuncs > 5) {
-        calc_function_group_two_byte(funcbyte, func, true);
-        xor_two_bytes(errdbyte, addrerrbyte, funcbyte);
-        strcat(bitstream, wait);
-        strcat(bitstream, addrstream);
-        strcat(bitstream, funcbyte);
-        strcat(bitstream, "0");
-        strcat(bitstream, errdbyte);
-        strcat(bitstream, "1");
-
-        if (nfuncs > 8) {
-            calc_function_group_two_byte(funcbyte, func, false);
-            xor_two_bytes(errdbyte, addrerrbyte, funcbyte);
-            strcat(bitstream2, wait);
-            strcat(bitstream2, addrstream);
-            strcat(bitstream2, funcbyte);
-            strcat(bitstream2, "0");
-            strcat(bitstream2, errdbyte);
-            strcat(bitstream2, "1");
-            if (nfuncs > 12) {
-                char funcbyte2[9];
-                strncpy(funcbyte2, "11011110", 9);
-                funcbyte2[8] = 0;
-                calc_single_byte(funcbyte, func >> 13);
-                xor_two_bytes(errdbyte, addrerrbyte, funcbyte2);
-                xor_two_bytes(errdbyte, errdbyte, funcbyte);
-                strcat(bitstream, wait);
-                strcat(bitstream, addrstream);
-                strcat(bitstream, funcbyte2);
-                strcat(bitstream, "0");
-                strcat(bitstream, funcbyte);
-                strcat(bitstream, "0");
-                strcat(bitstream, errdbyte);
-                strcat(bitstream, "1");
-                if (nfuncs > 20) {
-                    funcbyte2[7] = '1';
-                    xor_two_bytes(errdbyte, addrerrbyte, funcbyte2);
-                    calc_single_byte(funcbyte, func >> 21);
-                    xor_two_bytes(errdbyte, errdbyte, funcbyte);
-                    strcat(bitstream2, wait);
-                    strcat(bitstream2, addrstream);
-                    strcat(bitstream2, funcbyte2);
-                    strcat(bitstream2, "0");
-                    strcat(bitstream2, funcbyte);
-                    strcat(bitstream2, "0");
-                    strcat(bitstream2, errdbyte);
-                    strcat(bitstream2, "1");
-                }
-            }
-        }
-    }
-}
-
 /**
   Calculate the "bitstream" for the cv programming sequence
   @par Input: char *addrerrbyte error detection byte of the address byte(s)
@@ -484,39 +427,45 @@ static void calc_bit_program_stream(char *progstream, char *addrerrbyte,
 }
 
 /**
-  Calculate the "bitstream" for 7 and 14 bit addresses
-  @par Input: int address
-              int mode  1 = 7 bit, 2 = 14 bit
-  
-  @par Output: char* addrstream the resulting "bitstream" for address byte(s)
-               char* addrerrbyte the "bitstream" for error detection byte
+  Append the function packets for up to 28 functions (taken from
+  INIT <BUS> GL ...) to the two packet streams. Due to the length of
+  the packets in case of 28 functions they are split into two streams.
+  @par Input: unsigned char *bytes address byte(s), room for 2 more bytes
+              int alen number of address bytes
+              int func function bits
+              int nfuncs number of functions
+  @par Output: tPacker *pk the first stream, behind the speed packet
+               tPacker *pk2 the second stream
 */
-static void calc_address_stream(char *addrstream, char *addrerrbyte,
-                                int address, int mode)
+static void put_function_packets(tPacker *pk, tPacker *pk2,
+                                 unsigned char *bytes, int alen,
+                                 uint32_t func, int nfuncs)
 {
-    char addrbyte[9];
-    char addrbyte2[9];
-    if (mode == 1) {
-        /* calc 7 bit address - leading bit is zero */
-        calc_single_byte(addrbyte, address & 0x7f);
-        /* no second byte => error detection byte = addressbyte */
-        memcpy(addrerrbyte, addrbyte, 9);
-
-    }
-    else {
-        calc_14bit_address_byte(addrbyte, addrbyte2, address);
-        xor_two_bytes(addrerrbyte, addrbyte, addrbyte2);
-    }
-
-    /* putting all together in a 'bitstream' (char array) (speed & direction) */
-    memset(addrstream, 0, BUFFERSIZE);
-    strcat(addrstream, preamble);
-    strcat(addrstream, "0");
-    strcat(addrstream, addrbyte);
-    strcat(addrstream, "0");
-    if (mode == 2) {
-        strcat(addrstream, addrbyte2);
-        strcat(addrstream, "0");
+    /* function group one 100DDDDD, F0 or FL is out of order */
+    bytes[alen] = 0x80 | ((func & 0x1f) >> 1) | ((func & 1) << 4);
+    put_packet(pk2, PREAMBLE_BITS, bytes, alen + 1);
+    if (nfuncs > 5) {
+        /* function group two 101SDDDD, F5 to F8 */
+        bytes[alen] = 0xb0 | ((func >> 5) & 0xf);
+        put_packet(pk, GAP_BITS + PREAMBLE_BITS, bytes, alen + 1);
+        if (nfuncs > 8) {
+            /* F9 to F12 */
+            bytes[alen] = 0xa0 | ((func >> 9) & 0xf);
+            put_packet(pk2, GAP_BITS + PREAMBLE_BITS, bytes, alen + 1);
+            if (nfuncs > 12) {
+                /* feature expansion 11011110 DDDDDDDD, F13 to F20 */
+                bytes[alen] = 0xde;
+                bytes[alen + 1] = (func >> 13) & 0xff;
+                put_packet(pk, GAP_BITS + PREAMBLE_BITS, bytes, alen + 2);
+                if (nfuncs > 20) {
+                    /* 11011111 DDDDDDDD, F21 to F28 */
+                    bytes[alen] = 0xdf;
+                    bytes[alen + 1] = (func >> 21) & 0xff;
+                    put_packet(pk2, GAP_BITS + PREAMBLE_BITS, bytes,
+                               alen + 2);
+                }
+            }
+        }
     }
 }
 
@@ -535,18 +484,14 @@ static void calc_address_stream(char *addrstream, char *addrerrbyte,
 */
 void comp_nmra_multi_func(bus_t busnumber, gl_data_t *glp)
 {
-    char spdrbyte[9];
-    char spdrbyte2[9];
-    char errdbyte[9];
-    char addrerrbyte[9];
-    char addrstream[BUFFERSIZE];
-    char bitstream[BUFFERSIZE];
-    char bitstream2[BUFFERSIZE];
+    unsigned char bytes[4];
     char packetstream[PKTSIZE];
     char packetstream2_buf[PKTSIZE];
     char *packetstream2 = packetstream2_buf;
+    tPacker pk, pk2;
 
     int adr = 0;
+    int alen, len;
     int j, jj;
 
 	int mode = glp->protocolversion;
@@ -582,7 +527,8 @@ void comp_nmra_multi_func(bus_t busnumber, gl_data_t *glp)
         speed < 0 || speed > (nspeed + 1) || (address > 127 && mode == 1))
         return;
 
-    calc_address_stream(addrstream, addrerrbyte, address, mode);
+    alen = calc_address_bytes(bytes, address, mode);
+    len = alen + 1;
     if (speed < 2 || nspeed < 15) {
         /* commands for stop and emergency stop are identical for
            14 and 28 speed steps. All decoders supporting 128
@@ -591,40 +537,35 @@ void comp_nmra_multi_func(bus_t busnumber, gl_data_t *glp)
            speed steps decoders with speed=0, and a slightly faster 
            emergency stop for these decoders.
          */
-        calc_baseline_speed_byte(spdrbyte, direction, speed, func);
+        /* speed byte 01DUSSSS */
+        bytes[alen] = 0x40 | (direction << 5) | speed | ((func & 1) << 4);
     }
     else {
         if (nspeed > 29) {
-            calc_128spst_adv_op_bytes(spdrbyte, spdrbyte2, direction,
-                                      speed);
+            /* advanced operation 00111111 DSSSSSSS */
+            bytes[alen] = 0x3f;
+            bytes[alen + 1] = (direction << 7) | speed;
+            len++;
         }
         else {
-            calc_28spst_speed_byte(spdrbyte, direction, speed);
+            /* speed byte 01DSSSSS, last significant speed bit is at pos 3 */
+            speed += 2;
+            bytes[alen] = 0x40 | (direction << 5) | (speed >> 1) |
+                          ((speed & 1) << 4);
         }
     }
 
-    xor_two_bytes(errdbyte, addrerrbyte, spdrbyte);
-
-    memset(bitstream, 0, BUFFERSIZE);
-    strcat(bitstream, addrstream);
-    strcat(bitstream, spdrbyte);
-    strcat(bitstream, "0");
-    if (nspeed > 29 && speed > 1) {
-        strcat(bitstream, spdrbyte2);
-        strcat(bitstream, "0");
-        xor_two_bytes(errdbyte, errdbyte, spdrbyte2);
-    }
-    strcat(bitstream, errdbyte);
-    strcat(bitstream, "1");
+    packer_init(&pk, packetstream);
+    put_packet(&pk, PREAMBLE_BITS, bytes, len);
 
     if (nfuncs && (nspeed > 14)) {
-        calc_function_stream(bitstream, bitstream2, addrerrbyte,
-                             addrstream, func, nfuncs);
-        j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
-        jj = translateBitstream2Packetstream(busnumber, bitstream2, packetstream2);
+        packer_init(&pk2, packetstream2);
+        put_function_packets(&pk, &pk2, bytes, alen, func, nfuncs);
+        j = packer_finish(&pk);
+        jj = packer_finish(&pk2);
     }
     else {
-        j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
+        j = packer_finish(&pk);
         packetstream2 = packetstream;
         jj = j;
     }
@@ -633,7 +574,7 @@ void comp_nmra_multi_func(bus_t busnumber, gl_data_t *glp)
                               packetstream2, jj);
     	send_packet(busnumber, packetstream, j, QNBLOCOPKT, 2);    
         if (nfuncs && (nspeed > 14)) {
-    		send_packet(busnumber, packetstream, jj, QNBLOCOPKT, 2);    
+    		send_packet(busnumber, packetstream2, jj, QNBLOCOPKT, 2);    
         }
     }
 
@@ -655,11 +596,10 @@ void comp_nmra_multi_func(bus_t busnumber, gl_data_t *glp)
 int protocol_nmra_sm_write_cvbyte_pom(bus_t busnumber, int address, int cv,
                                       int value, int mode)
 {
-    char addrerrbyte[9];
-    char addrstream[BUFFERSIZE];
-    char progstream[BUFFERSIZE];
-    char bitstream[BUFFERSIZE];
+    unsigned char bytes[5];
     char packetstream[PKTSIZE];
+    tPacker pk;
+    int alen;
 
     syslog_bus(busnumber, DBG_DEBUG,
                "WR Byte command for PoM %d received addr:%d CV:%d value:%d",
@@ -670,14 +610,15 @@ int protocol_nmra_sm_write_cvbyte_pom(bus_t busnumber, int address, int cv,
         value < 0 || value > 255 || (address > 127 && mode == 1))
         return -1;
 
-    calc_address_stream(addrstream, addrerrbyte, address, mode);
-    calc_byte_program_stream(progstream, addrerrbyte, cv, value, false,
-                             true);
-    memset(bitstream, 0, BUFFERSIZE);
-    strcat(bitstream, addrstream);
-    strcat(bitstream, progstream);
+    alen = calc_address_bytes(bytes, address, mode);
+    /* 1110C1AA AAAAAAAA DDDDDDDD */
+    bytes[alen] = 0xec | (cv >> 8);
+    bytes[alen + 1] = cv & 0xff;
+    bytes[alen + 2] = value;
+    packer_init(&pk, packetstream);
+    put_packet(&pk, PREAMBLE_BITS, bytes, alen + 3);
 
-    int j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
+    int j = packer_finish(&pk);
 
     if (j > 0) {
     	send_packet(busnumber, packetstream, j, QNBLOCOPKT, 3);    
@@ -701,11 +642,10 @@ int protocol_nmra_sm_write_cvbyte_pom(bus_t busnumber, int address, int cv,
 int protocol_nmra_sm_write_cvbit_pom(bus_t busnumber, int address, int cv,
                                      int bit, int value, int mode)
 {
-    char addrerrbyte[9];
-    char addrstream[BUFFERSIZE];
-    char progstream[BUFFERSIZE];
-    char bitstream[BUFFERSIZE];
+    unsigned char bytes[5];
     char packetstream[PKTSIZE];
+    tPacker pk;
+    int alen;
 
     syslog_bus(busnumber, DBG_DEBUG,
                "WR Bit command for PoM %d received addr:%d CV:%d bit:%d value:%d",
@@ -717,14 +657,15 @@ int protocol_nmra_sm_write_cvbit_pom(bus_t busnumber, int address, int cv,
         || (address > 127 && mode == 1))
         return -1;
 
-    calc_address_stream(addrstream, addrerrbyte, address, mode);
-    calc_bit_program_stream(progstream, addrerrbyte, cv, bit, value, false,
-                            true);
-    memset(bitstream, 0, BUFFERSIZE);
-    strcat(bitstream, addrstream);
-    strcat(bitstream, progstream);
+    alen = calc_address_bytes(bytes, address, mode);
+    /* 111010AA AAAAAAAA 111CDBBB */
+    bytes[alen] = 0xe8 | (cv >> 8);
+    bytes[alen + 1] = cv & 0xff;
+    bytes[alen + 2] = 0xf0 | (value << 3) | bit;
+    packer_init(&pk, packetstream);
+    put_packet(&pk, PREAMBLE_BITS, bytes, alen + 3);
 
-    int j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
+    int j = packer_finish(&pk);
 
     if (j > 0) {
     	send_packet(busnumber, packetstream, j, QNBLOCOPKT, 3);    
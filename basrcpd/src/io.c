@@ -186,54 +186,58 @@ static int isvalidchar(unsigned char c)
     return ((c >= 0x20 && c <= 127) || c == 0x09 || c == '\n');
 }
 
+/* refill the receive buffer with one read(), return values like read() */
+static ssize_t fill_linebuf(int Socket, linebuf_t *lb)
+{
+    ssize_t bytes_read;
+
+    do {
+        bytes_read = read(Socket, lb->buf, sizeof(lb->buf));
+    } while (bytes_read == -1 && errno == EINTR);
+
+    lb->pos = 0;
+    lb->fill = (bytes_read > 0) ? bytes_read : 0;
+    return bytes_read;
+}
+
 /*
  * Read a text line from socket descriptor including newline character
- * (like fgets()).
+ * (like fgets()). The socket is read in blocks into the buffer lb, which
+ * keeps the following lines of a client sending several commands at once.
+ * The buffer must belong to the socket and start empty.
  * return values
  *   -1: error
  *    0: end of file (EOF), client terminated connection
  *   >0: number of read characters
  * */
-ssize_t socket_readline(int Socket, char *line, int len)
+ssize_t socket_readline(int Socket, linebuf_t *lb, char *line, int len)
 {
-    char c;
+    unsigned char c;
     int i = 0;
+    bool started = false;
     ssize_t bytes_read;
 
-  again:
-    bytes_read = read(Socket, &c, 1);
-    if (bytes_read == -1) {
-
-        /* handle interrupt */
-        if (errno == EINTR)
-            goto again;
-
-        /* normal read error */
-        else
-            return -1;
-    }
-
-    /*EOF detected, client closed connection */
-    else if (bytes_read == 0) {
-        return 0;
-    }
-
-    /*normal operation */
-    else {
-        if (isvalidchar(c))
-            line[i++] = c;
-        /* die Reihenfolge beachten! */
-        /*TODO: handle (errno == EINTR), message part will get lost */
-        while (read(Socket, &c, 1) > 0) {
-            if (isvalidchar(c) && (i < len - 1))
-                line[i++] = c;
-            /* stop at newline character */
-            if (c == '\n')
+    while (true) {
+        if (lb->pos >= lb->fill) {
+            bytes_read = fill_linebuf(Socket, lb);
+            /* read error or EOF, client closed connection */
+            if (bytes_read <= 0) {
+                if (!started)
+                    return bytes_read;
+                /* return the incomplete line first */
                 break;
+            }
         }
+        c = lb->buf[lb->pos++];
+        started = true;
+        if (isvalidchar(c) && (i < len - 1))
+            line[i++] = c;
+        /* stop at newline character */
+        if (c == '\n')
+            break;
     }
-    line[i++] = 0x00;
-    return (i - 1);
+    line[i] = 0x00;
+    return i;
 }
 
 /* Write "n" bytes to a descriptor. Stevens, UNP;
@@ -24,6 +24,14 @@
 
 #include "config-srcpd.h"
 
+/* receive buffer of a socket for socket_readline */
+#define LINEBUFLEN  4096
+typedef struct _LINEBUF {
+    int pos;                    /* next unread byte */
+    int fill;                   /* bytes in buf */
+    char buf[LINEBUFLEN];
+} linebuf_t;
+
 int read_comport(bus_t bus, ssize_t maxbytes, unsigned char *bytes);
 // TODO: check if UART routines below could be reused, eg for Railcom
 // int  readByte(bus_t bus, bool wait, unsigned char *the_byte);
@@ -35,7 +43,7 @@ int rxstartwait_comport(struct termios *config);
 void close_comport(bus_t bus);
 
 int ssplitstr(char * str, int n, ...);
-ssize_t socket_readline(int Socket, char *line, int len);
+ssize_t socket_readline(int Socket, linebuf_t *lb, char *line, int len);
 ssize_t writen(int fd, const void *vptr, size_t n);
 
 #endif
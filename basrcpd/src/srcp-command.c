@@ -397,6 +397,12 @@ static int handleGET(sessionid_t sessionid, bus_t bus, char *device,
         }
     }
 
+    else if (bus_has_devicegroup(bus, DG_STAT)
+             && strncasecmp(device, "STAT", 4) == 0
+             && buses[bus].info_stat_func != NULL) {
+        rc = (*buses[bus].info_stat_func) (bus, parameter, reply);
+    }
+
     else if (strncasecmp(device, "DESCRIPTION", 11) == 0) {
 
         /* there are two descriptions */
@@ -863,7 +869,7 @@ int doCmdClient(session_node_t * sn)
         pthread_testcancel();
         memset(line, 0, sizeof(line));
 
-        ssize_t result = socket_readline(sn->socket, line, sizeof(line) - 1);
+        ssize_t result = socket_readline(sn->socket, &sn->rdbuf, line, sizeof(line) - 1);
 
         /* client terminated connection */
         if (0 == result) {
@@ -18,19 +18,21 @@
 #include "srcp-info.h"
 #include "syslogmessage.h"
 
-#define QUEUELEN 50
+#define QUEUELEN 64     /* must be a power of 2 */
 
 /* current state state */
 static volatile ga_t ga[MAX_BUSES];
 
-/* command queues for each bus */
-static ga_data_t queue[MAX_BUSES][QUEUELEN];
-static pthread_mutex_t queue_mutex[MAX_BUSES];
-static int out[MAX_BUSES], in[MAX_BUSES];
+/* command queues for each bus, lock free for several writers (sessions,
+   MCS gateway) and the bus thread as the only reader. A slot belongs to
+   the writer if seq == position, to the reader if seq == position + 1. */
+typedef struct {
+    unsigned int seq;
+    ga_data_t ga;
+} ga_slot_t;
 
-/* forward declaration of internal functions */
-static int queue_len(bus_t busnumber);
-static int queue_isfull(bus_t busnumber);
+static ga_slot_t queue[MAX_BUSES][QUEUELEN];
+static unsigned int out[MAX_BUSES], in[MAX_BUSES];
 
 
 int get_number_ga(bus_t busnumber)
@@ -45,36 +47,37 @@ int enqueueGA(bus_t busnumber, int addr, int port, int action, int activetime)
     int number_ga = get_number_ga(busnumber);
 
     if ((addr > 0) && (addr <= number_ga)) {
-        if (queue_isfull(busnumber)) {
-            syslog_bus(busnumber, DBG_WARN, "GA Command Queue full");
-            return SRCP_TEMPORARILYPROHIBITED;
-        }
-
-        int result = pthread_mutex_lock(&queue_mutex[busnumber]);
-        if (result != 0) {
-            syslog_bus(busnumber, DBG_ERROR,
-                       "pthread_mutex_lock() failed: %s (errno = %d).",
-                       strerror(result), result);
+        ga_slot_t *slot;
+        unsigned int pos, seq;
+
+        /* claim the slot at the write position */
+        pos = __atomic_load_n(&in[busnumber], __ATOMIC_RELAXED);
+        for (;;) {
+            slot = &queue[busnumber][pos % QUEUELEN];
+            seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+            if (seq == pos) {
+                if (__atomic_compare_exchange_n(&in[busnumber], &pos, pos + 1,
+                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    break;
+            }
+            else if ((int) (seq - pos) < 0) {
+                syslog_bus(busnumber, DBG_WARN, "GA Command Queue full");
+                return SRCP_TEMPORARILYPROHIBITED;
+            }
+            else
+                pos = __atomic_load_n(&in[busnumber], __ATOMIC_RELAXED);
         }
 
-        queue[busnumber][in[busnumber]].protocol =
-            ga[busnumber].gastate[addr].protocol;
-        queue[busnumber][in[busnumber]].action = action;
-        queue[busnumber][in[busnumber]].port = port;
-        queue[busnumber][in[busnumber]].activetime = activetime;
+        slot->ga.protocol = ga[busnumber].gastate[addr].protocol;
+        slot->ga.action = action;
+        slot->ga.port = port;
+        slot->ga.activetime = activetime;
         gettimeofday(&now, NULL);
-        queue[busnumber][in[busnumber]].tv[port] = now;
-        queue[busnumber][in[busnumber]].id = addr;
-        in[busnumber]++;
-        if (in[busnumber] == QUEUELEN)
-            in[busnumber] = 0;
-
-        result = pthread_mutex_unlock(&queue_mutex[busnumber]);
-        if (result != 0) {
-            syslog_bus(busnumber, DBG_ERROR,
-                       "pthread_mutex_unlock() failed: %s (errno = %d).",
-                       strerror(result), result);
-        }
+        slot->ga.tv[port] = now;
+        slot->ga.id = addr;
+        /* hand the slot over to the bus thread */
+        __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
         /* Restart thread to send GL command */
         resume_bus_thread(busnumber);
     }
@@ -86,34 +89,31 @@ int enqueueGA(bus_t busnumber, int addr, int port, int action, int activetime)
 
 int queue_GA_isempty(bus_t busnumber)
 {
-    return (in[busnumber] == out[busnumber]);
-}
+    ga_slot_t *slot = &queue[busnumber][out[busnumber] % QUEUELEN];
 
-static int queue_len(bus_t busnumber)
-{
-    if (in[busnumber] >= out[busnumber])
-        return in[busnumber] - out[busnumber];
-    else
-        return QUEUELEN + in[busnumber] - out[busnumber];
+    return __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != out[busnumber] + 1;
 }
 
-/* maybe, 1 element in the queue cannot be used.. */
-static int queue_isfull(bus_t busnumber)
+/* Anzahl der Einträge, darf nur vom Bus Thread aufgerufen werden */
+unsigned int queue_GA_depth(bus_t busnumber)
 {
-    return queue_len(busnumber) >= QUEUELEN - 1;
+    return __atomic_load_n(&in[busnumber], __ATOMIC_RELAXED) - out[busnumber];
 }
 
-/** liefert naechsten Eintrag oder -1, setzt fifo pointer neu! */
+/** liefert naechsten Eintrag oder -1, setzt fifo pointer neu!
+    darf nur vom Bus Thread aufgerufen werden */
 int dequeueNextGA(bus_t busnumber, ga_data_t *a)
 {
-    if (in[busnumber] == out[busnumber])
+    ga_slot_t *slot = &queue[busnumber][out[busnumber] % QUEUELEN];
+
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != out[busnumber] + 1)
         return -1;
 
-    *a = queue[busnumber][out[busnumber]];
+    *a = slot->ga;
+    /* the slot is free for the next round of the writers */
+    __atomic_store_n(&slot->seq, out[busnumber] + QUEUELEN, __ATOMIC_RELEASE);
     out[busnumber]++;
-    if (out[busnumber] == QUEUELEN)
-        out[busnumber] = 0;
-    return out[busnumber];
+    return out[busnumber] % QUEUELEN;
 }
 
 // TODO: clarify why function 'getGA' is never used.
@@ -363,7 +363,7 @@ void unlock_ga_bytime(void)
     }
 }
 
-/*init GA mutexes for all buses*/
+/*init GA queues for all buses*/
 void startup_GA()
 {
     for (bus_t i = 0; i < MAX_BUSES; i++) {
@@ -371,27 +371,16 @@ void startup_GA()
         out[i] = 0;
         ga[i].numberOfGa = 0;
         ga[i].gastate = NULL;
-
-        int result = pthread_mutex_init(&queue_mutex[i], NULL);
-        if (result != 0) {
-            syslog_bus(0, DBG_ERROR,
-                       "pthread_mutex_init() failed: %s (errno = %d).",
-                       strerror(result), result);
-        }
+        for (unsigned int j = 0; j < QUEUELEN; j++)
+            queue[i][j].seq = j;
     }
 }
 
-/*destroy all occupied mutexes*/
+/*free all GA data*/
 void shutdown_GA()
 {
     for (bus_t i = 0; i < MAX_BUSES; i++) {
         free(ga[i].gastate);
-        int result = pthread_mutex_destroy(&queue_mutex[i]);
-        if (result != 0) {
-            syslog_bus(0, DBG_ERROR,
-                       "pthread_mutex_destroy() failed: %s (errno = %d).",
-                       strerror(result), result);
-        }
     }
 }
 
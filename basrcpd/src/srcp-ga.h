@@ -45,6 +45,7 @@ int get_number_ga(bus_t busnumber);
 int enqueueGA(bus_t busnumber, int addr, int port, int action, int activetime);
 int dequeueNextGA(bus_t busnumber, ga_data_t *);
 int queue_GA_isempty(bus_t busnumber);
+unsigned int queue_GA_depth(bus_t busnumber);
 
 int getGA(bus_t busnumber, int addr, ga_data_t *a);
 int setGA(bus_t busnumber, int addr, ga_data_t a);
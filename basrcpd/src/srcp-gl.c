@@ -11,6 +11,7 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -21,23 +22,27 @@
 #include "srcp-info.h"
 #include "syslogmessage.h"
 
-#define QUEUELEN 200 //SIG 29.10.16, 50 sind zuwenig!
 #define MCSADDRINDICATOR	0x10000
 
 /* current state */
 static struct _GL gl[MAX_BUSES];
 
-/* command queues for each bus */
-static gl_data_t * queue[MAX_BUSES][QUEUELEN];
+/* command queues for each bus, lock free for several writers (sessions,
+   MCS gateway) and the bus thread as the only reader. The queue holds
+   pointers to the GL state, which always has the latest values, and each
+   GL is queued only once. So the queue has room for all GL of the bus.
+   A slot belongs to the writer if seq == position, to the reader if
+   seq == position + 1. */
+typedef struct {
+    unsigned int seq;
+    gl_data_t *glp;
+} gl_slot_t;
 
-static pthread_mutex_t queue_mutex[MAX_BUSES];
+static gl_slot_t *queue[MAX_BUSES];
+static unsigned int queue_mask[MAX_BUSES];
 
 /* write position for queue writers */
-static int out[MAX_BUSES], in[MAX_BUSES];
-
-/* forward declaration of internal functions */
-static int queue_len(bus_t busnumber);
-static int queue_isfull(bus_t busnumber);
+static unsigned int out[MAX_BUSES], in[MAX_BUSES];
 
 /**
  * getMaxAddrGL: returns the maximum address for GL on the given bus
@@ -166,8 +171,9 @@ static void gl_enqueue(bus_t busnumber, gl_data_t * p)
 	if (buses[busnumber].debuglevel >= DBG_DEBUG)
 			debugGL(busnumber, p);
 
-    int result;
 	int addr = p->id;
+	gl_slot_t *slot;
+	unsigned int pos, seq;
 
     if (p->state == glsNone) {
         cacheInitGL(busnumber, addr, 'P', 1, 14, 1, NULL);
@@ -176,76 +182,80 @@ static void gl_enqueue(bus_t busnumber, gl_data_t * p)
    		if (p->state == glsInit)  p->state = glsActive;
     }
 
-    if (queue_isfull(busnumber)) {
-        syslog_bus(busnumber, DBG_WARN, "GL command queue full");
-        return;
-    }
-
-    result = pthread_mutex_lock(&queue_mutex[busnumber]);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                       "pthread_mutex_lock() failed: %s (errno = %d).",
-                       strerror(result), result);
-    }
-
-	/* avoid double queue entries */
-    int i = out[busnumber];
-    while (i != in[busnumber]) {
-      	if (queue[busnumber][i] == p) goto enqueue_unlock;
-       	i++;
-        if (i == QUEUELEN) i = 0;
+	/* avoid double queue entries, the bus thread will see the new values */
+    if (__atomic_exchange_n(&p->queued, 1, __ATOMIC_ACQ_REL))
+        goto enqueue_resume;
+
+    /* claim the slot at the write position */
+    pos = __atomic_load_n(&in[busnumber], __ATOMIC_RELAXED);
+    for (;;) {
+        slot = &queue[busnumber][pos & queue_mask[busnumber]];
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq == pos) {
+            if (__atomic_compare_exchange_n(&in[busnumber], &pos, pos + 1,
+                    true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if ((int) (seq - pos) < 0) {
+            __atomic_store_n(&p->queued, 0, __ATOMIC_RELEASE);
+            syslog_bus(busnumber, DBG_WARN, "GL command queue full");
+            return;
+        }
+        else
+            pos = __atomic_load_n(&in[busnumber], __ATOMIC_RELAXED);
     }
 
     /* copy pointer to new values to queue */
-    queue[busnumber][in[busnumber]] = p;
-    in[busnumber]++;
-    if (in[busnumber] == QUEUELEN) in[busnumber] = 0;
-
-enqueue_unlock:
-    result = pthread_mutex_unlock(&queue_mutex[busnumber]);
-    if (result != 0) {
-        syslog_bus(busnumber, DBG_ERROR,
-                       "pthread_mutex_unlock() failed: %s (errno = %d).",
-                       strerror(result), result);
-    }
+    slot->glp = p;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
 
+enqueue_resume:
     /* Restart thread to send GL command */
     resume_bus_thread(busnumber);
 }
 
 int queue_GL_isempty(bus_t busnumber)
 {
-    return (in[busnumber] == out[busnumber]);
-}
+    if (queue[busnumber] == NULL)
+        return 1;
 
-static int queue_len(bus_t busnumber)
-{
-    if (in[busnumber] >= out[busnumber])
-        return in[busnumber] - out[busnumber];
-    else
-        return QUEUELEN + in[busnumber] - out[busnumber];
+    gl_slot_t *slot = &queue[busnumber][out[busnumber] & queue_mask[busnumber]];
+    return __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != out[busnumber] + 1;
 }
 
-/* maybe, 1 element in the queue cannot be used.. */
-static int queue_isfull(bus_t busnumber)
+/* number of queued GL, must only be called from the bus thread */
+unsigned int queue_GL_depth(bus_t busnumber)
 {
-    return queue_len(busnumber) >= QUEUELEN - 1;
+    return __atomic_load_n(&in[busnumber], __ATOMIC_RELAXED) - out[busnumber];
 }
 
-/** result is pointer to next item or NULL, updates fifo pointer! */
+/** result is pointer to next item or NULL, updates fifo pointer!
+    must only be called from the bus thread */
 
 gl_data_t * dequeueNextGL(bus_t busnumber)
 {
-    if (in[busnumber] == out[busnumber])
+    if (queue_GL_isempty(busnumber))
         return NULL;
 
-    gl_data_t *p  = queue[busnumber][out[busnumber]];
+    gl_slot_t *slot = &queue[busnumber][out[busnumber] & queue_mask[busnumber]];
+    gl_data_t *p = slot->glp;
+    /* the slot is free for the next round of the writers */
+    __atomic_store_n(&slot->seq, out[busnumber] + queue_mask[busnumber] + 1,
+                     __ATOMIC_RELEASE);
     out[busnumber]++;
-    if (out[busnumber] == QUEUELEN)
-        out[busnumber] = 0;
+    /* changes from now on queue the GL again */
+    __atomic_exchange_n(&p->queued, 0, __ATOMIC_ACQ_REL);
     return p;
 }
 
+/* Clear all data of a GL except its queue state: a session may have
+   queued it again since the bus thread took it, and only the dequeue may
+   reset queued, otherwise the GL gets into the queue twice. */
+static void gl_clear(gl_data_t * p)
+{
+    memset(p, 0, offsetof(gl_data_t, queued));
+}
+
 // TODO: check if this procedure can be removed
 int cacheGetGL(bus_t busnumber, int addr, gl_data_t *gld)
 {
@@ -281,7 +291,7 @@ void cacheSetGL(bus_t busnumber, gl_data_t *glp, gl_data_t *l)
         // delete all data of terminated entry
         uint16_t *gli = getGLIndex(busnumber, getglid(glp) | MCSADDRINDICATOR, 0);
         *gli = 0;
-        bzero(glp, sizeof(gl_data_t));
+        gl_clear(glp);
 		if (addr < MAXSRCPGL) gl[busnumber].gldir->proto[addr] = 0;
     }
     else {
@@ -542,31 +552,21 @@ void startup_GL(void)
     for (i = 0; i < MAX_BUSES; i++) {
         in[i] = 0;
         out[i] = 0;
+        queue[i] = NULL;
+        queue_mask[i] = 0;
         gl[i].numberOfGl = 0;
         gl[i].glstate = NULL;
         gl[i].gldir = NULL;
-
-        int result = pthread_mutex_init(&queue_mutex[i], NULL);
-        if (result != 0) {
-            syslog_bus(0, DBG_ERROR,
-                       "pthread_mutex_init() failed: %s (errno = %d).",
-                       strerror(result), result);
-        }
     }
 }
 
-/*destroy all occupied mutexes*/
+/*free all GL data and queues*/
 void shutdown_GL()
 {
     for (bus_t i = 0; i < MAX_BUSES; i++) {
         free(gl[i].glstate);
         free(gl[i].gldir);
-        int result = pthread_mutex_destroy(&queue_mutex[i]);
-        if (result != 0) {
-            syslog_bus(0, DBG_ERROR,
-                       "pthread_mutex_destroy() failed: %s (errno = %d).",
-                       strerror(result), result);
-        }
+        free(queue[i]);
     }
 }
 
@@ -590,6 +590,15 @@ int init_GL(bus_t busnumber, unsigned int count)
         gl[busnumber].gldir = malloc(sizeof(gl_dir_t));
         if (gl[busnumber].gldir == NULL) return 1;
         bzero(gl[busnumber].gldir, sizeof(gl_dir_t));
+
+        /* power of 2 with room for every GL */
+        unsigned int len = 16;
+        while (len <= count) len <<= 1;
+        queue[busnumber] = malloc(len * sizeof(gl_slot_t));
+        if (queue[busnumber] == NULL) return 1;
+        for (unsigned int i = 0; i < len; i++)
+            queue[busnumber][i].seq = i;
+        queue_mask[busnumber] = len - 1;
     }
     return 0;
 }
@@ -616,7 +625,7 @@ static gl_data_t * get_gldata_ptr(bus_t bus, uint32_t locid)
     	if (*gli) {
         	p = &gl[bus].glstate[*gli];
         	if (p->state == glsNone) {			// new item to be considered
-        		memset(p, 0, sizeof(gl_data_t));
+        		gl_clear(p);
         		p->id = locid & 0x3FFF;
         		switch(locid >> 14) {
 					case 4:	p->protocol = 'M'; 	// MM
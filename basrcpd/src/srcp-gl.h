@@ -60,6 +60,8 @@ typedef struct _GLSTATE {
     long int lockduration;
     sessionid_t locked_by;
     uint32_t decuid; 			/* mfx decoder UID					   */
+    char queued;                /* in the command queue of the bus,
+                                   must stay the last member (gl_clear) */
 } gl_data_t;
 
 typedef struct _GL {
@@ -76,6 +78,7 @@ uint16_t isInitializedGL(bus_t busnumber, int index);
 int enqueueGL(bus_t busnumber, uint32_t locid, int dir, int speed,
         int maxspeed, int f);
 int queue_GL_isempty(bus_t busnumber);
+unsigned int queue_GL_depth(bus_t busnumber);
 gl_data_t * dequeueNextGL(bus_t busnumber);
 int cacheGetGL(bus_t busnumber, int addr, gl_data_t * l);
 void cacheSetGL(bus_t busnumber, gl_data_t *glp, gl_data_t *l);
@@ -20,23 +20,29 @@
 /*
    This code manages INFO SESSIONs. Every hardware driver, alias »bus
    process«, must call (directly or via set<devicegroup> functions) the
-   enqueueInfoMessage() function. This function is delegated to the
-   session function session_enqueue_info_message() which writes the
-   preformated string into the session specific message pipes.
+   enqueueInfoMessage() function. This function appends the preformated
+   string once to the INFO ring, a byte ring holding the SRCP text stream
+   of all info sessions.
 
-   On the other end of each session pipe the information session process
-   is waiting for new enqueued messages to write them to the socket file
-   descriptor. The process is blocked by the select() function to only
-   be bussy when real work has to be done.
+   After the start up dump each info session is handed over to the INFO
+   service thread. It waits with epoll() for new messages and for its
+   sockets, every session reads the ring by its own cursor. So the cost of
+   a message does not depend on the number of info sessions, and a slow
+   client never blocks the process which enqueues.
 
    When a new INFO session starts, it will first send all available
    status data and then wait for newly arriving messages.
  */
 
 #include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
 
 #include "config-srcpd.h"
 #include "io.h"
@@ -52,13 +58,90 @@
 #include "srcp-session.h"
 #include "syslogmessage.h"
 
-#define max(a,b)   ((a) > (b) ? (a) : (b))
+/* The INFO ring, positions are absolute byte counts. A message for a
+   single session is preceded by INFO_MARK <sid> INFO_MARKEND, both are no
+   valid characters of SRCP lines. The writer claims its bytes in
+   info_reserve before it overwrites them and publishes them in info_head
+   afterwards, readers check what they sent against info_reserve. */
+#define INFO_RING_SIZE  (1024 * 1024)
+#define INFO_MARK       '\001'
+#define INFO_MARKEND    '\002'
+#define INFO_EVENTS     16
+
+static char info_ring[INFO_RING_SIZE];
+static unsigned long long info_head = 0;
+static unsigned long long info_reserve = 0;
+static pthread_mutex_t info_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* INFO service thread, its epoll instance and wake up event */
+static pthread_once_t info_once = PTHREAD_ONCE_INIT;
+static pthread_t info_tid;
+static int info_epoll = -1;
+static int info_event = -1;
+static int info_signaled = 0;
+static bool info_terminate = false;
+static session_node_t *info_new = NULL;         /* handed over sessions */
+static session_node_t *info_sessions = NULL;    /* served sessions */
+
+static void info_signal(int event)
+{
+    uint64_t one = 1;
+
+    if (event == -1 ||
+        __atomic_exchange_n(&info_signaled, 1, __ATOMIC_SEQ_CST))
+        return;
+    if (write(event, &one, sizeof(one)) == -1) {
+        syslog_bus(0, DBG_ERROR, "INFO event write failed: %s (errno = %d)",
+                   strerror(errno), errno);
+    }
+}
 
+static void info_put(unsigned long long pos, const char *data, size_t len)
+{
+    size_t i = pos % INFO_RING_SIZE;
+    size_t n = INFO_RING_SIZE - i;
+
+    if (n >= len)
+        memcpy(&info_ring[i], data, len);
+    else {
+        memcpy(&info_ring[i], data, n);
+        memcpy(info_ring, data + n, len - n);
+    }
+}
+
+/* Append a message for all info sessions (sid == 0) or a single one */
+void info_ring_append(sessionid_t sid, const char *msg)
+{
+    char mark[32];
+    size_t marklen = 0, len;
+    int event;
+
+    len = strlen(msg);
+    if (len == 0)
+        return;
+    if (sid != 0)
+        marklen = snprintf(mark, sizeof(mark), "%c%lu%c",
+                           INFO_MARK, sid, INFO_MARKEND);
+
+    pthread_mutex_lock(&info_mutex);
+    __atomic_store_n(&info_reserve, info_head + marklen + len,
+                     __ATOMIC_SEQ_CST);
+    /* no byte of the ring is overwritten before the claim is visible */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    info_put(info_head, mark, marklen);
+    info_put(info_head + marklen, msg, len);
+    __atomic_store_n(&info_head, info_head + marklen + len,
+                     __ATOMIC_SEQ_CST);
+    event = info_event;
+    pthread_mutex_unlock(&info_mutex);
+
+    info_signal(event);
+}
 
 /* Enqueue a pre-formatted message */
 int enqueueInfoMessage(char *msg)
 {
-    session_enqueue_info_message(0, msg);
+    info_ring_append(0, msg);
     return SRCP_OK;
 }
 
@@ -67,36 +150,299 @@ void startup_INFO()
 {
 }
 
+/* a session more than the ring behind the claimed bytes has lost messages,
+   bytes read from its position on may already be overwritten */
+static bool info_lost(session_node_t * sn)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&info_reserve, __ATOMIC_SEQ_CST) - sn->infopos <=
+        INFO_RING_SIZE)
+        return false;
+    syslog_session(sn->session, DBG_WARN,
+                   "INFO client too slow, messages lost.");
+    return true;
+}
+
+/*
+ * Send the ring from the cursor of the session as far as the socket
+ * takes it. Returns -1 if the session has to be closed.
+ */
+static int info_send(session_node_t * sn)
+{
+    unsigned long long head, pos;
+    sessionid_t sid;
+    size_t i, len;
+    char *mark;
+    ssize_t sent;
+    char c;
+
+    head = __atomic_load_n(&info_head, __ATOMIC_SEQ_CST);
+    while (sn->infopos != head) {
+        if (info_lost(sn))
+            return -1;
+        i = sn->infopos % INFO_RING_SIZE;
+
+        /* message for a single session, skip it if it is not ours */
+        if (info_ring[i] == INFO_MARK) {
+            pos = sn->infopos + 1;
+            sid = 0;
+            while (pos != head
+                   && (c = info_ring[pos++ % INFO_RING_SIZE]) != INFO_MARKEND)
+                sid = sid * 10 + c - '0';
+            if (sid != sn->session) {
+                while (pos != head
+                       && info_ring[pos++ % INFO_RING_SIZE] != '\n');
+            }
+            if (info_lost(sn))
+                return -1;
+            sn->infopos = pos;
+            continue;
+        }
+
+        len = head - sn->infopos;
+        if (len > INFO_RING_SIZE - i)
+            len = INFO_RING_SIZE - i;
+        mark = memchr(&info_ring[i], INFO_MARK, len);
+        if (mark != NULL)
+            len = mark - &info_ring[i];
+
+        sent = send(sn->socket, &info_ring[i], len,
+                    MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            syslog_session(sn->session, DBG_ERROR,
+                           "Socket write failed: %s (errno = %d)\n",
+                           strerror(errno), errno);
+            return -1;
+        }
+        /* the enqueueing side may have overwritten what we just sent */
+        if (info_lost(sn))
+            return -1;
+        sn->infopos += sent;
+        if ((size_t) sent < len)
+            break;
+    }
+
+    /* wait for the socket to drain before sending the rest */
+    if ((sn->infopos != head) != sn->infoblocked) {
+        struct epoll_event ev;
+
+        sn->infoblocked = !sn->infoblocked;
+        ev.events = EPOLLIN | EPOLLRDHUP | (sn->infoblocked ? EPOLLOUT : 0);
+        ev.data.ptr = sn;
+        epoll_ctl(info_epoll, EPOLL_CTL_MOD, sn->socket, &ev);
+    }
+    return 0;
+}
+
+/* Leave the INFO service and run the cleanup of the client thread */
+static void info_close(session_node_t * sn)
+{
+    session_node_t **n;
+
+    epoll_ctl(info_epoll, EPOLL_CTL_DEL, sn->socket, NULL);
+    for (n = &info_sessions; *n != NULL; n = &(*n)->infonext) {
+        if (*n == sn) {
+            *n = sn->infonext;
+            break;
+        }
+    }
+    end_client_thread(sn);
+}
+
+/* Read from an info client, only a close is expected */
+static int info_receive(session_node_t * sn)
+{
+    char reply[MAXSRCPLINELEN];
+    ssize_t rwresult;
+
+    memset(reply, 0, sizeof(reply));
+    rwresult = read(sn->socket, reply, sizeof(reply) - 1);
+
+    if (0 == rwresult) {
+        syslog_session(sn->session, DBG_INFO,
+                       "Client terminated INFO session.\n");
+        return -1;
+    }
+
+    if (-1 == rwresult) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return 0;
+        syslog_session(sn->session, DBG_INFO,
+                       "Socket read failed: %s (errno = %d).\n",
+                       strerror(errno), errno);
+        return -1;
+    }
+
+    syslog_session(sn->session, DBG_INFO,
+                   "Unknown client message for INFO session: %s.\n", reply);
+    return 0;
+}
+
+/* INFO service thread, serves all info sessions after their start up */
+static void *thr_infoService(void *v)
+{
+    struct epoll_event events[INFO_EVENTS], ev;
+    session_node_t *sn, *next;
+    uint64_t count;
+    int i, n;
+
+    while (true) {
+        n = epoll_wait(info_epoll, events, INFO_EVENTS, -1);
+        if (n == -1) {
+            if (errno != EINTR)
+                syslog_bus(0, DBG_ERROR,
+                           "epoll_wait() failed: %s (errno = %d)\n",
+                           strerror(errno), errno);
+            continue;
+        }
+
+        for (i = 0; i < n; i++) {
+            sn = events[i].data.ptr;
+            if (sn == NULL) {
+                if (read(info_event, &count, sizeof(count)) == -1
+                    && errno != EAGAIN)
+                    syslog_bus(0, DBG_ERROR,
+                               "INFO event read failed: %s (errno = %d)",
+                               strerror(errno), errno);
+                __atomic_store_n(&info_signaled, 0, __ATOMIC_SEQ_CST);
+                continue;
+            }
+            if ((events[i].events & (EPOLLERR | EPOLLHUP))
+                || ((events[i].events & (EPOLLIN | EPOLLRDHUP))
+                    && info_receive(sn) == -1)) {
+                info_close(sn);
+                continue;
+            }
+            if ((events[i].events & EPOLLOUT) && info_send(sn) == -1)
+                info_close(sn);
+        }
+
+        /* take over the sessions which finished their start up */
+        pthread_mutex_lock(&info_mutex);
+        sn = info_new;
+        info_new = NULL;
+        pthread_mutex_unlock(&info_mutex);
+        while (sn != NULL) {
+            next = sn->infonext;
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.ptr = sn;
+            if (epoll_ctl(info_epoll, EPOLL_CTL_ADD, sn->socket, &ev) == -1) {
+                syslog_session(sn->session, DBG_ERROR,
+                               "epoll_ctl() failed: %s (errno = %d)\n",
+                               strerror(errno), errno);
+                end_client_thread(sn);
+            }
+            else {
+                sn->infonext = info_sessions;
+                info_sessions = sn;
+            }
+            sn = next;
+        }
+
+        /* send new messages to all sessions not waiting for their socket */
+        for (sn = info_sessions; sn != NULL; sn = next) {
+            next = sn->infonext;
+            if (__atomic_load_n(&info_terminate, __ATOMIC_SEQ_CST)
+                || (!sn->infoblocked && info_send(sn) == -1))
+                info_close(sn);
+        }
+    }
+    return NULL;
+}
+
+static void start_info_service(void)
+{
+    struct epoll_event ev;
+    int result;
+
+    info_epoll = epoll_create1(0);
+    if (info_epoll == -1) {
+        syslog_bus(0, DBG_ERROR, "epoll_create1() failed: %s (errno = %d)",
+                   strerror(errno), errno);
+        return;
+    }
+    pthread_mutex_lock(&info_mutex);
+    info_event = eventfd(0, EFD_NONBLOCK);
+    pthread_mutex_unlock(&info_mutex);
+    if (info_event == -1) {
+        syslog_bus(0, DBG_ERROR, "eventfd() failed: %s (errno = %d)",
+                   strerror(errno), errno);
+        return;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(info_epoll, EPOLL_CTL_ADD, info_event, &ev);
+
+    result = pthread_create(&info_tid, NULL, thr_infoService, NULL);
+    if (result != 0) {
+        syslog_bus(0, DBG_ERROR, "Create INFO service thread failed: "
+                   "%s (errno = %d)", strerror(result), result);
+        return;
+    }
+    pthread_detach(info_tid);
+}
+
+/* hand a started info session over to the INFO service */
+static int info_service_add(session_node_t * sn)
+{
+    int flags, event;
+
+    pthread_once(&info_once, start_info_service);
+    if (info_event == -1)
+        return -1;
+
+    flags = fcntl(sn->socket, F_GETFL);
+    if (flags == -1 || fcntl(sn->socket, F_SETFL, flags | O_NONBLOCK) == -1) {
+        syslog_session(sn->session, DBG_ERROR,
+                       "fcntl() failed: %s (errno = %d)\n",
+                       strerror(errno), errno);
+        return -1;
+    }
+
+    /* the client thread may not be cancelled from now on */
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+    session_detach_thread(sn);
+
+    sn->infoblocked = false;
+    pthread_mutex_lock(&info_mutex);
+    sn->infonext = info_new;
+    info_new = sn;
+    event = info_event;
+    pthread_mutex_unlock(&info_mutex);
+    info_signal(event);
+    return 0;
+}
+
+/* close all sessions served by the INFO service */
+void terminate_info_sessions()
+{
+    int event;
+
+    __atomic_store_n(&info_terminate, true, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&info_mutex);
+    event = info_event;
+    pthread_mutex_unlock(&info_mutex);
+    info_signal(event);
+}
+
 /**
- * Handler for info mode client thread;
- * terminates on write failure or if cancelled externaly
+ * Handler for info mode client thread, sends the start up information
+ * and hands the session over to the INFO service. Returns 0 if the
+ * session is served by the INFO service now, -1 on write failure.
  **/
 int doInfoClient(session_node_t * sn)
 {
-    int i, n, number, value, result, linelen, bufferlen;
+    int i, n, number, value;
     char reply[MAXSRCPLINELEN], description[MAXSRCPLINELEN];
-    char pipebuffer[2048];
-    char *buffer = &pipebuffer[0];
-    char *bufferend = &pipebuffer[sizeof(pipebuffer) - 1];
-    char *linestart;
     struct timeval cmp_time;
     bus_t bus;
-    fd_set rset;
-    int maxfdp1;
-    ssize_t rwresult = 0;
-    ssize_t swritten = 0;
-    ssize_t total = 0;
-
-    result = pipe(sn->pipefd);
-    if (-1 == result) {
-        syslog_session(sn->session, DBG_ERROR,
-                       "Pipe create failed: %s (errno = %d)\n",
-                       strerror(errno), errno);
-        return (-1);
-    }
 
-    maxfdp1 = max(sn->socket, sn->pipefd[0]) + 1;
-    FD_ZERO(&rset);
+    /* messages enqueued while sending the start up information follow it */
+    sn->infopos = __atomic_load_n(&info_head, __ATOMIC_SEQ_CST);
 
     syslog_session(sn->session, DBG_DEBUG, "New INFO client requested.");
 
@@ -253,151 +599,9 @@ int doInfoClient(session_node_t * sn)
                    "All messages send to new INFO client.\n");
 
     /*
-     * There is a kind of race condition: Newly piped messages may
-     * be ignored until we reach this point. But there is no message
-     * loss because the following action will properly detect and send
-     * them.
+     * There is a kind of race condition: Messages enqueued during the
+     * start up may repeat information already sent. But there is no
+     * message loss because the cursor was taken before.
      */
-
-    /*
-     * This while loop has two tasks:
-     *   1) Wait for enqueued info messages to send them to the
-     *      connected client.
-     *   2) Detect a client connection close in a timely manner.
-     *
-     *  The select() function helps to detect activities on these two
-     *  diffent communication channels each having its own file
-     *  descriptor.
-     */
-    while (true) {
-        pthread_testcancel();
-
-        FD_SET(sn->pipefd[0], &rset);
-        FD_SET(sn->socket, &rset);
-
-        if ((result = select(maxfdp1, &rset, NULL, NULL, NULL)) == -1) {
-            if (errno == EINTR)
-                continue;
-            else {
-                syslog_session(sn->session, DBG_ERROR,
-                               "Select failed: %s (errno = %d)\n",
-                               strerror(errno), errno);
-                return (-1);
-            }
-        }
-
-        /* some socket activity was detected */
-        if (FD_ISSET(sn->socket, &rset)) {
-            memset(reply, 0, sizeof(reply));
-            rwresult = read(sn->socket, &reply, sizeof(reply));
-
-            if (0 == rwresult) {
-                syslog_session(sn->session, DBG_INFO,
-                               "Client terminated INFO session.\n");
-                return (-1);
-            }
-
-            if (-1 == rwresult) {
-                syslog_session(sn->session, DBG_INFO,
-                               "Socket read failed: %s (errno = %d).\n",
-                               strerror(errno), errno);
-                return (-1);
-            }
-
-            syslog_session(sn->session, DBG_INFO,
-                           "Unknown client message for INFO session: %s.\n",
-                           reply);
-        }
-
-        /* Message from enqueueing process arrived; dequeue piped info
-         * messages and write them to socket. Watch out for truncated
-         * messages if pipe or read buffer is completely full.*/
-        if (FD_ISSET(sn->pipefd[0], &rset)) {
-
-            linelen = 0;
-
-            do {
-                /* start of read buffer has an offset if there is a
-                 * truncated message from last read */
-                buffer = &pipebuffer[0] + linelen;
-                bufferlen = sizeof(pipebuffer) - linelen;
-                linelen = 0;
-                total = 0;
-                swritten = 0;
-                linestart = NULL;
-
-                rwresult = read(sn->pipefd[0], buffer, bufferlen);
-
-                /* pipe read error */
-                if (-1 == rwresult) {
-                    syslog_session(sn->session, DBG_ERROR,
-                                   "Pipe read failed: %s (errno = %d)\n",
-                                   strerror(errno), errno);
-                    return -1;
-                }
-
-                /* EOF from other end of pipe */
-                if (0 == rwresult) {
-                    syslog_session(sn->session, DBG_ERROR,
-                                   "Pipe closed unexpectedly.\n");
-                    return -1;
-                }
-
-                /* check if buffer is full and last line was truncated;
-                 * if truncated line found, search start of line */
-                if (rwresult == bufferlen && *bufferend != '\0') {
-                    linestart = bufferend - 1;
-                    while (linestart >= &pipebuffer[0]) {
-                        if (*linestart == '\0') {
-                            linelen = bufferend - linestart;
-                            linestart++;
-                            break;
-                        }
-                        linestart--;
-                    }
-                    if (linestart == &pipebuffer[0]) {
-                        syslog_session(sn->session, DBG_ERROR,
-                                       "Pipe read buffer overfilled.");
-                        return -1;
-                    }
-                }
-
-                /* normal operation; write several times to socket if pipe
-                 * containes more than one message string, which is
-                 * terminated by '\0' */
-                buffer = &pipebuffer[0];
-                do {
-                    swritten = writen(sn->socket, buffer, strlen(buffer));
-                    total += swritten + 1;
-                    buffer += swritten + 1;
-
-                    /* if there is a truncated message, move it to start of
-                     * buffer to be used after next read*/
-                    if (buffer == linestart) {
-                        memmove(&pipebuffer[0], linestart, linelen);
-                        break;
-                    }
-                }
-                while (total < rwresult && swritten > 0);
-
-                /* socket write error */
-                if (-1 == swritten) {
-                    syslog_session(sn->session, DBG_ERROR,
-                                   "Socket write failed: %s (errno = %d)\n",
-                                   strerror(errno), errno);
-                    return -1;
-                }
-
-                /* EOF, client terminated connection */
-                if (0 == swritten) {
-                    syslog_session(sn->session, DBG_WARN,
-                                   "Socket write failed (connection terminated "
-                                   "by client).\n");
-                    return -1;
-                }
-
-            } while (linestart != NULL);
-        }
-    }
-    return 0;
+    return info_service_add(sn);
 }
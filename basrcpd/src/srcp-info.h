@@ -25,6 +25,8 @@
 int doInfoClient(session_node_t*);
 void startup_INFO();
 int enqueueInfoMessage(char *);
+void info_ring_append(sessionid_t, const char *);
+void terminate_info_sessions();
 int info_mcs(bus_t bus, uint16_t infoid, uint32_t itemid, char * info);
 
 #endif
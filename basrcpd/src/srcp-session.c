@@ -66,8 +66,11 @@ static session_node_t *list_add(session_node_t ** p, int s)
     n->socket = s;
     n->thread = 0;
     n->mode = smUndefined;
-    n->pipefd[0] = -1;
-    n->pipefd[1] = -1;
+    n->rdbuf.pos = 0;
+    n->rdbuf.fill = 0;
+    n->infopos = 0;
+    n->infoblocked = false;
+    n->infonext = NULL;
     return n;
 }
 
@@ -98,19 +101,6 @@ static session_node_t **list_search_session(session_node_t ** n,
     return NULL;
 }
 
-/* search sessionid in list, return pointer to node */
-static session_node_t *list_search_session_node(session_node_t ** n,
-                                                sessionid_t sid)
-{
-    while (*n != NULL) {
-        if ((*n)->session == sid) {
-            return *n;
-        }
-        n = &(*n)->next;
-    }
-    return NULL;
-}
-
 /* search thread id by sessionid, return thread id */
 static pthread_t list_search_thread_by_sessionid(session_node_t ** n,
                                                  sessionid_t sid)
@@ -340,78 +330,34 @@ bool is_valid_info_session(sessionid_t session)
 }
 
 /*
- * Enqueue a new info message to the appropriate session pipe.
- *
- * There is no write locking because writing to pipes is atomic as
- * far as MAXSRCPLEN < PIPE_BUF and pipe write access is blocking (see
- * "man 3 write" for more details).
+ * Enqueue a new info message for all info sessions (sid == 0) or for a
+ * single one. It is appended once to the INFO ring, the INFO service
+ * sends it to the sessions.
  */
 void session_enqueue_info_message(sessionid_t sid, char *msg)
 {
-    session_node_t *n;
-    int result;
-    ssize_t nwritten;
-
-    /*return immediately, if no session is running */
-    if (NULL == session_list)
-        return;
-
-    /*enqueue message for all info sessions */
-    if (sid == 0) {
-        n = session_list;
-        result = pthread_mutex_lock(&session_list_mutex);
-        if (result != 0) {
-            syslog_session(sid, DBG_ERROR,
-                           "pthread_mutex_lock() failed: %s (errno = %d).",
-                           strerror(result), result);
-        }
+    info_ring_append(sid, msg);
+}
 
-        while (n != NULL) {
-            if (n->mode == smInfo && n->pipefd[1] != -1) {
-                nwritten = write(n->pipefd[1], msg, strlen(msg) + 1);
-                if (nwritten == -1) {
-                    syslog_session(n->session, DBG_ERROR,
-                                   "Write to pipe failed: %s (errno = %d).",
-                                   strerror(errno), errno);
-                }
-            }
-            n = n->next;
-        }
+/* the session is served without its client thread from now on */
+void session_detach_thread(session_node_t * n)
+{
+    int result;
 
-        result = pthread_mutex_unlock(&session_list_mutex);
-        if (result != 0) {
-            syslog_session(sid, DBG_ERROR,
-                           "pthread_mutex_unlock() failed: %s (errno = %d).",
-                           strerror(result), result);
-        }
+    result = pthread_mutex_lock(&session_list_mutex);
+    if (result != 0) {
+        syslog_session(n->session, DBG_ERROR,
+                       "pthread_mutex_lock() failed: %s (errno = %d).",
+                       strerror(result), result);
     }
 
-    /*enqueue message for a single info session */
-    else {
-        result = pthread_mutex_lock(&session_list_mutex);
-        if (result != 0) {
-            syslog_session(sid, DBG_ERROR,
-                           "pthread_mutex_lock() failed: %s (errno = %d).",
-                           strerror(result), result);
-        }
-
-        n = list_search_session_node(&session_list, sid);
-
-        if (n != NULL && n->mode == smInfo && n->pipefd[1] != -1) {
-            nwritten = write(n->pipefd[1], msg, strlen(msg) + 1);
-            if (nwritten == -1) {
-                syslog_session(n->session, DBG_ERROR,
-                               "Write to pipe failed: %s (errno = %d).",
-                               strerror(errno), errno);
-            }
-        }
+    n->thread = 0;
 
-        result = pthread_mutex_unlock(&session_list_mutex);
-        if (result != 0) {
-            syslog_session(sid, DBG_ERROR,
-                           "pthread_mutex_unlock() failed: %s (errno = %d).",
-                           strerror(result), result);
-        }
+    result = pthread_mutex_unlock(&session_list_mutex);
+    if (result != 0) {
+        syslog_session(n->session, DBG_ERROR,
+                       "pthread_mutex_unlock() failed: %s (errno = %d).",
+                       strerror(result), result);
     }
 }
 
@@ -469,14 +415,18 @@ void terminate_all_sessions()
     }
 
     while (node != NULL) {
-        result = pthread_cancel(node->thread);
-        if (result != 0) {
-            syslog_bus(0, DBG_ERROR,
-                       "pthread_cancel() failed: %s (errno = %d).",
-                       strerror(result), result);
+        /* sessions of the INFO service have no thread */
+        if (node->thread != 0) {
+            result = pthread_cancel(node->thread);
+            if (result != 0) {
+                syslog_bus(0, DBG_ERROR,
+                           "pthread_cancel() failed: %s (errno = %d).",
+                           strerror(result), result);
+            }
         }
         node = node->next;
     }
+    terminate_info_sessions();
 
     /*... then wait for complete termination */
     while (runningsessions != 0) {
@@ -22,6 +22,7 @@
 #include <pthread.h>
 
 #include "config-srcpd.h"
+#include "io.h"
 
 /*session modes*/
 typedef enum {smUndefined = 0, smCommand, smInfo} SessionMode;
@@ -32,7 +33,10 @@ typedef struct sn {
     pthread_t thread;
     int socket;
     SessionMode mode;
-    int pipefd[2];
+    linebuf_t rdbuf;            /* receive buffer of the socket */
+    unsigned long long infopos; /* INFO ring position to send next */
+    bool infoblocked;           /* INFO socket full, waiting for EPOLLOUT */
+    struct sn *infonext;        /* session list of the INFO service */
     struct sn *next;
 } session_node_t;
 
@@ -45,6 +49,7 @@ void register_session(session_node_t*);
 void destroy_anonymous_session(session_node_t*);
 void destroy_session(sessionid_t);
 void terminate_all_sessions();
+void session_detach_thread(session_node_t*);
 bool is_valid_info_session(sessionid_t);
 void session_enqueue_info_message(sessionid_t, char*);
 
@@ -22,6 +22,7 @@
 #include <signal.h>
 
 #include "config-srcpd.h"
+#include "ddl.h"
 #include "netservice.h"
 #include "srcp-descr.h"
 #include "srcp-fb.h"
@@ -164,6 +165,12 @@ void sighup_handler(int s)
     create_all_threads();
 }
 
+/* signal SIGUSR1(10) caught, DDL buses report their statistics */
+void sigusr1_handler(int s)
+{
+    request_statistics_DDL();
+}
+
 /* signal SIGTERM(15) caught */
 void sigterm_handler(int s)
 {
@@ -217,6 +224,7 @@ void install_signal_handlers()
 
     signal(SIGTERM, sigterm_handler);
     signal(SIGHUP, sighup_handler);
+    signal(SIGUSR1, sigusr1_handler);
     /* important, because write() on sockets should return errors */
     signal(SIGPIPE, SIG_IGN);
 
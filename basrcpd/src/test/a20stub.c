@@ -0,0 +1,31 @@
+// a20stub.c - A20 GPIO functions without hardware for the benchmark srcpd
+
+/*
+ * Replaces a20hw.c in test/srcpd, so the server runs on any Linux host.
+ * Only the loopback bus is configured there, the GPIO pins are never used.
+ */
+
+#include "a20hw.h"
+
+int a20_init(void)
+{
+    return 1;
+}
+
+int a20_close(void)
+{
+    return 1;
+}
+
+void a20_gpio_set_fsel(uint16_t pin, uint8_t mode)
+{
+}
+
+uint8_t a20_gpio_lev(uint16_t pin)
+{
+    return LOW;
+}
+
+void a20_gpio_write(uint16_t pin, uint8_t on)
+{
+}
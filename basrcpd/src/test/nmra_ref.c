@@ -0,0 +1,674 @@
+// nmra_ref.c - reference encoder for the basrcpd NMRA test
+
+/*
+ * The operations mode encoders of ddl_nmra.c as they were before the
+ * packets were built packed from integers: every packet is composed as a
+ * string of '0' and '1' characters and then packed bit by bit.
+ * nmratest compares the output of ddl_nmra.c with this code.
+ *
+ * Only change made: the second function stream of ref_comp_nmra_multi_func
+ * is sent from its own buffer, as ddl_nmra.c does since then.
+ */
+
+#include <string.h>
+
+#include "ddl.h"
+#include "syslogmessage.h"
+#include "nmra_ref.h"
+
+static char *preamble = "111111111111111";
+
+/* 230 is needed for all functions F0-F28 */
+static const unsigned int BUFFERSIZE = 256;
+
+/* internal offset of the long addresses */
+static const unsigned int ADDR14BIT_OFFSET = 128;
+
+/**
+ * Erzeugung Paket für SPI Ausgabe. Was viel einfacher ist:
+ * Aus Effizenzgründen kodieren wir hier bitweise, Konvertierung 
+ * auf tatsächlich zu sendende SPI Bytes erfolgt dann direkt beim senden.
+ * (ein 0 Bit wird dann 2 Byte lang).
+ * Damit da bekannt ist, wieviele Bits gesendet werden müssen, wird diese
+ * Anzahl im 1. Packetstream Byte übergeben.
+ * Retunwert ist die Anzahl Byte, also erstes Löngenbyte plus alle notwendigen Datenbytes.
+ */
+static int translateBitstream2Packetstream(bus_t busnumber, char *Bitstream,
+                                           char *Packetstream)
+{
+  int i;
+  int bitLen = strlen(Bitstream);
+  if (bitLen > 255) {
+    //Paket zu Gross, Abbruch
+    return 0;
+  }
+  memset(Packetstream, 0, PKTSIZE);
+  //Länge
+  Packetstream[0] = (char)bitLen;
+  for (i=0; i<bitLen; i++) {
+    if (Bitstream[i] == '1') {
+      Packetstream[(i / 8) + 1] |= 1 << (i % 8);
+    }
+  }
+  return (bitLen / 8) + 2; //Inkl. Längenbyte
+}
+
+
+/*** Some useful functions to calculate NMRA-DCC bytes (char arrays) ***/
+
+/**
+  Transform the lower 8 bit of the input into a "bitstream" byte
+  @par Input: int value
+  @par Output: char* byte
+*/
+static void calc_single_byte(char *byte, int value)
+{
+    int i;
+    int bit = 0x1;
+
+    strncpy(byte, "00000000", 9);
+    byte[8] = 0;
+
+    for (i = 7; i >= 0; i--) {
+        if (value & bit)
+            byte[i] = '1';
+        bit <<= 1;
+    }
+}
+
+/* calculating address bytes: 11AAAAAA AAAAAAAA */
+static void calc_14bit_address_byte(char *byte1, char *byte2, int address)
+{
+    calc_single_byte(byte2, address);
+    calc_single_byte(byte1, 0xc0 | (address >> 8));
+}
+
+/* calculating speed byte2: 01DUSSSS  */
+static void calc_baseline_speed_byte(char *byte, int direction, int speed,
+                                     int func)
+{
+    calc_single_byte(byte, 0x40 | (direction << 5) | speed);
+    if (func & 1)
+        byte[3] = '1';
+}
+
+/* calculating speed byte: 01DSSSSS */
+static void calc_28spst_speed_byte(char *byte, int direction, int speed)
+{
+    /* last significant speed bit is at pos 3 */
+
+    if (speed > 1) {
+        speed += 2;
+        calc_single_byte(byte, 0x40 | (direction << 5) | (speed >> 1));
+        if (speed & 1) {
+            byte[3] = '1';
+        }
+    }
+    else {
+        calc_single_byte(byte, 0x40 | (direction << 5) | speed);
+    }
+}
+
+/* calculating function byte: 100DDDDD */
+static void calc_function_group_one_byte(char *byte, int func)
+{
+    /* mask out lower 5 function bits */
+    func &= 0x1f;
+    calc_single_byte(byte, 0x80 | (func >> 1));
+
+    /* F0 or FL is out of order */
+    if (func & 1)
+        byte[3] = '1';
+}
+
+/* calculating function byte: 101SDDDD */
+static void calc_function_group_two_byte(char *byte, int func, int lower)
+{
+    if (lower) {
+        /* shift func bits to lower 4 bits and mask them */
+        func = (func >> 5) & 0xf;
+        /* set command for F5 to F8 */
+        func |= 0xb0;
+    }
+    else {
+        func = (func >> 9) & 0xf;
+        func |= 0xa0;
+    }
+    calc_single_byte(byte, func);
+}
+
+static void calc_128spst_adv_op_bytes(char *byte1, char *byte2,
+                                      int direction, int speed)
+{
+    strcpy(byte1, "00111111");
+    calc_single_byte(byte2, speed);
+    if (direction == 1)
+        byte2[0] = '1';
+}
+
+static void xor_two_bytes(char *byte, char *byte1, char *byte2)
+{
+
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        if (byte1[i] == byte2[i])
+            byte[i] = '0';
+        else
+            byte[i] = '1';
+    }
+    byte[8] = 0;
+}
+
+/*** functions to generate NMRA-DCC data packets ***/
+
+int ref_comp_nmra_accessory(bus_t busnumber, int nr, int output, int activate,
+                            int offset)
+{
+    /* command: NA <nr [0001-2044]> <outp [0,1]> <activate [0,1]>
+       example: NA 0012 0 1  */
+
+    char byte1[9];
+    char byte2[9];
+    char byte3[9];
+    char bitstream[BUFFERSIZE];
+    char packetstream[PKTSIZE];
+//    char *p_packetstream;
+
+    int address = 0;            /* of the decoder                */
+    int pairnr = 0;             /* decoders have pair of outputs */
+
+    int j;
+
+    syslog_bus(busnumber, DBG_DEBUG,
+               "command for NMRA protocol for accessory decoders "
+               "(NA) received");
+
+    /* no special error handling, it's job of the clients */
+    if (nr < 1 || nr > 2044 || output < 0 || output > 1 ||
+        activate < 0 || activate > 1)
+        return 1;
+
+    /* packet is not available */
+//    p_packetstream = packetstream;
+
+    /* calculate the real address of the decoder and the pair number 
+     * of the switch */
+    /* valid decoder addresses: 0..511 */
+    address = ((nr - 1) / 4) + offset;
+    pairnr = (nr - 1) % 4;
+
+    /* address byte: 10AAAAAA (lower 6 bits) */
+    calc_single_byte(byte1, 0x80 | (address & 0x3f));
+
+    /* address and data 1AAACDDO upper 3 address bits are inverted */
+    /* C =  activate, DD = pairnr */
+    calc_single_byte(byte2,
+                     0x80 | ((~address) & 0x1c0) >> 2 | activate << 3 |
+                     pairnr << 1 | output);
+    xor_two_bytes(byte3, byte2, byte1);
+
+    /* putting all together in a 'bitstream' (char array) */
+    memset(bitstream, 0, BUFFERSIZE);
+    strcat(bitstream, preamble);
+    strcat(bitstream, "0");
+    strcat(bitstream, byte1);
+    strcat(bitstream, "0");
+    strcat(bitstream, byte2);
+    strcat(bitstream, "0");
+    strcat(bitstream, byte3);
+    strcat(bitstream, "1");
+
+    j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
+    if (j > 0) {
+    	send_packet(busnumber, packetstream, j, QNBACCPKT, 2);    
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+  Calculate up to 4 command sequences depending on the number of possible 
+  functions (taken from INIT <BUS> GL ...) for up to 28 Functions
+  due to the long bitstream in case of 28 functions the bitstream is
+  split into to parts.
+  @par Input: char *addrerrbyte Error detection code for address bytes(s)
+              char *addrstream "bitstream" for preamble and the address byte(s)
+              int func function bits
+              int nfuncs number of functions
+  @par Output: char* bitstream the resulting "bitstream"
+  @par Output: char* bitstream2 the second  "bitstream"
+*/
+static void calc_function_stream(char *bitstream, char *bitstream2,
+                                 char *addrerrbyte, char *addrstream,
+                                 int func, int nfuncs)
+{
+    char funcbyte[9];
+    char errdbyte[9];
+    /* between two commands to the same address there has to be a gap
+       of at least 5ms. 5ms are 10 packet bytes. one packet byte can take
+       5 logical "1" (0x55) ==> 50 logical "1" are needed between 2 packets.
+       The preamble holds 15 "1"s, so only 35 additional are needed
+     */
+    char wait[40] = "11111111111111111111111111111111111";
+
+    calc_function_group_one_byte(funcbyte, func);
+    xor_two_bytes(errdbyte, addrerrbyte, funcbyte);
+
+    /* putting all together in a 'bitstream' (char array) (functions) */
+    memset(bitstream2, 0, BUFFERSIZE);
+    strcat(bitstream2, addrstream);
+    strcat(bitstream2, funcbyte);
+    strcat(bitstream2, "0");
+    strcat(bitstream2, errdbyte);
+    strcat(bitstream2, "1");
+    if (nfuncs > 5) {
+        calc_function_group_two_byte(funcbyte, func, true);
+        xor_two_bytes(errdbyte, addrerrbyte, funcbyte);
+        strcat(bitstream, wait);
+        strcat(bitstream, addrstream);
+        strcat(bitstream, funcbyte);
+        strcat(bitstream, "0");
+        strcat(bitstream, errdbyte);
+        strcat(bitstream, "1");
+
+        if (nfuncs > 8) {
+            calc_function_group_two_byte(funcbyte, func, false);
+            xor_two_bytes(errdbyte, addrerrbyte, funcbyte);
+            strcat(bitstream2, wait);
+            strcat(bitstream2, addrstream);
+            strcat(bitstream2, funcbyte);
+            strcat(bitstream2, "0");
+            strcat(bitstream2, errdbyte);
+            strcat(bitstream2, "1");
+            if (nfuncs > 12) {
+                char funcbyte2[9];
+                strncpy(funcbyte2, "11011110", 9);
+                funcbyte2[8] = 0;
+                calc_single_byte(funcbyte, func >> 13);
+                xor_two_bytes(errdbyte, addrerrbyte, funcbyte2);
+                xor_two_bytes(errdbyte, errdbyte, funcbyte);
+                strcat(bitstream, wait);
+                strcat(bitstream, addrstream);
+                strcat(bitstream, funcbyte2);
+                strcat(bitstream, "0");
+                strcat(bitstream, funcbyte);
+                strcat(bitstream, "0");
+                strcat(bitstream, errdbyte);
+                strcat(bitstream, "1");
+                if (nfuncs > 20) {
+                    funcbyte2[7] = '1';
+                    xor_two_bytes(errdbyte, addrerrbyte, funcbyte2);
+                    calc_single_byte(funcbyte, func >> 21);
+                    xor_two_bytes(errdbyte, errdbyte, funcbyte);
+                    strcat(bitstream2, wait);
+                    strcat(bitstream2, addrstream);
+                    strcat(bitstream2, funcbyte2);
+                    strcat(bitstream2, "0");
+                    strcat(bitstream2, funcbyte);
+                    strcat(bitstream2, "0");
+                    strcat(bitstream2, errdbyte);
+                    strcat(bitstream2, "1");
+                }
+            }
+        }
+    }
+}
+
+/**
+  Calculate the "bitstream" for the cv programming sequence
+  @par Input: char *addrerrbyte error detection byte of the address byte(s)
+              int cv
+              int value
+              int verify
+              int pom  if true generate PoM command
+  @par Output: char* progstream the resulting "bitstream" for the
+               program sequence
+*/
+static void calc_byte_program_stream(char *progstream, char *addrerrbyte,
+                                     int cv, int value, int verify,
+                                     int pom)
+{
+    char byte2[9];
+    char byte3[9];
+    char byte4[9];
+    char byte5[9];
+
+    memset(progstream, 0, BUFFERSIZE);
+    /* calculating byte3: AAAAAAAA (rest of CV#) */
+    calc_single_byte(byte3, cv);
+
+    if (pom) {
+        /* calculating byte2: 1110C1AA (instruction byte1) */
+        calc_single_byte(byte2, 0xec | (cv >> 8));
+    }
+    else {
+        /* calculating byte2: 011110AA (instruction byte1) */
+        calc_single_byte(byte2, 0x7c | (cv >> 8));
+    }
+    if (verify) {
+        byte2[4] = '0';
+    }
+
+    /* calculating byte4: DDDDDDDD (data) */
+    calc_single_byte(byte4, value);
+
+    /* calculating byte5: EEEEEEEE (error detection byte) */
+    xor_two_bytes(byte5, addrerrbyte, byte2);
+    xor_two_bytes(byte5, byte5, byte3);
+    xor_two_bytes(byte5, byte5, byte4);
+
+    strcat(progstream, byte2);
+    strcat(progstream, "0");
+    strcat(progstream, byte3);
+    strcat(progstream, "0");
+    strcat(progstream, byte4);
+    strcat(progstream, "0");
+    strcat(progstream, byte5);
+    strcat(progstream, "1");
+}
+
+/**
+  Calculate the "bitstream" for the cvbit programming sequence
+  @par Input: char *addrerrbyte error detection byte of the address byte(s)
+              int cv
+              int value
+              int verify
+              int pom  if true generrate PoM command
+  @par Output: char* progstream the resulting "bitstream" for the
+               program sequence
+*/
+static void calc_bit_program_stream(char *progstream, char *addrerrbyte,
+                                    int cv, int bit, int value, int verify,
+                                    int pom)
+{
+    char byte2[9];
+    char byte3[9];
+    char byte4[9];
+    char byte5[9];
+
+    memset(progstream, 0, BUFFERSIZE);
+    /* calculating byte3: AAAAAAAA (rest of CV#) */
+    calc_single_byte(byte3, cv);
+
+    if (pom) {
+        /* calculating byte2: 111010AA (instruction byte1) */
+        calc_single_byte(byte2, 0xe8 | (cv >> 8));
+    }
+    else {
+        /* calculating byte2: 011110AA (instruction byte1) */
+        calc_single_byte(byte2, 0x78 | (cv >> 8));
+    }
+
+    /* calculating byte4: 111CDBBB (data) */
+    calc_single_byte(byte4, 0xf0 | (value << 3) | bit);
+    if (verify) {
+        byte4[3] = '0';
+    }
+
+    /* calculating byte5: EEEEEEEE (error detection byte) */
+    xor_two_bytes(byte5, addrerrbyte, byte2);
+    xor_two_bytes(byte5, byte5, byte3);
+    xor_two_bytes(byte5, byte5, byte4);
+
+    /* putting all together in a 'bitstream' (char array) */
+    strcat(progstream, byte2);
+    strcat(progstream, "0");
+    strcat(progstream, byte3);
+    strcat(progstream, "0");
+    strcat(progstream, byte4);
+    strcat(progstream, "0");
+    strcat(progstream, byte5);
+    strcat(progstream, "1");
+}
+
+/**
+  Calculate the "bitstream" for 7 and 14 bit addresses
+  @par Input: int address
+              int mode  1 = 7 bit, 2 = 14 bit
+  
+  @par Output: char* addrstream the resulting "bitstream" for address byte(s)
+               char* addrerrbyte the "bitstream" for error detection byte
+*/
+static void calc_address_stream(char *addrstream, char *addrerrbyte,
+                                int address, int mode)
+{
+    char addrbyte[9];
+    char addrbyte2[9];
+    if (mode == 1) {
+        /* calc 7 bit address - leading bit is zero */
+        calc_single_byte(addrbyte, address & 0x7f);
+        /* no second byte => error detection byte = addressbyte */
+        memcpy(addrerrbyte, addrbyte, 9);
+
+    }
+    else {
+        calc_14bit_address_byte(addrbyte, addrbyte2, address);
+        xor_two_bytes(addrerrbyte, addrbyte, addrbyte2);
+    }
+
+    /* putting all together in a 'bitstream' (char array) (speed & direction) */
+    memset(addrstream, 0, BUFFERSIZE);
+    strcat(addrstream, preamble);
+    strcat(addrstream, "0");
+    strcat(addrstream, addrbyte);
+    strcat(addrstream, "0");
+    if (mode == 2) {
+        strcat(addrstream, addrbyte2);
+        strcat(addrstream, "0");
+    }
+}
+
+/**
+  Generate the packet for NMRA (multi)-function-decoder with 7-bit or 14-bit
+  address and 14/28 or 128 speed steps and up to 28 functions
+  @par Input: bus_t busnumber
+              int address GL address
+              int direction
+              int speed
+              int func function bits
+              int nspeed number of speeds for this decoder
+              int nfuncs number of functions
+              int mode 1 == short address, 2 == long (2byte) address
+  @return 0 == OK, 1 == Error
+*/
+void ref_comp_nmra_multi_func(bus_t busnumber, gl_data_t *glp)
+{
+    char spdrbyte[9];
+    char spdrbyte2[9];
+    char errdbyte[9];
+    char addrerrbyte[9];
+    char addrstream[BUFFERSIZE];
+    char bitstream[BUFFERSIZE];
+    char bitstream2[BUFFERSIZE];
+    char packetstream[PKTSIZE];
+    char packetstream2_buf[PKTSIZE];
+    char *packetstream2 = packetstream2_buf;
+
+    int adr = 0;
+    int j, jj;
+
+	int mode = glp->protocolversion;
+    int address = glp->id;
+    int speed = glp->speed;
+    int direction = glp->direction;
+    uint32_t func = glp->funcs;
+    uint8_t nspeed = glp->n_fs;
+    uint8_t	nfuncs = glp->n_func;
+
+    if (glp->speedchange & SCEMERG) {   // Emergency Stop
+        speed = 1;
+        direction = glp->cacheddirection;
+        glp->speedchange &= ~SCEMERG;
+    }
+    else if (speed) speed++;        	// Never send FS1
+
+  	if (speed > 127) speed = 127;
+    glp->speedchange &= ~(SCSPEED | SCDIREC);   // handled now
+    
+    syslog_bus(busnumber, DBG_DEBUG,
+               "command for NMRA protocol (N%d) received addr:%d "
+               "dir:%d speed:%d nspeeds:%d nfunc:%d funcs %x",
+               mode, address, direction, speed, nspeed, nfuncs,func);
+
+    adr = address;
+
+    if (mode == 2) {
+        adr += ADDR14BIT_OFFSET;
+    }
+    /* no special error handling, it's job of the clients */
+    if (address < 1 || address > 10239 || direction < 0 || direction > 1 ||
+        speed < 0 || speed > (nspeed + 1) || (address > 127 && mode == 1))
+        return;
+
+    calc_address_stream(addrstream, addrerrbyte, address, mode);
+    if (speed < 2 || nspeed < 15) {
+        /* commands for stop and emergency stop are identical for
+           14 and 28 speed steps. All decoders supporting 128
+           speed steps also have to support 14/28 speed step commands
+           ==> results in shorter refresh cycle if there are many 128
+           speed steps decoders with speed=0, and a slightly faster 
+           emergency stop for these decoders.
+         */
+        calc_baseline_speed_byte(spdrbyte, direction, speed, func);
+    }
+    else {
+        if (nspeed > 29) {
+            calc_128spst_adv_op_bytes(spdrbyte, spdrbyte2, direction,
+                                      speed);
+        }
+        else {
+            calc_28spst_speed_byte(spdrbyte, direction, speed);
+        }
+    }
+
+    xor_two_bytes(errdbyte, addrerrbyte, spdrbyte);
+
+    memset(bitstream, 0, BUFFERSIZE);
+    strcat(bitstream, addrstream);
+    strcat(bitstream, spdrbyte);
+    strcat(bitstream, "0");
+    if (nspeed > 29 && speed > 1) {
+        strcat(bitstream, spdrbyte2);
+        strcat(bitstream, "0");
+        xor_two_bytes(errdbyte, errdbyte, spdrbyte2);
+    }
+    strcat(bitstream, errdbyte);
+    strcat(bitstream, "1");
+
+    if (nfuncs && (nspeed > 14)) {
+        calc_function_stream(bitstream, bitstream2, addrerrbyte,
+                             addrstream, func, nfuncs);
+        j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
+        jj = translateBitstream2Packetstream(busnumber, bitstream2, packetstream2);
+    }
+    else {
+        j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
+        packetstream2 = packetstream;
+        jj = j;
+    }
+    if (j > 0 && jj > 0) {
+        update_NMRAPacketPool(busnumber, adr, packetstream, j,
+                              packetstream2, jj);
+    	send_packet(busnumber, packetstream, j, QNBLOCOPKT, 2);    
+        if (nfuncs && (nspeed > 14)) {
+    		send_packet(busnumber, packetstream2, jj, QNBLOCOPKT, 2);    
+        }
+    }
+
+    return;
+}
+
+/**
+  Write a configuration variable (cv) on the Main (operations mode
+  programming). This is very similar to the service mode programming with
+  the extension, that the decoder address is used. I.e. only the cv of
+  the selected decoder is updated not all decoders.
+  @par Input: bus_t busnumber
+              int address
+              int cv
+              int value
+              int mode 1 == short address, 2 == long (2byte) address
+  @return ack 
+*/
+int ref_protocol_nmra_sm_write_cvbyte_pom(bus_t busnumber, int address,
+                                          int cv, int value, int mode)
+{
+    char addrerrbyte[9];
+    char addrstream[BUFFERSIZE];
+    char progstream[BUFFERSIZE];
+    char bitstream[BUFFERSIZE];
+    char packetstream[PKTSIZE];
+
+    syslog_bus(busnumber, DBG_DEBUG,
+               "WR Byte command for PoM %d received addr:%d CV:%d value:%d",
+               mode, address, cv, value);
+    cv -= 1;
+    /* do not allow to change the address on the main ==> cv 1 is disabled */
+    if (address < 1 || address > 10239 || cv < 1 || cv > 1023 ||
+        value < 0 || value > 255 || (address > 127 && mode == 1))
+        return -1;
+
+    calc_address_stream(addrstream, addrerrbyte, address, mode);
+    calc_byte_program_stream(progstream, addrerrbyte, cv, value, false,
+                             true);
+    memset(bitstream, 0, BUFFERSIZE);
+    strcat(bitstream, addrstream);
+    strcat(bitstream, progstream);
+
+    int j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
+
+    if (j > 0) {
+    	send_packet(busnumber, packetstream, j, QNBLOCOPKT, 3);    
+        return value;
+    }
+    return -1;
+}
+
+/**
+  Write a single bit of a configuration variable (cv) on the Main.
+  This is very similar to the service mode programming with the extension,
+  that the decoder address is used. I.e. only the cv of the selected 
+  decoder is updated not all decoders.
+  @par Input: bus_t busnumber
+              int address
+              int cv
+              int value
+              int mode 1 == short address, 2 == long (2byte) address
+  @return ack 
+*/
+int ref_protocol_nmra_sm_write_cvbit_pom(bus_t busnumber, int address,
+                                         int cv, int bit, int value, int mode)
+{
+    char addrerrbyte[9];
+    char addrstream[BUFFERSIZE];
+    char progstream[BUFFERSIZE];
+    char bitstream[BUFFERSIZE];
+    char packetstream[PKTSIZE];
+
+    syslog_bus(busnumber, DBG_DEBUG,
+               "WR Bit command for PoM %d received addr:%d CV:%d bit:%d value:%d",
+               mode, address, cv, bit, value);
+    cv -= 1;
+    /* do not allow to change the address on the main ==> cv 1 is disabled */
+    if (address < 1 || address > 10239 || cv < 1 || cv > 1023
+        || bit < 0 || bit > 7 || value < 0 || value > 1
+        || (address > 127 && mode == 1))
+        return -1;
+
+    calc_address_stream(addrstream, addrerrbyte, address, mode);
+    calc_bit_program_stream(progstream, addrerrbyte, cv, bit, value, false,
+                            true);
+    memset(bitstream, 0, BUFFERSIZE);
+    strcat(bitstream, addrstream);
+    strcat(bitstream, progstream);
+
+    int j = translateBitstream2Packetstream(busnumber, bitstream, packetstream);
+
+    if (j > 0) {
+    	send_packet(busnumber, packetstream, j, QNBLOCOPKT, 3);    
+        return value;
+    }
+    return -1;
+}
@@ -0,0 +1,14 @@
+// nmra_ref.h - reference encoder for the basrcpd NMRA test
+
+#ifndef NMRA_REF_H
+#define NMRA_REF_H
+
+void ref_comp_nmra_multi_func(bus_t busnumber, gl_data_t *glp);
+int ref_comp_nmra_accessory(bus_t busnumber, int nr, int output, int activate,
+                            int offset);
+int ref_protocol_nmra_sm_write_cvbyte_pom(bus_t busnumber, int address,
+                                          int cv, int value, int mode);
+int ref_protocol_nmra_sm_write_cvbit_pom(bus_t busnumber, int address,
+                                         int cv, int bit, int value, int mode);
+
+#endif
@@ -0,0 +1,322 @@
+// nmratest.c - compare the NMRA packet builder with the reference encoder
+
+/*
+ * Every operations mode packet of ddl_nmra.c is built a second time by the
+ * string based reference encoder in nmra_ref.c. The packets handed to
+ * send_packet() and update_NMRAPacketPool() have to be identical byte for
+ * byte, including the unused rest of the packet buffers.
+ *
+ * usage: nmratest       compare all address, speed and function ranges
+ *        nmratest -b    packets per second of both encoders
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include "ddl.h"
+#include "ddl_nmra.h"
+#include "syslogmessage.h"
+#include "nmra_ref.h"
+
+/* enough for the speed packet, two function streams and the pool update */
+#define RECSIZE     (8 * (PKTSIZE + 16))
+#define MAXREPORT   10
+
+typedef struct {
+    unsigned char data[RECSIZE];
+    unsigned int len;
+} tRecord;
+
+static tRecord *record;         /* NULL while benchmarking */
+static unsigned long packets;
+static unsigned long calls, differences;
+
+/*** stubs for the parts of srcpd used by ddl_nmra.c ***/
+
+void syslog_bus(bus_t busnumber, int dbglevel, const char *fmt, ...)
+{
+}
+
+static void record_put(const void *data, unsigned int len)
+{
+    if (record->len + len > RECSIZE) {
+        fprintf(stderr, "nmratest: record overflow\n");
+        exit(2);
+    }
+    memcpy(record->data + record->len, data, len);
+    record->len += len;
+}
+
+void send_packet(bus_t busnumber, char *packet, int packet_size,
+                 int packet_type, int xmits)
+{
+    int hdr[4] = { 'S', packet_size, packet_type, xmits };
+
+    packets++;
+    if (record == NULL)
+        return;
+    record_put(hdr, sizeof(hdr));
+    record_put(packet, PKTSIZE);
+}
+
+void update_NMRAPacketPool(bus_t busnumber, int adr,
+                           char const *const packet, int packet_size,
+                           char const *const fx_packet, int fx_packet_size)
+{
+    int hdr[4] = { 'U', adr, packet_size, fx_packet_size };
+
+    if (record == NULL)
+        return;
+    record_put(hdr, sizeof(hdr));
+    record_put(packet, PKTSIZE);
+    record_put(fx_packet, PKTSIZE);
+}
+
+/*** comparison ***/
+
+static tRecord rec_ref, rec_new;
+
+static void start_call(void)
+{
+    rec_ref.len = 0;
+    rec_new.len = 0;
+    calls++;
+}
+
+static void finish_call(const char *what, int rc_ref, int rc_new)
+{
+    if (rc_ref == rc_new && rec_ref.len == rec_new.len &&
+        memcmp(rec_ref.data, rec_new.data, rec_ref.len) == 0)
+        return;
+    if (++differences <= MAXREPORT)
+        fprintf(stderr, "differs: %s (rc %d/%d, %u/%u bytes)\n",
+                what, rc_ref, rc_new, rec_ref.len, rec_new.len);
+}
+
+static void check_loco(int mode, int addr, int dir, int speed, int nfs,
+                       int nfunc, uint32_t funcs, int emergency)
+{
+    gl_data_t gl_ref, gl_new;
+    char what[120];
+
+    memset(&gl_ref, 0, sizeof(gl_ref));
+    gl_ref.protocolversion = mode;
+    gl_ref.id = addr;
+    gl_ref.direction = dir;
+    gl_ref.cacheddirection = !dir;
+    gl_ref.speed = speed;
+    gl_ref.n_fs = nfs;
+    gl_ref.n_func = nfunc;
+    gl_ref.funcs = funcs;
+    gl_ref.speedchange = SCSPEED | SCDIREC | (emergency ? SCEMERG : 0);
+    gl_new = gl_ref;
+
+    start_call();
+    record = &rec_ref;
+    ref_comp_nmra_multi_func(0, &gl_ref);
+    record = &rec_new;
+    comp_nmra_multi_func(0, &gl_new);
+    snprintf(what, sizeof(what),
+             "GL N%d %d dir %d speed %d/%d funcs %d 0x%08x%s",
+             mode, addr, dir, speed, nfs, nfunc, funcs,
+             emergency ? " emergency" : "");
+    finish_call(what, gl_ref.speedchange, gl_new.speedchange);
+}
+
+static void check_accessory(int nr, int output, int activate, int offset)
+{
+    char what[80];
+    int rc_ref, rc_new;
+
+    start_call();
+    record = &rec_ref;
+    rc_ref = ref_comp_nmra_accessory(0, nr, output, activate, offset);
+    record = &rec_new;
+    rc_new = comp_nmra_accessory(0, nr, output, activate, offset);
+    snprintf(what, sizeof(what), "GA %d output %d activate %d offset %d",
+             nr, output, activate, offset);
+    finish_call(what, rc_ref, rc_new);
+}
+
+static void check_pom(int mode, int addr, int cv, int bit, int value)
+{
+    char what[80];
+    int rc_ref, rc_new;
+
+    start_call();
+    record = &rec_ref;
+    if (bit < 0)
+        rc_ref = ref_protocol_nmra_sm_write_cvbyte_pom(0, addr, cv, value, mode);
+    else
+        rc_ref = ref_protocol_nmra_sm_write_cvbit_pom(0, addr, cv, bit, value,
+                                                      mode);
+    record = &rec_new;
+    if (bit < 0)
+        rc_new = protocol_nmra_sm_write_cvbyte_pom(0, addr, cv, value, mode);
+    else
+        rc_new = protocol_nmra_sm_write_cvbit_pom(0, addr, cv, bit, value,
+                                                  mode);
+    snprintf(what, sizeof(what), "PoM N%d %d cv %d bit %d value %d",
+             mode, addr, cv, bit, value);
+    finish_call(what, rc_ref, rc_new);
+}
+
+static const int speedsteps[] = { 14, 28, 128 };
+#define NSPEEDSTEPS (sizeof(speedsteps) / sizeof(speedsteps[0]))
+
+/* address limits and some out of range values for both address modes */
+static const int sample_addr[] = { 0, 1, 3, 100, 127, 128, 1000, 10239, 10240 };
+#define NSAMPLEADDR (sizeof(sample_addr) / sizeof(sample_addr[0]))
+
+static void compare_all(void)
+{
+    int mode, addr, dir, s, i, nf, f, nr, out, act, off, cv, bit, v;
+    uint32_t funcs;
+
+    /* every address with every speed step mode */
+    for (mode = 1; mode <= 2; mode++)
+        for (addr = 0; addr <= 10240; addr++)
+            for (s = 0; s < NSPEEDSTEPS; s++) {
+                funcs = addr * 2654435761u;
+                check_loco(mode, addr, addr & 1, (addr % speedsteps[s]) + 1,
+                           speedsteps[s], 28, funcs, 0);
+                check_loco(mode, addr, addr & 1, 0, speedsteps[s],
+                           addr % 29, funcs, 0);
+            }
+
+    /* every speed and direction, with and without emergency stop */
+    for (mode = 1; mode <= 2; mode++)
+        for (i = 0; i < NSAMPLEADDR; i++)
+            for (s = 0; s < NSPEEDSTEPS; s++)
+                for (v = -1; v <= speedsteps[s] + 2; v++)
+                    for (dir = -1; dir <= 2; dir++) {
+                        check_loco(mode, sample_addr[i], dir, v,
+                                   speedsteps[s], 28, 0x15555555, 0);
+                        check_loco(mode, sample_addr[i], dir, v,
+                                   speedsteps[s], 5, 0, 1);
+                    }
+
+    /* every number of functions with every single function on, all on
+       and all off */
+    for (mode = 1; mode <= 2; mode++)
+        for (i = 0; i < NSAMPLEADDR; i++)
+            for (s = 0; s < NSPEEDSTEPS; s++)
+                for (nf = 0; nf <= 28; nf++) {
+                    for (f = 0; f <= 28; f++)
+                        check_loco(mode, sample_addr[i], 1, 7, speedsteps[s],
+                                   nf, 1u << f, 0);
+                    check_loco(mode, sample_addr[i], 0, 7, speedsteps[s],
+                               nf, 0x1fffffff, 0);
+                    check_loco(mode, sample_addr[i], 0, 7, speedsteps[s],
+                               nf, 0, 0);
+                }
+
+    /* every accessory output */
+    for (nr = -1; nr <= 2045; nr++)
+        for (out = 0; out <= 1; out++)
+            for (act = 0; act <= 1; act++)
+                for (off = 0; off <= 1; off++)
+                    check_accessory(nr, out, act, off);
+    check_accessory(1, 2, 1, 0);
+    check_accessory(1, 0, 2, 0);
+
+    /* every cv and bit with programming on main */
+    for (mode = 1; mode <= 2; mode++)
+        for (i = 0; i < NSAMPLEADDR; i++) {
+            for (cv = 0; cv <= 1025; cv++) {
+                check_pom(mode, sample_addr[i], cv, -1, cv & 0xff);
+                for (bit = 0; bit <= 7; bit++)
+                    check_pom(mode, sample_addr[i], cv, bit, (cv >> bit) & 1);
+            }
+            for (v = -1; v <= 256; v++)
+                check_pom(mode, sample_addr[i], 29, -1, v);
+            check_pom(mode, sample_addr[i], 29, 8, 1);
+            check_pom(mode, sample_addr[i], 29, 3, 2);
+        }
+}
+
+/*** benchmark ***/
+
+static double seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void bench_loco(const char *name, void (*multi_func)(bus_t, gl_data_t *),
+                       int n)
+{
+    gl_data_t gl;
+    double start;
+    int i;
+
+    packets = 0;
+    start = seconds();
+    for (i = 0; i < n; i++) {
+        memset(&gl, 0, sizeof(gl));
+        gl.protocolversion = 1 + (i & 1);
+        gl.id = 1 + (i % 127);
+        gl.direction = i & 1;
+        gl.speed = i % 120;
+        gl.n_fs = 128;
+        gl.n_func = 28;
+        gl.funcs = i * 2654435761u;
+        multi_func(0, &gl);
+    }
+    printf("%-10s loco F0-F28: %10.0f packets/s\n", name,
+           packets / (seconds() - start));
+}
+
+static void bench_accessory(const char *name,
+                            int (*accessory)(bus_t, int, int, int, int), int n)
+{
+    double start;
+    int i;
+
+    packets = 0;
+    start = seconds();
+    for (i = 0; i < n; i++)
+        accessory(0, 1 + (i % 2044), i & 1, (i >> 1) & 1, 0);
+    printf("%-10s accessory:   %10.0f packets/s\n", name,
+           packets / (seconds() - start));
+}
+
+static void bench_pom(const char *name,
+                      int (*pom)(bus_t, int, int, int, int), int n)
+{
+    double start;
+    int i;
+
+    packets = 0;
+    start = seconds();
+    for (i = 0; i < n; i++)
+        pom(0, 1 + (i % 10239), 2 + (i % 1000), i & 0xff, 2);
+    printf("%-10s PoM:         %10.0f packets/s\n", name,
+           packets / (seconds() - start));
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        record = NULL;
+        bench_loco("reference", ref_comp_nmra_multi_func, 200000);
+        bench_loco("ddl_nmra", comp_nmra_multi_func, 2000000);
+        bench_accessory("reference", ref_comp_nmra_accessory, 500000);
+        bench_accessory("ddl_nmra", comp_nmra_accessory, 5000000);
+        bench_pom("reference", ref_protocol_nmra_sm_write_cvbyte_pom, 500000);
+        bench_pom("ddl_nmra", protocol_nmra_sm_write_cvbyte_pom, 5000000);
+        return 0;
+    }
+    if (argc > 1) {
+        fprintf(stderr, "usage: %s [-b]\n", argv[0]);
+        return 2;
+    }
+    compare_all();
+    printf("nmratest: %lu calls, %lu differences\n", calls, differences);
+    return differences ? 1 : 0;
+}
@@ -0,0 +1,207 @@
+// srcpbench.c - SRCP commands per second of a running srcpd over loopback
+
+/*
+ * The client connects to srcpd on 127.0.0.1, switches the session into the
+ * command mode and sends "SET 1 GL" commands to a loco of the loopback bus.
+ * Every command has to be answered by "200 OK" before it is counted. Up to
+ * <inflight> commands are sent ahead of the answers, so with more than one
+ * command in flight several lines arrive with one read() in socket_readline.
+ *
+ * usage: srcpbench [-p port] [-n commands] [inflight ...]
+ *
+ * Without inflight the benchmark runs with 1 and 50 commands in flight.
+ * srcpd has to be started with test/srcpbench.conf, "make bench" does so.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#define DEFAULT_PORT        14303
+#define DEFAULT_COMMANDS    20000
+#define MAXINFLIGHT         1000
+#define MAXLINE             1024
+#define CONNECT_TRIES       50
+
+/* answers are read through a buffer, as the server does it */
+static char inbuf[65536];
+static int inpos, infill;
+
+static double seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int readline(int s, char *line, int len)
+{
+    int i = 0;
+    char c;
+
+    do {
+        if (inpos >= infill) {
+            infill = read(s, inbuf, sizeof(inbuf));
+            inpos = 0;
+            if (infill <= 0)
+                return -1;
+        }
+        c = inbuf[inpos++];
+        if (i < len - 1)
+            line[i++] = c;
+    } while (c != '\n');
+    line[i] = 0;
+    return i;
+}
+
+static int writeall(int s, const char *data, int len)
+{
+    ssize_t n;
+
+    while (len > 0) {
+        n = write(s, data, len);
+        if (n <= 0)
+            return -1;
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* send one handshake or setup line and expect a positive answer */
+static int request(int s, const char *cmd)
+{
+    char line[MAXLINE];
+
+    if (writeall(s, cmd, strlen(cmd)) < 0 ||
+        readline(s, line, sizeof(line)) < 0)
+        return -1;
+    if (strstr(line, " 20") == NULL) {
+        fprintf(stderr, "srcpbench: %s -> %s", cmd, line);
+        return -1;
+    }
+    return 0;
+}
+
+static int session(int port)
+{
+    struct sockaddr_in addr;
+    char line[MAXLINE];
+    int s, one = 1, tries;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    /* srcpd may still be starting up */
+    for (tries = 0;; tries++) {
+        s = socket(AF_INET, SOCK_STREAM, 0);
+        if (s < 0) {
+            perror("srcpbench: socket");
+            return -1;
+        }
+        if (connect(s, (struct sockaddr *) &addr, sizeof(addr)) == 0)
+            break;
+        close(s);
+        if (tries == CONNECT_TRIES) {
+            perror("srcpbench: connect");
+            return -1;
+        }
+        usleep(100000);
+    }
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    inpos = infill = 0;
+
+    /* welcome message */
+    if (readline(s, line, sizeof(line)) < 0 ||
+        request(s, "SET PROTOCOL SRCP 0.8\n") < 0 ||
+        request(s, "SET CONNECTIONMODE SRCP COMMAND\n") < 0 ||
+        request(s, "GO\n") < 0 ||
+        request(s, "INIT 1 GL 3 N 1 28 5\n") < 0) {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+static int bench(int s, int n, int inflight)
+{
+    char batch[MAXINFLIGHT * 40], line[MAXLINE];
+    int sent = 0, answered = 0, len;
+    double start;
+
+    start = seconds();
+    while (answered < n) {
+        len = 0;
+        while (sent < n && sent - answered < inflight) {
+            len += sprintf(batch + len, "SET 1 GL 3 1 %d 100 0 0 0 0 0\n",
+                           sent % 100);
+            sent++;
+        }
+        if (len > 0 && writeall(s, batch, len) < 0) {
+            perror("srcpbench: write");
+            return -1;
+        }
+        if (readline(s, line, sizeof(line)) < 0) {
+            fprintf(stderr, "srcpbench: closed after %d answers\n", answered);
+            return -1;
+        }
+        if (strstr(line, " 200 OK") == NULL) {
+            fprintf(stderr, "srcpbench: answer %s", line);
+            return -1;
+        }
+        answered++;
+    }
+    printf("%4d in flight: %10.0f commands/s\n", inflight,
+           n / (seconds() - start));
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int port = DEFAULT_PORT, n = DEFAULT_COMMANDS, inflight;
+    int s, c, result = 0;
+
+    while ((c = getopt(argc, argv, "p:n:")) != -1) {
+        switch (c) {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'n':
+                n = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr,
+                        "usage: %s [-p port] [-n commands] [inflight ...]\n",
+                        argv[0]);
+                return 2;
+        }
+    }
+
+    for (c = optind; c < argc; c++) {
+        inflight = atoi(argv[c]);
+        if (inflight < 1 || inflight > MAXINFLIGHT) {
+            fprintf(stderr, "srcpbench: 1 to %d commands in flight\n",
+                    MAXINFLIGHT);
+            return 2;
+        }
+    }
+
+    s = session(port);
+    if (s < 0)
+        return 1;
+    if (optind == argc)
+        result = bench(s, n, 1) < 0 || bench(s, n, 50) < 0;
+    for (c = optind; c < argc && result == 0; c++)
+        result = bench(s, n, atoi(argv[c])) < 0;
+    close(s);
+    return result;
+}
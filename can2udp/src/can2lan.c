@@ -10,6 +10,7 @@
 /* Thanks to Stefan Krauss and the SocketCAN team
  */
 
+#define _GNU_SOURCE
 #include "can2lan.h"
 
 static char *CAN_FORMAT_STRG      = "      CAN->   0x%08X R [%d]";
@@ -76,6 +77,9 @@ unsigned char ec_frame[13];
 
 struct filter_t filter[2];
 
+int epoll_fd;
+struct tcp_client_t tcp_client[MAX_TCP_CONN];
+
 void signal_handler(int sig) {
     syslog(LOG_WARNING, "got signal %s\n", strsignal(sig));
     do_loop = 0;
@@ -136,6 +140,203 @@ int send_can_ping(int can_socket, int verbose) {
     return 0;
 }
 
+struct tcp_client_t *search_tcp_client(int fd) {
+    int i;
+
+    if (fd <= 0)
+	return NULL;
+    for (i = 0; i < MAX_TCP_CONN; i++) {
+	if (tcp_client[i].fd == fd)
+	    return &tcp_client[i];
+    }
+    return NULL;
+}
+
+void close_tcp_client(struct tcp_client_t *client) {
+    char buffer[64];
+
+    syslog(LOG_NOTICE, "%s: closing client %s conn fd: %d\n", __func__,
+	   inet_ntop(AF_INET, &client->addr.sin_addr, buffer, sizeof(buffer)), client->fd);
+    /* close removes the socket from the epoll set */
+    close(client->fd);
+    free(client->out);
+    client->fd = -1;
+    client->out = NULL;
+    client->head = 0;
+    client->length = 0;
+    client->want_write = 0;
+}
+
+/* append data to the output ring buffer - caller checks the free space */
+static void tcp_queue(struct tcp_client_t *client, unsigned char *data, unsigned int length) {
+    unsigned int pos, first;
+
+    pos = (client->head + client->length) & (TCP_OUT_BUFFER_SIZE - 1);
+    first = MIN(length, TCP_OUT_BUFFER_SIZE - pos);
+    memcpy(&client->out[pos], data, first);
+    memcpy(client->out, &data[first], length - first);
+    client->length += length;
+}
+
+/* write as much as the socket takes, the rest waits for EPOLLOUT */
+static int tcp_flush(struct tcp_client_t *client) {
+    struct iovec iov[2];
+    struct epoll_event ev;
+    unsigned int first;
+    int want_write;
+    ssize_t s;
+
+    while (client->length) {
+	first = MIN(client->length, TCP_OUT_BUFFER_SIZE - client->head);
+	iov[0].iov_base = &client->out[client->head];
+	iov[0].iov_len = first;
+	iov[1].iov_base = client->out;
+	iov[1].iov_len = client->length - first;
+	s = writev(client->fd, iov, iov[1].iov_len ? 2 : 1);
+	if (s < 0) {
+	    if (errno == EINTR)
+		continue;
+	    if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+		break;
+	    return -1;
+	}
+	client->head = (client->head + s) & (TCP_OUT_BUFFER_SIZE - 1);
+	client->length -= s;
+    }
+    if (client->length == 0)
+	client->head = 0;
+
+    want_write = client->length > 0;
+    if (want_write != client->want_write) {
+	ev.events = want_write ? EPOLLIN | EPOLLOUT : EPOLLIN;
+	ev.data.fd = client->fd;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client->fd, &ev) < 0)
+	    return -1;
+	client->want_write = want_write;
+    }
+    return 0;
+}
+
+/* send data to one TCP client without blocking the relay */
+int tcp_client_send(int fd, unsigned char *data, int length) {
+    struct tcp_client_t *client;
+    unsigned int n;
+
+    client = search_tcp_client(fd);
+    if (client == NULL)
+	return -1;
+    while (length > 0) {
+	n = MIN((unsigned int)length, TCP_OUT_BUFFER_SIZE - client->length);
+	if (n == 0) {
+	    /* a stalled client must not stop the others */
+	    syslog(LOG_WARNING, "%s: TCP client fd %d doesn't read - closing\n", __func__, fd);
+	    close_tcp_client(client);
+	    return -1;
+	}
+	tcp_queue(client, data, n);
+	data += n;
+	length -= n;
+	if (tcp_flush(client) < 0) {
+	    fprint_syslog_wc(stderr, LOG_ERR, "error sending TCP data:", strerror(errno));
+	    close_tcp_client(client);
+	    return -1;
+	}
+    }
+    return 0;
+}
+
+/* queue a frame for all TCP clients - tcp_flush_all() sends them */
+void tcp_broadcast(unsigned char *data, int length) {
+    struct tcp_client_t *client;
+    int i;
+
+    for (i = 0; i < MAX_TCP_CONN; i++) {
+	client = &tcp_client[i];
+	if (client->fd < 0)
+	    continue;
+	if (TCP_OUT_BUFFER_SIZE - client->length < (unsigned int)length) {
+	    if (client->want_write || (tcp_flush(client) < 0) ||
+		(TCP_OUT_BUFFER_SIZE - client->length < (unsigned int)length)) {
+		syslog(LOG_WARNING, "%s: TCP client fd %d doesn't read - closing\n", __func__, client->fd);
+		close_tcp_client(client);
+		continue;
+	    }
+	}
+	tcp_queue(client, data, length);
+    }
+}
+
+void tcp_flush_all(void) {
+    int i;
+
+    for (i = 0; i < MAX_TCP_CONN; i++) {
+	/* clients waiting for EPOLLOUT are flushed when writable */
+	if ((tcp_client[i].fd < 0) || !tcp_client[i].length || tcp_client[i].want_write)
+	    continue;
+	if (tcp_flush(&tcp_client[i]) < 0) {
+	    fprint_syslog_wc(stderr, LOG_ERR, "error sending TCP data:", strerror(errno));
+	    close_tcp_client(&tcp_client[i]);
+	}
+    }
+}
+
+int add_tcp_client(int listen_socket, int verbose) {
+    struct tcp_client_t *client;
+    struct sockaddr_in addr;
+    socklen_t addr_length = sizeof(addr);
+    struct epoll_event ev;
+    char buffer[64];
+    const int on = 1;
+    int conn_fd, i;
+
+    conn_fd = accept(listen_socket, (struct sockaddr *)&addr, &addr_length);
+    if (conn_fd < 0) {
+	fprint_syslog_wc(stderr, LOG_ERR, "accept error:", strerror(errno));
+	return -1;
+    }
+    if (verbose)
+	printf("new client: %s, port %d conn fd: %d\n", inet_ntop(AF_INET, &addr.sin_addr, buffer, sizeof(buffer)),
+	       ntohs(addr.sin_port), conn_fd);
+    syslog(LOG_NOTICE, "%s: new client: %s port %d conn fd: %d\n", __func__,
+	   inet_ntop(AF_INET, &addr.sin_addr, buffer, sizeof(buffer)), ntohs(addr.sin_port), conn_fd);
+
+    for (i = 0; i < MAX_TCP_CONN; i++) {
+	if (tcp_client[i].fd < 0)
+	    break;
+    }
+    if (i == MAX_TCP_CONN) {
+	fprintf(stderr, "too many TCP clients\n");
+	syslog(LOG_ERR, "%s: too many TCP clients\n", __func__);
+	close(conn_fd);
+	return -1;
+    }
+    client = &tcp_client[i];
+    client->out = malloc(TCP_OUT_BUFFER_SIZE);
+    if (client->out == NULL) {
+	fprint_syslog_wc(stderr, LOG_ERR, "can't alloc TCP output buffer:", strerror(errno));
+	close(conn_fd);
+	return -1;
+    }
+    /* the relay coalesces the frames itself - disable Nagle */
+    fcntl(conn_fd, F_SETFL, fcntl(conn_fd, F_GETFL) | O_NONBLOCK);
+    setsockopt(conn_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    ev.events = EPOLLIN;
+    ev.data.fd = conn_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn_fd, &ev) < 0) {
+	fprint_syslog_wc(stderr, LOG_ERR, "can't add TCP client to epoll:", strerror(errno));
+	free(client->out);
+	client->out = NULL;
+	close(conn_fd);
+	return -1;
+    }
+    client->fd = conn_fd;
+    client->addr = addr;
+    client->head = 0;
+    client->length = 0;
+    client->want_write = 0;
+    return conn_fd;
+}
+
 int copy_cs2_config(struct cs2_config_data_t *cs2_config_data) {
     char *ptr;
     unsigned char newframe[CAN_ENCAP_SIZE];
@@ -161,7 +362,7 @@ int copy_cs2_config(struct cs2_config_data_t *cs2_config_data) {
 
 	if (cs2_config_data->verbose)
 	    printf("send to CAN member ...\n");
-	net_to_net(cs2_config_data->cs2_tcp_socket, NULL, newframe, CAN_ENCAP_SIZE);
+	tcp_client_send(cs2_config_data->cs2_tcp_socket, newframe, CAN_ENCAP_SIZE);
 	/* done - don't copy again */
 	cs2_config_data->cs2_config_copy = 0;
 	cs2_config_data->state = CS2_STATE_NORMAL_CONFIG;
@@ -263,7 +464,7 @@ int check_data(int tcp_socket, struct cs2_config_data_t *cs2_config_data, unsign
 	    netframe[4]  = 7;
 	    netframe[10] = 0xff;
 	    netframe[11] = 0xff;
-	    net_to_net(tcp_socket, NULL, netframe, CAN_ENCAP_SIZE);
+	    tcp_client_send(tcp_socket, netframe, CAN_ENCAP_SIZE);
 	    if (cs2_config_data->verbose)
 		printf("got CAN device registration\n");
 	}
@@ -273,7 +474,7 @@ int check_data(int tcp_socket, struct cs2_config_data_t *cs2_config_data, unsign
 	    if (cs2_config_data->verbose)
 		printf("                received CAN ping\n");
 	    memcpy(netframe, M_CAN_PING_CS2_3, 13);
-	    if (net_to_net(tcp_socket, NULL, netframe, CAN_ENCAP_SIZE)) {
+	    if (tcp_client_send(tcp_socket, netframe, CAN_ENCAP_SIZE)) {
 		fprint_syslog_wc(stderr, LOG_ERR, "sending TCP data (CAN Ping member) error:", strerror(errno));
 	    } else {
 		print_can_frame(NET_TCP_FORMAT_STRG, netframe, cs2_config_data->verbose);
@@ -304,7 +505,7 @@ int check_data(int tcp_socket, struct cs2_config_data_t *cs2_config_data, unsign
 	    netframe[1] |= 1;
 	    netframe[4] = 4;
 	    strcpy((char *)&netframe[5], "copy");
-	    net_to_net(tcp_socket, NULL, netframe, CAN_ENCAP_SIZE);
+	    tcp_client_send(tcp_socket, netframe, CAN_ENCAP_SIZE);
 	    if (cs2_config_data->verbose)
 		printf("CAN member copy request\n");
 	    syslog(LOG_NOTICE, "%s: CAN member copy request\n", __func__);
@@ -316,7 +517,7 @@ int check_data(int tcp_socket, struct cs2_config_data_t *cs2_config_data, unsign
 	    if (cs2_config_data->verbose)
 		printf("%s ID 0x%08x %s\n", __func__, canid, (char *)&netframe[5]);
 	    netframe[1] |= 1;
-	    net_to_net(tcp_socket, NULL, netframe, CAN_ENCAP_SIZE);
+	    tcp_client_send(tcp_socket, netframe, CAN_ENCAP_SIZE);
 	    if (strcmp("loks", config_name) == 0) {
 		ret = 1;
 		syslog(LOG_NOTICE, "%s: sending lokomotive.cs2\n", __func__);
@@ -413,22 +614,25 @@ int check_data(int tcp_socket, struct cs2_config_data_t *cs2_config_data, unsign
 }
 
 int main(int argc, char **argv) {
-    int n, i, max_fds, opt, max_tcp_i, nready, conn_fd, timeout, ret, tcp_client[MAX_TCP_CONN];
+    int n, i, j, opt, nready, fd, timeout, ret;
     struct sigaction sigact;
     sigset_t blockset, emptyset;
-    struct can_frame frame;
+    struct epoll_event ev, events[MAX_EVENTS];
+    struct tcp_client_t *client;
+    /* batched CAN reading and UDP sending */
+    struct can_frame can_frames[CAN_RECV_BATCH];
+    struct iovec can_iov[CAN_RECV_BATCH], udp_iov[CAN_RECV_BATCH];
+    struct mmsghdr can_msgs[CAN_RECV_BATCH], udp_msgs[CAN_RECV_BATCH];
+    unsigned char udp_frames[CAN_RECV_BATCH][CAN_ENCAP_SIZE];
     char timestamp[16];
     /* UDP incoming socket, CAN socket, UDP broadcast socket, TCP socket */
-    int sa, sc, sb, st, st2, tcp_socket;
+    int sa, sc, sb, st, st2;
     struct sockaddr_in saddr, baddr, tcp_addr, tcp_addr2;
     /* vars for determing broadcast address */
     struct sockaddr_can caddr;
     struct ifreq ifr;
     socklen_t caddrlen = sizeof(caddr);
-    socklen_t tcp_client_length = sizeof(tcp_addr);
-    fd_set all_fds, read_fds;
     int s = 0;
-    struct timespec ts;
     char *udp_dst_address;
     char *bcast_interface;
     char *searchif;
@@ -683,9 +887,8 @@ int main(int argc, char **argv) {
 	exit(EXIT_FAILURE);
     }
     /* prepare TCP clients array */
-    max_tcp_i = -1;		/* index into tcp_client[] array */
     for (i = 0; i < MAX_TCP_CONN; i++)
-	tcp_client[i] = -1;	/* -1 indicates available entry */
+	tcp_client[i].fd = -1;	/* -1 indicates available entry */
 
     /* prepare second TCP socket */
     st2 = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
@@ -704,13 +907,6 @@ int main(int argc, char **argv) {
 	fprintf(stderr, "starting TCP listener error: %s\n", strerror(errno));
 	exit(EXIT_FAILURE);
     }
-#if 0
-    /* prepare TCP clients array */
-    max_tcp_i = -1;		/* index into tcp_client[] array */
-    for (i = 0; i < MAX_TCP_CONN; i++)
-	tcp_client[i] = -1;	/* -1 indicates available entry */
-#endif
-
     /* prepare CAN socket */
     memset(&caddr, 0, sizeof(caddr));
     sc = socket(PF_CAN, SOCK_RAW, CAN_RAW);
@@ -777,24 +973,43 @@ int main(int argc, char **argv) {
     sigaction(SIGTERM, &sigact, NULL);
     sigemptyset(&emptyset);
 
-    /* set select timeout -> send periodic CAN Ping */
-    ts.tv_sec = 1;
-    ts.tv_nsec = 0;
-
-    FD_ZERO(&all_fds);
-    FD_SET(sc, &all_fds);
-    FD_SET(sa, &all_fds);
-    FD_SET(st, &all_fds);
-    FD_SET(st2, &all_fds);
-    max_fds = MAX(MAX(MAX(sc, sa), st), st2);
+    /* prepare epoll set: CAN, UDP and the two TCP listeners */
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+	fprint_syslog_wc(stderr, LOG_ERR, "creating epoll error:", strerror(errno));
+	exit(EXIT_FAILURE);
+    }
+    ev.events = EPOLLIN;
+    ev.data.fd = sc;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sc, &ev);
+    ev.data.fd = sa;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sa, &ev);
+    ev.data.fd = st;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, st, &ev);
+    ev.data.fd = st2;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, st2, &ev);
+
+    /* the receive and send vectors point to fixed buffers */
+    memset(can_msgs, 0, sizeof(can_msgs));
+    memset(udp_msgs, 0, sizeof(udp_msgs));
+    for (i = 0; i < CAN_RECV_BATCH; i++) {
+	can_iov[i].iov_base = &can_frames[i];
+	can_iov[i].iov_len = sizeof(struct can_frame);
+	can_msgs[i].msg_hdr.msg_iov = &can_iov[i];
+	can_msgs[i].msg_hdr.msg_iovlen = 1;
+	udp_iov[i].iov_base = udp_frames[i];
+	udp_iov[i].iov_len = CAN_ENCAP_SIZE;
+	udp_msgs[i].msg_hdr.msg_iov = &udp_iov[i];
+	udp_msgs[i].msg_hdr.msg_iovlen = 1;
+	udp_msgs[i].msg_hdr.msg_name = &baddr;
+	udp_msgs[i].msg_hdr.msg_namelen = sizeof(baddr);
+    }
 
     while (do_loop) {
-	read_fds = all_fds;
-	nready = pselect(max_fds + 1, &read_fds, NULL, NULL, &ts, &emptyset);
+	/* timeout 1 sec -> send periodic CAN Ping */
+	nready = epoll_pwait(epoll_fd, events, MAX_EVENTS, 1000, &emptyset);
 	if (nready == 0) {
 	    /* send periodic ping */
-	    ts.tv_sec = 1;
-	    ts.tv_nsec = 0;
 	    if (cs2fake_ping)
 		cs2ping_timer++;
 	    if (cs2ping_timer >= PING_TIME) {
@@ -803,139 +1018,110 @@ int main(int argc, char **argv) {
 		if (frame_to_can(sc, M_CAN_PING) < 0) {
 		    fprint_syslog(stderr, LOG_ERR, "can't send CAN ping");
 		}
-		for (i = 0; i <= max_tcp_i; i++) {	/* check all clients for data */
-		    tcp_socket = tcp_client[i];
-		    if (tcp_socket <= 0)
-			continue;
-		    net_to_net(tcp_socket, NULL, M_CAN_PING, CAN_ENCAP_SIZE);
-		    print_can_frame(CAN_TCP_FORMAT_STRG, M_CAN_PING, cs2_config_data.verbose && !background);
-		}
+		tcp_broadcast(M_CAN_PING, CAN_ENCAP_SIZE);
+		tcp_flush_all();
+		print_can_frame(CAN_TCP_FORMAT_STRG, M_CAN_PING, cs2_config_data.verbose && !background);
 	    }
 	    continue;
 	} else if (nready < 0) {
+	    if (errno == EINTR)
+		continue;
 	    if (!background)
-		fprintf(stderr, "select exception: [%d] %s\n", nready, strerror(errno));
-	    syslog(LOG_WARNING, "select exception: [%d] %s\n", nready, strerror(errno));
+		fprintf(stderr, "epoll exception: [%d] %s\n", nready, strerror(errno));
+	    syslog(LOG_WARNING, "epoll exception: [%d] %s\n", nready, strerror(errno));
 	    continue;
 	}
 
-	/* received a CAN frame */
-	if (FD_ISSET(sc, &read_fds)) {
-	    /* reading via SockatCAN */
-	    if (read(sc, &frame, sizeof(struct can_frame)) < 0) {
-		fprintf(stderr, "reading CAN frame error: %s\n", strerror(errno));
-		syslog(LOG_ERR, "%s: reading CAN frame error: %s\n", __func__, strerror(errno));
-	    }
-	    /* if CAN Frame is EFF do it */
-	    if (frame.can_id & CAN_EFF_FLAG) {	/* only EFF frames are valid */
-		/* send UDP frame */
-		frame_to_net(sb, (struct sockaddr *)&baddr, (struct can_frame *)&frame);
-		print_can_frame(UDP_FORMAT_STRG, netframe, cs2_config_data.verbose && !background);
-		/* send CAN frame to all connected TCP clients */
-		/* TODO: need all clients the packets ? */
-		for (i = 0; i <= max_tcp_i; i++) {	/* check all clients for data */
-		    tcp_socket = tcp_client[i];
-		    if (tcp_socket < 0)
+	for (i = 0; i < nready; i++) {
+	    fd = events[i].data.fd;
+	    /* received CAN frames */
+	    if (fd == sc) {
+		/* reading via SocketCAN - as many frames as are waiting */
+		n = recvmmsg(sc, can_msgs, CAN_RECV_BATCH, MSG_DONTWAIT, NULL);
+		if (n < 0) {
+		    fprintf(stderr, "reading CAN frame error: %s\n", strerror(errno));
+		    syslog(LOG_ERR, "%s: reading CAN frame error: %s\n", __func__, strerror(errno));
+		    continue;
+		}
+		ret = 0;
+		for (j = 0; j < n; j++) {
+		    /* if CAN Frame is EFF do it */
+		    if (!(can_frames[j].can_id & CAN_EFF_FLAG))	/* only EFF frames are valid */
+			continue;
+		    if (!can_to_netframe(&can_frames[j], udp_frames[ret]))
 			continue;
-		    frame_to_net(tcp_socket, (struct sockaddr *)&tcp_addr, (struct can_frame *)&frame);
-		    print_can_frame(CAN_TCP_FORMAT_STRG, netframe, cs2_config_data.verbose && !background);
+		    print_can_frame(UDP_FORMAT_STRG, udp_frames[ret], cs2_config_data.verbose && !background);
+		    /* queue CAN frame for all connected TCP clients */
+		    /* TODO: need all clients the packets ? */
+		    tcp_broadcast(udp_frames[ret], CAN_ENCAP_SIZE);
+		    print_can_frame(CAN_TCP_FORMAT_STRG, udp_frames[ret], cs2_config_data.verbose && !background);
+		    ret++;
 		}
+		/* send UDP frames */
+		if ((ret > 0) && (sendmmsg(sb, udp_msgs, ret, 0) != ret))
+		    fprint_syslog_wc(stderr, LOG_ERR, "error sending UDP data:", strerror(errno));
 	    }
-	}
-	/* received a UDP packet */
-	if (FD_ISSET(sa, &read_fds)) {
-	    if (read(sa, netframe, MAXDG) == CAN_ENCAP_SIZE) {
-		/* check for S88 events on send them to TCP connected clients */
-		memcpy(&canid, netframe, 4);
-		canid = ntohl(canid);
-		if ((canid & 0x00230000) == 0x00230000) {
-		    for (i = 0; i <= max_tcp_i; i++) {
-			tcp_socket = tcp_client[i];
-			if (tcp_socket < 0)
-			    continue;
-			net_to_net(tcp_socket, NULL, netframe, CAN_ENCAP_SIZE);
+	    /* received a UDP packet */
+	    else if (fd == sa) {
+		if (read(sa, netframe, MAXDG) == CAN_ENCAP_SIZE) {
+		    /* check for S88 events on send them to TCP connected clients */
+		    memcpy(&canid, netframe, 4);
+		    canid = ntohl(canid);
+		    if ((canid & 0x00230000) == 0x00230000) {
+			tcp_broadcast(netframe, CAN_ENCAP_SIZE);
 			print_can_frame(UDP_TCP_FORMAT_STRG, netframe, cs2_config_data.verbose && !background);
+			net_to_net(sb, (struct sockaddr *)&baddr, netframe, CAN_ENCAP_SIZE);
+			print_can_frame(UDP_UDP_FORMAT_STRG, netframe, cs2_config_data.verbose && !background);
+		    } else {
+		    /* send packet on CAN */
+			ret = frame_to_can(sc, netframe);
+			print_can_frame(NET_UDP_FORMAT_STRG, netframe, cs2_config_data.verbose && !background);
+			check_data_udp(sb, (struct sockaddr *)&baddr, &cs2_config_data, netframe);
 		    }
-		    net_to_net(sb, (struct sockaddr *)&baddr, netframe, CAN_ENCAP_SIZE);
-		    print_can_frame(UDP_UDP_FORMAT_STRG, netframe, cs2_config_data.verbose && !background);
-		} else {
-		/* send packet on CAN */
-		    ret = frame_to_can(sc, netframe);
-		    print_can_frame(NET_UDP_FORMAT_STRG, netframe, cs2_config_data.verbose && !background);
-		    check_data_udp(sb, (struct sockaddr *)&baddr, &cs2_config_data, netframe);
 		}
 	    }
-	}
-	/* received a TCP packet */
-	if (FD_ISSET(st, &read_fds)) {
-	    conn_fd = accept(st, (struct sockaddr *)&tcp_addr, &tcp_client_length);
-	    if (cs2_config_data.verbose && !background) {
-		printf("new client: %s, port %d conn fd: %d max fds: %d\n", inet_ntop(AF_INET, &(tcp_addr.sin_addr),
-			buffer, sizeof(buffer)), ntohs(tcp_addr.sin_port), conn_fd, max_fds);
+	    /* new TCP connection on one of the TCP ports */
+	    else if ((fd == st) || (fd == st2)) {
+		fd = add_tcp_client(fd, cs2_config_data.verbose && !background);
+		if (fd < 0)
+		    continue;
+		/* send embedded CAN ping */
+		memcpy(netframe, M_CAN_PING, CAN_ENCAP_SIZE);
+		tcp_client_send(fd, netframe, CAN_ENCAP_SIZE);
+		if (cs2_config_data.verbose && !background)
+		    printf("send embedded CAN ping\n");
 	    }
-	    syslog(LOG_NOTICE, "%s: new client: %s port %d conn fd: %d max fds: %d\n", __func__,
-			 inet_ntop(AF_INET, &(tcp_addr.sin_addr), buffer, sizeof(buffer)), ntohs(tcp_addr.sin_port), conn_fd, max_fds);
-	    for (i = 0; i < MAX_TCP_CONN; i++) {
-		if (tcp_client[i] < 0) {
-		    tcp_client[i] = conn_fd;	/* save new TCP client descriptor */
-		    break;
+	    /* already connected TCP client */
+	    else {
+		client = search_tcp_client(fd);
+		if (client == NULL)
+		    continue;
+		if (events[i].events & EPOLLOUT) {
+		    if (tcp_flush(client) < 0) {
+			fprint_syslog_wc(stderr, LOG_ERR, "error sending TCP data:", strerror(errno));
+			close_tcp_client(client);
+			continue;
+		    }
 		}
-	    }
-	    if (i == MAX_TCP_CONN) {
-		fprintf(stderr, "too many TCP clients\n");
-		syslog(LOG_ERR, "%s: too many TCP clients\n", __func__);
-	    }
-
-	    FD_SET(conn_fd, &all_fds);		/* add new descriptor to set */
-	    max_fds = MAX(conn_fd, max_fds);	/* for select */
-	    max_tcp_i = MAX(i, max_tcp_i);	/* max index in tcp_client[] array */
-	    /* send embedded CAN ping */
-	    memcpy(netframe, M_CAN_PING, CAN_ENCAP_SIZE);
-	    net_to_net(conn_fd, NULL, netframe, CAN_ENCAP_SIZE);
-	    if (cs2_config_data.verbose && !background)
-		printf("send embedded CAN ping\n");
-
-	    if (--nready <= 0)
-		continue;	/* no more readable descriptors */
-	}
-	/* received a packet on second TCP port */
-	if (FD_ISSET(st2, &read_fds)) {
-	    conn_fd = accept(st2, (struct sockaddr *)&tcp_addr2, &tcp_client_length);
-
-	    /* TODO : close missing */
-	    if (cs2_config_data.verbose && !background) {
-		printf("new client: %s, port %d conn fd: %d max fds: %d\n", inet_ntop(AF_INET, &(tcp_addr2.sin_addr),
-			buffer, sizeof(buffer)), ntohs(tcp_addr2.sin_port), conn_fd, max_fds);
-	    }
-	    syslog(LOG_NOTICE, "%s: new client: %s port %d conn fd: %d max fds: %d\n", __func__,
-			 inet_ntop(AF_INET, &(tcp_addr2.sin_addr), buffer, sizeof(buffer)), ntohs(tcp_addr2.sin_port), conn_fd, max_fds);
-	    FD_SET(conn_fd, &all_fds);	/* add new descriptor to set */
-	    max_fds = MAX(conn_fd, max_fds);	/* for select */
-	    max_tcp_i = MAX(i, max_tcp_i);	/* max index in tcp_client[] array */
-	}
-
-	/* check for already connected TCP clients */
-	for (i = 0; i <= max_tcp_i; i++) {	/* check all clients for data */
-	    tcp_socket = tcp_client[i];
-	    if (tcp_socket < 0)
-		continue;
-	    /* printf("%s tcp packet received from client #%d  max_tcp_i:%d todo:%d\n", time_stamp(timestamp), i, max_tcp_i,nready); */
-	    if (FD_ISSET(tcp_socket, &read_fds)) {
+		if (!(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+		    continue;
 		if (cs2_config_data.verbose && !background) {
 		    time_stamp(timestamp);
-		    printf("%s packet from: %s\n", timestamp, inet_ntop(AF_INET, &tcp_addr.sin_addr, buffer, sizeof(buffer)));
+		    printf("%s packet from: %s\n", timestamp, inet_ntop(AF_INET, &client->addr.sin_addr, buffer, sizeof(buffer)));
 		}
-		n = read(tcp_socket, netframe, MAXDG);
-		if (!n) {
+		n = read(fd, netframe, MAXDG);
+		if (n < 0) {
+		    if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+			continue;
+		    fprint_syslog_wc(stderr, LOG_ERR, "reading TCP data error:", strerror(errno));
+		    close_tcp_client(client);
+		} else if (!n) {
 		    /* connection closed by client */
 		    if (cs2_config_data.verbose && !background) {
 			time_stamp(timestamp);
-			printf("%s client %s closed connection\n", timestamp, inet_ntop(AF_INET, &tcp_addr.sin_addr, buffer, sizeof(buffer)));
+			printf("%s client %s closed connection\n", timestamp, inet_ntop(AF_INET, &client->addr.sin_addr, buffer, sizeof(buffer)));
 		    }
-		    syslog(LOG_NOTICE, "%s: client %s closed connection\n", __func__, inet_ntop(AF_INET, &tcp_addr.sin_addr, buffer, sizeof(buffer)));
-		    close(tcp_socket);
-		    FD_CLR(tcp_socket, &all_fds);
-		    tcp_client[i] = -1;
+		    close_tcp_client(client);
 		} else {
 		    /* check the whole TCP packet, if there are more than one CAN frame included */
 		    /* TCP packets with size modulo 13 !=0 are ignored though */
@@ -945,27 +1131,32 @@ int main(int argc, char **argv) {
 			    fprintf(stderr, "%s received packet %% 13 : length %d - maybe close connection\n", timestamp, n);
 			syslog(LOG_ERR, "%s: received packet %% 13 : length %d - maybe close connection\n", __func__, n);
 		    } else {
-			for (i = 0; i < n; i += CAN_ENCAP_SIZE) {
+			for (j = 0; j < n; j += CAN_ENCAP_SIZE) {
 			    /* check if we need to forward the message to CAN */
-			    if (!check_data(tcp_socket, &cs2_config_data, &netframe[i])) {
-				ret = frame_to_can(sc, &netframe[i]);
+			    if (!check_data(fd, &cs2_config_data, &netframe[j])) {
+				ret = frame_to_can(sc, &netframe[j]);
 				if (!ret) {
-				    if (i > 0)
-					print_can_frame(TCP_FORMATS_STRG, &netframe[i], cs2_config_data.verbose && !background);
+				    if (j > 0)
+					print_can_frame(TCP_FORMATS_STRG, &netframe[j], cs2_config_data.verbose && !background);
 				    else
-					print_can_frame(TCP_FORMAT_STRG, &netframe[i], cs2_config_data.verbose && !background);
+					print_can_frame(TCP_FORMAT_STRG, &netframe[j], cs2_config_data.verbose && !background);
 				}
-				net_to_net(sb, (struct sockaddr *)&baddr, &netframe[i], CAN_ENCAP_SIZE);
-				print_can_frame(UDP_FORMAT_STRG, &netframe[i], cs2_config_data.verbose && !background);
+				net_to_net(sb, (struct sockaddr *)&baddr, &netframe[j], CAN_ENCAP_SIZE);
+				print_can_frame(UDP_FORMAT_STRG, &netframe[j], cs2_config_data.verbose && !background);
 			    }
 			}
 		    }
 		}
-		if (--nready <= 0)
-		    break;	/* no more readable descriptors */
 	    }
 	}
+	/* one writev per TCP client for everything queued in this round */
+	tcp_flush_all();
+    }
+    for (i = 0; i < MAX_TCP_CONN; i++) {
+	if (tcp_client[i].fd >= 0)
+	    close_tcp_client(&tcp_client[i]);
     }
+    close(epoll_fd);
     free_track_file(page_name);
     free(page_name);
     /* free(udp_dst_address); */
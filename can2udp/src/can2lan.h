@@ -27,6 +27,8 @@
 #include <sys/socket.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -49,7 +51,17 @@
 #define MAXIFLEN  		64		/* maximum interface string length */
 #define MAX_UDP_BCAST_RETRY  	10		/* maximum retries getting UDP socket */
 #define MAX_TRACK_PAGE		64		/* maximum number track pages */
+#define MAX_EVENTS		(MAX_TCP_CONN + 4)	/* max epoll events per wakeup */
+#define CAN_RECV_BATCH		32		/* max CAN frames per recvmmsg */
+#define CONFIG_STREAM_MAX	((1 + (0x8000 + 8) / 8) * CAN_ENCAP_SIZE)	/* largest config data stream, see CHUNK in gio.c */
+#define TCP_OUT_BUFFER_SIZE	0x20000		/* output buffer per TCP client, power of 2 */
+
+/* a client asking for several config files must not be taken for stalled */
+#if TCP_OUT_BUFFER_SIZE < 2 * CONFIG_STREAM_MAX + 0x4000
+#error TCP_OUT_BUFFER_SIZE too small for two config data streams
+#endif
 #define MAX(a,b)		((a) > (b) ? (a) : (b))
+#define MIN(a,b)		((a) < (b) ? (a) : (b))
 
 #define	CRC			0x01
 #define COMPRESSED		0x02
@@ -121,6 +133,26 @@ struct cs2_config_data_t {
     char **page_name;
 };
 
+struct config_cache_t {
+    char *filename;
+    struct timespec mtime;
+    off_t size;
+    ino_t ino;
+    uint32_t canid;
+    int nframes;
+    uint8_t *frames;
+    struct config_cache_t *next;
+};
+
+struct tcp_client_t {
+    int fd;
+    int want_write;
+    unsigned int head;
+    unsigned int length;
+    unsigned char *out;
+    struct sockaddr_in addr;
+};
+
 #define MS1_BUFFER_SIZE 8
 #define MS1_BUFFER_MASK (MS1_BUFFER_SIZE-1)
 
@@ -136,10 +168,13 @@ int time_stamp(char *timestamp);
 uint16_t generateHash(uint32_t uid);
 char **read_track_file(char *filename, char **page_name);
 int send_tcp_config_data(char *filename, char *config_dir,  uint32_t canid, int tcp_socket, int flags);
+void invalidate_config_cache(char *filename);
 void print_can_frame(char *format_string, unsigned char *netframe, int verbose);
 int net_to_net(int net_socket, struct sockaddr *net_addr, unsigned char *netframe, int length);
 int frame_to_can(int can_socket, unsigned char *netframe);
+int can_to_netframe(struct can_frame *frame, unsigned char *netframe);
 int frame_to_net(int net_socket, struct sockaddr *net_addr, struct can_frame *frame);
+int tcp_client_send(int fd, unsigned char *data, int length);
 void ms1_node_buffer_init(void);
 int ms1_node_buffer_in(uint8_t node);
 int ms1_node_buffer_out(uint8_t *node);
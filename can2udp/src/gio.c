@@ -209,8 +209,7 @@ int net_to_net(int net_socket, struct sockaddr *net_addr, unsigned char *netfram
     return 0;
 }
 
-int frame_to_net(int net_socket, struct sockaddr *net_addr, struct can_frame *frame) {
-    int s;
+int can_to_netframe(struct can_frame *frame, unsigned char *netframe) {
     uint32_t canid;
 
     if (filter[0].use) {
@@ -228,6 +227,14 @@ int frame_to_net(int net_socket, struct sockaddr *net_addr, struct can_frame *fr
     memcpy(netframe, &canid, 4);
     netframe[4] = frame->can_dlc;
     memcpy(&netframe[5], &frame->data, frame->can_dlc);
+    return 1;
+}
+
+int frame_to_net(int net_socket, struct sockaddr *net_addr, struct can_frame *frame) {
+    int s;
+
+    if (!can_to_netframe(frame, netframe))
+	return 0;
 
     /* send TCP/UDP frame */
     s = sendto(net_socket, netframe, CAN_ENCAP_SIZE, 0, net_addr, sizeof(*net_addr));
@@ -383,6 +390,7 @@ int config_write(struct cs2_config_data_t *config_data) {
     inflate_data(config_data);
     fwrite(config_data->inflated_data, 1, config_data->inflated_size, config_fp);
     fclose(config_fp);
+    invalidate_config_cache(config_data->name);
     free(filename);
     free(config_data->deflated_data);
     free(config_data->inflated_data);
@@ -455,7 +463,7 @@ int reassemble_data(struct cs2_config_data_t *config_data, unsigned char *netfra
 			syslog(LOG_NOTICE, "%s: getting %s filename %s\n", __func__, cs2_configs[config_data->next][0], config_data->name);
 			memcpy(&newframe[5], cs2_configs[config_data->next][0], strlen(cs2_configs[config_data->next][0]));
 			/* print_can_frame(NET_TCP_FORMAT_STRG, newframe, 1); */
-			net_to_net(config_data->cs2_tcp_socket, NULL, newframe, CAN_ENCAP_SIZE);
+			tcp_client_send(config_data->cs2_tcp_socket, newframe, CAN_ENCAP_SIZE);
 			config_data->next++;
 			break;
 		    } else {
@@ -502,7 +510,7 @@ int reassemble_data(struct cs2_config_data_t *config_data, unsigned char *netfra
 			if (config_data->verbose)
 			    printf("getting track %s filename %s\n", &newframe[5], config_data->name);
 		        syslog(LOG_NOTICE, "%s: getting track %s filename %s\n", __func__, &newframe[5], config_data->name);
-			net_to_net(config_data->cs2_tcp_socket, NULL, newframe, CAN_ENCAP_SIZE);
+			tcp_client_send(config_data->cs2_tcp_socket, newframe, CAN_ENCAP_SIZE);
 			config_data->track_index++;
 		    } else {
 			/* reset dir */
@@ -585,141 +593,191 @@ static void strm_init(z_stream * strm) {
     CALL_ZLIB(deflateInit2(strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY));
 }
 
-int send_tcp_config_data(char *filename, char *config_dir, uint32_t canid, int tcp_socket, int flags) {
-    /* uint16_t crc; */
-    uint32_t temp32, canid_be, nbytes = 0;
-    uint8_t *config;
-    uint8_t *out;
+/* compressed config files are kept as ready-made CAN frame stream   */
+/* until the file changes - a reconnecting app doesn't deflate again */
+static struct config_cache_t *config_cache = NULL;
+
+static struct config_cache_t *search_config_cache(char *filename) {
+    struct config_cache_t *entry;
+
+    for (entry = config_cache; entry; entry = entry->next) {
+	if (strcmp(entry->filename, filename) == 0)
+	    return entry;
+    }
+    return NULL;
+}
+
+void invalidate_config_cache(char *filename) {
+    struct config_cache_t **link, *entry;
+
+    for (link = &config_cache; *link; link = &(*link)->next) {
+	entry = *link;
+	if (strcmp(entry->filename, filename) == 0) {
+	    *link = entry->next;
+	    free(entry->filename);
+	    free(entry->frames);
+	    free(entry);
+	    return;
+	}
+    }
+}
+
+static struct config_cache_t *build_config_cache(char *filename, char *config_dir, struct stat *st) {
+    struct config_cache_t *entry;
+    uint32_t temp32, nbytes = 0;
+    uint8_t *config, *out, *frame;
     z_stream strm;
-    int inflated_size, deflated_size, padded_nbytes, i, src_i, n_packets;
+    int inflated_size, deflated_size, padded_nbytes, i;
     uint16_t crc, temp16;
-    uint8_t netframe[MAXMTU];
-    int on = 1;
-
-    out = NULL;
 
     config = read_config_file(filename, config_dir, &nbytes);
     if (config == NULL) {
 	fprintf(stderr, "%s: error reading config %s\n", __func__, filename);
 	syslog(LOG_ERR, "%s: error reading config %s\n", __func__, filename);
-	return -1;
+	return NULL;
     }
 
-    if (flags & COMPRESSED) {
-	/* we need some more bytes to prepare send data (includes inflated file size and padding)    */
-	/* assuming that out[CHUNK] is large enough to compress the whole file, otherwise don't send */
-	out = (uint8_t *) calloc(CHUNK + 12, 1);
-	if (out == NULL) {
-	    fprintf(stderr, "%s: error calloc failed creating deflation buffer\n", __func__);
-	    syslog(LOG_ERR, "%s: error calloc failed creating deflation buffer\n", __func__);
-	    return -1;
-	}
-	strm_init(&strm);
-	strm.next_in = config;
-	strm.avail_in = nbytes;
-	strm.avail_out = CHUNK;
-	/* store deflated file beginning at byte 5 */
-	strm.next_out = &out[4];
-	CALL_ZLIB(deflate(&strm, Z_FINISH));
-	deflated_size = CHUNK - strm.avail_out;
-	if (strm.avail_out == 0) {
-	    /* printf("%s: compressed file to large : %d filesize %d strm.avail_out\n", __func__, nbytes, strm.avail_out); */
-	    deflateEnd(&strm);
-	    free(config);
-	    free(out);
-	    return -1;
-	}
+    /* we need some more bytes to prepare send data (includes inflated file size and padding)    */
+    /* assuming that out[CHUNK] is large enough to compress the whole file, otherwise don't send */
+    out = (uint8_t *) calloc(CHUNK + 12, 1);
+    if (out == NULL) {
+	fprintf(stderr, "%s: error calloc failed creating deflation buffer\n", __func__);
+	syslog(LOG_ERR, "%s: error calloc failed creating deflation buffer\n", __func__);
+	free(config);
+	return NULL;
+    }
+    strm_init(&strm);
+    strm.next_in = config;
+    strm.avail_in = nbytes;
+    strm.avail_out = CHUNK;
+    /* store deflated file beginning at byte 5 */
+    strm.next_out = &out[4];
+    CALL_ZLIB(deflate(&strm, Z_FINISH));
+    deflated_size = CHUNK - strm.avail_out;
+    deflateEnd(&strm);
+    free(config);
+    if (strm.avail_out == 0) {
+	/* printf("%s: compressed file to large : %d filesize %d strm.avail_out\n", __func__, nbytes, strm.avail_out); */
+	free(out);
+	return NULL;
+    }
 
-	/* now prepare the send buffer */
-	inflated_size = htonl(nbytes);
-	memcpy(out, &inflated_size, 4);
-	/* prepare padding */
-	padded_nbytes = deflated_size + 4;
-	if (padded_nbytes % 8) {
-	    padded_nbytes += 8 - (padded_nbytes % 8);
-	}
+    /* now prepare the send buffer */
+    inflated_size = htonl(nbytes);
+    memcpy(out, &inflated_size, 4);
+    /* prepare padding */
+    padded_nbytes = deflated_size + 4;
+    if (padded_nbytes % 8) {
+	padded_nbytes += 8 - (padded_nbytes % 8);
+    }
 
-	for (i = deflated_size + 4; i < padded_nbytes; i++) {
-	    out[i] = 0;
-	}
+    for (i = deflated_size + 4; i < padded_nbytes; i++) {
+	out[i] = 0;
+    }
 
-	crc = CRCCCITT(out, padded_nbytes, 0xffff);
-	/* printf("%s: canid 0x%08x filesize %d deflated size: %d crc 0x%04x\n", __func__, canid, nbytes, deflated_size, crc); */
-	memset(netframe, 0, MAXMTU);
-	/* prepare first CAN frame   */
-	/* delete response bit and set canid to config data stream */
-	canid_be = htonl((canid & 0xFFFEFFFFUL) | 0x00020000UL);
-	memcpy(&netframe[0], &canid_be, 4);
-	/* CAN DLC is 6 */
-	netframe[4] = 0x06;
-	temp32 = htonl(deflated_size + 4);
-	memcpy(&netframe[5], &temp32, 4);
-	temp16 = htons(crc);
-	memcpy(&netframe[9], &temp16, 2);
-	netframe[11] = 0x00;
-	netframe[12] = 0x00;
-
-	if (net_to_net(tcp_socket, NULL, netframe, CAN_ENCAP_SIZE)) {
-	    deflateEnd(&strm);
-	    free(config);
-	    free(out);
-	    return -1;
-	}
+    crc = CRCCCITT(out, padded_nbytes, 0xffff);
+    /* printf("%s: filesize %d deflated size: %d crc 0x%04x\n", __func__, nbytes, deflated_size, crc); */
 
-	/* loop until all packets send */
-	src_i = 0;
-	do {
-	    n_packets = 0;
-	    i = 0;
-	    do {
-		memcpy(&netframe[i], &canid_be, 4);
-		i += 4;
-		/* CAN DLC is always 8 */
-		netframe[i] = 0x08;
-		i++;
-		memcpy(&netframe[i], &out[src_i], 8);
-		i += 8;
-		src_i += 8;
-		n_packets++;
-	    } while ((src_i < padded_nbytes) && (n_packets < MAX_PACKETS));
-
-	    /* disable Nagle - force PUSH */
-	    if (setsockopt(tcp_socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) < 0) {
-		fprintf(stderr, "error disabling Nagle - TCP_NODELAY on: %s\n", strerror(errno));
-		return -1;
-	    }
-	    /* printf("send %3d bytes by TCP\n", i); */
-	    /* don't use frame_to_net because we have more then 13 (CAN_ENCAP_SIZE) bytes to send */
-	    if (net_to_net(tcp_socket, NULL, netframe, i)) {
-		perror("error sending TCP data\n");
-		deflateEnd(&strm);
-		free(config);
-		free(out);
-		return -1;
-	    }
-	    /* disable Nagle - force PUSH */
-	    if (setsockopt(tcp_socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) < 0) {
-		fprintf(stderr, "error disabling Nagle - TCP_NODELAY on: %s\n", strerror(errno));
-		return -1;
-	    }
-	    /* small sleep (reschedule) */
-	    usec_sleep(1000);
-	} while (src_i < padded_nbytes);
-#if 0
-	/* print compressed data */
-	temp32 = i;
-	for (i = 0; i < temp32; i++) {
-	    if ((i % CAN_ENCAP_SIZE) == 0) {
-		printf("\n");
-	    }
-	    printf("%02x ", netframe[i]);
-	}
-	printf("\n");
-#endif
-	deflateEnd(&strm);
+    entry = (struct config_cache_t *)calloc(1, sizeof(struct config_cache_t));
+    if (entry == NULL) {
+	free(out);
+	return NULL;
     }
-    free(config);
-    if (out)
+    entry->nframes = 1 + padded_nbytes / 8;
+    entry->frames = (uint8_t *) calloc(entry->nframes, CAN_ENCAP_SIZE);
+    entry->filename = strdup(filename);
+    if ((entry->frames == NULL) || (entry->filename == NULL)) {
+	fprintf(stderr, "%s: error calloc failed creating config cache\n", __func__);
+	syslog(LOG_ERR, "%s: error calloc failed creating config cache\n", __func__);
+	free(entry->frames);
+	free(entry->filename);
+	free(entry);
 	free(out);
-    return 0;
+	return NULL;
+    }
+    entry->mtime = st->st_mtim;
+    entry->size = st->st_size;
+    entry->ino = st->st_ino;
+    /* the CAN ID is filled in when sending */
+    entry->canid = 0;
+
+    /* first CAN frame: CAN DLC is 6 */
+    frame = entry->frames;
+    frame[4] = 0x06;
+    temp32 = htonl(deflated_size + 4);
+    memcpy(&frame[5], &temp32, 4);
+    temp16 = htons(crc);
+    memcpy(&frame[9], &temp16, 2);
+
+    /* data frames: CAN DLC is always 8 */
+    for (i = 0; i < padded_nbytes; i += 8) {
+	frame += CAN_ENCAP_SIZE;
+	frame[4] = 0x08;
+	memcpy(&frame[5], &out[i], 8);
+    }
+    free(out);
+
+    entry->next = config_cache;
+    config_cache = entry;
+    return entry;
+}
+
+static struct config_cache_t *get_config_cache(char *filename, char *config_dir) {
+    struct config_cache_t *entry;
+    struct stat st;
+    char *file_name;
+    int rc;
+
+    file_name = calloc(MAXLINE, 1);
+    if (!file_name)
+	return NULL;
+    strncat(file_name, config_dir, MAXLINE - 1);
+    strncat(file_name, filename, MAXLINE - strlen(file_name) - 1);
+    rc = stat(file_name, &st);
+    free(file_name);
+
+    entry = search_config_cache(filename);
+    if (rc < 0) {
+	if (entry)
+	    invalidate_config_cache(filename);
+	fprintf(stderr, "%s: error stat failed for file %s\n", __func__, filename);
+	syslog(LOG_ERR, "%s: error stat failed for file %s\n", __func__, filename);
+	return NULL;
+    }
+    if (entry) {
+	if ((entry->mtime.tv_sec == st.st_mtim.tv_sec) && (entry->mtime.tv_nsec == st.st_mtim.tv_nsec) &&
+	    (entry->size == st.st_size) && (entry->ino == st.st_ino))
+	    return entry;
+	invalidate_config_cache(filename);
+    }
+    return build_config_cache(filename, config_dir, &st);
+}
+
+int send_tcp_config_data(char *filename, char *config_dir, uint32_t canid, int tcp_socket, int flags) {
+    struct config_cache_t *entry;
+    uint32_t canid_be;
+    uint8_t *frame;
+    int i;
+
+    if (!(flags & COMPRESSED))
+	return 0;
+
+    entry = get_config_cache(filename, config_dir);
+    if (entry == NULL)
+	return -1;
+
+    /* delete response bit and set canid to config data stream */
+    canid = (canid & 0xFFFEFFFFUL) | 0x00020000UL;
+    if (entry->canid != canid) {
+	canid_be = htonl(canid);
+	frame = entry->frames;
+	for (i = 0; i < entry->nframes; i++) {
+	    memcpy(frame, &canid_be, 4);
+	    frame += CAN_ENCAP_SIZE;
+	}
+	entry->canid = canid;
+    }
+
+    /* the whole stream in one go - the relay buffers what the socket doesn't take */
+    return tcp_client_send(tcp_socket, entry->frames, entry->nframes * CAN_ENCAP_SIZE);
 }
@@ -0,0 +1,54 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <boolean.h>
+#include <compare.h>
+
+typedef void *HashKeyType;
+typedef void *HashDataType;
+typedef void (*HashKeyDelCbFkt)(HashKeyType Key);
+typedef void (*HashDataDelCbFkt)(HashDataType Daten);
+typedef unsigned long (*HashFkt)(HashKeyType Key);
+typedef struct {
+   HashKeyType Key;
+   HashDataType Daten;
+   unsigned long HashWert;
+   BOOL Frei;
+} HashElement, *HashKnoten;
+typedef struct {
+   HashElement *Eintraege;
+   unsigned long *Index;
+   unsigned long AnzSlots;
+   unsigned long AnzEintraege;
+   unsigned long AnzBelegt;
+   unsigned long AnzGeloescht;
+   BOOL Geordnet;
+   HashFkt Hash;
+   CmpFkt Compare;
+   HashKeyDelCbFkt DestroyKey;
+   HashDataDelCbFkt DestroyDaten;
+} HashTabelle;
+typedef struct {
+   HashTabelle *Wurzel;
+   unsigned long Pos;
+} HashIterator;
+typedef void (*HashWalkCbFkt)(void *PrivData, HashKnoten Element);
+
+HashTabelle *HashCreate(void);
+void HashDestroy(HashTabelle *Wurzel);
+void HashInit(HashTabelle *Wurzel, HashFkt Hash, CmpFkt Cmp, BOOL Geordnet,
+              HashKeyDelCbFkt DestroyKeyCb, HashDataDelCbFkt DestroyDatenCb);
+BOOL HashInsert(HashTabelle *Wurzel, HashKeyType Key, HashDataType Daten);
+void HashDelete(HashTabelle *Wurzel, HashKeyType Key);
+HashKnoten HashFinde(HashTabelle *Wurzel, HashKeyType Key);
+void HashPurge(HashTabelle *Wurzel);
+void HashWalk(HashTabelle *Wurzel, HashWalkCbFkt Cb, void *PrivData);
+void HashWalkSortiert(HashTabelle *Wurzel, HashWalkCbFkt Cb, void *PrivData);
+void HashInitIterator(HashIterator *Iter, HashTabelle *Wurzel);
+HashKnoten HashFirst(HashIterator *Iter);
+HashKnoten HashNext(HashIterator *Iter);
+HashKnoten HashIterRemove(HashIterator *Iter);
+unsigned long HashString(HashKeyType Key);
+unsigned long HashPointer(HashKeyType Key);
+
+#endif
@@ -0,0 +1,25 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <boolean.h>
+#include "hash.h"
+
+HashTabelle *HashCreate(void)
+{  HashTabelle *NewHash;
+
+   NewHash = (HashTabelle *)malloc(sizeof(HashTabelle));
+   if (NewHash != NULL)
+   {
+      NewHash->Eintraege = (HashElement *)NULL;
+      NewHash->Index = (unsigned long *)NULL;
+      NewHash->AnzSlots = 0;
+      NewHash->AnzEintraege = 0;
+      NewHash->AnzBelegt = 0;
+      NewHash->AnzGeloescht = 0;
+      NewHash->Geordnet = FALSE;
+      NewHash->Hash = NULL;
+      NewHash->Compare = NULL;
+      NewHash->DestroyKey = NULL;
+      NewHash->DestroyDaten = NULL;
+   }
+   return(NewHash);
+}
@@ -0,0 +1,50 @@
+#include <stddef.h>
+#include <boolean.h>
+#include "hash_int.h"
+
+/* Eintrag im Slot freigeben, ohne Reihenfolge wird der letzte Eintrag in
+   die Luecke geschoben, sonst bleibt sie bis zum naechsten Reorganisieren */
+void HashEntferne(HashTabelle *Wurzel, unsigned long Slot)
+{  unsigned long Pos, Letzter, Maske;
+   HashKnoten Element;
+
+   Pos = Wurzel->Index[Slot] - 1;
+   Element = &(Wurzel->Eintraege[Pos]);
+   if ((Wurzel->DestroyKey != NULL) && (Element->Key != NULL))
+      Wurzel->DestroyKey(Element->Key);
+   if ((Wurzel->DestroyDaten != NULL) && (Element->Daten != NULL))
+      Wurzel->DestroyDaten(Element->Daten);
+   Wurzel->Index[Slot] = HASH_SLOT_GELOESCHT;
+   Wurzel->AnzGeloescht++;
+   Wurzel->AnzBelegt--;
+   Letzter = Wurzel->AnzEintraege - 1;
+   if (Wurzel->Geordnet && (Pos != Letzter))
+   {
+      Element->Key = NULL;
+      Element->Daten = NULL;
+      Element->Frei = TRUE;
+   }
+   else
+   {
+      if (Pos != Letzter)
+      {
+         Maske = Wurzel->AnzSlots - 1;
+         Slot = Wurzel->Eintraege[Letzter].HashWert & Maske;
+         while (Wurzel->Index[Slot] != Letzter + 1)
+            Slot = (Slot + 1) & Maske;
+         Wurzel->Index[Slot] = Pos + 1;
+         *Element = Wurzel->Eintraege[Letzter];
+      }
+      Wurzel->AnzEintraege--;
+   }
+}
+
+void HashDelete(HashTabelle *Wurzel, HashKeyType Key)
+{  unsigned long Slot;
+
+   Slot = HashSucheSlot(Wurzel, Key, Wurzel->Hash(Key));
+   if (Slot < Wurzel->AnzSlots)
+   {
+      HashEntferne(Wurzel, Slot);
+   }
+}
@@ -0,0 +1,14 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include "hash.h"
+
+void HashDestroy(HashTabelle *Wurzel)
+{
+   if (Wurzel != NULL)
+   {
+      HashPurge(Wurzel);
+      free(Wurzel->Eintraege);
+      free(Wurzel->Index);
+      free(Wurzel);
+   }
+}
@@ -0,0 +1,41 @@
+#include <stddef.h>
+#include <compare.h>
+#include "hash_int.h"
+
+/* lineares Sondieren, liefert den Slot des Keys oder AnzSlots */
+unsigned long HashSucheSlot(HashTabelle *Wurzel, HashKeyType Key,
+                            unsigned long HashWert)
+{  unsigned long Maske, Slot, Eintrag;
+   HashKnoten Element;
+
+   if (Wurzel->AnzSlots == 0)
+      return(Wurzel->AnzSlots);
+   Maske = Wurzel->AnzSlots - 1;
+   Slot = HashWert & Maske;
+   while ((Eintrag = Wurzel->Index[Slot]) != HASH_SLOT_FREI)
+   {
+      if (Eintrag != HASH_SLOT_GELOESCHT)
+      {
+         Element = &(Wurzel->Eintraege[Eintrag - 1]);
+         if ((Element->HashWert == HashWert) &&
+             EQUAL(Wurzel->Compare(Element->Key, Key)))
+            return(Slot);
+      }
+      Slot = (Slot + 1) & Maske;
+   }
+   return(Wurzel->AnzSlots);
+}
+
+HashKnoten HashFinde(HashTabelle *Wurzel, HashKeyType Key)
+{  unsigned long Slot;
+
+   Slot = HashSucheSlot(Wurzel, Key, Wurzel->Hash(Key));
+   if (Slot < Wurzel->AnzSlots)
+   {
+      return(&(Wurzel->Eintraege[Wurzel->Index[Slot] - 1]));
+   }
+   else
+   {
+      return(NULL);
+   }
+}
@@ -0,0 +1,26 @@
+#include <stdint.h>
+#include "hash.h"
+
+/* FNV-1a fuer nullterminierte Strings */
+unsigned long HashString(HashKeyType Key)
+{  unsigned char *Zeichen;
+   unsigned long Wert;
+
+   Wert = 2166136261ul;
+   for (Zeichen = (unsigned char *)Key; *Zeichen != '\0'; Zeichen++)
+   {
+      Wert ^= *Zeichen;
+      Wert *= 16777619ul;
+   }
+   return(Wert);
+}
+
+/* fuer Zeiger als Key, die unteren Bits sind durch malloc immer gleich */
+unsigned long HashPointer(HashKeyType Key)
+{  unsigned long Wert;
+
+   Wert = (unsigned long)(uintptr_t)Key;
+   Wert ^= Wert >> 4;
+   Wert *= 0x9e3779b1ul;
+   return(Wert ^ (Wert >> 16));
+}
@@ -0,0 +1,11 @@
+#include "hash.h"
+
+void HashInit(HashTabelle *Wurzel, HashFkt Hash, CmpFkt Cmp, BOOL Geordnet,
+              HashKeyDelCbFkt DestroyKeyCb, HashDataDelCbFkt DestroyDatenCb)
+{
+   Wurzel->Hash = Hash;
+   Wurzel->Compare = Cmp;
+   Wurzel->Geordnet = Geordnet;
+   Wurzel->DestroyKey = DestroyKeyCb;
+   Wurzel->DestroyDaten = DestroyDatenCb;
+}
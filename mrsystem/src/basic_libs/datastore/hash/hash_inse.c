@@ -0,0 +1,94 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <boolean.h>
+#include "hash_int.h"
+
+static void SetzeIndex(HashTabelle *Wurzel, unsigned long Pos)
+{  unsigned long Maske, Slot;
+
+   Maske = Wurzel->AnzSlots - 1;
+   Slot = Wurzel->Eintraege[Pos].HashWert & Maske;
+   while (Wurzel->Index[Slot] != HASH_SLOT_FREI)
+      Slot = (Slot + 1) & Maske;
+   Wurzel->Index[Slot] = Pos + 1;
+}
+
+/* Luecken entfernen (Reihenfolge bleibt) und Index neu aufbauen */
+static BOOL Reorganisiere(HashTabelle *Wurzel, unsigned long AnzSlots)
+{  HashElement *Eintraege;
+   unsigned long *Index;
+   unsigned long Pos, Neu;
+
+   Index = (unsigned long *)calloc(AnzSlots, sizeof(unsigned long));
+   if (Index == NULL)
+      return(FALSE);
+   Neu = 0;
+   for (Pos = 0; Pos < Wurzel->AnzEintraege; Pos++)
+   {
+      if (!Wurzel->Eintraege[Pos].Frei)
+      {
+         Wurzel->Eintraege[Neu] = Wurzel->Eintraege[Pos];
+         Neu++;
+      }
+   }
+   Eintraege = (HashElement *)realloc(Wurzel->Eintraege,
+                                      HashKapazitaet(AnzSlots) * sizeof(HashElement));
+   if (Eintraege == NULL)
+   {
+      free(Index);
+      Wurzel->AnzEintraege = Neu;
+      Index = Wurzel->Index;
+      memset(Index, 0, Wurzel->AnzSlots * sizeof(unsigned long));
+      Wurzel->AnzGeloescht = 0;
+      for (Pos = 0; Pos < Neu; Pos++)
+         SetzeIndex(Wurzel, Pos);
+      return(FALSE);
+   }
+   free(Wurzel->Index);
+   Wurzel->Eintraege = Eintraege;
+   Wurzel->Index = Index;
+   Wurzel->AnzSlots = AnzSlots;
+   Wurzel->AnzEintraege = Neu;
+   Wurzel->AnzGeloescht = 0;
+   for (Pos = 0; Pos < Neu; Pos++)
+      SetzeIndex(Wurzel, Pos);
+   return(TRUE);
+}
+
+BOOL HashInsert(HashTabelle *Wurzel, HashKeyType Key, HashDataType Daten)
+{  unsigned long HashWert, Slot, AnzSlots;
+   HashKnoten Element;
+
+   HashWert = Wurzel->Hash(Key);
+   Slot = HashSucheSlot(Wurzel, Key, HashWert);
+   if (Slot < Wurzel->AnzSlots)
+   {
+      /* wie MapSet mit Avl: alten Eintrag freigeben, Position bleibt */
+      Element = &(Wurzel->Eintraege[Wurzel->Index[Slot] - 1]);
+      if ((Wurzel->DestroyKey != NULL) && (Element->Key != NULL))
+         Wurzel->DestroyKey(Element->Key);
+      if ((Wurzel->DestroyDaten != NULL) && (Element->Daten != NULL))
+         Wurzel->DestroyDaten(Element->Daten);
+      Element->Key = Key;
+      Element->Daten = Daten;
+      return(TRUE);
+   }
+   if (Wurzel->AnzBelegt + Wurzel->AnzGeloescht >= HashKapazitaet(Wurzel->AnzSlots))
+   {
+      AnzSlots = Wurzel->AnzSlots > 0 ? Wurzel->AnzSlots : HASH_MIN_SLOTS;
+      while (Wurzel->AnzBelegt + 1 > HashKapazitaet(AnzSlots) / 2)
+         AnzSlots *= 2;
+      if (!Reorganisiere(Wurzel, AnzSlots))
+         return(FALSE);
+   }
+   Element = &(Wurzel->Eintraege[Wurzel->AnzEintraege]);
+   Element->Key = Key;
+   Element->Daten = Daten;
+   Element->HashWert = HashWert;
+   Element->Frei = FALSE;
+   SetzeIndex(Wurzel, Wurzel->AnzEintraege);
+   Wurzel->AnzEintraege++;
+   Wurzel->AnzBelegt++;
+   return(TRUE);
+}
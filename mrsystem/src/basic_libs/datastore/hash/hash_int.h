@@ -0,0 +1,18 @@
+#ifndef HASH_INT_H
+#define HASH_INT_H
+
+#include "hash.h"
+
+/* Index enthaelt 0 fuer einen freien Slot, sonst Position in Eintraege + 1 */
+#define HASH_SLOT_FREI      0ul
+#define HASH_SLOT_GELOESCHT (~0ul)
+#define HASH_MIN_SLOTS      16ul
+
+/* hoechstens 2/3 der Slots belegt, Geloeschte mitgezaehlt */
+#define HashKapazitaet(Slots) ((Slots) / 3 * 2)
+
+unsigned long HashSucheSlot(HashTabelle *Wurzel, HashKeyType Key,
+                            unsigned long HashWert);
+void HashEntferne(HashTabelle *Wurzel, unsigned long Slot);
+
+#endif
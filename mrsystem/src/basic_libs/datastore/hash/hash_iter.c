@@ -0,0 +1,45 @@
+#include <stddef.h>
+#include "hash_int.h"
+
+static HashKnoten Aktuell(HashIterator *Iter)
+{
+   while ((Iter->Pos < Iter->Wurzel->AnzEintraege) &&
+          Iter->Wurzel->Eintraege[Iter->Pos].Frei)
+      Iter->Pos++;
+   if (Iter->Pos < Iter->Wurzel->AnzEintraege)
+      return(&(Iter->Wurzel->Eintraege[Iter->Pos]));
+   else
+      return(NULL);
+}
+
+void HashInitIterator(HashIterator *Iter, HashTabelle *Wurzel)
+{
+   Iter->Wurzel = Wurzel;
+   Iter->Pos = 0;
+}
+
+HashKnoten HashFirst(HashIterator *Iter)
+{
+   Iter->Pos = 0;
+   return(Aktuell(Iter));
+}
+
+HashKnoten HashNext(HashIterator *Iter)
+{
+   Iter->Pos++;
+   return(Aktuell(Iter));
+}
+
+/* entfernt den aktuellen Eintrag und liefert den naechsten */
+HashKnoten HashIterRemove(HashIterator *Iter)
+{  HashKnoten Element;
+   unsigned long Slot;
+
+   Element = Aktuell(Iter);
+   if (Element == NULL)
+      return(NULL);
+   Slot = HashSucheSlot(Iter->Wurzel, Element->Key, Element->HashWert);
+   HashEntferne(Iter->Wurzel, Slot);
+   /* ohne Reihenfolge steht jetzt der letzte Eintrag an dieser Position */
+   return(Aktuell(Iter));
+}
@@ -0,0 +1,26 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash_int.h"
+
+void HashPurge(HashTabelle *Wurzel)
+{  unsigned long Pos;
+   HashKnoten Element;
+
+   for (Pos = 0; Pos < Wurzel->AnzEintraege; Pos++)
+   {
+      Element = &(Wurzel->Eintraege[Pos]);
+      if (!Element->Frei)
+      {
+         if ((Wurzel->DestroyKey != NULL) && (Element->Key != NULL))
+            Wurzel->DestroyKey(Element->Key);
+         if ((Wurzel->DestroyDaten != NULL) && (Element->Daten != NULL))
+            Wurzel->DestroyDaten(Element->Daten);
+      }
+   }
+   if (Wurzel->Index != NULL)
+      memset(Wurzel->Index, 0, Wurzel->AnzSlots * sizeof(unsigned long));
+   Wurzel->AnzEintraege = 0;
+   Wurzel->AnzBelegt = 0;
+   Wurzel->AnzGeloescht = 0;
+}
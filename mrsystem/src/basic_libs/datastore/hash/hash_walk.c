@@ -0,0 +1,71 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash.h"
+
+/* mit Geordnet in der Reihenfolge des Einfuegens */
+void HashWalk(HashTabelle *Wurzel, HashWalkCbFkt Cb, void *PrivData)
+{  unsigned long Pos;
+
+   for (Pos = 0; Pos < Wurzel->AnzEintraege; Pos++)
+   {
+      if (!Wurzel->Eintraege[Pos].Frei)
+         Cb(PrivData, &(Wurzel->Eintraege[Pos]));
+   }
+}
+
+/* Mergesort von unten, stabil und ohne Kontextzeiger fuer qsort */
+static void Sortiere(HashTabelle *Wurzel, HashKnoten *Feld, HashKnoten *Puffer,
+                     unsigned long Anzahl)
+{  unsigned long Breite, Links, Mitte, Rechts, i, j, k;
+
+   for (Breite = 1; Breite < Anzahl; Breite *= 2)
+   {
+      for (Links = 0; Links < Anzahl - Breite; Links += 2 * Breite)
+      {
+         Mitte = Links + Breite;
+         Rechts = Mitte + Breite < Anzahl ? Mitte + Breite : Anzahl;
+         i = Links;
+         j = Mitte;
+         k = Links;
+         while ((i < Mitte) && (j < Rechts))
+         {
+            if (Wurzel->Compare(Feld[j]->Key, Feld[i]->Key) < 0)
+               Puffer[k++] = Feld[j++];
+            else
+               Puffer[k++] = Feld[i++];
+         }
+         while (i < Mitte)
+            Puffer[k++] = Feld[i++];
+         while (j < Rechts)
+            Puffer[k++] = Feld[j++];
+         memcpy(&Feld[Links], &Puffer[Links], (Rechts - Links) * sizeof(HashKnoten));
+      }
+   }
+}
+
+/* aufsteigend nach Key wie AvlWalkAscend, ist kein Speicher fuer das
+   Feld frei, in der Reihenfolge von HashWalk */
+void HashWalkSortiert(HashTabelle *Wurzel, HashWalkCbFkt Cb, void *PrivData)
+{  HashKnoten *Feld;
+   unsigned long Pos, Anzahl;
+
+   if (Wurzel->AnzEintraege == 0)
+      return;
+   Feld = (HashKnoten *)malloc(2 * Wurzel->AnzEintraege * sizeof(HashKnoten));
+   if (Feld == NULL)
+   {
+      HashWalk(Wurzel, Cb, PrivData);
+      return;
+   }
+   Anzahl = 0;
+   for (Pos = 0; Pos < Wurzel->AnzEintraege; Pos++)
+   {
+      if (!Wurzel->Eintraege[Pos].Frei)
+         Feld[Anzahl++] = &(Wurzel->Eintraege[Pos]);
+   }
+   Sortiere(Wurzel, Feld, &Feld[Wurzel->AnzEintraege], Anzahl);
+   for (Pos = 0; Pos < Anzahl; Pos++)
+      Cb(PrivData, Feld[Pos]);
+   free(Feld);
+}
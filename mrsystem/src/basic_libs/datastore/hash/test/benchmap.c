@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <boolean.h>
+#include <map.h>
+
+/*
+* Map mit AVL Baum und mit Hash Tabelle vergleichen
+*
+* Wie in der zentrale werden Loks ueber ihren Namen gesucht. Zuerst werden
+* alle Loks eingetragen, dann wird zufaellig gesucht und ein Teil der Loks
+* neu eingetragen, wie beim Lesen einer geaenderten lokomotive.cs2.
+*/
+
+#define DEFAULT_LOKS   500
+#define DEFAULT_ROUNDS 2000
+#define NAME_LEN       17
+
+static double Seconds(void)
+{  struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+   return(Now.tv_sec + Now.tv_nsec / 1e9);
+}
+
+static int NameCompare(void *d1, void *d2)
+{
+   return(strcmp((char *)d1, (char *)d2));
+}
+
+static double Bench(Map *Loks, char *Namen, int NumLoks, int Rounds,
+                    unsigned long *Found)
+{  int i, j;
+   double Start;
+
+   MapInit(Loks, NameCompare, (MapKeyDelCbFkt)NULL, (MapDataDelCbFkt)NULL);
+   Start = Seconds();
+   for (i = 0; i < NumLoks; i++)
+      MapSet(Loks, &Namen[i * NAME_LEN], &Namen[i * NAME_LEN]);
+   srand(1);
+   for (j = 0; j < Rounds; j++)
+   {
+      for (i = 0; i < NumLoks; i++)
+      {
+         if (MapGet(Loks, &Namen[(rand() % NumLoks) * NAME_LEN]) != NULL)
+            (*Found)++;
+      }
+      i = rand() % NumLoks;
+      MapSet(Loks, &Namen[i * NAME_LEN], &Namen[i * NAME_LEN]);
+   }
+   return(Seconds() - Start);
+}
+
+int main(int argc, char *argv[])
+{  int NumLoks, Rounds, i, c;
+   char *Namen;
+   Map *Avl, *Hash;
+   unsigned long AvlFound, HashFound;
+   double AvlTime, HashTime;
+
+   NumLoks = DEFAULT_LOKS;
+   Rounds = DEFAULT_ROUNDS;
+   while ((c = getopt(argc, argv, "n:r:?")) != -1)
+   {
+      switch (c)
+      {
+         case 'n':
+            NumLoks = atoi(optarg);
+            break;
+         case 'r':
+            Rounds = atoi(optarg);
+            break;
+         default:
+            printf("%s [-n <loks>] [-r <rounds>]\n", argv[0]);
+            return(1);
+      }
+   }
+   Namen = (char *)malloc(NumLoks * NAME_LEN);
+   Avl = MapCreate();
+   Hash = MapCreateHash(HashString, FALSE);
+   if ((Namen == (char *)NULL) || (Avl == (Map *)NULL) ||
+       (Hash == (Map *)NULL))
+   {
+      puts("out of memory");
+      return(1);
+   }
+   for (i = 0; i < NumLoks; i++)
+      sprintf(&Namen[i * NAME_LEN], "BR %d %05d", 10 + i % 90, i);
+   AvlFound = 0;
+   HashFound = 0;
+   AvlTime = Bench(Avl, Namen, NumLoks, Rounds, &AvlFound);
+   HashTime = Bench(Hash, Namen, NumLoks, Rounds, &HashFound);
+   printf("%d loks, %lu lookups\n", NumLoks, (unsigned long)NumLoks * Rounds);
+   printf("avl:  %.3f s, %.0f lookups/s\n", AvlTime,
+          (double)NumLoks * Rounds / AvlTime);
+   printf("hash: %.3f s, %.0f lookups/s\n", HashTime,
+          (double)NumLoks * Rounds / HashTime);
+   if (AvlFound != HashFound)
+      printf("found %lu with avl and %lu with hash\n", AvlFound, HashFound);
+   MapDestroy(Avl);
+   MapDestroy(Hash);
+   free(Namen);
+   return(0);
+}
@@ -3,6 +3,7 @@
 
 #include <boolean.h>
 #include <avl.h>
+#include <hash.h>
 
 typedef void *MapKeyType;
 typedef void *MapDataType;
@@ -11,11 +12,15 @@ typedef void (*MapDataDelCbFkt)(MapDataType Daten);
 typedef void (*MapWalkCbFkt)(void *PrivData, MapKeyType Key, MapDataType Daten);
 typedef struct {
    AvlBaum *MapDaten;
+   HashTabelle *MapHash;
+   HashFkt Hash;
+   BOOL Geordnet;
    MapKeyDelCbFkt DestroyKey;
    MapDataDelCbFkt DestroyDaten;
 } Map;
 
 Map *MapCreate(void);
+Map *MapCreateHash(HashFkt Hash, BOOL Geordnet);
 void MapDestroy(Map *Wurzel);
 void MapInit(Map *Wurzel, CmpFkt Cmp, MapKeyDelCbFkt DestroyKeyCb, MapDataDelCbFkt DestroyDatenCb);
 BOOL MapSet(Map *Wurzel, MapKeyType Key, MapDataType Daten);
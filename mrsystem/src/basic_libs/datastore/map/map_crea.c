@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <boolean.h>
 #include <avl.h>
+#include <hash.h>
 #include "map.h"
 
 Map *MapCreate(void)
@@ -18,6 +19,34 @@ Map *MapCreate(void)
       }
       else
       {
+         NewMap->MapHash = (HashTabelle *)NULL;
+         NewMap->DestroyKey = NULL;
+         NewMap->DestroyDaten = NULL;
+      }
+   }
+   return(NewMap);
+}
+
+/* wie MapCreate, aber als Hashtabelle: MapGet braucht keine Vergleiche
+   entlang des Baums, dafuer muss MapWalkAscend die Eintraege erst nach
+   dem Key sortieren */
+Map *MapCreateHash(HashFkt Hash, BOOL Geordnet)
+{  Map *NewMap;
+
+   NewMap = (Map *)malloc(sizeof(Map));
+   if (NewMap != NULL)
+   {
+      NewMap->MapHash = HashCreate();
+      if (NewMap->MapHash == NULL)
+      {
+         free(NewMap);
+         NewMap = (Map *)NULL;
+      }
+      else
+      {
+         NewMap->MapDaten = (AvlBaum *)NULL;
+         NewMap->Hash = Hash;
+         NewMap->Geordnet = Geordnet;
          NewMap->DestroyKey = NULL;
          NewMap->DestroyDaten = NULL;
       }
@@ -2,9 +2,13 @@
 #include <stdlib.h>
 #include <boolean.h>
 #include <avl.h>
+#include <hash.h>
 #include "map.h"
 
 void MapDel(Map *Wurzel, MapKeyType Key)
 {
-   AvlDelete(Wurzel->MapDaten, (AvlKeyType)Key);
+   if (Wurzel->MapHash != NULL)
+      HashDelete(Wurzel->MapHash, (HashKeyType)Key);
+   else
+      AvlDelete(Wurzel->MapDaten, (AvlKeyType)Key);
 }
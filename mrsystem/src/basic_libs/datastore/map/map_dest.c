@@ -1,13 +1,17 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <avl.h>
+#include <hash.h>
 #include "map.h"
 
 void MapDestroy(Map *Wurzel)
 {
    if (Wurzel != NULL)
    {
-      AvlDestroy(Wurzel->MapDaten);
+      if (Wurzel->MapHash != NULL)
+         HashDestroy(Wurzel->MapHash);
+      else
+         AvlDestroy(Wurzel->MapDaten);
       free(Wurzel);
    }
 }
@@ -1,10 +1,24 @@
 #include <stddef.h>
 #include <avl.h>
+#include <hash.h>
 #include "map.h"
 
 MapDataType MapGet(Map *Wurzel, MapKeyType Key)
 {  AvlKnoten PresentData;
+   HashKnoten PresentHash;
 
+   if (Wurzel->MapHash != NULL)
+   {
+      PresentHash = HashFinde(Wurzel->MapHash, (HashKeyType)Key);
+      if (PresentHash != NULL)
+      {
+         return((MapDataType)PresentHash->Daten);
+      }
+      else
+      {
+         return((MapDataType)NULL);
+      }
+   }
    PresentData = AvlFinde(Wurzel->MapDaten, (AvlKeyType)Key);
    if (PresentData != NULL)
    {
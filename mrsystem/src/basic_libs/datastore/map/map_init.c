@@ -1,13 +1,23 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <avl.h>
+#include <hash.h>
 #include "map.h"
 
 void MapInit(Map *Wurzel, CmpFkt Cmp, MapKeyDelCbFkt DestroyKeyCb, MapDataDelCbFkt DestroyDatenCb)
 {
    Wurzel->DestroyKey = DestroyKeyCb;
    Wurzel->DestroyDaten = DestroyDatenCb;
-   AvlInit(Wurzel->MapDaten, Cmp,
-           (AvlKeyDelCbFkt)DestroyKeyCb,
-           (AvlDataDelCbFkt)DestroyDatenCb);
+   if (Wurzel->MapHash != NULL)
+   {
+      HashInit(Wurzel->MapHash, Wurzel->Hash, Cmp, Wurzel->Geordnet,
+               (HashKeyDelCbFkt)DestroyKeyCb,
+               (HashDataDelCbFkt)DestroyDatenCb);
+   }
+   else
+   {
+      AvlInit(Wurzel->MapDaten, Cmp,
+              (AvlKeyDelCbFkt)DestroyKeyCb,
+              (AvlDataDelCbFkt)DestroyDatenCb);
+   }
 }
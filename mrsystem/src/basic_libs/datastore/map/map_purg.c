@@ -1,12 +1,16 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <avl.h>
+#include <hash.h>
 #include "map.h"
 
 void MapPurge(Map *Wurzel)
 {
    if (Wurzel != NULL)
    {
-      AvlPurge(Wurzel->MapDaten);
+      if (Wurzel->MapHash != NULL)
+         HashPurge(Wurzel->MapHash);
+      else
+         AvlPurge(Wurzel->MapDaten);
    }
 }
@@ -2,10 +2,16 @@
 #include <stdlib.h>
 #include <boolean.h>
 #include <avl.h>
+#include <hash.h>
 #include "map.h"
 
 BOOL MapSet(Map *Wurzel, MapKeyType Key, MapDataType Daten)
 {
+   if (Wurzel->MapHash != NULL)
+   {
+      /* ersetzt einen vorhandenen Key an seiner Position */
+      return(HashInsert(Wurzel->MapHash, (HashKeyType)Key, (HashDataType)Daten));
+   }
    AvlDelete(Wurzel->MapDaten, (AvlKeyType)Key);
    return(AvlInsert(Wurzel->MapDaten, (AvlKeyType)Key, (AvlDataType)Daten));
 }
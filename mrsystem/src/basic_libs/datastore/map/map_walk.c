@@ -1,4 +1,6 @@
+#include <stddef.h>
 #include <avl.h>
+#include <hash.h>
 #include "map.h"
 
 typedef struct {
@@ -13,10 +15,19 @@ static void AvlWalkAscendCb(void *PrivData, AvlKnoten Element)
                                     Element->Key, Element->Daten);
 }
 
+static void HashWalkCb(void *PrivData, HashKnoten Element)
+{
+   ((WalkStruct *)PrivData)->WalkCb(((WalkStruct *)PrivData)->PrivData,
+                                    Element->Key, Element->Daten);
+}
+
 void MapWalkAscend(Map *Wurzel, MapWalkCbFkt Cb, void *PrivData)
 {  WalkStruct CbData;
 
    CbData.WalkCb = Cb;
    CbData.PrivData = PrivData;
-   AvlWalkAscend(Wurzel->MapDaten, AvlWalkAscendCb, &CbData);
+   if (Wurzel->MapHash != NULL)
+      HashWalkSortiert(Wurzel->MapHash, HashWalkCb, &CbData);
+   else
+      AvlWalkAscend(Wurzel->MapDaten, AvlWalkAscendCb, &CbData);
 }
@@ -4,19 +4,25 @@
 #include <boolean.h>
 #include <compare.h>
 #include <dliste.h>
+#include <hash.h>
 
 typedef void *MengeDataType;
 typedef void (*MengeDelCbFkt)(MengeDataType Daten);
 typedef struct {
    Dliste *MengeDaten;
+   HashTabelle *MengeHash;
+   HashFkt Hash;
+   BOOL Geordnet;
    CmpFkt Compare;
 } Menge;
 typedef struct {
    DlisteIterator Iter;
+   HashIterator HashIter;
    Menge *Wurzel;
 } MengeIterator;
 
 Menge *MengeCreate(void);
+Menge *MengeCreateHash(HashFkt Hash, BOOL Geordnet);
 void MengeDestroy(Menge *Wurzel);
 void MengeInit(Menge *Wurzel, CmpFkt Cmp, MengeDelCbFkt DestroyDatenCb);
 BOOL MengeAdd(Menge *Wurzel, MengeDataType Daten);
@@ -1,10 +1,18 @@
 #include <stddef.h>
 #include <boolean.h>
 #include <dliste.h>
+#include <hash.h>
 #include "menge.h"
 
 BOOL MengeAdd(Menge *Wurzel, MengeDataType Daten)
 {
+   if (Wurzel->MengeHash != NULL)
+   {
+      if (HashFinde(Wurzel->MengeHash, (HashKeyType)Daten) != NULL)
+         return(TRUE);
+      return(HashInsert(Wurzel->MengeHash,
+                        (HashKeyType)Daten, (HashDataType)Daten));
+   }
    return(DlisteAhead(Wurzel->MengeDaten,
                       (DlisteKeyType)NULL, (DlisteDataType)Daten));
 }
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <boolean.h>
 #include <dliste.h>
+#include <hash.h>
 #include "menge.h"
 
 Menge *MengeCreate(void)
@@ -10,6 +11,7 @@ Menge *MengeCreate(void)
    NewMenge = (Menge *)malloc(sizeof(Menge));
    if (NewMenge != NULL)
    {
+      NewMenge->MengeHash = (HashTabelle *)NULL;
       NewMenge->MengeDaten = DlisteCreate();
       if (NewMenge->MengeDaten == NULL)
       {
@@ -19,3 +21,24 @@ Menge *MengeCreate(void)
    }
    return(NewMenge);
 }
+
+/* wie MengeCreate, aber als Hashtabelle: MengeRemove muss nicht die Liste
+   durchsuchen, ein Element ist nur einmal enthalten */
+Menge *MengeCreateHash(HashFkt Hash, BOOL Geordnet)
+{  Menge *NewMenge;
+
+   NewMenge = (Menge *)malloc(sizeof(Menge));
+   if (NewMenge != NULL)
+   {
+      NewMenge->MengeDaten = (Dliste *)NULL;
+      NewMenge->Hash = Hash;
+      NewMenge->Geordnet = Geordnet;
+      NewMenge->MengeHash = HashCreate();
+      if (NewMenge->MengeHash == NULL)
+      {
+         free(NewMenge);
+         NewMenge = (Menge *)NULL;
+      }
+   }
+   return(NewMenge);
+}
@@ -1,13 +1,17 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <dliste.h>
+#include <hash.h>
 #include "menge.h"
 
 void MengeDestroy(Menge *Wurzel)
 {
    if (Wurzel != NULL)
    {
-      DlisteDestroy(Wurzel->MengeDaten);
+      if (Wurzel->MengeHash != NULL)
+         HashDestroy(Wurzel->MengeHash);
+      else
+         DlisteDestroy(Wurzel->MengeDaten);
       free(Wurzel);
    }
 }
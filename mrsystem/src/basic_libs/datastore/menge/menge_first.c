@@ -1,10 +1,18 @@
 #include <stddef.h>
 #include <dliste.h>
+#include <hash.h>
 #include "menge.h"
 
 MengeDataType MengeFirst(MengeIterator *Iter)
 {  DlisteKnoten FirstNode;
+   HashKnoten HashNode;
 
+   if (Iter->Wurzel->MengeHash != NULL)
+   {
+      HashNode = HashFirst(&(Iter->HashIter));
+      return(HashNode != NULL ? (MengeDataType)HashNode->Daten :
+                                (MengeDataType)NULL);
+   }
    FirstNode = DlisteFirst(&(Iter->Iter));
    if (FirstNode != (DlisteKnoten)NULL)
    {
@@ -1,10 +1,18 @@
 #include <stddef.h>
 #include <dliste.h>
+#include <hash.h>
 #include "menge.h"
 
 MengeDataType MengeIterRemove(MengeIterator *Iter)
 {  DlisteKnoten NextNode;
+   HashKnoten HashNode;
 
+   if (Iter->Wurzel->MengeHash != NULL)
+   {
+      HashNode = HashIterRemove(&(Iter->HashIter));
+      return(HashNode != NULL ? (MengeDataType)HashNode->Daten :
+                                (MengeDataType)NULL);
+   }
    NextNode = DlisteRemove(&(Iter->Iter));
    if (NextNode != NULL)
    {
@@ -2,10 +2,14 @@
 #include <stdlib.h>
 #include <compare.h>
 #include <dliste.h>
+#include <hash.h>
 #include "menge.h"
 
 void MengeInitIterator(MengeIterator *Iter, Menge *Wurzel)
 {
-   DlisteInitIterator(&(Iter->Iter), Wurzel->MengeDaten);
+   if (Wurzel->MengeHash != NULL)
+      HashInitIterator(&(Iter->HashIter), Wurzel->MengeHash);
+   else
+      DlisteInitIterator(&(Iter->Iter), Wurzel->MengeDaten);
    Iter->Wurzel = Wurzel;
 }
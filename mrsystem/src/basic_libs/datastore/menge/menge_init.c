@@ -2,12 +2,21 @@
 #include <stdlib.h>
 #include <compare.h>
 #include <dliste.h>
+#include <hash.h>
 #include "menge.h"
 
 void MengeInit(Menge *Wurzel, CmpFkt Cmp, MengeDelCbFkt DestroyDatenCb)
 {
-   DlisteInit(Wurzel->MengeDaten, (CmpFkt)NULL,
-              (DlisteKeyDelCbFkt)NULL,
-              (DlisteDataDelCbFkt)DestroyDatenCb);
+   if (Wurzel->MengeHash != NULL)
+   {
+      HashInit(Wurzel->MengeHash, Wurzel->Hash, Cmp, Wurzel->Geordnet,
+               (HashKeyDelCbFkt)NULL, (HashDataDelCbFkt)DestroyDatenCb);
+   }
+   else
+   {
+      DlisteInit(Wurzel->MengeDaten, (CmpFkt)NULL,
+                 (DlisteKeyDelCbFkt)NULL,
+                 (DlisteDataDelCbFkt)DestroyDatenCb);
+   }
    Wurzel->Compare = Cmp;
 }
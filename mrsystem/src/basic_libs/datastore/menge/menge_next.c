@@ -1,10 +1,18 @@
 #include <stddef.h>
 #include <dliste.h>
+#include <hash.h>
 #include "menge.h"
 
 MengeDataType MengeNext(MengeIterator *Iter)
 {  DlisteKnoten NextNode;
+   HashKnoten HashNode;
 
+   if (Iter->Wurzel->MengeHash != NULL)
+   {
+      HashNode = HashNext(&(Iter->HashIter));
+      return(HashNode != NULL ? (MengeDataType)HashNode->Daten :
+                                (MengeDataType)NULL);
+   }
    NextNode = DlisteNext(&(Iter->Iter));
    if (NextNode != NULL)
    {
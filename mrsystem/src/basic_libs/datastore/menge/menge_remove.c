@@ -1,12 +1,18 @@
 #include <stddef.h>
 #include <compare.h>
 #include <dliste.h>
+#include <hash.h>
 #include "menge.h"
 
 void MengeRemove(Menge *Wurzel, MengeDataType Daten)
 {  DlisteKnoten WorkPtr;
    DlisteIterator Iter;
 
+   if (Wurzel->MengeHash != NULL)
+   {
+      HashDelete(Wurzel->MengeHash, (HashKeyType)Daten);
+      return;
+   }
    DlisteInitIterator(&Iter, Wurzel->MengeDaten);
    WorkPtr = DlisteFirst(&Iter);
    while ((WorkPtr != NULL) &&
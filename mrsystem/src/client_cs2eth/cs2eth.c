@@ -40,6 +40,7 @@ Cs2ethStruct *Cs2ethCreate(void)
             Cs2ethSetInterface(Data, "");
             Cs2ethSetServerPort(Data, -1);
             Cs2ethSetClientSock(Data, -1);
+            Cs2ethSetShm(Data, (MrIpcShmType *)NULL);
          }
          else
          {
@@ -100,6 +101,7 @@ void Cs2ethInit(Cs2ethStruct *Data, BOOL Verbose, char *Iface, char *Addr,
    Cs2ethSetBcIp(Data, BcAddr);
    Cs2ethSetServerPort(Data, Port);
    Cs2ethSetClientSock(Data, -1);
+   Cs2ethSetShm(Data, (MrIpcShmType *)NULL);
    Cs2ethSetOutsideUdpSock(Data, -1);
    Cs2ethSetOutsideTcpSock(Data, -1);
    memset((void *)(&(Cs2ethGetClientAddr(Data))), 0,
@@ -133,6 +135,8 @@ static BOOL Start(Cs2ethStruct *Data)
    }
    if (Cs2ethGetClientSock(Data) >= 0)
    {
+      Cs2ethSetShm(Data, MrIpcShmAttach(Cs2ethGetClientSock(Data),
+                                       Cs2ethGetServerPort(Data)));
       if (Cs2ethGetVerbose(Data))
          puts("start mrcs2eth: start tcp server");
       Cs2ethSetOutsideTcpSock(Data, MrEthCs2StartAppServer());
@@ -207,6 +211,8 @@ static void Stop(Cs2ethStruct *Data)
       OneClient = (ClientInfo *)MengeNext(Cs2ethGetClientIter(Data));
    }
    MrIpcClose(Cs2ethGetClientSock(Data));
+   MrIpcShmDetach(Cs2ethGetShm(Data));
+   Cs2ethSetShm(Data, (MrIpcShmType *)NULL);
    MrEthCs2Close(Cs2ethGetOutsideUdpSock(Data));
    MrEthCs2Close(Cs2ethGetOutsideTcpSock(Data));
 }
@@ -279,7 +285,8 @@ static void HandleSystemData(Cs2ethStruct *Data)
    if (Cs2ethGetVerbose(Data))
       puts("new data available");
    MrIpcInit(&CmdFrame);
-   RcvReturnValue = MrIpcRecv(Cs2ethGetClientSock(Data), &CmdFrame);
+   RcvReturnValue = MrIpcShmRecv(Cs2ethGetShm(Data),
+                                 Cs2ethGetClientSock(Data), &CmdFrame);
    if (RcvReturnValue == MR_IPC_RCV_ERROR)
    {
       if (Cs2ethGetVerbose(Data))
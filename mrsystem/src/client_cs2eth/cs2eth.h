@@ -4,6 +4,7 @@
 #include <arpa/inet.h>
 #include <menge.h>
 #include <boolean.h>
+#include <mr_ipc.h>
 
 typedef struct {
    BOOL Verbosity;
@@ -17,6 +18,7 @@ typedef struct {
    char BcIp[20];
    int ServerPort;
    int ClientSock;
+   MrIpcShmType *Shm;
    int OutsideUdpSock;
    int OutsideTcpSock;
    struct sockaddr_in ClientAddr;
@@ -35,6 +37,7 @@ typedef struct {
 #define Cs2ethSetBcIp(Data, IpAddr)         strcpy((Data)->BcIp,IpAddr)
 #define Cs2ethSetServerPort(Data, Port)     (Data)->ServerPort=Port
 #define Cs2ethSetClientSock(Data, Sock)     (Data)->ClientSock=Sock
+#define Cs2ethSetShm(Data, Ipc)             (Data)->Shm=Ipc
 #define Cs2ethSetOutsideUdpSock(Data, Sock) (Data)->OutsideUdpSock=Sock
 #define Cs2ethSetOutsideTcpSock(Data, Sock) (Data)->OutsideTcpSock=Sock
 #define Cs2ethSetClients(Data, Client)      (Data)->Clients=Client
@@ -51,6 +54,7 @@ typedef struct {
 #define Cs2ethGetBcIp(Data)           (Data)->BcIp
 #define Cs2ethGetServerPort(Data)     (Data)->ServerPort
 #define Cs2ethGetClientSock(Data)     (Data)->ClientSock
+#define Cs2ethGetShm(Data)            (Data)->Shm
 #define Cs2ethGetOutsideUdpSock(Data) (Data)->OutsideUdpSock
 #define Cs2ethGetOutsideTcpSock(Data) (Data)->OutsideTcpSock
 #define Cs2ethGetClientAddr(Data)     (Data)->ClientAddr
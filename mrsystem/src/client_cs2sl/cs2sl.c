@@ -2,7 +2,6 @@
 #include <stdio.h>
 #include <time.h>
 #include <signal.h>
-#include <sys/select.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <linux/can.h>
@@ -14,7 +13,7 @@
 #include <cs2.h>
 #include "cs2sl.h"
 
-#define SELECT_TIMEOUT 100
+#define LOOP_TIMEOUT 100
 #define MAX_DATAGRAM_SIZE 4096
 #define DEVICE_ID 0xFFFF
 
@@ -26,10 +25,20 @@ Cs2slStruct *Cs2slCreate(void)
    Data = (Cs2slStruct *)malloc(sizeof(Cs2slStruct));
    if (Data != (Cs2slStruct *)NULL)
    {
-      Cs2slSetVerbose(Data, FALSE);
-      Cs2slSetInterface(Data, (char *)NULL);
-      Cs2slSetServerPort(Data, -1);
-      Cs2slSetClientSock(Data, -1);
+      Cs2slSetEventLoop(Data, MrIpcLoopCreate());
+      if (Cs2slGetEventLoop(Data) != (MrIpcLoopType *)NULL)
+      {
+         Cs2slSetVerbose(Data, FALSE);
+         Cs2slSetInterface(Data, (char *)NULL);
+         Cs2slSetServerPort(Data, -1);
+         Cs2slSetClientSock(Data, -1);
+         Cs2slSetShm(Data, (MrIpcShmType *)NULL);
+      }
+      else
+      {
+         free(Data);
+         Data = (Cs2slStruct *)NULL;
+      }
    }
    return(Data);
 }
@@ -38,6 +47,7 @@ void Cs2slDestroy(Cs2slStruct *Data)
 {
    if (Cs2slGetVerbose(Data))
       puts("destroy mrCs2sl");
+   MrIpcLoopDestroy(Cs2slGetEventLoop(Data));
    free(Data);
 }
 
@@ -58,6 +68,7 @@ void Cs2slInit(Cs2slStruct *Data, BOOL Verbose, char *Iface, char *Addr,
    Cs2slSetAddress(Data, Addr);
    Cs2slSetServerPort(Data, Port);
    Cs2slSetClientSock(Data, -1);
+   Cs2slSetShm(Data, (MrIpcShmType *)NULL);
    Cs2slSetIoFunctions(Data, IoFunctions);
 }
 
@@ -87,6 +98,8 @@ static BOOL Start(Cs2slStruct *Data)
    }
    if (Cs2slGetClientSock(Data) >= 0)
    {
+      Cs2slSetShm(Data, MrIpcShmAttach(Cs2slGetClientSock(Data),
+                                      Cs2slGetServerPort(Data)));
       if (Cs2slGetVerbose(Data))
          puts("start mrCs2sl; start udp client");
       if (Cs2slGetIoFunctions(Data)->Open(Cs2slGetIoFunctions(Data)->private))
@@ -117,7 +130,10 @@ static void Stop(Cs2slStruct *Data)
 {
    if (Cs2slGetVerbose(Data))
       puts("stop mrCs2sl");
+   MrIpcLoopRemoveFd(Cs2slGetEventLoop(Data), Cs2slGetClientSock(Data));
    MrIpcClose(Cs2slGetClientSock(Data));
+   MrIpcShmDetach(Cs2slGetShm(Data));
+   Cs2slSetShm(Data, (MrIpcShmType *)NULL);
    Cs2slGetIoFunctions(Data)->Close(Cs2slGetIoFunctions(Data)->private);
 }
 
@@ -162,7 +178,8 @@ static void HandleSystemData(Cs2slStruct *Data)
    if (Cs2slGetVerbose(Data))
       puts("new data available");
    MrIpcInit(&CmdFrame);
-   RcvReturnValue = MrIpcRecv(Cs2slGetClientSock(Data), &CmdFrame);
+   RcvReturnValue = MrIpcShmRecv(Cs2slGetShm(Data),
+                                 Cs2slGetClientSock(Data), &CmdFrame);
    if (RcvReturnValue == MR_IPC_RCV_ERROR)
    {
       if (Cs2slGetVerbose(Data))
@@ -228,40 +245,45 @@ static void HandleOutsideData(Cs2slStruct *Data, int Fd)
    }
 }
 
+static void SystemData(void *PrivData, int Fd)
+{  Cs2slStruct *Data;
+
+   Data = (Cs2slStruct *)PrivData;
+   if (Cs2slGetVerbose(Data))
+      puts("data on cmd socket to drehscheibe");
+   HandleSystemData(Data);
+}
+
+static void OutsideData(void *PrivData, int Fd)
+{  Cs2slStruct *Data;
+
+   Data = (Cs2slStruct *)PrivData;
+   HandleOutsideData(Data, Fd);
+   /* the outside fds change only while reading from outside */
+   MrIpcLoopSyncFds(Cs2slGetEventLoop(Data), Cs2slGetIoFunctions(Data)->GetFd,
+                    Cs2slGetIoFunctions(Data)->private, OutsideData, (void *)Data);
+}
+
 void Cs2slRun(Cs2slStruct *Data)
-{  fd_set ReadFds;
-   int RetVal, HighFd, IoFd;
-   struct timeval SelectTimeout;
+{  int RetVal;
    time_t Now;
 
    if (Start(Data))
    {
       if (Cs2slGetVerbose(Data))
          puts("run mrCs2sl");
+      MrIpcLoopAddFd(Cs2slGetEventLoop(Data), Cs2slGetClientSock(Data),
+                     SystemData, (void *)Data);
+      MrIpcLoopSyncFds(Cs2slGetEventLoop(Data), Cs2slGetIoFunctions(Data)->GetFd,
+                       Cs2slGetIoFunctions(Data)->private, OutsideData, (void *)Data);
       while (Loop)
       {
-         FD_ZERO(&ReadFds);
-         HighFd = 0;
-         if (Cs2slGetVerbose(Data))
-            printf("add client socket %d\n", Cs2slGetClientSock(Data));
-         FD_SET(Cs2slGetClientSock(Data), &ReadFds);
-         if (Cs2slGetClientSock(Data) > HighFd)
-            HighFd = Cs2slGetClientSock(Data);
-         while ((IoFd = Cs2slGetIoFunctions(Data)->GetFd(Cs2slGetIoFunctions(Data)->private)) != IOFKT_INVALID_FD)
-         {
-            if (Cs2slGetVerbose(Data))
-               printf("add outside socket %d\n", IoFd);
-            FD_SET(IoFd, &ReadFds);
-            if (IoFd > HighFd)
-               HighFd = IoFd;
-         }
-         SelectTimeout.tv_sec = SELECT_TIMEOUT;
-         SelectTimeout.tv_usec = 0;
          if (Cs2slGetVerbose(Data))
-            printf("wait for %d fd, max %ld s\n", HighFd, SelectTimeout.tv_sec);
-         RetVal = select(HighFd + 1, &ReadFds, NULL, NULL, &SelectTimeout);
+            printf("wait for data, max %d s\n", LOOP_TIMEOUT);
+         RetVal = MrIpcLoopRunOnce(Cs2slGetEventLoop(Data),
+                                   LOOP_TIMEOUT * 1000);
          if (Cs2slGetVerbose(Data))
-            printf("select liefert %d\n", RetVal);
+            printf("epoll liefert %d\n", RetVal);
          if (((RetVal == -1) && (errno == EINTR)) || (RetVal == 0))
          {
             Now = time(NULL);
@@ -274,22 +296,6 @@ void Cs2slRun(Cs2slStruct *Data)
                puts("error in main loop");
             Loop = FALSE;
          }
-         else
-         {
-            if (FD_ISSET(Cs2slGetClientSock(Data), &ReadFds))
-            {
-               if (Cs2slGetVerbose(Data))
-                  puts("data on cmd socket to drehscheibe");
-               HandleSystemData(Data);
-            }
-            while ((IoFd = Cs2slGetIoFunctions(Data)->GetFd(Cs2slGetIoFunctions(Data)->private)) != IOFKT_INVALID_FD)
-            {
-               if (FD_ISSET(IoFd, &ReadFds))
-               {
-                  HandleOutsideData(Data, IoFd);
-               }
-            }
-         }
       }
       Stop(Data);
    }
@@ -3,6 +3,7 @@
 
 #include <arpa/inet.h>
 #include <boolean.h>
+#include <mr_ipc.h>
 #include "can_io.h"
 
 typedef struct {
@@ -14,7 +15,9 @@ typedef struct {
    char *Address;
    int ServerPort;
    int ClientSock;
+   MrIpcShmType *Shm;
    IoFktStruct *IoFunctions;
+   MrIpcLoopType *EventLoop;
 } Cs2slStruct;
 
 #define Cs2slSetVerbose(Data, Verbose)     (Data)->Verbosity=Verbose
@@ -25,7 +28,9 @@ typedef struct {
 #define Cs2slSetAddress(Data, Addr)        (Data)->Address=Addr
 #define Cs2slSetServerPort(Data, Port)     (Data)->ServerPort=Port
 #define Cs2slSetClientSock(Data, Sock)     (Data)->ClientSock=Sock
+#define Cs2slSetShm(Data, Ipc)             (Data)->Shm=Ipc
 #define Cs2slSetIoFunctions(Data, Fkts)    (Data)->IoFunctions=Fkts
+#define Cs2slSetEventLoop(Data, Loop)      (Data)->EventLoop=Loop
 
 #define Cs2slGetVerbose(Data)       (Data)->Verbosity
 #ifdef TRACE
@@ -35,7 +40,9 @@ typedef struct {
 #define Cs2slGetAddress(Data)        (Data)->Address
 #define Cs2slGetServerPort(Data)     (Data)->ServerPort
 #define Cs2slGetClientSock(Data)     (Data)->ClientSock
+#define Cs2slGetShm(Data)            (Data)->Shm
 #define Cs2slGetIoFunctions(Data)    (Data)->IoFunctions
+#define Cs2slGetEventLoop(Data)      (Data)->EventLoop
 
 Cs2slStruct *Cs2slCreate(void);
 void Cs2slDestroy(Cs2slStruct *Data);
@@ -377,6 +377,14 @@ int main(int argc, char **argv) {
 	fprintf(stderr, "UDP set broadcast option error: %s\n", strerror(errno));
 	exit(EXIT_FAILURE);
     }
+#else
+    {
+	MrIpcSubscriptionType subscription;
+
+	/* we only send s88 events and never read the socket */
+	MrIpcSubscriptionInit(&subscription, FALSE);
+	MrIpcSubscribe(s88_data.socket, &subscription);
+    }
 #endif
 
     if (destination_second_port) {
@@ -25,6 +25,7 @@ LogStruct *LogCreate(void)
       LogSetInterface(Data, (char *)NULL);
       LogSetServerPort(Data, -1);
       LogSetClientSock(Data, -1);
+      LogSetShm(Data, (MrIpcShmType *)NULL);
    }
    return(Data);
 }
@@ -44,6 +45,7 @@ void LogInit(LogStruct *Data, BOOL Verbose, char *Interface, char *Addr,
    LogSetAddress(Data, Addr);
    LogSetServerPort(Data, Port);
    LogSetClientSock(Data, -1);
+   LogSetShm(Data, (MrIpcShmType *)NULL);
 }
 
 static void SigHandler(int sig)
@@ -70,6 +72,8 @@ static BOOL Start(LogStruct *Data)
    }
    if (LogGetClientSock(Data) >= 0)
    {
+      LogSetShm(Data, MrIpcShmAttach(LogGetClientSock(Data),
+                                    LogGetServerPort(Data)));
       if (LogGetVerbose(Data))
          puts("ready for incoming comands");
       SigStruct.sa_handler = SigHandler;
@@ -93,6 +97,8 @@ static void Stop(LogStruct *Data)
    if (LogGetClientSock(Data) >= 0)
    {
       MrIpcClose(LogGetClientSock(Data));
+      MrIpcShmDetach(LogGetShm(Data));
+      LogSetShm(Data, (MrIpcShmType *)NULL);
    }
 }
 
@@ -307,7 +313,8 @@ static void HandleSystemData(LogStruct *Data)
       puts("new data available");
    do {
       MrIpcInit(&CmdFrame);
-      RcvReturnValue = MrIpcRecv(LogGetClientSock(Data), &CmdFrame);
+      RcvReturnValue = MrIpcShmRecv(LogGetShm(Data),
+                                    LogGetClientSock(Data), &CmdFrame);
       if (RcvReturnValue == MR_IPC_RCV_ERROR)
       {
          if (LogGetVerbose(Data))
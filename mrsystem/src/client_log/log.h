@@ -2,6 +2,7 @@
 #define LOG_H
 
 #include <boolean.h>
+#include <mr_ipc.h>
 
 typedef struct {
    BOOL Verbosity;
@@ -9,6 +10,7 @@ typedef struct {
    char *Address;
    int ServerPort;
    int ClientSock;
+   MrIpcShmType *Shm;
 } LogStruct;
 
 #define LogSetVerbose(Data, Verbose) (Data)->Verbosity=Verbose
@@ -16,12 +18,14 @@ typedef struct {
 #define LogSetAddress(Data, Addr)    (Data)->Address=Addr
 #define LogSetServerPort(Data, Port) (Data)->ServerPort=Port
 #define LogSetClientSock(Data, Sock) (Data)->ClientSock=Sock
+#define LogSetShm(Data, Ipc)         (Data)->Shm=Ipc
 
 #define LogGetVerbose(Data)    (Data)->Verbosity
 #define LogGetInterface(Data)  (Data)->Interface
 #define LogGetAddress(Data)    (Data)->Address
 #define LogGetServerPort(Data) (Data)->ServerPort
 #define LogGetClientSock(Data) (Data)->ClientSock
+#define LogGetShm(Data)        (Data)->Shm
 
 LogStruct *LogCreate(void);
 void LogDestroy(LogStruct *Data);
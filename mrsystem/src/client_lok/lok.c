@@ -255,6 +255,7 @@ static void SigHandler(int sig)
 
 static BOOL Start(LokStruct *Data)
 {  struct sigaction SigStruct;
+   MrIpcSubscriptionType Subscription;
 
    if ((strlen(LokGetInterface(Data)) > 0) &&
        ((strlen(LokGetAddress(Data)) == 0) ||
@@ -272,6 +273,10 @@ static BOOL Start(LokStruct *Data)
    }
    if (LokGetClientSock(Data) >= 0)
    {
+      /* only function commands are handled, do not wake up for the rest */
+      MrIpcSubscriptionInit(&Subscription, FALSE);
+      MrIpcSubscriptionSetCmd(&Subscription, MrIpcCmdLocomotiveFunction);
+      MrIpcSubscribe(LokGetClientSock(Data), &Subscription);
       if (LokGetVerbose(Data))
          puts("ready for incoming comands");
       SigStruct.sa_handler = SigHandler;
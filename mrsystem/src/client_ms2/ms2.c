@@ -27,6 +27,7 @@ Ms2Struct *Ms2Create(void)
       Ms2SetInterface(Data, (char *)NULL);
       Ms2SetServerPort(Data, -1);
       Ms2SetClientSock(Data, -1);
+      Ms2SetShm(Data, (MrIpcShmType *)NULL);
       Ms2SetCanName(Data, (char *)NULL);
       Ms2SetCanSock(Data, -1);
       Ms2SetZentraleMode(Data, MASTER_MODE_MS2_MASTER);
@@ -49,6 +50,7 @@ void Ms2Init(Ms2Struct *Data, BOOL Verbose, char *Interface, char *Addr,
    Ms2SetAddress(Data, Addr);
    Ms2SetServerPort(Data, Port);
    Ms2SetClientSock(Data, -1);
+   Ms2SetShm(Data, (MrIpcShmType *)NULL);
    Ms2SetCanSock(Data, -1);
    Ms2SetCanName(Data, CanIf);
    Ms2SetZentraleMode(Data, ZentraleMode);
@@ -59,6 +61,24 @@ static void SigHandler(int sig)
    Loop = FALSE;
 }
 
+static void Subscribe(Ms2Struct *Data)
+{  MrIpcSubscriptionType Subscription;
+
+   /* only a proxy sends config data and bootloader frames to the MS2 */
+   MrIpcSubscriptionInit(&Subscription, TRUE);
+   if (Ms2GetZentraleMode(Data) != MASTER_MODE_PROXY)
+   {
+      MrIpcSubscriptionClrCmd(&Subscription, MrIpcCmdMember);
+      MrIpcSubscriptionClrCmd(&Subscription, MrIpcCmdRequestFile);
+      MrIpcSubscriptionClrCmd(&Subscription, MrIpcCmdCfgHeader);
+      MrIpcSubscriptionClrCmd(&Subscription, MrIpcCmdCfgZHeader);
+      MrIpcSubscriptionClrCmd(&Subscription, MrIpcCmdCfgData);
+      MrIpcSubscriptionClrCmd(&Subscription, MrIpcCmdCanBootldrGeb);
+      MrIpcSubscriptionClrCanCmd(&Subscription, MR_CS2_CMD_BOOTLDR_CAN);
+   }
+   MrIpcSubscribe(Ms2GetClientSock(Data), &Subscription);
+}
+
 static BOOL Start(Ms2Struct *Data)
 {  struct sigaction SigStruct;
 
@@ -80,6 +100,9 @@ static BOOL Start(Ms2Struct *Data)
    }
    if (Ms2GetClientSock(Data) >= 0)
    {
+      Ms2SetShm(Data, MrIpcShmAttach(Ms2GetClientSock(Data),
+                                    Ms2GetServerPort(Data)));
+      Subscribe(Data);
       if (Ms2GetVerbose(Data))
          puts("start mrm2: open can socket");
       Ms2SetCanSock(Data, MrMs2Connect(Ms2GetCanName(Data)));
@@ -113,6 +136,8 @@ static void Stop(Ms2Struct *Data)
    if (Ms2GetVerbose(Data))
       puts("stop network client");
    MrIpcClose(Ms2GetClientSock(Data));
+   MrIpcShmDetach(Ms2GetShm(Data));
+   Ms2SetShm(Data, (MrIpcShmType *)NULL);
    MrMs2Close(Ms2GetCanSock(Data));
 }
 
@@ -243,7 +268,8 @@ static void HandleSystemData(Ms2Struct *Data)
    if (Ms2GetVerbose(Data))
       puts("new data available");
    MrIpcInit(&CmdFrame);
-   RcvReturnValue = MrIpcRecv(Ms2GetClientSock(Data), &CmdFrame);
+   RcvReturnValue = MrIpcShmRecv(Ms2GetShm(Data),
+                                 Ms2GetClientSock(Data), &CmdFrame);
    if (RcvReturnValue == MR_IPC_RCV_ERROR)
    {
       if (Ms2GetVerbose(Data))
@@ -3,6 +3,7 @@
 
 #include <arpa/inet.h>
 #include <boolean.h>
+#include <mr_ipc.h>
 
 #define MASTER_MODE_PROXY      0
 #define MASTER_MODE_MS2_MASTER 1
@@ -14,6 +15,7 @@ typedef struct {
    char *Address;
    int ServerPort;
    int ClientSock;
+   MrIpcShmType *Shm;
    char *CanName;
    int CanSock;
    int ZentraleMode;
@@ -24,6 +26,7 @@ typedef struct {
 #define Ms2SetAddress(Data, Addr)          (Data)->Address=Addr
 #define Ms2SetServerPort(Data, Port)       (Data)->ServerPort=Port
 #define Ms2SetClientSock(Data, Sock)       (Data)->ClientSock=Sock
+#define Ms2SetShm(Data, Ipc)               (Data)->Shm=Ipc
 #define Ms2SetCanName(Data, Name)          (Data)->CanName=Name
 #define Ms2SetCanSock(Data, Sock)          (Data)->CanSock=Sock
 #define Ms2SetZentraleMode(Data, Zentrale) (Data)->ZentraleMode=Zentrale
@@ -33,6 +36,7 @@ typedef struct {
 #define Ms2GetAddress(Data)      (Data)->Address
 #define Ms2GetServerPort(Data)   (Data)->ServerPort
 #define Ms2GetClientSock(Data)   (Data)->ClientSock
+#define Ms2GetShm(Data)          (Data)->Shm
 #define Ms2GetCanName(Data)      (Data)->CanName
 #define Ms2GetCanSock(Data)      (Data)->CanSock
 #define Ms2GetZentraleMode(Data) (Data)->ZentraleMode
@@ -0,0 +1,170 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <boolean.h>
+#include <map.h>
+#include "zfile.h"
+#include "cfgcache.h"
+
+/* the compressed cs2 files are kept until the file changes on disk or the
+   zentrale writes it, so a request only deflates a file after a change */
+
+static void CfgCacheEntryDestroy(CfgCacheEntry *Entry)
+{
+   ZFileExit(CfgCacheEntryGetPacked(Entry));
+   ZFileDestroy(CfgCacheEntryGetPacked(Entry));
+   free(Entry);
+}
+
+CfgCacheStruct *CfgCacheCreate(void)
+{  CfgCacheStruct *NewData;
+
+   NewData = (CfgCacheStruct *)malloc(sizeof(CfgCacheStruct));
+   if (NewData != (CfgCacheStruct *)NULL)
+   {
+      CfgCacheSetLocPath(NewData, (char *)NULL);
+      CfgCacheSetDateien(NewData, MapCreateHash(HashString, FALSE));
+      if (CfgCacheGetDateien(NewData) == (Map *)NULL)
+      {
+         free(NewData);
+         NewData = (CfgCacheStruct *)NULL;
+      }
+   }
+   return(NewData);
+}
+
+void CfgCacheDestroy(CfgCacheStruct *Data)
+{
+   if (CfgCacheGetDateien(Data) != (Map *)NULL)
+      MapDestroy(CfgCacheGetDateien(Data));
+   free(Data);
+}
+
+void CfgCacheInit(CfgCacheStruct *Data, char *LocPath)
+{
+   CfgCacheSetLocPath(Data, LocPath);
+   MapInit(CfgCacheGetDateien(Data), (CmpFkt)strcmp,
+           (MapKeyDelCbFkt)free, (MapDataDelCbFkt)CfgCacheEntryDestroy);
+}
+
+void CfgCacheExit(CfgCacheStruct *Data)
+{
+   CfgCacheClear(Data);
+}
+
+static BOOL IsUpToDate(CfgCacheEntry *Entry, struct stat *Attribut)
+{
+   return((CfgCacheEntryGetMTime(Entry) == Attribut->st_mtim.tv_sec) &&
+          (CfgCacheEntryGetMTimeNsec(Entry) == Attribut->st_mtim.tv_nsec) &&
+          (CfgCacheEntryGetSize(Entry) == Attribut->st_size) &&
+          (CfgCacheEntryGetInode(Entry) == Attribut->st_ino));
+}
+
+static CfgCacheEntry *Compress(char *FullPath)
+{  CfgCacheEntry *Entry;
+   struct stat Attribut;
+   char *Daten;
+   int Fd;
+   ssize_t Gelesen, Len;
+
+   Entry = (CfgCacheEntry *)NULL;
+   Fd = open(FullPath, O_RDONLY);
+   if (Fd < 0)
+      return(Entry);
+   if ((fstat(Fd, &Attribut) == 0) && (Attribut.st_size > 0))
+   {
+      Daten = (char *)malloc(Attribut.st_size);
+      if (Daten != (char *)NULL)
+      {
+         Len = 0;
+         while (Len < Attribut.st_size)
+         {
+            Gelesen = read(Fd, Daten + Len, Attribut.st_size - Len);
+            if (Gelesen <= 0)
+               break;
+            Len += Gelesen;
+         }
+         Entry = (CfgCacheEntry *)malloc(sizeof(CfgCacheEntry));
+         if (Entry != (CfgCacheEntry *)NULL)
+         {
+            CfgCacheEntrySetMTime(Entry, Attribut.st_mtim.tv_sec);
+            CfgCacheEntrySetMTimeNsec(Entry, Attribut.st_mtim.tv_nsec);
+            CfgCacheEntrySetSize(Entry, Attribut.st_size);
+            CfgCacheEntrySetInode(Entry, Attribut.st_ino);
+            CfgCacheEntrySetPacked(Entry, ZFileCreate());
+            if ((Len <= 0) ||
+                (CfgCacheEntryGetPacked(Entry) == (ZlibFile *)NULL))
+            {
+               if (CfgCacheEntryGetPacked(Entry) != (ZlibFile *)NULL)
+                  ZFileDestroy(CfgCacheEntryGetPacked(Entry));
+               free(Entry);
+               Entry = (CfgCacheEntry *)NULL;
+            }
+            else
+            {
+               ZFileInit(CfgCacheEntryGetPacked(Entry), Daten, Len);
+               if (!ZFileCompress(CfgCacheEntryGetPacked(Entry)))
+               {
+                  CfgCacheEntryDestroy(Entry);
+                  Entry = (CfgCacheEntry *)NULL;
+               }
+               else
+               {
+                  /* the input is only needed for deflate */
+                  ZFileInit(CfgCacheEntryGetPacked(Entry), (char *)NULL, 0);
+               }
+            }
+         }
+         free(Daten);
+      }
+   }
+   close(Fd);
+   return(Entry);
+}
+
+ZlibFile *CfgCacheGet(CfgCacheStruct *Data, char *Dateiname)
+{  CfgCacheEntry *Entry;
+   struct stat Attribut;
+   char FullPath[255];
+   char *Key;
+
+   strcpy(FullPath, CfgCacheGetLocPath(Data));
+   if (FullPath[strlen(FullPath) - 1] != '/')
+      strcat(FullPath, "/");
+   strcat(FullPath, Dateiname);
+   if (stat(FullPath, &Attribut) != 0)
+   {
+      CfgCacheInvalidate(Data, Dateiname);
+      return((ZlibFile *)NULL);
+   }
+   Entry = (CfgCacheEntry *)MapGet(CfgCacheGetDateien(Data),
+                                   (MapKeyType)Dateiname);
+   if ((Entry != (CfgCacheEntry *)NULL) && IsUpToDate(Entry, &Attribut))
+      return(CfgCacheEntryGetPacked(Entry));
+   CfgCacheInvalidate(Data, Dateiname);
+   Entry = Compress(FullPath);
+   if (Entry == (CfgCacheEntry *)NULL)
+      return((ZlibFile *)NULL);
+   Key = strdup(Dateiname);
+   if ((Key == (char *)NULL) ||
+       !MapSet(CfgCacheGetDateien(Data), (MapKeyType)Key, (MapDataType)Entry))
+   {
+      free(Key);
+      CfgCacheEntryDestroy(Entry);
+      return((ZlibFile *)NULL);
+   }
+   return(CfgCacheEntryGetPacked(Entry));
+}
+
+void CfgCacheInvalidate(CfgCacheStruct *Data, char *Dateiname)
+{
+   MapDel(CfgCacheGetDateien(Data), (MapKeyType)Dateiname);
+}
+
+void CfgCacheClear(CfgCacheStruct *Data)
+{
+   MapPurge(CfgCacheGetDateien(Data));
+}
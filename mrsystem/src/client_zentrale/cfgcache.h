@@ -0,0 +1,49 @@
+#ifndef CFGCACHE_H
+#define CFGCACHE_H
+
+#include <time.h>
+#include <sys/types.h>
+#include <boolean.h>
+#include <map.h>
+#include "zfile.h"
+
+typedef struct {
+   time_t MTime;
+   long MTimeNsec;
+   off_t Size;
+   ino_t Inode;
+   ZlibFile *Packed;
+} CfgCacheEntry;
+
+#define CfgCacheEntrySetMTime(Data,Val)     (Data)->MTime=Val
+#define CfgCacheEntrySetMTimeNsec(Data,Val) (Data)->MTimeNsec=Val
+#define CfgCacheEntrySetSize(Data,Val)      (Data)->Size=Val
+#define CfgCacheEntrySetInode(Data,Val)     (Data)->Inode=Val
+#define CfgCacheEntrySetPacked(Data,Val)    (Data)->Packed=Val
+
+#define CfgCacheEntryGetMTime(Data)     (Data)->MTime
+#define CfgCacheEntryGetMTimeNsec(Data) (Data)->MTimeNsec
+#define CfgCacheEntryGetSize(Data)      (Data)->Size
+#define CfgCacheEntryGetInode(Data)     (Data)->Inode
+#define CfgCacheEntryGetPacked(Data)    (Data)->Packed
+
+typedef struct {
+   char *LocPath;
+   Map *Dateien;
+} CfgCacheStruct;
+
+#define CfgCacheSetLocPath(Data,Val) (Data)->LocPath=Val
+#define CfgCacheSetDateien(Data,Val) (Data)->Dateien=Val
+
+#define CfgCacheGetLocPath(Data) (Data)->LocPath
+#define CfgCacheGetDateien(Data) (Data)->Dateien
+
+CfgCacheStruct *CfgCacheCreate(void);
+void CfgCacheDestroy(CfgCacheStruct *Data);
+void CfgCacheInit(CfgCacheStruct *Data, char *LocPath);
+void CfgCacheExit(CfgCacheStruct *Data);
+ZlibFile *CfgCacheGet(CfgCacheStruct *Data, char *Dateiname);
+void CfgCacheInvalidate(CfgCacheStruct *Data, char *Dateiname);
+void CfgCacheClear(CfgCacheStruct *Data);
+
+#endif
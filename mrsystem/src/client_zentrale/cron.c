@@ -10,6 +10,13 @@ typedef struct {
    int NewState;
 } CronCheckWalkStruct;
 
+#define CRON_TICK_SLACK 10
+
+typedef struct {
+   BOOL Found;
+   time_t NextDue;
+} CronNextWalkStruct;
+
 #define CronCheckWalkStructSetActualTime(Data,Val) (Data)->ActualTime=Val
 #define CronCheckWalkStructSetNewState(Data,Val  ) (Data)->NewState=Val
 
@@ -131,3 +138,37 @@ int CronDo(CronStruct *Data)
                  (void *)&CronWalkData);
    return(CronCheckWalkStructGetNewState(&CronWalkData));
 }
+
+static void NextCron(void *PrivData, MapKeyType Key, MapDataType Daten)
+{  CronEntryStruct *CronEntry;
+   CronNextWalkStruct *CronWalkData;
+
+   CronEntry = (CronEntryStruct *)Daten;
+   CronWalkData = (CronNextWalkStruct *)PrivData;
+   /* CheckCron starts a job in the first second after NextTrigger */
+   if (CronEntryGetIsActive(CronEntry) &&
+       (!CronWalkData->Found ||
+        (CronEntryGetNextTrigger(CronEntry) + 1 < CronWalkData->NextDue)))
+   {
+      CronWalkData->Found = TRUE;
+      CronWalkData->NextDue = CronEntryGetNextTrigger(CronEntry) + 1;
+   }
+}
+
+long CronNextTimeout(CronStruct *Data)
+{  CronNextWalkStruct CronWalkData;
+   struct timespec Now;
+   long Timeout;
+
+   CronWalkData.Found = FALSE;
+   MapWalkAscend(CronGetCronFkts(Data), (MapWalkCbFkt)NextCron,
+                 (void *)&CronWalkData);
+   if (!CronWalkData.Found)
+      return(-1);
+   /* time() may lag behind the real time by a clock tick, so wait a bit
+      longer to find the job due in CronDo() */
+   clock_gettime(CLOCK_REALTIME, &Now);
+   Timeout = (long)(CronWalkData.NextDue - Now.tv_sec) * 1000 -
+             Now.tv_nsec / 1000000 + CRON_TICK_SLACK;
+   return(Timeout > 0 ? Timeout : 0);
+}
@@ -53,5 +53,6 @@ void CronEnable(CronStruct *Data, char *Name);
 void CronResume(CronStruct *Data, char *Name);
 void CronDisable(CronStruct *Data, char *Name);
 int CronDo(CronStruct *Data);
+long CronNextTimeout(CronStruct *Data);
 
 #endif
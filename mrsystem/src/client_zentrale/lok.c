@@ -15,7 +15,7 @@ LokStruct *LokCreate(void)
    {
       LokSetLocFilePath(NewData, "/var/www/config/");
       LokSetNumLoks(NewData, 0);
-      LokSetLokDb(NewData, MapCreate());
+      LokSetLokDb(NewData, MapCreateHash(HashString, TRUE));
       if (LokGetLokDb(NewData) == (Map *)NULL)
       {
          free(NewData);
@@ -52,7 +52,7 @@ void LokClear(LokStruct *Data)
       MapDestroy(LokGetLokDb(Data));
    LokSetNumLoks(Data, 0);
    LokSetIsChanged(Data, FALSE);
-   LokSetLokDb(Data, MapCreate());
+   LokSetLokDb(Data, MapCreateHash(HashString, TRUE));
    if (LokGetLokDb(Data) != (Map *)NULL)
    {
       MapInit(LokGetLokDb(Data), (CmpFkt)strcmp,
@@ -317,9 +317,8 @@ BOOL LokParseLokomotiveCs2(LokStruct *Data, char *Buf, int Len)
 }
 
 void LokLoadLokomotiveCs2(LokStruct *Data)
-{  FILE *LokCs2Stream;
-   struct stat attribut;
-   char *LokFileName, *LokFileContent;
+{  char *LokFileName, *LokFileContent;
+   int LokFileLength;
 
    if (LokGetLocFilePath(Data) != (char *)NULL)
    {
@@ -331,28 +330,15 @@ void LokLoadLokomotiveCs2(LokStruct *Data)
          if (LokFileName[strlen(LokFileName) - 1] != '/')
             strcat(LokFileName, "/");
          strcat(LokFileName, CS2_FILE_STRING_LOKOMOTIVE);
-         if (stat(LokFileName, &attribut) == 0)
+         LokFileContent = Cs2pMapFile(LokFileName, &LokFileLength);
+         if (LokFileContent != (char *)NULL)
          {
-            if (attribut.st_size > 0)
+            if (!LokParseLokomotiveCs2(Data, LokFileContent, LokFileLength))
             {
-               LokFileContent = (char *)malloc(attribut.st_size);
-               if (LokFileContent != (char *)NULL)
-               {
-                  LokCs2Stream = fopen(LokFileName, "r");
-                  if (LokCs2Stream != NULL)
-                  {
-                     fread(LokFileContent, 1, attribut.st_size, LokCs2Stream);
-                     if (!LokParseLokomotiveCs2(Data, LokFileContent, 
-                                                attribut.st_size))
-                     {
-                        LokClear(Data);
-                     }
-                     Cs2Close(LokCs2Stream);
-                     LokSetIsChanged(Data, FALSE);
-                  }
-                  free(LokFileContent);
-               }
+               LokClear(Data);
             }
+            LokSetIsChanged(Data, FALSE);
+            Cs2pUnmapFile(LokFileContent, LokFileLength);
          }
          free(LokFileName);
       }
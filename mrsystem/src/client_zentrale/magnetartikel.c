@@ -212,9 +212,8 @@ BOOL MagnetartikelParseMagnetartikelCs2(MagnetartikelStruct *Data, char *Buf, in
 }
 
 void MagnetartikelLoadMagnetartikelCs2(MagnetartikelStruct *Data)
-{  FILE *MagnetartikelCs2Stream;
-   struct stat attribut;
-   char *MagnetartikelFileName, *MagnetartikelFileContent;
+{  char *MagnetartikelFileName, *MagnetartikelFileContent;
+   int MagnetartikelFileLength;
 
    if (MagnetartikelGetMagnetartikelFilePath(Data) != (char *)NULL)
    {
@@ -227,26 +226,17 @@ void MagnetartikelLoadMagnetartikelCs2(MagnetartikelStruct *Data)
          if (MagnetartikelFileName[strlen(MagnetartikelFileName) - 1] != '/')
             strcat(MagnetartikelFileName, "/");
          strcat(MagnetartikelFileName, CS2_FILE_STRING_MAGNETARTIKEL);
-         if (stat(MagnetartikelFileName, &attribut) == 0)
+         MagnetartikelFileContent = Cs2pMapFile(MagnetartikelFileName,
+                                                &MagnetartikelFileLength);
+         if (MagnetartikelFileContent != (char *)NULL)
          {
-            MagnetartikelFileContent = (char *)malloc(attribut.st_size);
-            if (MagnetartikelFileContent != (char *)NULL)
+            if (!MagnetartikelParseMagnetartikelCs2(Data,
+                                                    MagnetartikelFileContent,
+                                                    MagnetartikelFileLength))
             {
-               MagnetartikelCs2Stream = fopen(MagnetartikelFileName, "r");
-               if (MagnetartikelCs2Stream != NULL)
-               {
-                  fread(MagnetartikelFileContent, 1, attribut.st_size,
-                        MagnetartikelCs2Stream);
-                  if (!MagnetartikelParseMagnetartikelCs2(Data,
-                                                          MagnetartikelFileContent,
-                                                          attribut.st_size))
-                  {
-                     MagnetartikelClear(Data);
-                  }
-                  Cs2Close(MagnetartikelCs2Stream);
-               }
-               free(MagnetartikelFileContent);
+               MagnetartikelClear(Data);
             }
+            Cs2pUnmapFile(MagnetartikelFileContent, MagnetartikelFileLength);
          }
          free(MagnetartikelFileName);
       }
@@ -5,6 +5,7 @@
 #include <string.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <boolean.h>
 #include <bytestream.h>
 #include <cs2parse.h>
@@ -42,6 +43,8 @@
 #define PERIODIC_INTERVALL_QPERIOD   1
 #define STATE_TIMEOUT 5
 
+#define CFG_SEND_BATCH 64
+
 #define PARAGRAPH_UNDEFINED 0
 #define PARAGRAPH_LOK       1
 #define PARAGRAPH_NUMLOKS   2
@@ -253,14 +256,53 @@ static int HandleLokFunction(void *Priv, void *SignalData)
    return(STATE_NO_CHANGE);
 }
 
+static void SendCfgBatch(ZentraleStruct *Data, MrIpcCmdType *Frames,
+                         struct iovec *Iov, int NumFrames)
+{  int i;
+
+   for (i = 0; i < NumFrames; i++)
+   {
+      Iov[i].iov_base = &Frames[i];
+      Iov[i].iov_len = sizeof(MrIpcCmdType);
+   }
+   MrIpcSendv(ZentraleGetClientSock(Data), Iov, NumFrames);
+}
+
+static void SendCfgFile(ZentraleStruct *Data, ZlibFile *Packed,
+                        int ReceiverSock)
+{  MrIpcCmdType Frames[CFG_SEND_BATCH];
+   struct iovec Iov[CFG_SEND_BATCH];
+   unsigned long i;
+   int NumFrames;
+
+   /* header and data frames go to the drehscheibe in batches of writev() */
+   MrIpcHlCfgHeaderRequest(&Frames[0], ZentraleGetUid(Data), ReceiverSock,
+                           ZFileGetLength(Packed), ZFileGetCrc(Packed));
+   NumFrames = 1;
+   i = 0;
+   while (i < ZFileGetFrameLength(Packed))
+   {
+      MrIpcHlCfgDataRequest(&Frames[NumFrames], ZentraleGetUid(Data),
+                            ReceiverSock,
+                            (char *)&(ZFileGetBuffer(Packed)[i]));
+      NumFrames++;
+      i += 8;
+      if ((NumFrames == CFG_SEND_BATCH) || (i >= ZFileGetFrameLength(Packed)))
+      {
+         SendCfgBatch(Data, Frames, Iov, NumFrames);
+         NumFrames = 0;
+      }
+   }
+   if (NumFrames > 0)
+      SendCfgBatch(Data, Frames, Iov, NumFrames);
+}
+
 static int HandleFileRequest(void *Priv, void *SignalData)
 {  ZentraleStruct *Data;
-   MrIpcCmdType *CmdFrame, Cmd;
-   char Name[9], *Dateiname, FullPath[255], *LokomotiveDaten;
-   int i, j, FileLength;
+   MrIpcCmdType *CmdFrame;
+   char Name[9], *Dateiname;
    unsigned Hash;
-   struct stat attribut;
-   FILE *LokomotiveDatei;
+   ZlibFile *Packed;
 
    Data = (ZentraleStruct *)Priv;
    CmdFrame = (MrIpcCmdType *)SignalData;
@@ -333,73 +375,20 @@ static int HandleFileRequest(void *Priv, void *SignalData)
    {
       if (ZentraleGetVerbose(Data))
          printf("FSM: request file %s\n", Dateiname);
-      strcpy(FullPath, ZentraleGetLocPath(Data));
-      if (FullPath[strlen(FullPath)] != '/')
-         strcat(FullPath, "/");
-      strcat(FullPath, Dateiname);
-      LokomotiveDatei = fopen(FullPath, "r");
-      if (LokomotiveDatei != (FILE *)NULL)
+      Packed = CfgCacheGet(ZentraleGetCfgCache(Data), Dateiname);
+      if (Packed != (ZlibFile *)NULL)
       {
-         if (stat(FullPath, &attribut) == 0)
-         {
-            LokomotiveDaten = (char *)malloc(attribut.st_size);
-            if (LokomotiveDaten != (char *)NULL)
-            {
-               FileLength = fread(LokomotiveDaten, 1, attribut.st_size,
-                                  LokomotiveDatei);
-               if (FileLength > 0)
-               {
-                  ZFileInit(ZentraleGetPackedCs2File(Data), LokomotiveDaten,
-                            FileLength);
-                  if (ZFileCompress(ZentraleGetPackedCs2File(Data)))
-                  {
-                     MrIpcSetCanResponse(CmdFrame, 1);
-                     Hash = Cs2CalcHash(ZentraleGetUid(Data));
-                     MrIpcSetCanHash(CmdFrame, Cs2CalcHash(ZentraleGetUid(Data)));
-                     MrIpcSetReceiverSocket(CmdFrame,
-                                            MrIpcGetSenderSocket(CmdFrame));
-                     MrIpcSetSenderSocket(CmdFrame, MR_IPC_SOCKET_ALL);
-                     MrIpcSend(ZentraleGetClientSock(Data), CmdFrame);
-                     MrIpcSetCanHash(CmdFrame, Hash);
-                     MrIpcHlCfgHeaderRequest(&Cmd, ZentraleGetUid(Data),
-                                             MrIpcGetReceiverSocket(CmdFrame),
-                                             ZFileGetLength(ZentraleGetPackedCs2File(Data)),
-                                             ZFileGetCrc(ZentraleGetPackedCs2File(Data)));
-                     MrIpcSend(ZentraleGetClientSock(Data), &Cmd);
-
-                     i = 0;
-                     while (i < ZFileGetFrameLength(ZentraleGetPackedCs2File(Data)))
-                     {
-                        j = 0;
-                        while (j < 8)
-                        {
-                           Name[j] = ZFileGetBuffer(ZentraleGetPackedCs2File(Data))[i + j];
-                           j++;
-                        }
-                        MrIpcHlCfgDataRequest(&Cmd, ZentraleGetUid(Data),
-                                              MrIpcGetReceiverSocket(CmdFrame),
-                                              Name);
-                        MrIpcSend(ZentraleGetClientSock(Data), &Cmd);
-                        i += 8;
-                     }
-                  }
-                  else if (ZentraleGetVerbose(Data))
-                     printf("FSM: error in compress file %s\n", Dateiname);
-                  ZFileExit(ZentraleGetPackedCs2File(Data));
-               }
-               else if (ZentraleGetVerbose(Data))
-                  printf("FSM: error in read file %s\n", Dateiname);
-               free(LokomotiveDaten);
-            }
-            else if (ZentraleGetVerbose(Data))
-               printf("FSM: error in allocate file buffer for %s\n", Dateiname);
-            fclose(LokomotiveDatei);
-         }
-         else if (ZentraleGetVerbose(Data))
-            printf("FSM: error in get file size %s\n", FullPath);
+         MrIpcSetCanResponse(CmdFrame, 1);
+         Hash = Cs2CalcHash(ZentraleGetUid(Data));
+         MrIpcSetCanHash(CmdFrame, Cs2CalcHash(ZentraleGetUid(Data)));
+         MrIpcSetReceiverSocket(CmdFrame, MrIpcGetSenderSocket(CmdFrame));
+         MrIpcSetSenderSocket(CmdFrame, MR_IPC_SOCKET_ALL);
+         MrIpcSend(ZentraleGetClientSock(Data), CmdFrame);
+         MrIpcSetCanHash(CmdFrame, Hash);
+         SendCfgFile(Data, Packed, MrIpcGetReceiverSocket(CmdFrame));
       }
       else if (ZentraleGetVerbose(Data))
-         printf("FSM: error in open file %s\n", FullPath);
+         printf("FSM: error in read or compress file %s\n", Dateiname);
    }
    if (ZentraleGetVerbose(Data))
       printf("FSM: new state %d\n",STATE_NO_CHANGE);
@@ -811,6 +800,7 @@ static BOOL HandleCfgLokinfo(ZentraleStruct *Data, MrIpcCmdType *CmdFrame)
       if (ZentraleGetVerbose(Data))
          printf("save lokomotive.cs2\n");
       LokSaveLokomotiveCs2(ZentraleGetLoks(Data));
+      CfgCacheInvalidate(ZentraleGetCfgCache(Data), CS2_FILE_STRING_LOKOMOTIVE);
       return(TRUE);
    }
 }
@@ -870,6 +860,8 @@ static void HandleCfgCompressedData(ZentraleStruct *Data, MrIpcCmdType *CmdFrame
                                                  ZFileGetLength(ZentraleGetPackedCs2File(Data))))
                {
                   LokSaveLokomotiveCs2(ZentraleGetLoks(Data));
+                  CfgCacheInvalidate(ZentraleGetCfgCache(Data),
+                                     CS2_FILE_STRING_LOKOMOTIVE);
                }
                else
                {
@@ -882,6 +874,8 @@ static void HandleCfgCompressedData(ZentraleStruct *Data, MrIpcCmdType *CmdFrame
                   char GleisbildPageDir[256], GleisbildPageFullName[256];
 
                   GleisbildClear(ZentraleGetGleisbild(Data));
+                  /* all pages are removed and written again */
+                  CfgCacheClear(ZentraleGetCfgCache(Data));
                   strcpy(GleisbildPageDir, ZentraleGetLocPath(Data));
                   if (GleisbildPageDir[strlen(GleisbildPageDir) - 1] != '/')
                      strcat(GleisbildPageDir, "/");
@@ -943,6 +937,8 @@ static void HandleCfgCompressedData(ZentraleStruct *Data, MrIpcCmdType *CmdFrame
                                                       ZFileGetLength(ZentraleGetPackedCs2File(Data))))
                {
                   MagnetartikelSaveMagnetartikelCs2(ZentraleGetMagnetartikel(Data));
+                  CfgCacheInvalidate(ZentraleGetCfgCache(Data),
+                                     CS2_FILE_STRING_MAGNETARTIKEL);
                }
                else
                {
@@ -955,6 +951,8 @@ static void HandleCfgCompressedData(ZentraleStruct *Data, MrIpcCmdType *CmdFrame
                                                   ZFileGetLength(ZentraleGetPackedCs2File(Data))))
                {
                   FahrstrasseSaveFahrstrasseCs2(ZentraleGetFahrstrasse(Data));
+                  CfgCacheInvalidate(ZentraleGetCfgCache(Data),
+                                     CS2_FILE_STRING_FAHRSTRASSE);
                }
                else
                {
@@ -988,6 +986,8 @@ static void HandleCfgCompressedData(ZentraleStruct *Data, MrIpcCmdType *CmdFrame
                            GleisbildPageSetGleisbildName(NewPage,
                                                          GleisbildName);
                            GleisbildPageSaveGleisbildPageCs2(NewPage);
+                           CfgCacheInvalidate(ZentraleGetCfgCache(Data),
+                                              GleisbildPageGetName(NewPage));
                            ZentraleSetNrGleisPages(Data,
                                                    GleisbildPageStructGetPage(NewPage),
                                                    NewPage);
@@ -1086,24 +1086,32 @@ static int HandleCvrData(void *Priv, void *SignalData)
                                               (char *)ZFileGetBuffer(ZentraleGetPackedCs2File(Data)),
                                               ZFileGetLength(ZentraleGetPackedCs2File(Data)));
                   LokStatusSaveLokomotiveSr2(ZentraleGetLoks(Data));
+                  CfgCacheInvalidate(ZentraleGetCfgCache(Data),
+                                     CS2_FILE_STRING_STATUS_LOKOMOTIVE);
                   break;
                case PARSER_PARAGRAPH_GLEISBILD:
                   GbsStatParseGbsStatSr2(ZentraleGetGleisbild(Data),
                                          (char *)ZFileGetBuffer(ZentraleGetPackedCs2File(Data)),
                                          ZFileGetLength(ZentraleGetPackedCs2File(Data)));
                   GbsStatSaveGbsStatSr2(ZentraleGetGleisbild(Data));
+                  CfgCacheInvalidate(ZentraleGetCfgCache(Data),
+                                     CS2_FILE_STRING_STATUS_GLEISBILD);
                   break;
                case PARSER_PARAGRAPH_MAGNETARTIKEL:
                   MagStatusParseMagStatusSr2(ZentraleGetMagnetartikel(Data),
                                              (char *)ZFileGetBuffer(ZentraleGetPackedCs2File(Data)),
                                              ZFileGetLength(ZentraleGetPackedCs2File(Data)));
                   MagStatusSaveMagStatusSr2(ZentraleGetMagnetartikel(Data));
+                  CfgCacheInvalidate(ZentraleGetCfgCache(Data),
+                                     CS2_FILE_STRING_STATUS_MAGNETARTIKEL);
                   break;
                case PARSER_PARAGRAPH_FAHRSTRASSEN:
                   FsStatParseFsStatSr2(ZentraleGetFahrstrasse(Data),
                                        (char *)ZFileGetBuffer(ZentraleGetPackedCs2File(Data)),
                                        ZFileGetLength(ZentraleGetPackedCs2File(Data)));
                   FsStatSaveFsStatSr2(ZentraleGetFahrstrasse(Data));
+                  CfgCacheInvalidate(ZentraleGetCfgCache(Data),
+                                     CS2_FILE_STRING_STATUS_FAHRSTRASSE);
                   break;
             }
          }
@@ -5,7 +5,6 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <sys/select.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
@@ -31,7 +30,6 @@
 #include "fsstat.h"
 #include "cs2cfg.h"
 
-#define SELECT_TIMEOUT  1
 #define TIMER_INTERVALL  10
 #define GERAET_VRS_FILE "geraet.vrs"
 #define S88_WAKEUP_PARM_DELIMETER " .,;:!-"
@@ -50,6 +48,9 @@ ZentraleStruct *ZentraleCreate(void)
       ZentraleSetInterface(Data, (char *)NULL);
       ZentraleSetServerPort(Data, -1);
       ZentraleSetClientSock(Data, -1);
+      ZentraleSetShm(Data, (MrIpcShmType *)NULL);
+      ZentraleSetEventLoop(Data, (MrIpcLoopType *)NULL);
+      ZentraleSetCronTimer(Data, -1);
       ZentraleSetLocPath(Data, (char *)NULL);
       ZentraleSetMajorVersion(Data, 0);
       ZentraleSetMinorVersion(Data, 1);
@@ -80,7 +81,24 @@ ZentraleStruct *ZentraleCreate(void)
                            if (ZentraleGetCanMember(Data) != (CanMemberStruct *)NULL)
                            {
                               ZentraleSetCs2CfgDaten(Data, Cs2CfgDataCreate());
-                              if (ZentraleGetCs2CfgDaten(Data) == (Cs2CfgData *)NULL)
+                              if (ZentraleGetCs2CfgDaten(Data) != (Cs2CfgData *)NULL)
+                              {
+                                 ZentraleSetCfgCache(Data, CfgCacheCreate());
+                                 if (ZentraleGetCfgCache(Data) == (CfgCacheStruct *)NULL)
+                                 {
+                                    Cs2CfgDataDestroy(ZentraleGetCs2CfgDaten(Data));
+                                    CanMemberDestroy(ZentraleGetCanMember(Data));
+                                    GleisbildDestroy(ZentraleGetGleisbild(Data));
+                                    MagnetartikelDestroy(ZentraleGetMagnetartikel(Data));
+                                    LokDestroy(ZentraleGetLoks(Data));
+                                    CronDestroy(ZentraleGetCronJobs(Data));
+                                    ZFileDestroy(ZentraleGetPackedCs2File(Data));
+                                    FsmDestroy(ZentraleGetStateMachine(Data));
+                                    free(Data);
+                                    Data = (ZentraleStruct *)NULL;
+                                 }
+                              }
+                              else
                               {
                                  CanMemberDestroy(ZentraleGetCanMember(Data));
                                  GleisbildDestroy(ZentraleGetGleisbild(Data));
@@ -202,6 +220,8 @@ void ZentraleDestroy(ZentraleStruct *Data)
       ZFileDestroy(ZentraleGetPackedCs2File(Data));
    if (ZentraleGetCs2CfgDaten(Data) != (Cs2CfgData *)NULL)
       Cs2CfgDataDestroy(ZentraleGetCs2CfgDaten(Data));
+   if (ZentraleGetCfgCache(Data) != (CfgCacheStruct *)NULL)
+      CfgCacheDestroy(ZentraleGetCfgCache(Data));
    free(Data);
 }
 
@@ -240,6 +260,7 @@ void ZentraleInit(ZentraleStruct *Data, BOOL Verbose, int MasterMode,
    ZentraleSetAddress(Data, Addr);
    ZentraleSetServerPort(Data, Port);
    ZentraleSetClientSock(Data, -1);
+   ZentraleSetShm(Data, (MrIpcShmType *)NULL);
    CronInit(ZentraleGetCronJobs(Data));
    ZentraleInitFsm(Data, ZentraleGetMasterMode(Data));
    ZentraleSetLocPath(Data, LocPath);
@@ -305,6 +326,7 @@ void ZentraleInit(ZentraleStruct *Data, BOOL Verbose, int MasterMode,
                               sizeof(ZentraleLokName)));
    CanMemberInit(ZentraleGetCanMember(Data));
    Cs2CfgDataInit(ZentraleGetCs2CfgDaten(Data), ZentraleGetVerbose(Data));
+   CfgCacheInit(ZentraleGetCfgCache(Data), LocPath);
    LokInit(ZentraleGetLoks(Data), LocPath, NumLokFkts);
    LokLoadLokomotiveCs2(ZentraleGetLoks(Data));
    LokStatusLoadLokomotiveSr2(ZentraleGetLoks(Data));
@@ -501,6 +523,8 @@ void ZentraleExit(ZentraleStruct *Data)
       FsmExit(ZentraleGetStateMachine(Data));
    if (ZentraleGetPackedCs2File(Data) == (ZlibFile *)NULL)
       ZFileExit(ZentraleGetPackedCs2File(Data));
+   if (ZentraleGetCfgCache(Data) != (CfgCacheStruct *)NULL)
+      CfgCacheExit(ZentraleGetCfgCache(Data));
 }
 
 static void SigHandler(int sig)
@@ -525,8 +549,12 @@ static BOOL Start(ZentraleStruct *Data)
                             MrIpcConnect(ZentraleGetAddress(Data),
                                          ZentraleGetServerPort(Data)));
    }
-   if (ZentraleGetClientSock(Data) >= 0)
+   ZentraleSetEventLoop(Data, MrIpcLoopCreate());
+   if ((ZentraleGetClientSock(Data) >= 0) &&
+       (ZentraleGetEventLoop(Data) != (MrIpcLoopType *)NULL))
    {
+      ZentraleSetShm(Data, MrIpcShmAttach(ZentraleGetClientSock(Data),
+                                         ZentraleGetServerPort(Data)));
       if (ZentraleGetVerbose(Data))
          puts("ready for incoming comands");
       SigStruct.sa_handler = SigHandler;
@@ -540,6 +568,11 @@ static BOOL Start(ZentraleStruct *Data)
    else
    {
       puts("ERROR: can not open socket to 'drehscheibe'");
+      if (ZentraleGetClientSock(Data) >= 0)
+         MrIpcClose(ZentraleGetClientSock(Data));
+      ZentraleSetClientSock(Data, -1);
+      MrIpcLoopDestroy(ZentraleGetEventLoop(Data));
+      ZentraleSetEventLoop(Data, (MrIpcLoopType *)NULL);
       return(FALSE);
    }
 }
@@ -550,8 +583,16 @@ static void Stop(ZentraleStruct *Data)
       puts("stop network client");
    if (ZentraleGetClientSock(Data) >= 0)
    {
+      MrIpcLoopRemoveFd(ZentraleGetEventLoop(Data),
+                        ZentraleGetClientSock(Data));
       MrIpcClose(ZentraleGetClientSock(Data));
+      MrIpcShmDetach(ZentraleGetShm(Data));
+      ZentraleSetShm(Data, (MrIpcShmType *)NULL);
    }
+   /* closes the cron timer too */
+   MrIpcLoopDestroy(ZentraleGetEventLoop(Data));
+   ZentraleSetEventLoop(Data, (MrIpcLoopType *)NULL);
+   ZentraleSetCronTimer(Data, -1);
 }
 
 static void ProcessSystemData(ZentraleStruct *Data, MrIpcCmdType *CmdFrame)
@@ -567,7 +608,8 @@ static void HandleSystemData(ZentraleStruct *Data)
    int RcvReturnValue;
 
    MrIpcInit(&CmdFrame);
-   RcvReturnValue = MrIpcRecv(ZentraleGetClientSock(Data), &CmdFrame);
+   RcvReturnValue = MrIpcShmRecv(ZentraleGetShm(Data),
+                                 ZentraleGetClientSock(Data), &CmdFrame);
    if (RcvReturnValue == MR_IPC_RCV_ERROR)
    {
       if (ZentraleGetVerbose(Data))
@@ -644,52 +686,68 @@ static void StartTimerCheck(ZentraleStruct *Data)
    FsmDo(ZentraleGetStateMachine(Data), 0, &Cmd);
 }
 
+static void SystemData(void *PrivData, int Fd)
+{
+   /* new cmd frame */
+   HandleSystemData((ZentraleStruct *)PrivData);
+}
+
+static void CronTimer(void *PrivData, int Fd)
+{  ZentraleStruct *Data;
+
+   Data = (ZentraleStruct *)PrivData;
+   if (ZentraleGetVerbose(Data))
+      puts("interrupt");
+   StartTimerCheck(Data);
+}
+
+static void ArmCronTimer(ZentraleStruct *Data)
+{  long Timeout;
+
+   /* sleep until the next cron job is due instead of polling every second,
+      an overdue job is started at once */
+   Timeout = CronNextTimeout(ZentraleGetCronJobs(Data));
+   if (ZentraleGetVerbose(Data))
+      printf("next cron job in %ld ms\n", Timeout);
+   MrIpcLoopSetTimer(ZentraleGetEventLoop(Data), ZentraleGetCronTimer(Data),
+                     Timeout < 0 ? 0 : (Timeout == 0 ? 1 : Timeout), FALSE);
+}
+
 void ZentraleRun(ZentraleStruct *Data)
-{  fd_set ReadFds;
-   int RetVal, HighFd;
-   struct timeval SelectTimeout;
+{  int RetVal;
 
    if (Start(Data))
    {
-      SwitchOn(Data);
-      Loop = TRUE;
+      ZentraleSetCronTimer(Data,
+                           MrIpcLoopAddTimer(ZentraleGetEventLoop(Data),
+                                             CronTimer, (void *)Data));
+      if (MrIpcLoopAddFd(ZentraleGetEventLoop(Data),
+                         ZentraleGetClientSock(Data), SystemData,
+                         (void *)Data) &&
+          (ZentraleGetCronTimer(Data) >= 0))
+      {
+         SwitchOn(Data);
+         Loop = TRUE;
+      }
+      else
+      {
+         puts("ERROR: can not start event loop");
+         Loop = FALSE;
+      }
       while (Loop)
       {
-         FD_ZERO(&ReadFds);
-         HighFd = 0;
-         if (ZentraleGetVerbose(Data))
-            printf("add client socket %d\n", ZentraleGetClientSock(Data));
-         FD_SET(ZentraleGetClientSock(Data), &ReadFds);
-         if (ZentraleGetClientSock(Data) > HighFd)
-            HighFd = ZentraleGetClientSock(Data);
-         SelectTimeout.tv_sec = SELECT_TIMEOUT;
-         SelectTimeout.tv_usec = 0;
-         if (ZentraleGetVerbose(Data))
-            printf("wait for %d fd, max %ld s\n", HighFd, SelectTimeout.tv_sec);
-         RetVal = select(HighFd + 1, &ReadFds, NULL, NULL, &SelectTimeout);
+         /* a frame or a cron job may have changed the cron jobs */
+         ArmCronTimer(Data);
+         RetVal = MrIpcLoopRunOnce(ZentraleGetEventLoop(Data),
+                                   MR_IPC_LOOP_NO_TIMEOUT);
          if (ZentraleGetVerbose(Data))
-            printf("select liefert %d\n", RetVal);
-         if (((RetVal == -1) && (errno == EINTR)) || (RetVal == 0))
-         {
-            if (ZentraleGetVerbose(Data))
-               puts("interrupt");
-            StartTimerCheck(Data);
-         }
-         else if (RetVal < 0)
+            printf("epoll liefert %d\n", RetVal);
+         if ((RetVal < 0) && (errno != EINTR))
          {
             if (ZentraleGetVerbose(Data))
                puts("error in main loop");
             Loop = FALSE;
          }
-         else
-         {
-            if (FD_ISSET(ZentraleGetClientSock(Data), &ReadFds))
-            {
-               /* new cmd frame */
-               HandleSystemData(Data);
-            }
-            StartTimerCheck(Data);
-         }
       }
       Stop(Data);
    }
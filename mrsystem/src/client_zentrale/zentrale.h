@@ -2,6 +2,7 @@
 #define ZENTRALE_H
 
 #include <boolean.h>
+#include <mr_ipc.h>
 #include <fsm.h>
 #include "canmember.h"
 #include "cron.h"
@@ -12,6 +13,7 @@
 #include "fahrstrasse.h"
 #include "zfile.h"
 #include "cs2cfg.h"
+#include "cfgcache.h"
 
 #define MM2_PRG_TEXT "mm2_prg"
 
@@ -50,6 +52,7 @@ typedef struct {
    char *Address;
    int ServerPort;
    int ClientSock;
+   MrIpcShmType *Shm;
    BOOL ShouldWakeUpS88;
    char *WakeUpS88;
    FsmStruct *StateMachine;
@@ -65,6 +68,7 @@ typedef struct {
    unsigned long Uid;
    BOOL WriteWeb;
    ZlibFile *PackedCs2File;
+   CfgCacheStruct *CfgCache;
    BOOL HaveDb;
    BOOL IsInPoll;
    Cs2CfgData *Cs2CgfDaten;
@@ -79,6 +83,8 @@ typedef struct {
    ZentraleLokName *LokNamen;
    CanMemberStruct *CanMember;
    CronStruct *CronJobs;
+   MrIpcLoopType *EventLoop;
+   int CronTimer;
    LokStruct *Loks;
    MagnetartikelStruct *Magnetartikel;
    GleisbildStruct *Gleisbild;
@@ -93,6 +99,7 @@ typedef struct {
 #define ZentraleSetAddress(Data, Addr)                  (Data)->Address=Addr
 #define ZentraleSetServerPort(Data, Port)               (Data)->ServerPort=Port
 #define ZentraleSetClientSock(Data, Sock)               (Data)->ClientSock=Sock
+#define ZentraleSetShm(Data, Ipc)                       (Data)->Shm=Ipc
 #define ZentraleSetShouldWakeUpS88(Data, DoWakeUp)      (Data)->ShouldWakeUpS88=DoWakeUp
 #define ZentraleSetWakeUpS88(Data, WakeUp)              (Data)->WakeUpS88=WakeUp
 #define ZentraleSetStateMachine(Data, Fsm)              (Data)->StateMachine=Fsm
@@ -109,6 +116,7 @@ typedef struct {
 #define ZentraleSetWriteWeb(Data, Write)                (Data)->WriteWeb=Write
 #define ZentraleSetIsInPoll(Data, Poll)                 (Data)->IsInPoll=Poll
 #define ZentraleSetPackedCs2File(Data, Zfile)           (Data)->PackedCs2File=Zfile
+#define ZentraleSetCfgCache(Data, Cache)                (Data)->CfgCache=Cache
 #define ZentraleSetCs2CfgDaten(Data, Cs2Daten)          (Data)->Cs2CgfDaten=Cs2Daten
 #define ZentraleSetActualIndex(Data, i)                 (Data)->ActualIndex=i
 #define ZentraleSetNumLoks(Data, i)                     (Data)->NumLoks=i
@@ -121,6 +129,8 @@ typedef struct {
 #define ZentraleSetLokNamenNr(Data, i, Namen)           strcpy((Data)->LokNamen[i].Name, Namen)
 #define ZentraleSetCanMember(Data, CanMemberDb)         (Data)->CanMember=CanMemberDb
 #define ZentraleSetCronJobs(Data, CronTab)              (Data)->CronJobs=CronTab
+#define ZentraleSetEventLoop(Data, Loop)                (Data)->EventLoop=Loop
+#define ZentraleSetCronTimer(Data, Timer)               (Data)->CronTimer=Timer
 #define ZentraleSetLoks(Data, LoksDb)                   (Data)->Loks=LoksDb
 #define ZentraleSetMagnetartikel(Data, MagnetartikelDb) (Data)->Magnetartikel=MagnetartikelDb
 #define ZentraleSetGleisbild(Data, GleisbildDb)         (Data)->Gleisbild=GleisbildDb
@@ -139,6 +149,7 @@ typedef struct {
 #define ZentraleGetShouldWakeUpS88(Data)      (Data)->ShouldWakeUpS88
 #define ZentraleGetWakeUpS88(Data)            (Data)->WakeUpS88
 #define ZentraleGetClientSock(Data)           (Data)->ClientSock
+#define ZentraleGetShm(Data)                  (Data)->Shm
 #define ZentraleGetStateMachine(Data)         (Data)->StateMachine
 #define ZentraleGetLocPath(Data)              (Data)->LocPath
 #define ZentraleGetProtokolle(Data)           (Data)->Protokolle
@@ -153,6 +164,7 @@ typedef struct {
 #define ZentraleGetWriteWeb(Data)             (Data)->WriteWeb
 #define ZentraleGetIsInPoll(Data)             (Data)->IsInPoll
 #define ZentraleGetPackedCs2File(Data)        (Data)->PackedCs2File
+#define ZentraleGetCfgCache(Data)             (Data)->CfgCache
 #define ZentraleGetCs2CfgDaten(Data)          (Data)->Cs2CgfDaten
 #define ZentraleGetLoks(Data)                 (Data)->Loks
 #define ZentraleGetActualIndex(Data)          (Data)->ActualIndex
@@ -167,6 +179,8 @@ typedef struct {
 #define ZentraleGetLokNamenNr(Data, i)        (Data)->LokNamen[i].Name
 #define ZentraleGetCanMember(Data)            (Data)->CanMember
 #define ZentraleGetCronJobs(Data)             (Data)->CronJobs
+#define ZentraleGetEventLoop(Data)            (Data)->EventLoop
+#define ZentraleGetCronTimer(Data)            (Data)->CronTimer
 #define ZentraleGetLoks(Data)                 (Data)->Loks
 #define ZentraleGetMagnetartikel(Data)        (Data)->Magnetartikel
 #define ZentraleGetGleisbild(Data)            (Data)->Gleisbild
@@ -2,7 +2,6 @@
 #include <stdio.h>
 #include <time.h>
 #include <signal.h>
-#include <sys/select.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <linux/can.h>
@@ -16,7 +15,7 @@
 #include "can_io.h"
 #include "cs2eth.h"
 
-#define SELECT_TIMEOUT 100
+#define LOOP_TIMEOUT 100
 #define MAX_DATAGRAM_SIZE 4096
 #define DEVICE_ID 0xFFFF
 
@@ -28,11 +27,20 @@ Cs2ethStruct *Cs2ethCreate(void)
    Data = (Cs2ethStruct *)malloc(sizeof(Cs2ethStruct));
    if (Data != (Cs2ethStruct *)NULL)
    {
-      Cs2ethSetVerbose(Data, FALSE);
-      Cs2ethSetInterface(Data, "");
-      Cs2ethSetServerPort(Data, -1);
-      Cs2ethSetClientSock(Data, -1);
-      Cs2ethSetHideMs2(Data, FALSE);
+      Cs2ethSetEventLoop(Data, MrIpcLoopCreate());
+      if (Cs2ethGetEventLoop(Data) != (MrIpcLoopType *)NULL)
+      {
+         Cs2ethSetVerbose(Data, FALSE);
+         Cs2ethSetInterface(Data, "");
+         Cs2ethSetServerPort(Data, -1);
+         Cs2ethSetClientSock(Data, -1);
+         Cs2ethSetHideMs2(Data, FALSE);
+      }
+      else
+      {
+         free(Data);
+         Data = (Cs2ethStruct *)NULL;
+      }
    }
    return(Data);
 }
@@ -41,6 +49,7 @@ void Cs2ethDestroy(Cs2ethStruct *Data)
 {
    if (Cs2ethGetVerbose(Data))
       puts("destroy mrcs2eth");
+   MrIpcLoopDestroy(Cs2ethGetEventLoop(Data));
    free(Data);
 }
 
@@ -124,6 +133,7 @@ static void Stop(Cs2ethStruct *Data)
 {
    if (Cs2ethGetVerbose(Data))
       puts("stop mrcs2eth");
+   MrIpcLoopRemoveFd(Cs2ethGetEventLoop(Data), Cs2ethGetClientSock(Data));
    MrIpcClose(Cs2ethGetClientSock(Data));
    Cs2ethGetIoFunctions(Data)->Close(Cs2ethGetIoFunctions(Data)->private);
 }
@@ -277,40 +287,45 @@ static void HandleOutsideData(Cs2ethStruct *Data, int Fd)
    }
 }
 
+static void SystemData(void *PrivData, int Fd)
+{  Cs2ethStruct *Data;
+
+   Data = (Cs2ethStruct *)PrivData;
+   if (Cs2ethGetVerbose(Data))
+      puts("data on cmd socket to drehscheibe");
+   HandleSystemData(Data);
+}
+
+static void OutsideData(void *PrivData, int Fd)
+{  Cs2ethStruct *Data;
+
+   Data = (Cs2ethStruct *)PrivData;
+   HandleOutsideData(Data, Fd);
+   /* the outside fds change only while reading from outside */
+   MrIpcLoopSyncFds(Cs2ethGetEventLoop(Data), Cs2ethGetIoFunctions(Data)->GetFd,
+                    Cs2ethGetIoFunctions(Data)->private, OutsideData, (void *)Data);
+}
+
 void Cs2ethRun(Cs2ethStruct *Data)
-{  fd_set ReadFds;
-   int RetVal, HighFd, IoFd;
-   struct timeval SelectTimeout;
+{  int RetVal;
    time_t Now;
 
    if (Start(Data))
    {
       if (Cs2ethGetVerbose(Data))
          puts("run mrcs2eth");
+      MrIpcLoopAddFd(Cs2ethGetEventLoop(Data), Cs2ethGetClientSock(Data),
+                     SystemData, (void *)Data);
+      MrIpcLoopSyncFds(Cs2ethGetEventLoop(Data), Cs2ethGetIoFunctions(Data)->GetFd,
+                       Cs2ethGetIoFunctions(Data)->private, OutsideData, (void *)Data);
       while (Loop)
       {
-         FD_ZERO(&ReadFds);
-         HighFd = 0;
-         if (Cs2ethGetVerbose(Data))
-            printf("add client socket %d\n", Cs2ethGetClientSock(Data));
-         FD_SET(Cs2ethGetClientSock(Data), &ReadFds);
-         if (Cs2ethGetClientSock(Data) > HighFd)
-            HighFd = Cs2ethGetClientSock(Data);
-         while ((IoFd = Cs2ethGetIoFunctions(Data)->GetFd(Cs2ethGetIoFunctions(Data)->private)) != IOFKT_INVALID_FD)
-         {
-            if (Cs2ethGetVerbose(Data))
-               printf("add outside socket %d\n", IoFd);
-            FD_SET(IoFd, &ReadFds);
-            if (IoFd > HighFd)
-               HighFd = IoFd;
-         }
-         SelectTimeout.tv_sec = SELECT_TIMEOUT;
-         SelectTimeout.tv_usec = 0;
          if (Cs2ethGetVerbose(Data))
-            printf("wait for %d fd, max %ld s\n", HighFd, SelectTimeout.tv_sec);
-         RetVal = select(HighFd + 1, &ReadFds, NULL, NULL, &SelectTimeout);
+            printf("wait for data, max %d s\n", LOOP_TIMEOUT);
+         RetVal = MrIpcLoopRunOnce(Cs2ethGetEventLoop(Data),
+                                   LOOP_TIMEOUT * 1000);
          if (Cs2ethGetVerbose(Data))
-            printf("select liefert %d\n", RetVal);
+            printf("epoll liefert %d\n", RetVal);
          if (((RetVal == -1) && (errno == EINTR)) || (RetVal == 0))
          {
             Now = time(NULL);
@@ -323,22 +338,6 @@ void Cs2ethRun(Cs2ethStruct *Data)
                puts("error in main loop");
             Loop = FALSE;
          }
-         else
-         {
-            if (FD_ISSET(Cs2ethGetClientSock(Data), &ReadFds))
-            {
-               if (Cs2ethGetVerbose(Data))
-                  puts("data on cmd socket to drehscheibe");
-               HandleSystemData(Data);
-            }
-            while ((IoFd = Cs2ethGetIoFunctions(Data)->GetFd(Cs2ethGetIoFunctions(Data)->private)) != IOFKT_INVALID_FD)
-            {
-               if (FD_ISSET(IoFd, &ReadFds))
-               {
-                  HandleOutsideData(Data, IoFd);
-               }
-            }
-         }
       }
       Stop(Data);
    }
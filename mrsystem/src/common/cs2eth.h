@@ -3,6 +3,7 @@
 
 #include <arpa/inet.h>
 #include <boolean.h>
+#include <mr_ipc.h>
 #include "can_io.h"
 
 typedef struct {
@@ -16,6 +17,7 @@ typedef struct {
    int ClientSock;
    BOOL HideMs2;
    IoFktStruct *IoFunctions;
+   MrIpcLoopType *EventLoop;
 } Cs2ethStruct;
 
 #define Cs2ethSetVerbose(Data, Verbose)     (Data)->Verbosity=Verbose
@@ -28,6 +30,7 @@ typedef struct {
 #define Cs2ethSetClientSock(Data, Sock)     (Data)->ClientSock=Sock
 #define Cs2ethSetHideMs2(Data, Hide)        (Data)->HideMs2=Hide
 #define Cs2ethSetIoFunctions(Data, Fkts)    (Data)->IoFunctions=Fkts
+#define Cs2ethSetEventLoop(Data, Loop)      (Data)->EventLoop=Loop
 
 #define Cs2ethGetVerbose(Data)       (Data)->Verbosity
 #ifdef TRACE
@@ -39,6 +42,7 @@ typedef struct {
 #define Cs2ethGetClientSock(Data)     (Data)->ClientSock
 #define Cs2ethGetHideMs2(Data)        (Data)->HideMs2
 #define Cs2ethGetIoFunctions(Data)    (Data)->IoFunctions
+#define Cs2ethGetEventLoop(Data)      (Data)->EventLoop
 
 Cs2ethStruct *Cs2ethCreate(void);
 void Cs2ethDestroy(Cs2ethStruct *Data);
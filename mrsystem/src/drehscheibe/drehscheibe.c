@@ -2,7 +2,6 @@
 #include <stdio.h>
 #include <time.h>
 #include <signal.h>
-#include <sys/select.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <string.h>
@@ -13,29 +12,68 @@
 #include <mr_ipc.h>
 #include "drehscheibe.h"
 
-#define SELECT_TIMEOUT 100
+#define LOOP_TIMEOUT 100
 
 static BOOL Loop = TRUE;
 
+static BOOL SubscribersCreate(DrehscheibeStruct *Data)
+{  int i;
+   BOOL Ret;
+
+   Ret = TRUE;
+   for (i = 0; i < MR_IPC_NUM_COMMANDS; i++)
+   {
+      DrehscheibeSetSubscribers(Data, i,
+                                MengeCreateHash(HashPointer, FALSE));
+      if (DrehscheibeGetSubscribers(Data, i) == (Menge *)NULL)
+         Ret = FALSE;
+   }
+   for (i = 0; i < MR_IPC_NUM_CAN_COMMANDS; i++)
+   {
+      DrehscheibeSetCanSubscribers(Data, i,
+                                   MengeCreateHash(HashPointer, FALSE));
+      if (DrehscheibeGetCanSubscribers(Data, i) == (Menge *)NULL)
+         Ret = FALSE;
+   }
+   return(Ret);
+}
+
+static void SubscribersDestroy(DrehscheibeStruct *Data)
+{  int i;
+
+   for (i = 0; i < MR_IPC_NUM_COMMANDS; i++)
+      MengeDestroy(DrehscheibeGetSubscribers(Data, i));
+   for (i = 0; i < MR_IPC_NUM_CAN_COMMANDS; i++)
+      MengeDestroy(DrehscheibeGetCanSubscribers(Data, i));
+}
+
 DrehscheibeStruct *DrehscheibeCreate(void)
 {  DrehscheibeStruct *Data;
 
    Data = (DrehscheibeStruct *)malloc(sizeof(DrehscheibeStruct));
    if (Data != (DrehscheibeStruct *)NULL)
    {
-      DrehscheibeSetClient(Data, MengeCreate());
+      DrehscheibeSetClient(Data, MengeCreateHash(HashPointer, FALSE));
       if (DrehscheibeGetClient(Data) != (Menge *)NULL)
       {
-         DrehscheibeSetRemove(Data, StackCreate());
-         if (DrehscheibeGetRemove(Data) != (Stack *)NULL)
+         DrehscheibeSetEventLoop(Data, MrIpcLoopCreate());
+         DrehscheibeSetFlush(Data, StackCreate());
+         if (SubscribersCreate(Data) &&
+             (DrehscheibeGetEventLoop(Data) != (MrIpcLoopType *)NULL) &&
+             (DrehscheibeGetFlush(Data) != (Stack *)NULL))
          {
             DrehscheibeSetVerbose(Data, FALSE);
             DrehscheibeSetInterface(Data, (char *)NULL);
             DrehscheibeSetServerPort(Data, -1);
             DrehscheibeSetServerSock(Data, -1);
+            DrehscheibeSetShmRing(Data, (MrIpcShmRingType *)NULL);
          }
          else
          {
+            SubscribersDestroy(Data);
+            MrIpcLoopDestroy(DrehscheibeGetEventLoop(Data));
+            if (DrehscheibeGetFlush(Data) != (Stack *)NULL)
+               StackDestroy(DrehscheibeGetFlush(Data));
             MengeDestroy(DrehscheibeGetClient(Data));
             free(Data);
             Data = (DrehscheibeStruct *)NULL;
@@ -54,7 +92,9 @@ void DrehscheibeDestroy(DrehscheibeStruct *Data)
 {
    if (DrehscheibeGetVerbose(Data))
       puts("destroy drehscheibe");
-   StackDestroy(DrehscheibeGetRemove(Data));
+   SubscribersDestroy(Data);
+   StackDestroy(DrehscheibeGetFlush(Data));
+   MrIpcLoopDestroy(DrehscheibeGetEventLoop(Data));
    MengeDestroy(DrehscheibeGetClient(Data));
    free(Data);
 }
@@ -70,66 +110,348 @@ static void StackNullDel(StackDataType Data)
 
 void DrehscheibeInit(DrehscheibeStruct *Data, BOOL Verbose, char *Interface,
                      char *Addr, int Port)
-{
+{  int i;
+
    DrehscheibeSetVerbose(Data, Verbose);
    DrehscheibeSetInterface(Data, Interface);
    DrehscheibeSetAddress(Data, Addr);
    DrehscheibeSetServerPort(Data, Port);
    DrehscheibeSetServerSock(Data, -1);
    MengeInit(DrehscheibeGetClient(Data), SocketClientsCompare, free);
-   StackInit(DrehscheibeGetRemove(Data), StackNullDel);
+   StackInit(DrehscheibeGetFlush(Data), StackNullDel);
+   /* the index only references the entries of SocketClients */
+   for (i = 0; i < MR_IPC_NUM_COMMANDS; i++)
+      MengeInit(DrehscheibeGetSubscribers(Data, i), SocketClientsCompare,
+                (MengeDelCbFkt)NULL);
+   for (i = 0; i < MR_IPC_NUM_CAN_COMMANDS; i++)
+      MengeInit(DrehscheibeGetCanSubscribers(Data, i), SocketClientsCompare,
+                (MengeDelCbFkt)NULL);
 }
 
-static void SigHandler(int sig)
+static void UnindexClient(DrehscheibeStruct *Data,
+                          DrehscheibeClientStruct *ClientEntry)
+{  int i;
+
+   for (i = 0; i < MR_IPC_NUM_COMMANDS; i++)
+      MengeRemove(DrehscheibeGetSubscribers(Data, i),
+                  (MengeDataType)ClientEntry);
+   for (i = 0; i < MR_IPC_NUM_CAN_COMMANDS; i++)
+      MengeRemove(DrehscheibeGetCanSubscribers(Data, i),
+                  (MengeDataType)ClientEntry);
+}
+
+static void IndexClient(DrehscheibeStruct *Data,
+                        DrehscheibeClientStruct *ClientEntry)
+{  int i;
+   MrIpcSubscriptionType *Sub;
+
+   /* a frame is sent only to the clients in the index of its command */
+   UnindexClient(Data, ClientEntry);
+   Sub = DrehclientGetSubscription(ClientEntry);
+   for (i = 0; i < MR_IPC_NUM_COMMANDS; i++)
+   {
+      if ((i != MrIpcCmdNull) && MrIpcSubscriptionGetCmd(Sub, i))
+         MengeAdd(DrehscheibeGetSubscribers(Data, i),
+                  (MengeDataType)ClientEntry);
+   }
+   if (MrIpcSubscriptionGetCmd(Sub, MrIpcCmdNull))
+   {
+      for (i = 0; i < MR_IPC_NUM_CAN_COMMANDS; i++)
+      {
+         if (MrIpcSubscriptionGetCanCmd(Sub, i))
+            MengeAdd(DrehscheibeGetCanSubscribers(Data, i),
+                     (MengeDataType)ClientEntry);
+      }
+   }
+}
+
+static void QueueFrame(DrehscheibeStruct *Data, MrIpcCmdType *CmdFrame,
+                       DrehscheibeClientStruct *RcvClientEntry)
+{  struct iovec *Pending;
+
+   if (DrehscheibeGetVerbose(Data))
+      printf("send to client with socket %d\n",
+             DrehclientGetSock(RcvClientEntry));
+   if (DrehclientGetNumPending(RcvClientEntry) == 0)
+      StackPush(DrehscheibeGetFlush(Data), (StackDataType)RcvClientEntry);
+   Pending = &(DrehclientGetPending(RcvClientEntry)[DrehclientGetNumPending(RcvClientEntry)]);
+   Pending->iov_base = CmdFrame;
+   Pending->iov_len = sizeof(MrIpcCmdType);
+   DrehclientSetNumPending(RcvClientEntry,
+                           DrehclientGetNumPending(RcvClientEntry) + 1);
+}
+
+static void DropClient(DrehscheibeStruct *Data,
+                       DrehscheibeClientStruct *ClientEntry)
 {
-   Loop = FALSE;
+   /* the client may still be referenced by the batch in progress, so only
+      shut the socket down, the next read sees it closed and removes it */
+   if (DrehscheibeGetVerbose(Data))
+      printf("client with socket %d does not take its frames, drop it\n",
+             DrehclientGetSock(ClientEntry));
+   DrehclientSetClosing(ClientEntry, TRUE);
+   MrIpcLoopSetWriteFkt(DrehscheibeGetEventLoop(Data),
+                        DrehclientGetSock(ClientEntry),
+                        (MrIpcLoopFktType)NULL);
+   shutdown(DrehclientGetSock(ClientEntry), SHUT_RDWR);
 }
 
-static BOOL Start(DrehscheibeStruct *Data)
-{  struct sigaction SigStruct;
+static void ClientWritable(void *PrivData, int Fd)
+{  DrehscheibeClientStruct *ClientEntry;
+   DrehscheibeStruct *Data;
 
-   if ((strlen(DrehscheibeGetInterface(Data)) > 0) &&
-       ((strlen(DrehscheibeGetAddress(Data)) == 0) ||
-        (strcmp(DrehscheibeGetAddress(Data), "0.0.0.0") == 0)))
+   ClientEntry = (DrehscheibeClientStruct *)PrivData;
+   Data = (DrehscheibeStruct *)DrehclientGetDrehscheibe(ClientEntry);
+   switch (MrIpcOutputFlush(Fd, DrehclientGetOutput(ClientEntry)))
    {
-      DrehscheibeSetServerSock(Data,
-                               MrIpcStartServerIf(DrehscheibeGetInterface(Data),
-                                                  DrehscheibeGetServerPort(Data)));
+      case MR_IPC_RCV_OK:
+         MrIpcLoopSetWriteFkt(DrehscheibeGetEventLoop(Data), Fd,
+                              (MrIpcLoopFktType)NULL);
+         break;
+      case MR_IPC_RCV_PENDING:
+         break;
+      default:
+         DropClient(Data, ClientEntry);
+         break;
    }
-   else
+}
+
+static void SendToClient(DrehscheibeStruct *Data,
+                         DrehscheibeClientStruct *ClientEntry,
+                         struct iovec *Iov, int Count)
+{
+   if (DrehclientGetClosing(ClientEntry))
+      return;
+   /* what the socket does not take now is sent from the output buffer as
+      soon as the socket is writable again */
+   switch (MrIpcOutputSendv(DrehclientGetSock(ClientEntry),
+                            DrehclientGetOutput(ClientEntry), Iov, Count))
    {
-      DrehscheibeSetServerSock(Data,
-                               MrIpcStartServer(DrehscheibeGetAddress(Data),
-                                                DrehscheibeGetServerPort(Data)));
+      case MR_IPC_RCV_OK:
+         break;
+      case MR_IPC_RCV_PENDING:
+         if (!MrIpcLoopSetWriteFkt(DrehscheibeGetEventLoop(Data),
+                                   DrehclientGetSock(ClientEntry),
+                                   ClientWritable))
+            DropClient(Data, ClientEntry);
+         break;
+      default:
+         DropClient(Data, ClientEntry);
+         break;
    }
-   if (DrehscheibeGetServerSock(Data) >= 0)
+}
+
+static void SendFrameToClient(DrehscheibeStruct *Data,
+                              DrehscheibeClientStruct *ClientEntry,
+                              MrIpcCmdType *CmdFrame)
+{  struct iovec Iov;
+
+   Iov.iov_base = CmdFrame;
+   Iov.iov_len = sizeof(MrIpcCmdType);
+   SendToClient(Data, ClientEntry, &Iov, 1);
+}
+
+static void FlushClients(DrehscheibeStruct *Data)
+{  DrehscheibeClientStruct *RcvClientEntry;
+
+   /* one writev per client for all frames read with one recv */
+   while (!StackIsEmpty(DrehscheibeGetFlush(Data)))
    {
-      if (DrehscheibeGetVerbose(Data))
-         puts("ready for incoming connections");
-      SigStruct.sa_handler = SigHandler;
-      sigemptyset(&SigStruct.sa_mask);
-      SigStruct.sa_flags = 0;
-      sigaction(SIGINT, &SigStruct, NULL);
-      sigaction(SIGQUIT, &SigStruct, NULL);
-      sigaction(SIGTERM, &SigStruct, NULL);
-      return(TRUE);
+      RcvClientEntry = (DrehscheibeClientStruct *)StackPop(DrehscheibeGetFlush(Data));
+      SendToClient(Data, RcvClientEntry, DrehclientGetPending(RcvClientEntry),
+                   DrehclientGetNumPending(RcvClientEntry));
+      DrehclientSetNumPending(RcvClientEntry, 0);
+   }
+}
+
+static void StopShmClient(DrehscheibeStruct *Data, int Consumer)
+{  MengeIterator ClientIter;
+   DrehscheibeClientStruct *ClientEntry;
+   struct iovec Backlog[MR_IPC_BUFFER_CMDS];
+   unsigned int Pos;
+   int NumCmds;
+
+   MengeInitIterator(&ClientIter, DrehscheibeGetClient(Data));
+   ClientEntry = (DrehscheibeClientStruct *)MengeFirst(&ClientIter);
+   while ((ClientEntry != (DrehscheibeClientStruct *)NULL) &&
+          (DrehclientGetShmConsumer(ClientEntry) != Consumer))
+      ClientEntry = (DrehscheibeClientStruct *)MengeNext(&ClientIter);
+   Pos = MrIpcShmStop(DrehscheibeGetShmRing(Data), Consumer);
+   if (ClientEntry == (DrehscheibeClientStruct *)NULL)
+      return;
+   if (DrehscheibeGetVerbose(Data))
+      printf("client with socket %d does not keep up, stop ring consumer %d\n",
+             DrehclientGetSock(ClientEntry), Consumer);
+   /* what it has not read from the ring goes over the socket before the
+      new frames, which are queued for the socket from now on */
+   while ((NumCmds = MrIpcShmBacklog(DrehscheibeGetShmRing(Data), Consumer,
+                                     &Pos, Backlog, MR_IPC_BUFFER_CMDS)) > 0)
+      SendToClient(Data, ClientEntry, Backlog, NumCmds);
+}
+
+static void ProcessSystemData(DrehscheibeStruct *Data, MrIpcCmdType *CmdFrame,
+                              DrehscheibeClientStruct *ClientEntry)
+{  MengeIterator ClientIter;
+   DrehscheibeClientStruct *RcvClientEntry;
+   Menge *Subscribers;
+   MrIpcCmdType Doorbell;
+   unsigned int Command;
+   int Consumer;
+
+   /* write the frame only once for all clients at the shared memory ring,
+      but never over a slot a client has not read yet */
+   if (DrehscheibeGetShmRing(Data) != (MrIpcShmRingType *)NULL)
+   {
+      while ((Consumer = MrIpcShmNextLagging(DrehscheibeGetShmRing(Data))) !=
+             MR_IPC_SHM_NO_CONSUMER)
+         StopShmClient(Data, Consumer);
+      MrIpcShmPublish(DrehscheibeGetShmRing(Data), CmdFrame,
+                      DrehclientGetShmConsumer(ClientEntry));
    }
+   Command = MrIpcGetCommand(CmdFrame);
+   if (Command == MrIpcCmdNull)
+      Subscribers = DrehscheibeGetCanSubscribers(Data,
+                                                 MrIpcGetCanCommand(CmdFrame) %
+                                                 MR_IPC_NUM_CAN_COMMANDS);
+   else if (Command < MR_IPC_NUM_COMMANDS)
+      Subscribers = DrehscheibeGetSubscribers(Data, Command);
    else
+      Subscribers = DrehscheibeGetClient(Data);
+   MengeInitIterator(&ClientIter, Subscribers);
+   RcvClientEntry = (DrehscheibeClientStruct *)MengeFirst(&ClientIter);
+   while (RcvClientEntry != (DrehscheibeClientStruct *)NULL)
    {
-      return(FALSE);
+      if (DrehclientGetSock(ClientEntry) != DrehclientGetSock(RcvClientEntry))
+      {
+         /* send only to other clients */
+         if (MrIpcShmIsReading(DrehscheibeGetShmRing(Data),
+                               DrehclientGetShmConsumer(RcvClientEntry)))
+         {
+            /* reads from ring, only wake it up if it is waiting */
+            if (MrIpcShmWakeup(DrehscheibeGetShmRing(Data),
+                               DrehclientGetShmConsumer(RcvClientEntry)))
+            {
+               MrIpcShmInitDoorbell(&Doorbell);
+               SendFrameToClient(Data, RcvClientEntry, &Doorbell);
+            }
+         }
+         else
+         {
+            QueueFrame(Data, CmdFrame, RcvClientEntry);
+         }
+      }
+      RcvClientEntry = (DrehscheibeClientStruct *)MengeNext(&ClientIter);
    }
 }
 
-static void Stop(DrehscheibeStruct *Data)
+static void HandleShmAttach(DrehscheibeStruct *Data, MrIpcCmdType *CmdFrame,
+                            DrehscheibeClientStruct *ClientEntry)
+{  MrIpcCmdType Ack;
+   int Consumer;
+
+   Consumer = MrIpcShmRegister(DrehscheibeGetShmRing(Data), CmdFrame);
+   DrehclientSetShmConsumer(ClientEntry, Consumer);
+   MrIpcShmSetSubscription(DrehscheibeGetShmRing(Data), Consumer,
+                           DrehclientGetSubscription(ClientEntry));
+   if (DrehscheibeGetVerbose(Data))
+      printf("client with socket %d reads from ring as consumer %d\n",
+             DrehclientGetSock(ClientEntry), Consumer);
+   MrIpcInit(&Ack);
+   MrIpcSetCommand(&Ack, MrIpcCmdIntern);
+   MrIpcSetIntIp1(&Ack, MrIpcInternalShmAck);
+   MrIpcSetIntIp2(&Ack, Consumer != MR_IPC_SHM_NO_CONSUMER);
+   SendFrameToClient(Data, ClientEntry, &Ack);
+}
+
+static void HandleSubscribe(DrehscheibeStruct *Data, MrIpcCmdType *CmdFrame,
+                            DrehscheibeClientStruct *ClientEntry)
 {
+   MrIpcSubscriptionUpdate(DrehclientGetSubscription(ClientEntry), CmdFrame);
    if (DrehscheibeGetVerbose(Data))
-      puts("stop network server");
-   if (DrehscheibeGetServerSock(Data) >= 0)
+      printf("client with socket %d subscribes word %d: 0x%08lx\n",
+             DrehclientGetSock(ClientEntry), MrIpcGetIntIp2(CmdFrame),
+             MrIpcGetIntLp1(CmdFrame));
+   IndexClient(Data, ClientEntry);
+   MrIpcShmSetSubscription(DrehscheibeGetShmRing(Data),
+                           DrehclientGetShmConsumer(ClientEntry),
+                           DrehclientGetSubscription(ClientEntry));
+}
+
+static void RemoveClient(DrehscheibeStruct *Data,
+                         DrehscheibeClientStruct *ClientEntry)
+{
+   MrIpcLoopRemoveFd(DrehscheibeGetEventLoop(Data),
+                     DrehclientGetSock(ClientEntry));
+   MrIpcClose(DrehclientGetSock(ClientEntry));
+   MrIpcShmUnregister(DrehscheibeGetShmRing(Data),
+                      DrehclientGetShmConsumer(ClientEntry));
+   UnindexClient(Data, ClientEntry);
+   MengeRemove(DrehscheibeGetClient(Data), (MengeDataType)ClientEntry);
+}
+
+static void HandleSystemData(DrehscheibeStruct *Data,
+                             DrehscheibeClientStruct *ClientEntry)
+{  MrIpcCmdType CmdFrames[MR_IPC_BUFFER_CMDS], *CmdFrame, Doorbell;
+   int RcvReturnValue, NumCmds;
+
+   if (DrehscheibeGetVerbose(Data))
+      printf("data on client socket %d available\n",
+             DrehclientGetSock(ClientEntry));
+   RcvReturnValue = MrIpcBufferFill(DrehclientGetSock(ClientEntry),
+                                    DrehclientGetInput(ClientEntry));
+   if (RcvReturnValue == MR_IPC_RCV_ERROR)
    {
-      MrIpcClose(DrehscheibeGetServerSock(Data));
+      if (DrehscheibeGetVerbose(Data))
+         puts("Error in recieve from socket!");
+   }
+   else if (RcvReturnValue == MR_IPC_RCV_CLOSED)
+   {
+      if (DrehscheibeGetVerbose(Data))
+         puts("client socket was closed");
+      RemoveClient(Data, ClientEntry);
+   }
+   else
+   {
+      /* handle all complete frames of this recv, the frames stay in
+         CmdFrames until they are flushed to the receiving clients */
+      NumCmds = 0;
+      CmdFrame = &CmdFrames[NumCmds];
+      while (MrIpcBufferGet(DrehclientGetInput(ClientEntry), CmdFrame))
+      {
+         if (DrehscheibeGetVerbose(Data))
+            printf("read new comand frame from socket %d, cmd %02x\n",
+                   MrIpcGetCommand(CmdFrame), CmdFrame->CanCommand);
+         if ((MrIpcGetCommand(CmdFrame) == MrIpcCmdIntern) &&
+             (MrIpcGetIntIp1(CmdFrame) == MrIpcInternalShmAttach))
+            HandleShmAttach(Data, CmdFrame, ClientEntry);
+         else if ((MrIpcGetCommand(CmdFrame) == MrIpcCmdIntern) &&
+                  (MrIpcGetIntIp1(CmdFrame) == MrIpcInternalShmDoorbell))
+         {
+            MrIpcShmInitDoorbell(&Doorbell);
+            SendFrameToClient(Data, ClientEntry, &Doorbell);
+         }
+         else if ((MrIpcGetCommand(CmdFrame) == MrIpcCmdIntern) &&
+                  (MrIpcGetIntIp1(CmdFrame) == MrIpcInternalSubscribe))
+            HandleSubscribe(Data, CmdFrame, ClientEntry);
+         else
+         {
+            ProcessSystemData(Data, CmdFrame, ClientEntry);
+            NumCmds++;
+            CmdFrame = &CmdFrames[NumCmds];
+         }
+      }
+      FlushClients(Data);
    }
 }
 
+static void ClientData(void *PrivData, int Fd)
+{  DrehscheibeClientStruct *ClientEntry;
+
+   ClientEntry = (DrehscheibeClientStruct *)PrivData;
+   HandleSystemData((DrehscheibeStruct *)DrehclientGetDrehscheibe(ClientEntry),
+                    ClientEntry);
+}
+
 static void AddNewClient(DrehscheibeStruct *Data)
 {  DrehscheibeClientStruct *SocketEntry;
    int NewClientSock;
@@ -138,83 +460,111 @@ static void AddNewClient(DrehscheibeStruct *Data)
       puts("new incoming connection");
    NewClientSock = MrIpcAccept(DrehscheibeGetServerSock(Data));
    SocketEntry = (DrehscheibeClientStruct *)malloc(sizeof(DrehscheibeClientStruct));
-   if (SocketEntry != (DrehscheibeClientStruct *)NULL)
+   if ((SocketEntry != (DrehscheibeClientStruct *)NULL) &&
+       MrIpcLoopAddFd(DrehscheibeGetEventLoop(Data), NewClientSock,
+                      ClientData, (void *)SocketEntry))
    {
       /* we got one, accept */
+      DrehclientSetDrehscheibe(SocketEntry, Data);
       DrehclientSetSock(SocketEntry, NewClientSock);
+      DrehclientSetShmConsumer(SocketEntry, MR_IPC_SHM_NO_CONSUMER);
+      /* without subscription a client gets all commands */
+      MrIpcSubscriptionInit(DrehclientGetSubscription(SocketEntry), TRUE);
+      MrIpcBufferInit(DrehclientGetInput(SocketEntry));
+      DrehclientSetNumPending(SocketEntry, 0);
+      DrehclientSetClosing(SocketEntry, FALSE);
+      MrIpcOutputInit(DrehclientGetOutput(SocketEntry));
       if (DrehscheibeGetVerbose(Data))
          printf("accept new connection %d\n", DrehclientGetSock(SocketEntry));
       MengeAdd(DrehscheibeGetClient(Data), (MengeDataType)SocketEntry);
+      IndexClient(Data, SocketEntry);
    }
    else
    {
       /* can not create client struct, reject */
       if (DrehscheibeGetVerbose(Data))
          puts("reject new connection");
+      free(SocketEntry);
       MrIpcClose(NewClientSock);
    }
 }
 
-static void ProcessSystemData(DrehscheibeStruct *Data, MrIpcCmdType *CmdFrame,
-                              DrehscheibeClientStruct *ClientEntry)
-{  MengeIterator ClientIter;
-   DrehscheibeClientStruct *RcvClientEntry;
+static void ServerData(void *PrivData, int Fd)
+{
+   /* new connection requested */
+   AddNewClient((DrehscheibeStruct *)PrivData);
+}
 
-   MengeInitIterator(&ClientIter, DrehscheibeGetClient(Data));
-   RcvClientEntry = (DrehscheibeClientStruct *)MengeFirst(&ClientIter);
-   while (RcvClientEntry != (DrehscheibeClientStruct *)NULL)
-   {
-      if (DrehclientGetSock(ClientEntry) != DrehclientGetSock(RcvClientEntry))
-      {
-         /* send only to other clients */
-         if (DrehscheibeGetVerbose(Data))
-            printf("send to client with socket %d\n",
-                   DrehclientGetSock(RcvClientEntry));
-         MrIpcSend(DrehclientGetSock(RcvClientEntry), CmdFrame);
-      }
-      RcvClientEntry = (DrehscheibeClientStruct *)MengeNext(&ClientIter);
-   }
+static void SigHandler(int sig)
+{
+   Loop = FALSE;
 }
 
-static BOOL HandleSystemData(DrehscheibeStruct *Data,
-                             DrehscheibeClientStruct *ClientEntry)
-{  MrIpcCmdType CmdFrame;
-   int RcvReturnValue;
-   BOOL Ret;
+static BOOL Start(DrehscheibeStruct *Data)
+{  struct sigaction SigStruct;
 
-   if (DrehscheibeGetVerbose(Data))
-      printf("data on client socket %d available\n",
-             DrehclientGetSock(ClientEntry));
-   MrIpcInit(&CmdFrame);
-   RcvReturnValue = MrIpcRecv(DrehclientGetSock(ClientEntry), &CmdFrame);
-   if (RcvReturnValue == MR_IPC_RCV_ERROR)
+   if ((strlen(DrehscheibeGetInterface(Data)) > 0) &&
+       ((strlen(DrehscheibeGetAddress(Data)) == 0) ||
+        (strcmp(DrehscheibeGetAddress(Data), "0.0.0.0") == 0)))
    {
-      if (DrehscheibeGetVerbose(Data))
-         puts("Error in recieve from socket!");
-      Ret = FALSE;
+      DrehscheibeSetServerSock(Data,
+                               MrIpcStartServerIf(DrehscheibeGetInterface(Data),
+                                                  DrehscheibeGetServerPort(Data)));
    }
-   else if (RcvReturnValue == MR_IPC_RCV_CLOSED)
+   else
+   {
+      DrehscheibeSetServerSock(Data,
+                               MrIpcStartServer(DrehscheibeGetAddress(Data),
+                                                DrehscheibeGetServerPort(Data)));
+   }
+   if ((DrehscheibeGetServerSock(Data) >= 0) &&
+       MrIpcLoopAddFd(DrehscheibeGetEventLoop(Data),
+                      DrehscheibeGetServerSock(Data), ServerData, (void *)Data))
    {
+      DrehscheibeSetShmRing(Data,
+                            MrIpcShmServerCreate(DrehscheibeGetServerPort(Data)));
       if (DrehscheibeGetVerbose(Data))
-         puts("client socket was closed");
-      MrIpcClose(DrehclientGetSock(ClientEntry));
-      Ret = TRUE;
+      {
+         if (DrehscheibeGetShmRing(Data) != (MrIpcShmRingType *)NULL)
+            puts("shared memory ring for local clients created");
+         else
+            puts("no shared memory ring, all clients use sockets");
+         puts("ready for incoming connections");
+      }
+      SigStruct.sa_handler = SigHandler;
+      sigemptyset(&SigStruct.sa_mask);
+      SigStruct.sa_flags = 0;
+      sigaction(SIGINT, &SigStruct, NULL);
+      sigaction(SIGQUIT, &SigStruct, NULL);
+      sigaction(SIGTERM, &SigStruct, NULL);
+      /* a client may go away while we send to it */
+      SigStruct.sa_handler = SIG_IGN;
+      sigaction(SIGPIPE, &SigStruct, NULL);
+      return(TRUE);
    }
    else
    {
-      if (DrehscheibeGetVerbose(Data))
-         printf("read new comand frame from socket %d, cmd %02x\n",
-                MrIpcGetCommand(&CmdFrame), CmdFrame.CanCommand);
-      ProcessSystemData(Data, &CmdFrame, ClientEntry);
-      Ret = FALSE;
+      return(FALSE);
    }
-   return(Ret);
+}
+
+static void Stop(DrehscheibeStruct *Data)
+{
+   if (DrehscheibeGetVerbose(Data))
+      puts("stop network server");
+   if (DrehscheibeGetServerSock(Data) >= 0)
+   {
+      MrIpcLoopRemoveFd(DrehscheibeGetEventLoop(Data),
+                        DrehscheibeGetServerSock(Data));
+      MrIpcClose(DrehscheibeGetServerSock(Data));
+   }
+   MrIpcShmServerDestroy(DrehscheibeGetShmRing(Data),
+                         DrehscheibeGetServerPort(Data));
+   DrehscheibeSetShmRing(Data, (MrIpcShmRingType *)NULL);
 }
 
 void DrehscheibeRun(DrehscheibeStruct *Data)
-{  fd_set ReadFds;
-   int RetVal, HighFd;
-   struct timeval SelectTimeout;
+{  int RetVal;
    DrehscheibeClientStruct *ClientEntry;
    MengeIterator ClientIter;
    time_t Now;
@@ -223,41 +573,14 @@ void DrehscheibeRun(DrehscheibeStruct *Data)
    {
       while (Loop)
       {
-         /* Main loop for receive and send data */
-
-         /* fill fd set for call to select */
-         FD_ZERO(&ReadFds);
-         HighFd = 0;
-         /* 1. server socket */
+         /* Main loop for receive and send data, the server socket and all
+            client sockets are registered at the event loop */
          if (DrehscheibeGetVerbose(Data))
-            printf("add server socket %d\n", DrehscheibeGetServerSock(Data));
-         FD_SET(DrehscheibeGetServerSock(Data), &ReadFds);
-         if (DrehscheibeGetServerSock(Data) > HighFd)
-            HighFd = DrehscheibeGetServerSock(Data);
-         /* 2. client sockets */
-         MengeInitIterator(&ClientIter, DrehscheibeGetClient(Data));
-         ClientEntry = (DrehscheibeClientStruct *)MengeFirst(&ClientIter);
-         while (ClientEntry != (DrehscheibeClientStruct *)NULL)
-         {
-            if (DrehscheibeGetVerbose(Data))
-               printf("add client socket %d\n", DrehclientGetSock(ClientEntry));
-            FD_SET(DrehclientGetSock(ClientEntry), &ReadFds);
-            if (DrehclientGetSock(ClientEntry) > HighFd)
-                  HighFd = DrehclientGetSock(ClientEntry);
-            ClientEntry = (DrehscheibeClientStruct *)MengeNext(&ClientIter);
-         }
-         /* 3. Timeout */
-         SelectTimeout.tv_sec = SELECT_TIMEOUT;
-         SelectTimeout.tv_usec = 0;
-         if (DrehscheibeGetVerbose(Data))
-            printf("wait for %d fd, max %ld s\n", HighFd, SelectTimeout.tv_sec);
-
-         /* wait for data */
-         RetVal = select(HighFd + 1, &ReadFds, NULL, NULL, &SelectTimeout);
+            printf("wait for data, max %d s\n", LOOP_TIMEOUT);
+         RetVal = MrIpcLoopRunOnce(DrehscheibeGetEventLoop(Data),
+                                   LOOP_TIMEOUT * 1000);
          if (DrehscheibeGetVerbose(Data))
-            printf("select liefert %d\n", RetVal);
-
-         /* check, who has data */
+            printf("epoll liefert %d\n", RetVal);
          if (((RetVal == -1) && (errno == EINTR)) || (RetVal == 0))
          {
             /* timeout, time for periodic tasks */
@@ -267,62 +590,8 @@ void DrehscheibeRun(DrehscheibeStruct *Data)
          }
          else if (RetVal < 0)
          {
-            /* error, check if some clients disconnect */
             if (DrehscheibeGetVerbose(Data))
                puts("error in main loop");
-            /* 1) check clients for closed socket */
-            MengeInitIterator(&ClientIter, DrehscheibeGetClient(Data));
-            ClientEntry = (DrehscheibeClientStruct *)MengeFirst(&ClientIter);
-            while (ClientEntry != (DrehscheibeClientStruct *)NULL)
-            {
-               /* check for client socket for data */
-               if (HandleSystemData(Data, ClientEntry))
-               {
-                  StackPush(DrehscheibeGetRemove(Data),
-                            (MengeDataType)ClientEntry);
-               }
-               ClientEntry = (DrehscheibeClientStruct *)MengeNext(&ClientIter);
-            }
-            /* remove clients with closed socket */
-            while (!StackIsEmpty(DrehscheibeGetRemove(Data)))
-            {
-               ClientEntry = (DrehscheibeClientStruct *)StackPop(DrehscheibeGetRemove(Data));
-               MengeRemove(DrehscheibeGetClient(Data),
-                           (MengeDataType)ClientEntry);
-            }
-         }
-         else
-         {
-            /* data, check at which fd */
-            /* 1) check server socket */
-            if (FD_ISSET(DrehscheibeGetServerSock(Data), &ReadFds))
-            {
-               /* new connection requested */
-               AddNewClient(Data);
-            }
-            /* 2) check clients for data */
-            MengeInitIterator(&ClientIter, DrehscheibeGetClient(Data));
-            ClientEntry = (DrehscheibeClientStruct *)MengeFirst(&ClientIter);
-            while (ClientEntry != (DrehscheibeClientStruct *)NULL)
-            {
-               /* check for client socket for data */
-               if (FD_ISSET(DrehclientGetSock(ClientEntry), &ReadFds))
-               {
-                  if (HandleSystemData(Data, ClientEntry))
-                  {
-                     StackPush(DrehscheibeGetRemove(Data),
-                               (MengeDataType)ClientEntry);
-                  }
-               }
-               ClientEntry = (DrehscheibeClientStruct *)MengeNext(&ClientIter);
-            }
-            /* remove closed clients */
-            while (!StackIsEmpty(DrehscheibeGetRemove(Data)))
-            {
-               ClientEntry = (DrehscheibeClientStruct *)StackPop(DrehscheibeGetRemove(Data));
-               MengeRemove(DrehscheibeGetClient(Data),
-                           (MengeDataType)ClientEntry);
-            }
          }
       }
 
@@ -333,6 +602,8 @@ void DrehscheibeRun(DrehscheibeStruct *Data)
       ClientEntry = (DrehscheibeClientStruct *)MengeFirst(&ClientIter);
       while (ClientEntry != (DrehscheibeClientStruct *)NULL)
       {
+         MrIpcLoopRemoveFd(DrehscheibeGetEventLoop(Data),
+                           DrehclientGetSock(ClientEntry));
          MrIpcClose(DrehclientGetSock(ClientEntry));
          DrehclientSetSock(ClientEntry, -1);
          ClientEntry = (DrehscheibeClientStruct *)MengeNext(&ClientIter);
@@ -1,17 +1,39 @@
 #ifndef DREHSCHEIBE_H
 #define DREHSCHEIBE_H
 
+#include <sys/uio.h>
 #include <boolean.h>
 #include <menge.h>
 #include <stack.h>
+#include <mr_ipc.h>
 
 typedef struct {
+   void *Drehscheibe;
    int ClientSock;
+   int ShmConsumer;
+   MrIpcSubscriptionType Subscription;
+   MrIpcBufferType Input;
+   struct iovec Pending[MR_IPC_BUFFER_CMDS];
+   int NumPending;
+   BOOL Closing;
+   MrIpcOutputType Output;
 } DrehscheibeClientStruct;
 
-#define DrehclientSetSock(Data, Sock) (Data)->ClientSock=Sock
+#define DrehclientSetDrehscheibe(Data, Dreh)     (Data)->Drehscheibe=Dreh
+#define DrehclientSetSock(Data, Sock)            (Data)->ClientSock=Sock
+#define DrehclientSetShmConsumer(Data, Consumer) (Data)->ShmConsumer=Consumer
+#define DrehclientSetNumPending(Data, Num)       (Data)->NumPending=Num
+#define DrehclientSetClosing(Data, Close)        (Data)->Closing=Close
 
-#define DrehclientGetSock(Data) (Data)->ClientSock
+#define DrehclientGetDrehscheibe(Data)  (Data)->Drehscheibe
+#define DrehclientGetSock(Data)         (Data)->ClientSock
+#define DrehclientGetShmConsumer(Data)  (Data)->ShmConsumer
+#define DrehclientGetSubscription(Data) &((Data)->Subscription)
+#define DrehclientGetInput(Data)        &((Data)->Input)
+#define DrehclientGetPending(Data)      (Data)->Pending
+#define DrehclientGetNumPending(Data)   (Data)->NumPending
+#define DrehclientGetClosing(Data)      (Data)->Closing
+#define DrehclientGetOutput(Data)       &((Data)->Output)
 
 typedef struct {
    BOOL Verbosity;
@@ -19,8 +41,12 @@ typedef struct {
    char *Address;
    int ServerPort;
    int ServerSock;
+   MrIpcLoopType *EventLoop;
    Menge *SocketClients;
-   Stack *RemoveClients;
+   Stack *FlushClients;
+   MrIpcShmRingType *ShmRing;
+   Menge *Subscribers[MR_IPC_NUM_COMMANDS];
+   Menge *CanSubscribers[MR_IPC_NUM_CAN_COMMANDS];
 } DrehscheibeStruct;
 
 #define DrehscheibeSetVerbose(Data, Verbose) (Data)->Verbosity=Verbose
@@ -29,7 +55,11 @@ typedef struct {
 #define DrehscheibeSetServerPort(Data, Port) (Data)->ServerPort=Port
 #define DrehscheibeSetServerSock(Data, Sock) (Data)->ServerSock=Sock
 #define DrehscheibeSetClient(Data, Client)   (Data)->SocketClients=Client
-#define DrehscheibeSetRemove(Data, Remove)   (Data)->RemoveClients=Remove
+#define DrehscheibeSetEventLoop(Data, Ev)    (Data)->EventLoop=Ev
+#define DrehscheibeSetFlush(Data, Flush)     (Data)->FlushClients=Flush
+#define DrehscheibeSetShmRing(Data, Ring)    (Data)->ShmRing=Ring
+#define DrehscheibeSetSubscribers(Data, Cmd, Clients)       (Data)->Subscribers[Cmd]=Clients
+#define DrehscheibeSetCanSubscribers(Data, CanCmd, Clients) (Data)->CanSubscribers[CanCmd]=Clients
 
 #define DrehscheibeGetVerbose(Data)    (Data)->Verbosity
 #define DrehscheibeGetInterface(Data)  (Data)->Interface
@@ -37,7 +67,11 @@ typedef struct {
 #define DrehscheibeGetServerPort(Data) (Data)->ServerPort
 #define DrehscheibeGetServerSock(Data) (Data)->ServerSock
 #define DrehscheibeGetClient(Data)     (Data)->SocketClients
-#define DrehscheibeGetRemove(Data)     (Data)->RemoveClients
+#define DrehscheibeGetEventLoop(Data)  (Data)->EventLoop
+#define DrehscheibeGetFlush(Data)      (Data)->FlushClients
+#define DrehscheibeGetShmRing(Data)    (Data)->ShmRing
+#define DrehscheibeGetSubscribers(Data, Cmd)       (Data)->Subscribers[Cmd]
+#define DrehscheibeGetCanSubscribers(Data, CanCmd) (Data)->CanSubscribers[CanCmd]
 
 DrehscheibeStruct *DrehscheibeCreate(void);
 void DrehscheibeDestroy(DrehscheibeStruct *Data);
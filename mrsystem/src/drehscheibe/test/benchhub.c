@@ -0,0 +1,271 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/wait.h>
+#include <boolean.h>
+#include <mr_ipc.h>
+
+/*
+* Durchsatz der drehscheibe messen
+*
+* Ein Sender schickt Lokgeschwindigkeiten in Bl&ouml;cken an die drehscheibe,
+* die sie an alle Empf&auml;nger verteilt. Jeder Empf&auml;nger quittiert
+* das letzte Kommando eines Blocks, erst dann kommt der n&auml;chste Block.
+* So bleibt die Messung ohne Verluste in vollen Socketpuffern vergleichbar.
+* Zus&auml;tzliche Empf&auml;nger abonnieren nur MrIpcCmdRun, sie d&uuml;rfen
+* die Lokgeschwindigkeiten nicht sehen und die drehscheibe nicht bremsen.
+* Ist ein Block gr&ouml;&szlig;er als der Ring, nimmt die drehscheibe
+* Empf&auml;nger, die nicht hinterherkommen, vom Ring. Sie d&uuml;rfen dabei
+* kein Kommando verlieren.
+*
+* Die drehscheibe mu&szlig; vorher gestartet werden, z.B. mit
+*    drehscheibe -f -a 127.0.0.1 -p 15731
+*/
+
+#define DEFAULT_ADDRESS   "127.0.0.1"
+#define DEFAULT_PORT      15731
+#define DEFAULT_RECEIVERS 8
+#define DEFAULT_IDLE      0
+#define DEFAULT_FRAMES    100000
+#define DEFAULT_BLOCK     256
+#define ACK_TIMEOUT       1
+#define CONNECT_TIMEOUT   5
+
+static void usage(char *name)
+{
+   printf("%s [-a <addr>] [-p <port>] [-r <receivers>] [-i <idle>] [-n <frames>] [-b <block>] [-s]\n", name);
+   puts("-a - network address of drehscheibe (" DEFAULT_ADDRESS ")");
+   printf("-p - port of drehscheibe (%d)\n", DEFAULT_PORT);
+   printf("-r - number of receiving clients (%d)\n", DEFAULT_RECEIVERS);
+   printf("-i - number of clients subscribed to run/stop only (%d)\n", DEFAULT_IDLE);
+   printf("-n - number of frames to send (%d)\n", DEFAULT_FRAMES);
+   printf("-b - frames per block (%d)\n", DEFAULT_BLOCK);
+   puts("-s - receivers read from the shared memory ring");
+}
+
+static double Seconds(void)
+{  struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+   return(Now.tv_sec + Now.tv_nsec / 1e9);
+}
+
+static int Connect(char *Addr, int Port)
+{  int Sock, NoDelay;
+
+   /* measure the drehscheibe and not the Nagle algorithm of the bench */
+   Sock = MrIpcConnect(Addr, Port);
+   if (Sock >= 0)
+   {
+      NoDelay = 1;
+      setsockopt(Sock, IPPROTO_TCP, TCP_NODELAY, &NoDelay, sizeof(NoDelay));
+   }
+   return(Sock);
+}
+
+static void SendAck(int Sock)
+{  MrIpcCmdType Ack;
+
+   MrIpcInit(&Ack);
+   MrIpcCmdSetRequestMember(&Ack);
+   MrIpcSend(Sock, &Ack);
+}
+
+static int Receiver(char *Addr, int Port, BOOL UseShm, int Block, BOOL Idle)
+{  int Sock, Ret;
+   MrIpcShmType *Shm;
+   MrIpcSubscriptionType Subscription;
+   MrIpcCmdType CmdFrame;
+   fd_set ReadFds;
+   unsigned long Next, Addr2, Missing, Received;
+   unsigned Speed;
+   SwitchType Switch;
+
+   Sock = Connect(Addr, Port);
+   if (Sock < 0)
+   {
+      puts("receiver can not connect to drehscheibe");
+      return(1);
+   }
+   Shm = UseShm ? MrIpcShmAttach(Sock, Port) : (MrIpcShmType *)NULL;
+   if (UseShm && (Shm == (MrIpcShmType *)NULL))
+      puts("receiver has no shared memory ring, use socket");
+   if (Idle)
+   {
+      MrIpcSubscriptionInit(&Subscription, FALSE);
+      MrIpcSubscriptionSetCmd(&Subscription, MrIpcCmdRun);
+      MrIpcSubscribe(Sock, &Subscription);
+   }
+   SendAck(Sock);
+   Next = 0;
+   Missing = 0;
+   Received = 0;
+   while (TRUE)
+   {
+      FD_ZERO(&ReadFds);
+      FD_SET(Sock, &ReadFds);
+      if (select(Sock + 1, &ReadFds, NULL, NULL, NULL) <= 0)
+         continue;
+      Ret = MrIpcShmRecv(Shm, Sock, &CmdFrame);
+      if (Ret == MR_IPC_RCV_CLOSED)
+         break;
+      else if (Ret == MR_IPC_RCV_ERROR)
+         continue;
+      if (MrIpcGetCommand(&CmdFrame) == MrIpcCmdRun)
+      {
+         MrIpcCmdGetRun(&CmdFrame, &Switch);
+         if (Switch == Off)
+            break;
+      }
+      else if (MrIpcGetCommand(&CmdFrame) == MrIpcCmdLocomotiveSpeed)
+      {
+         MrIpcCmdGetLocomotiveSpeed(&CmdFrame, &Addr2, &Speed);
+         if (Addr2 != Next)
+            Missing += Addr2 - Next;
+         Next = Addr2 + 1;
+         Received++;
+         if (!Idle && (Next % Block == 0))
+            SendAck(Sock);
+      }
+   }
+   if (Idle && (Received > 0))
+      printf("idle receiver %d: %lu frames not subscribed\n", getpid(),
+             Received);
+   else if (!Idle && (Missing > 0))
+      printf("receiver %d: %lu frames, %lu missing\n", getpid(), Received,
+             Missing);
+   if ((Shm != (MrIpcShmType *)NULL) && MrIpcShmGetStopped(Shm))
+      printf("receiver %d: did not keep up with the ring, read from socket\n",
+             getpid());
+   MrIpcShmDetach(Shm);
+   MrIpcClose(Sock);
+   return(0);
+}
+
+static int WaitForAcks(int Sock, int Receivers, int Seconds)
+{  fd_set ReadFds;
+   struct timeval Timeout;
+   MrIpcCmdType CmdFrame;
+   int Acks;
+
+   Acks = 0;
+   while (Acks < Receivers)
+   {
+      FD_ZERO(&ReadFds);
+      FD_SET(Sock, &ReadFds);
+      Timeout.tv_sec = Seconds;
+      Timeout.tv_usec = 0;
+      if (select(Sock + 1, &ReadFds, NULL, NULL, &Timeout) <= 0)
+         return(FALSE);
+      if (MrIpcRecv(Sock, &CmdFrame) != MR_IPC_RCV_OK)
+         return(FALSE);
+      if (MrIpcGetCommand(&CmdFrame) == MrIpcCmdRequestMember)
+         Acks++;
+   }
+   return(TRUE);
+}
+
+int main(int argc, char *argv[])
+{  char *Addr;
+   int Port, Receivers, Idle, Frames, Block, Sock, i, c, Timeouts;
+   BOOL UseShm;
+   MrIpcCmdType CmdFrame;
+   double Start, Elapsed;
+
+   Addr = DEFAULT_ADDRESS;
+   Port = DEFAULT_PORT;
+   Receivers = DEFAULT_RECEIVERS;
+   Idle = DEFAULT_IDLE;
+   Frames = DEFAULT_FRAMES;
+   Block = DEFAULT_BLOCK;
+   UseShm = FALSE;
+   while ((c = getopt(argc, argv, "a:p:r:i:n:b:s?")) != -1)
+   {
+      switch (c)
+      {
+         case 'a':
+            Addr = optarg;
+            break;
+         case 'p':
+            Port = atoi(optarg);
+            break;
+         case 'r':
+            Receivers = atoi(optarg);
+            break;
+         case 'i':
+            Idle = atoi(optarg);
+            break;
+         case 'n':
+            Frames = atoi(optarg);
+            break;
+         case 'b':
+            Block = atoi(optarg);
+            break;
+         case 's':
+            UseShm = TRUE;
+            break;
+         default:
+            usage(argv[0]);
+            return(1);
+      }
+   }
+   Frames -= Frames % Block;
+
+   Sock = Connect(Addr, Port);
+   if (Sock < 0)
+   {
+      puts("can not connect to drehscheibe");
+      return(1);
+   }
+   for (i = 0; i < Receivers + Idle; i++)
+   {
+      if (fork() == 0)
+      {
+         MrIpcClose(Sock);
+         return(Receiver(Addr, Port, UseShm, Block, i >= Receivers));
+      }
+   }
+   /* the receivers send an acknowledge when they are connected */
+   if (!WaitForAcks(Sock, Receivers + Idle, CONNECT_TIMEOUT))
+   {
+      puts("not all receivers connected");
+      MrIpcClose(Sock);
+      return(1);
+   }
+
+   Timeouts = 0;
+   Start = Seconds();
+   for (i = 0; i < Frames; i++)
+   {
+      MrIpcInit(&CmdFrame);
+      MrIpcCmdSetLocomotiveSpeed(&CmdFrame, i, i % 1024);
+      MrIpcSend(Sock, &CmdFrame);
+      if ((i + 1) % Block == 0 && !WaitForAcks(Sock, Receivers, ACK_TIMEOUT))
+         Timeouts++;
+   }
+   Elapsed = Seconds() - Start;
+
+   MrIpcInit(&CmdFrame);
+   MrIpcCmdSetRun(&CmdFrame, Off);
+   MrIpcSend(Sock, &CmdFrame);
+   for (i = 0; i < Receivers + Idle; i++)
+      wait(NULL);
+   MrIpcClose(Sock);
+
+   printf("%s: %d receivers, %d idle, %d frames in %.3f s\n",
+          UseShm ? "shared memory" : "socket", Receivers, Idle, Frames,
+          Elapsed);
+   printf("%.0f frames/s through the drehscheibe, %.0f deliveries/s",
+          Frames / Elapsed, Frames * (double)Receivers / Elapsed);
+   if (Timeouts > 0)
+      printf(", %d blocks not acknowledged", Timeouts);
+   putchar('\n');
+   return(0);
+}
@@ -18,12 +18,11 @@ Cs2parser *Cs2pCreate(void)
    NewData = (Cs2parser *)malloc(sizeof(Cs2parser));
    if (NewData != NULL)
    {
-      Cs2pSetScanner(NewData, ScanCreate());
-      if (Cs2pGetScanner(NewData) == (Scanner *)NULL)
-      {
-         free(NewData);
-         NewData = (Cs2parser *)NULL;
-      }
+      Cs2pSetBuf(NewData, (char *)NULL);
+      Cs2pSetLen(NewData, 0);
+      Cs2pSetPos(NewData, 0);
+      Cs2pSetNumKeywords(NewData, 0);
+      Cs2pSetKeywords(NewData, (ScanKeyword *)NULL);
    }
    return(NewData);
 }
@@ -14,6 +14,5 @@
 */
 void Cs2pDestroy(Cs2parser *Data)
 {
-   ScanDestroy(Cs2pGetScanner(Data));
    free(Data);
 }
@@ -275,57 +275,65 @@ ScanKeyword LoklisteKeywords[] = {
 * @param[in] Len L&auml;nge (Anzahl Bytes) der zu parsenden Daten
 */
 void Cs2pInit(Cs2parser *Data, int Type, char *InputLine, int Len)
-{
+{  char *Ende;
+
    Cs2pSetVerbose(Data, FALSE);
+   /* config data received over CAN is padded with zeros to full blocks */
+   Ende = (Len > 0) ? memchr(InputLine, '\0', Len) : (char *)NULL;
+   Cs2pSetBuf(Data, InputLine);
+   Cs2pSetLen(Data, Ende == (char *)NULL ? Len : Ende - InputLine);
+   Cs2pSetPos(Data, 0);
+   Cs2pSetNumKeywords(Data, 0);
+   Cs2pSetKeywords(Data, (ScanKeyword *)NULL);
    if (Type == PARSER_TYPE_LOKNAMEN)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               4, LokNameKeywords);
+      Cs2pSetNumKeywords(Data, 4);
+      Cs2pSetKeywords(Data, LokNameKeywords);
    }
    else if (Type == PARSER_TYPE_LOKINFO)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               19, LokInfoKeywords);
+      Cs2pSetNumKeywords(Data, 19);
+      Cs2pSetKeywords(Data, LokInfoKeywords);
    }
    else if (Type == PARSER_TYPE_GERAET_VRS)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               8, GeraetVrsKeywords);
+      Cs2pSetNumKeywords(Data, 8);
+      Cs2pSetKeywords(Data, GeraetVrsKeywords);
    }
    else if (Type == PARSER_TYPE_LOK_CS2)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               35, LokCs2Keywords);
+      Cs2pSetNumKeywords(Data, 35);
+      Cs2pSetKeywords(Data, LokCs2Keywords);
    }
    else if (Type == PARSER_TYPE_GLEISBILD_CS2)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               11, GleisbildCs2Keywords);
+      Cs2pSetNumKeywords(Data, 11);
+      Cs2pSetKeywords(Data, GleisbildCs2Keywords);
    }
    else if (Type == PARSER_TYPE_MAGNETARTIKEL_CS2)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               13, MagnetartikelCs2Keywords);
+      Cs2pSetNumKeywords(Data, 13);
+      Cs2pSetKeywords(Data, MagnetartikelCs2Keywords);
    }
    else if (Type == PARSER_TYPE_FAHRSTRASSEN_CS2)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               20, FahrstrassenCs2Keywords);
+      Cs2pSetNumKeywords(Data, 20);
+      Cs2pSetKeywords(Data, FahrstrassenCs2Keywords);
    }
    else if (Type == PARSER_TYPE_GLEISBILD_SEITE)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               13, GleisbildPageCs2Keywords);
+      Cs2pSetNumKeywords(Data, 13);
+      Cs2pSetKeywords(Data, GleisbildPageCs2Keywords);
    }
    else if (Type == PARSER_TYPE_HEADER_CS2)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               8, HeaderCs2Keywords);
+      Cs2pSetNumKeywords(Data, 8);
+      Cs2pSetKeywords(Data, HeaderCs2Keywords);
    }
    else if (Type == PARSER_TYPE_LOKLISTE)
    {
-      ScanInit(Cs2pGetScanner(Data), (char *)NULL, InputLine, Len,
-               6, LoklisteKeywords);
+      Cs2pSetNumKeywords(Data, 6);
+      Cs2pSetKeywords(Data, LoklisteKeywords);
    }
 }
 
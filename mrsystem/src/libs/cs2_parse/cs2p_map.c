@@ -0,0 +1,63 @@
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cs2parse.h"
+
+/** @file */
+
+/**
+* @brief *.cs2 Datei in den Speicher einblenden
+*
+* Die Datei wird nur gelesen und nicht kopiert. Der Puffer kann direkt an
+* Cs2pInit() &uuml;bergeben werden und mu&szlig; nach dem Parsen mit
+* Cs2pUnmapFile() freigegeben werden.
+*
+* @param[in] FileName Name der Datei
+* @param[out] Len L&auml;nge (Anzahl Bytes) der Datei
+*
+* @return Zeiger auf den Inhalt der Datei oder NULL, wenn die Datei nicht
+*         existiert oder leer ist.
+*/
+char *Cs2pMapFile(char *FileName, int *Len)
+{  int Fd;
+   struct stat Attribut;
+   char *Buf;
+
+   Buf = (char *)NULL;
+   Fd = open(FileName, O_RDONLY);
+   if (Fd >= 0)
+   {
+      if ((fstat(Fd, &Attribut) == 0) && (Attribut.st_size > 0))
+      {
+         Buf = (char *)mmap(NULL, Attribut.st_size, PROT_READ, MAP_PRIVATE,
+                            Fd, 0);
+         if (Buf == (char *)MAP_FAILED)
+         {
+            Buf = (char *)NULL;
+         }
+         else
+         {
+            madvise(Buf, Attribut.st_size, MADV_SEQUENTIAL);
+            *Len = Attribut.st_size;
+         }
+      }
+      close(Fd);
+   }
+   return(Buf);
+}
+
+/**
+* @brief Mit Cs2pMapFile() eingeblendete Datei freigeben
+*
+* @param[in] Buf Zeiger auf den Inhalt der Datei, darf NULL sein
+* @param[in] Len L&auml;nge (Anzahl Bytes) der Datei
+*/
+void Cs2pUnmapFile(char *Buf, int Len)
+{
+   if (Buf != (char *)NULL)
+   {
+      munmap(Buf, Len);
+   }
+}
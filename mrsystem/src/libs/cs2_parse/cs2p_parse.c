@@ -1,28 +1,104 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include <boolean.h>
 #include <scanner.h>
 #include "cs2parse.h"
 #include "cs2ptoken.h"
 
-static void PrintError(Cs2parser *Data, char *ErrorString)
-{  int i;
+static void PrintError(Cs2parser *Data, char *Pos, char *ErrorString)
+{  char *Zeichen;
 
    if (Cs2pGetVerbose(Data))
    {
-      fprintf(stderr, "\nERROR: %s\n%s\n", ErrorString,
-              Cs2pGetScanner(Data)->Puffer);
-      for (i = 0; i < Cs2pGetScanner(Data)->AktZeichen; i++)
+      fprintf(stderr, "\nERROR: %s\n%.*s\n", ErrorString,
+              Cs2pGetLineLen(Data), Cs2pGetLine(Data));
+      for (Zeichen = Cs2pGetLine(Data); Zeichen < Pos; Zeichen++)
          fputc(' ', stderr);
       fputs("^\n\n", stderr);
    }
 }
 
-static void DoParagraph(Cs2parser *Data)
+static BOOL NextLine(Cs2parser *Data)
+{  char *Start, *Ende;
+   int Rest;
+
+   Rest = Cs2pGetLen(Data) - Cs2pGetPos(Data);
+   if (Rest <= 0)
+   {
+      return(FALSE);
+   }
+   Start = Cs2pGetBuf(Data) + Cs2pGetPos(Data);
+   Ende = memchr(Start, '\n', Rest);
+   if (Ende == (char *)NULL)
+   {
+      Cs2pSetLineLen(Data, Rest);
+      Cs2pSetPos(Data, Cs2pGetLen(Data));
+   }
+   else
+   {
+      Cs2pSetLineLen(Data, Ende - Start);
+      Cs2pSetPos(Data, Cs2pGetPos(Data) + Cs2pGetLineLen(Data) + 1);
+   }
+   if ((Cs2pGetLineLen(Data) > 0) &&
+       (Start[Cs2pGetLineLen(Data) - 1] == '\r'))
+   {
+      Cs2pSetLineLen(Data, Cs2pGetLineLen(Data) - 1);
+   }
+   Cs2pSetLine(Data, Start);
+   return(TRUE);
+}
+
+static char *SkipBlanks(char *Zeichen, char *Ende)
+{
+   while ((Zeichen < Ende) && (*Zeichen == ' '))
+      Zeichen++;
+   return(Zeichen);
+}
+
+static int Keyword(Cs2parser *Data, char **Zeichen, char *Ende)
+{  char *Start;
+   int Len, k;
+   ScanKeyword *Keywords;
+
+   Start = *Zeichen;
+   while ((*Zeichen < Ende) &&
+          (isalnum((unsigned char)**Zeichen) || (**Zeichen == '_')))
+      (*Zeichen)++;
+   Len = *Zeichen - Start;
+   if (Len < (int)sizeof(Cs2pGetName(Data)))
+   {
+      memcpy(Cs2pGetName(Data), Start, Len);
+      Cs2pGetName(Data)[Len] = '\0';
+   }
+   else
+   {
+      memcpy(Cs2pGetName(Data), Start, sizeof(Cs2pGetName(Data)) - 1);
+      Cs2pGetName(Data)[sizeof(Cs2pGetName(Data)) - 1] = '\0';
+   }
+   if (Len == 0)
+   {
+      return(BezeichnerSy);
+   }
+   Keywords = Cs2pGetKeywords(Data);
+   for (k = 0; k < Cs2pGetNumKeywords(Data); k++)
+   {
+      if ((Keywords[k].Keyword[0] == *Start) &&
+          (strncmp(Keywords[k].Keyword, Start, Len) == 0) &&
+          (Keywords[k].Keyword[Len] == '\0'))
+      {
+         return(Keywords[k].Symbol);
+      }
+   }
+   return(BezeichnerSy);
+}
+
+static void DoParagraph(Cs2parser *Data, char *Zeichen, char *Ende)
 {  int Token;
 
-   Token = Scan(Cs2pGetScanner(Data));
+   Zeichen = SkipBlanks(Zeichen, Ende);
+   Token = Keyword(Data, &Zeichen, Ende);
    if ((Token == PARSER_TOKEN_KEYWORD_LOK) ||
        (Token == PARSER_TOKEN_KEYWORD_NUMLOKS) ||
        (Token == PARSER_TOKEN_KEYWORD_LOKOMOTIVE) ||
@@ -34,7 +110,6 @@ static void DoParagraph(Cs2parser *Data)
        (Token == PARSER_TOKEN_KEYWORD_LOKSTATUS) ||
        (Token == PARSER_TOKEN_KEYWORD_LOKLISTE))
    {
-      Cs2pSetName(Data, ScanGetString(Cs2pGetScanner(Data)));
       if (Cs2pGetVerbose(Data))
          printf("Parser: paragraph >%s< token %d\n", Cs2pGetName(Data), Token);
       if (Token == PARSER_TOKEN_KEYWORD_LOK)
@@ -57,41 +132,30 @@ static void DoParagraph(Cs2parser *Data)
          Cs2pSetSubType(Data, PARSER_PARAGRAPH_LOKSTATUS);
       else if (Token == PARSER_TOKEN_KEYWORD_LOKLISTE)
          Cs2pSetSubType(Data, PARSER_PARAGRAPH_LOKLISTE);
-      else
-         Cs2pSetSubType(Data, 0);
-      Token = Scan(Cs2pGetScanner(Data));
-      switch (Token)
-      {
-         case MengezuSy:
-            do {
-               Token = Scan(Cs2pGetScanner(Data));
-            } while (Token != EolnSy);
-            break;
-         default:
-            PrintError(Data, "Unexpected token for paragraph!");
-            break;
-      }
    }
    else
    {
-      Cs2pSetSubType(Data, 0);
+      Cs2pSetSubType(Data, PARSER_PARAGRAPH_UNDEFINED);
       if (Cs2pGetVerbose(Data))
          printf("Parser: found %d\n", Token);
    }
+   Zeichen = SkipBlanks(Zeichen, Ende);
+   if ((Zeichen >= Ende) || (*Zeichen != ']'))
+      PrintError(Data, Zeichen, "Unexpected token for paragraph!");
 }
 
-static void DoValue(Cs2parser *Data, int StartToken)
-{  int Token;
+static int DoValue(Cs2parser *Data, char *Zeichen, char *Ende)
+{  int Token, Len;
 
-   Token = StartToken;
-   while (Token == PunktSy)
+   while ((Zeichen < Ende) && ((*Zeichen == '.') || (*Zeichen == ' ')))
    {
-      if (Token == PunktSy)
+      if (*Zeichen == '.')
       {
          Cs2pSetLevel(Data, Cs2pGetLevel(Data) + 1);
       }
-      Token = Scan(Cs2pGetScanner(Data));
+      Zeichen++;
    }
+   Token = Keyword(Data, &Zeichen, Ende);
    if ((Token == PARSER_TOKEN_KEYWORD_LOK) ||
        (Token == PARSER_TOKEN_KEYWORD_LOKOMOTIVE) ||
        (Token == PARSER_TOKEN_KEYWORD_NAME) ||
@@ -161,7 +225,6 @@ static void DoValue(Cs2parser *Data, int StartToken)
        (Token == PARSER_TOKEN_KEYWORD_LLINDEX) ||
        (Token == PARSER_TOKEN_KEYWORD_CRC))
    {
-      Cs2pSetName(Data, ScanGetString(Cs2pGetScanner(Data)));
       if (Cs2pGetVerbose(Data))
          printf("Parser: value name >%s<\n", Cs2pGetName(Data));
       if (Token == PARSER_TOKEN_KEYWORD_LOK)
@@ -300,31 +363,39 @@ static void DoValue(Cs2parser *Data, int StartToken)
          Cs2pSetSubType(Data, PARSER_VALUE_LLINDEX);
       else if (Token == PARSER_TOKEN_KEYWORD_CRC)
          Cs2pSetSubType(Data, PARSER_VALUE_CRC);
-      Token = Scan(Cs2pGetScanner(Data));
-      switch (Token)
+      Zeichen = SkipBlanks(Zeichen, Ende);
+      if (Zeichen >= Ende)
+      {
+         if (Cs2pGetVerbose(Data))
+            puts("Parser: found eol");
+         Cs2pSetValue(Data, "");
+      }
+      else if (*Zeichen == '=')
       {
-         case GleichSy:
-            if (Cs2pGetVerbose(Data))
-               puts("Parser: found '='");
-            Token = ScanEol(Cs2pGetScanner(Data));
-            Cs2pSetValue(Data, ScanGetString(Cs2pGetScanner(Data)));
-            if (Cs2pGetVerbose(Data))
-               printf("Parser: value >%s<\n",
-                      ScanGetString(Cs2pGetScanner(Data)));
-            Token = Scan(Cs2pGetScanner(Data));
-            break;
-         case EolnSy:
-            if (Cs2pGetVerbose(Data))
-               puts("Parser: found eol");
-            Cs2pSetValue(Data, "");
-            break;
-         default:
-            PrintError(Data, "Unexpected token for value!");
-            break;
+         if (Cs2pGetVerbose(Data))
+            puts("Parser: found '='");
+         /* the value is the rest of the line */
+         Zeichen++;
+         Len = Ende - Zeichen;
+         if (Len >= (int)sizeof(Cs2pGetValue(Data)))
+            Len = sizeof(Cs2pGetValue(Data)) - 1;
+         memcpy(Cs2pGetValue(Data), Zeichen, Len);
+         Cs2pGetValue(Data)[Len] = '\0';
+         if (Cs2pGetVerbose(Data))
+            printf("Parser: value >%s<\n", Cs2pGetValue(Data));
       }
+      else
+      {
+         PrintError(Data, Zeichen, "Unexpected token for value!");
+         return(PARSER_ERROR);
+      }
+      return(PARSER_VALUE);
    }
    else
-      PrintError(Data, "Unexpected token for name-value!");
+   {
+      PrintError(Data, Zeichen, "Unexpected token for name-value!");
+      return(PARSER_ERROR);
+   }
 }
 
 /** @file */
@@ -343,6 +414,10 @@ static void DoValue(Cs2parser *Data, int StartToken)
 * Diese Funktion wird ein einer Schleife  aufgerufen, bis das Ende der
 * Eingangsdaten erreicht ist.
 *
+* Jeder Aufruf verarbeitet genau eine Zeile. Eine Zeile, die nicht erkannt
+* wird, liefert PARSER_ERROR und der n&auml;chste Aufruf macht mit der
+* folgenden Zeile weiter.
+*
 * Damit k&ouml;nnte eine Parserschleife wie folgt (Ausschnitt) aussehen:
 *
 *    do {
@@ -377,52 +452,45 @@ static void DoValue(Cs2parser *Data, int StartToken)
 * @return Typ der erkannten Information
 */
 int Cs2pParse(Cs2parser *Data)
-{  int Token, Ret;
+{  char *Zeichen, *Ende;
+   int Ret;
 
-   Token = Scan(Cs2pGetScanner(Data));
-   Ret = PARSER_ERROR;
-   switch (Token)
+   Zeichen = (char *)NULL;
+   Ende = (char *)NULL;
+   if (NextLine(Data))
    {
-      case EofSy:
-      case EolnSy:
-         if (Cs2pGetVerbose(Data))
-            puts("Parser: EOF reached");
-         Cs2pSetType(Data, PARSER_EOF);
-         Ret = PARSER_EOF;
-         break;
-      case MengeaufSy:
-         if (Cs2pGetVerbose(Data))
-            puts("Parser: Paragraph found");
-         Cs2pSetType(Data, PARSER_PARAGRAPH);
-         DoParagraph(Data);
-         Ret = PARSER_PARAGRAPH;
-         break;
-      case PunktSy:
-         if (Cs2pGetVerbose(Data))
-            puts("Parser: Value found");
-         Cs2pSetLevel(Data, 0);
-         Cs2pSetType(Data, PARSER_VALUE);
-         DoValue(Data, Token);
-         Ret = PARSER_VALUE;
-         break;
-      default:
-         if (Token >= PARSER_TOKEN_KEYWORD_LOK)
-         {
-            if (Cs2pGetVerbose(Data))
-               puts("Parser: Value found");
-            Cs2pSetLevel(Data, 0);
-            Cs2pSetType(Data, PARSER_VALUE);
-            DoValue(Data, Token);
-            Ret = PARSER_VALUE;
-         }
-         else
-         {
-            if (Cs2pGetVerbose(Data))
-               printf("Parser: token 0x%x\n", Token);
-            PrintError(Data, "Unexpected character!");
-            Ret = PARSER_ERROR;
-         }
-         break;
+      Ende = Cs2pGetLine(Data) + Cs2pGetLineLen(Data);
+      Zeichen = SkipBlanks(Cs2pGetLine(Data), Ende);
+   }
+   if (Zeichen == Ende)
+   {
+      if (Cs2pGetVerbose(Data))
+         puts("Parser: EOF reached");
+      Cs2pSetType(Data, PARSER_EOF);
+      Ret = PARSER_EOF;
+   }
+   else if (*Zeichen == '[')
+   {
+      if (Cs2pGetVerbose(Data))
+         puts("Parser: Paragraph found");
+      Cs2pSetType(Data, PARSER_PARAGRAPH);
+      DoParagraph(Data, Zeichen + 1, Ende);
+      Ret = PARSER_PARAGRAPH;
+   }
+   else if ((*Zeichen == '.') || isalpha((unsigned char)*Zeichen))
+   {
+      if (Cs2pGetVerbose(Data))
+         puts("Parser: Value found");
+      Cs2pSetLevel(Data, 0);
+      Cs2pSetType(Data, PARSER_VALUE);
+      Ret = DoValue(Data, Zeichen, Ende);
+   }
+   else
+   {
+      if (Cs2pGetVerbose(Data))
+         printf("Parser: character 0x%x\n", (unsigned char)*Zeichen);
+      PrintError(Data, Zeichen, "Unexpected character!");
+      Ret = PARSER_ERROR;
    }
    return(Ret);
 }
@@ -11,6 +11,10 @@
 * Funktion in einer Schleife so lange aufgerufen, bis das Ende der Daten
 * erreicht ist.
 *
+* Der Parser arbeitet immer auf einem Puffer im Speicher, entweder auf den
+* per CAN empfangenen Daten oder auf einer mit Cs2pMapFile() eingeblendeten
+* Datei. Er zerlegt den Puffer zeilenweise, es wird also nichts kopiert.
+*
 * @author Michael Bernstein
 */
 
@@ -150,7 +154,13 @@
 */
 typedef struct {
    BOOL Verbose;
-   Scanner *Scanner;
+   char *Buf;
+   int Len;
+   int Pos;
+   char *Line;
+   int LineLen;
+   int NumKeywords;
+   ScanKeyword *Keywords;
    int Type;
    int SubType;
    int Level;
@@ -163,12 +173,20 @@ void Cs2pDestroy(Cs2parser *Data);
 void Cs2pInit(Cs2parser *Data, int Type, char *InputLine, int Len);
 #define Cs2pExit(Data)
 int Cs2pParse(Cs2parser *Data);
+char *Cs2pMapFile(char *FileName, int *Len);
+void Cs2pUnmapFile(char *Buf, int Len);
 
 /**
 * @brief Makros, um Felder im Kommando zu setzen
 */
 #define Cs2pSetVerbose(Data, Val) (Data)->Verbose=Val
-#define Cs2pSetScanner(Data, Scn) (Data)->Scanner=Scn
+#define Cs2pSetBuf(Data, Val)     (Data)->Buf=Val
+#define Cs2pSetLen(Data, Val)     (Data)->Len=Val
+#define Cs2pSetPos(Data, Val)     (Data)->Pos=Val
+#define Cs2pSetLine(Data, Val)    (Data)->Line=Val
+#define Cs2pSetLineLen(Data, Val) (Data)->LineLen=Val
+#define Cs2pSetNumKeywords(Data, Val) (Data)->NumKeywords=Val
+#define Cs2pSetKeywords(Data, Val)    (Data)->Keywords=Val
 #define Cs2pSetType(Data, Val)    (Data)->Type=Val
 #define Cs2pSetSubType(Data, Val) (Data)->SubType=Val
 #define Cs2pSetLevel(Data, Val)   (Data)->Level=Val
@@ -184,7 +202,13 @@ int Cs2pParse(Cs2parser *Data);
 * Dazu gibt es die folgenden Makros:
 */
 #define Cs2pGetVerbose(Data) (Data)->Verbose
-#define Cs2pGetScanner(Data) (Data)->Scanner
+#define Cs2pGetBuf(Data)     (Data)->Buf
+#define Cs2pGetLen(Data)     (Data)->Len
+#define Cs2pGetPos(Data)     (Data)->Pos
+#define Cs2pGetLine(Data)    (Data)->Line
+#define Cs2pGetLineLen(Data) (Data)->LineLen
+#define Cs2pGetNumKeywords(Data) (Data)->NumKeywords
+#define Cs2pGetKeywords(Data)    (Data)->Keywords
 /** Diese Makro liefert nochmals, welcher Konfigurationstyp (Paragraph, Wert,
 * ...) erkant wurde. Also der Returnwert der Funktion Cs2pParse()
 */
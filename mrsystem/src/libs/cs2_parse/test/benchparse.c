@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <boolean.h>
+#include <cs2parse.h>
+#include <write_cs2.h>
+
+/*
+* Durchsatz des cs2 Parsers messen
+*
+* Es wird eine lokomotive.cs2 mit der angegebenen Anzahl Loks erzeugt oder
+* eine vorhandene Datei benutzt. Diese wird einmal aus einem Puffer im
+* Speicher geparst, so wie die per CAN empfangenen Daten, und einmal aus
+* der mit Cs2pMapFile() eingeblendeten Datei, so wie beim Start der
+* zentrale.
+*/
+
+#define DEFAULT_LOKS   500
+#define DEFAULT_ROUNDS 50
+#define NUM_FUNCTIONS  16
+
+static double Seconds(void)
+{  struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+   return(Now.tv_sec + Now.tv_nsec / 1e9);
+}
+
+static void WriteLokomotiveCs2(char *FileName, int NumLoks)
+{  FILE *Stream;
+   int i, j;
+   char Name[20];
+
+   Stream = fopen(FileName, "w");
+   if (Stream == (FILE *)NULL)
+      return;
+   Cs2WriteParagraphByType(Stream, CS2_PARAGRAPH_TYPE_LOKOMOTIVE);
+   Cs2WriteTitleByName(Stream, "version", 0);
+   Cs2WriteIntValueByName(Stream, "minor", 3, 1);
+   Cs2WriteTitleByName(Stream, "session", 0);
+   Cs2WriteIntValueByName(Stream, "id", 1, 1);
+   for (i = 0; i < NumLoks; i++)
+   {
+      sprintf(Name, "BR %d %05d", 10 + i % 90, i);
+      Cs2WriteTitleByName(Stream, "lokomotive", 0);
+      Cs2WriteStringValueByName(Stream, "name", Name, 1);
+      Cs2WriteHexLongValueByName(Stream, "uid", 0x4000 + i, 1);
+      Cs2WriteHexValueByName(Stream, "adresse", 1 + i % 255, 1);
+      Cs2WriteStringValueByName(Stream, "typ", "mfx", 1);
+      Cs2WriteHexLongValueByName(Stream, "mfxuid", 0x7f000000 + i, 1);
+      Cs2WriteStringValueByName(Stream, "icon", Name, 1);
+      Cs2WriteIntValueByName(Stream, "av", 60, 1);
+      Cs2WriteIntValueByName(Stream, "bv", 60, 1);
+      Cs2WriteIntValueByName(Stream, "volume", 100, 1);
+      Cs2WriteIntValueByName(Stream, "tachomax", 200, 1);
+      Cs2WriteIntValueByName(Stream, "vmax", 255, 1);
+      Cs2WriteIntValueByName(Stream, "vmin", 13, 1);
+      for (j = 0; j < NUM_FUNCTIONS; j++)
+      {
+         Cs2WriteTitleByName(Stream, "funktionen", 1);
+         Cs2WriteIntValueByName(Stream, "nr", j, 2);
+         Cs2WriteIntValueByName(Stream, "typ", j + 1, 2);
+      }
+   }
+   fclose(Stream);
+}
+
+static int Parse(Cs2parser *Parser, char *Buf, int Len, int *Lines)
+{  int LineInfo, NumLoks;
+
+   NumLoks = 0;
+   Cs2pInit(Parser, PARSER_TYPE_LOK_CS2, Buf, Len);
+   do {
+      LineInfo = Cs2pParse(Parser);
+      (*Lines)++;
+      if ((LineInfo == PARSER_VALUE) &&
+          (Cs2pGetSubType(Parser) == PARSER_VALUE_LOKOMOTIVE))
+         NumLoks++;
+   } while (LineInfo != PARSER_EOF);
+   return(NumLoks);
+}
+
+static void Report(char *Mode, double Elapsed, int Rounds, int Len,
+                   int Lines, int NumLoks)
+{
+   printf("%s: %d loks, %.3f s, %.1f MB/s, %.0f lines/s\n", Mode, NumLoks,
+          Elapsed, (double)Len * Rounds / Elapsed / 1e6, Lines / Elapsed);
+}
+
+int main(int argc, char *argv[])
+{  char *FileName, *Buf, *Mapped;
+   int NumLoks, Rounds, Len, Lines, Found, i, c;
+   BOOL Generated;
+   Cs2parser *Parser;
+   double Start;
+
+   FileName = (char *)NULL;
+   NumLoks = DEFAULT_LOKS;
+   Rounds = DEFAULT_ROUNDS;
+   Found = 0;
+   while ((c = getopt(argc, argv, "f:n:r:?")) != -1)
+   {
+      switch (c)
+      {
+         case 'f':
+            FileName = optarg;
+            break;
+         case 'n':
+            NumLoks = atoi(optarg);
+            break;
+         case 'r':
+            Rounds = atoi(optarg);
+            break;
+         default:
+            printf("%s [-f <lokomotive.cs2>] [-n <loks>] [-r <rounds>]\n",
+                   argv[0]);
+            return(1);
+      }
+   }
+   if ((Rounds <= 0) || (NumLoks <= 0))
+   {
+      printf("rounds and loks must be greater than 0\n");
+      return(1);
+   }
+   Generated = (FileName == (char *)NULL);
+   if (Generated)
+   {
+      FileName = "/tmp/benchparse_" CS2_FILE_STRING_LOKOMOTIVE;
+      WriteLokomotiveCs2(FileName, NumLoks);
+   }
+   Parser = Cs2pCreate();
+   Mapped = Cs2pMapFile(FileName, &Len);
+   if ((Parser == (Cs2parser *)NULL) || (Mapped == (char *)NULL))
+   {
+      printf("can not read %s\n", FileName);
+      return(1);
+   }
+
+   /* like config data received over CAN, parse a copy in memory */
+   Buf = (char *)malloc(Len);
+   memcpy(Buf, Mapped, Len);
+   Cs2pUnmapFile(Mapped, Len);
+   Lines = 0;
+   Start = Seconds();
+   for (i = 0; i < Rounds; i++)
+      Found = Parse(Parser, Buf, Len, &Lines);
+   Report("buffer", Seconds() - Start, Rounds, Len, Lines, Found);
+   free(Buf);
+
+   /* like the zentrale at startup, map the file and parse it */
+   Lines = 0;
+   Start = Seconds();
+   for (i = 0; i < Rounds; i++)
+   {
+      Buf = Cs2pMapFile(FileName, &Len);
+      Found = Parse(Parser, Buf, Len, &Lines);
+      Cs2pUnmapFile(Buf, Len);
+   }
+   Report("mmap", Seconds() - Start, Rounds, Len, Lines, Found);
+
+   Cs2pDestroy(Parser);
+   if (Generated)
+      unlink(FileName);
+   return(0);
+}
@@ -1,5 +1,7 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <fcntl.h>
 #include "mr_ipc.h"
 
@@ -7,7 +9,7 @@ int MrIpcAccept(int ServerSock)
 {  int ClntSock;                /* Socket descriptor for client */
    struct sockaddr_in ClntAddr; /* Client address */
    unsigned int ClntLen;        /* Length of client address data structure */
-   int Flags;
+   int Flags, NoDelay;
 
    /* Set the size of the in-out parameter */
    ClntLen = sizeof(ClntAddr);
@@ -19,6 +21,11 @@ int MrIpcAccept(int ServerSock)
       if (Flags != -1)
       {
          fcntl(ClntSock, F_SETFL, Flags | O_NONBLOCK);
+         /* every frame is a complete message, do not hold it back until
+            the client acknowledges the previous one */
+         NoDelay = 1;
+         setsockopt(ClntSock, IPPROTO_TCP, TCP_NODELAY, &NoDelay,
+                    sizeof(NoDelay));
       }
       else
       {
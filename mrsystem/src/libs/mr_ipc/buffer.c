@@ -0,0 +1,80 @@
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <boolean.h>
+#include "mr_ipc.h"
+
+/** @file */
+
+/**
+* @brief Empfangspuffer leeren
+*
+* @param[in] Buffer Zeiger auf den Puffer
+*/
+void MrIpcBufferInit(MrIpcBufferType *Buffer)
+{
+   Buffer->Len = 0;
+   Buffer->Pos = 0;
+}
+
+/**
+* @brief Empfangspuffer mit einem recv() f&uuml;llen
+*
+* Wird aufgerufen, wenn select() Daten auf dem Socket meldet. Es wird
+* gelesen, soviel in den Puffer pa&szlig;t, danach liefert MrIpcBufferGet()
+* alle vollst&auml;ndigen Kommandos. Ein angefangenes Kommando bleibt bis zum
+* n&auml;chsten Aufruf im Puffer.
+*
+* @param[in] socket Socket zur drehscheibe bzw. zum Client
+* @param[in] Buffer Zeiger auf den Puffer
+*
+* @return Fehler oder OK (MR_IPC_RCV_OK, MR_IPC_RCV_CLOSED, MR_IPC_RCV_ERROR)
+*/
+int MrIpcBufferFill(int socket, MrIpcBufferType *Buffer)
+{  int RecvBytes;
+
+   if (Buffer->Pos > 0)
+   {
+      /* move the rest of a split message to the start */
+      memmove(Buffer->Buf, Buffer->Buf + Buffer->Pos,
+              Buffer->Len - Buffer->Pos);
+      Buffer->Len -= Buffer->Pos;
+      Buffer->Pos = 0;
+   }
+   do {
+      RecvBytes = recv(socket, Buffer->Buf + Buffer->Len,
+                       sizeof(Buffer->Buf) - Buffer->Len, 0);
+   } while ((RecvBytes < 0) && (errno == EINTR));
+   if (RecvBytes < 0)
+   {
+      return MR_IPC_RCV_ERROR;
+   }
+   else if (RecvBytes == 0)
+   {
+      return MR_IPC_RCV_CLOSED;
+   }
+   else
+   {
+      Buffer->Len += RecvBytes;
+      return MR_IPC_RCV_OK;
+   }
+}
+
+/**
+* @brief Vollst&auml;ndiges Kommando aus dem Empfangspuffer holen
+*
+* @param[in] Buffer Zeiger auf den Puffer
+* @param[out] Data Zeiger auf die IPC Struktur
+*
+* @return TRUE, wenn ein Kommando geliefert wurde
+*/
+BOOL MrIpcBufferGet(MrIpcBufferType *Buffer, MrIpcCmdType *Data)
+{
+   if (Buffer->Len - Buffer->Pos < sizeof(MrIpcCmdType))
+   {
+      return FALSE;
+   }
+   memcpy(Data, Buffer->Buf + Buffer->Pos, sizeof(MrIpcCmdType));
+   Buffer->Pos += sizeof(MrIpcCmdType);
+   return TRUE;
+}
@@ -0,0 +1,250 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <boolean.h>
+#include "mr_ipc.h"
+
+/** @file */
+
+#define MrIpcLoopEvents(Entry) \
+   (((Entry)->WriteFkt != (MrIpcLoopFktType)NULL) ? EPOLLIN | EPOLLOUT : EPOLLIN)
+
+/**
+* @brief Ereignisschleife anlegen
+*
+* @return Zeiger auf die Schleife oder NULL bei einem Fehler
+*/
+MrIpcLoopType *MrIpcLoopCreate(void)
+{  MrIpcLoopType *Loop;
+
+   Loop = (MrIpcLoopType *)malloc(sizeof(MrIpcLoopType));
+   if (Loop != (MrIpcLoopType *)NULL)
+   {
+      Loop->EpollFd = epoll_create1(EPOLL_CLOEXEC);
+      if (Loop->EpollFd < 0)
+      {
+         free(Loop);
+         return((MrIpcLoopType *)NULL);
+      }
+      Loop->NumEntries = 0;
+      Loop->Entries = (MrIpcLoopEntryType **)NULL;
+      Loop->Serial = 0;
+      Loop->Mark = 0;
+   }
+   return(Loop);
+}
+
+/**
+* @brief Ereignisschleife freigeben
+*
+* Die angemeldeten Sockets bleiben offen, sie geh&ouml;ren dem Aufrufer.
+* Timer werden geschlossen.
+*
+* @param[in] Loop Zeiger auf die Schleife, darf NULL sein
+*/
+void MrIpcLoopDestroy(MrIpcLoopType *Loop)
+{  int Fd;
+
+   if (Loop != (MrIpcLoopType *)NULL)
+   {
+      for (Fd = 0; Fd < Loop->NumEntries; Fd++)
+      {
+         if (Loop->Entries[Fd] != (MrIpcLoopEntryType *)NULL)
+         {
+            if (Loop->Entries[Fd]->IsTimer)
+               close(Fd);
+            free(Loop->Entries[Fd]);
+         }
+      }
+      free(Loop->Entries);
+      close(Loop->EpollFd);
+      free(Loop);
+   }
+}
+
+static BOOL GrowEntries(MrIpcLoopType *Loop, int Fd)
+{  MrIpcLoopEntryType **Entries;
+   int NumEntries;
+
+   NumEntries = Loop->NumEntries > 0 ? Loop->NumEntries : 32;
+   while (NumEntries <= Fd)
+      NumEntries *= 2;
+   Entries = (MrIpcLoopEntryType **)realloc(Loop->Entries,
+                                            NumEntries * sizeof(MrIpcLoopEntryType *));
+   if (Entries == (MrIpcLoopEntryType **)NULL)
+   {
+      return(FALSE);
+   }
+   memset(Entries + Loop->NumEntries, 0,
+          (NumEntries - Loop->NumEntries) * sizeof(MrIpcLoopEntryType *));
+   Loop->Entries = Entries;
+   Loop->NumEntries = NumEntries;
+   return(TRUE);
+}
+
+/**
+* @brief Filedescriptor an der Ereignisschleife anmelden
+*
+* Sobald der Filedescriptor lesbar ist oder geschlossen wurde, ruft
+* MrIpcLoopRunOnce() die Funktion auf. Ist der Filedescriptor schon
+* angemeldet, werden Funktion und Daten ersetzt.
+*
+* @param[in] Loop Zeiger auf die Schleife
+* @param[in] Fd Filedescriptor
+* @param[in] Fkt Funktion, die bei Daten aufgerufen wird
+* @param[in] PrivData Daten f&uuml;r die Funktion
+*
+* @return TRUE, wenn der Filedescriptor angemeldet wurde
+*/
+BOOL MrIpcLoopAddFd(MrIpcLoopType *Loop, int Fd, MrIpcLoopFktType Fkt,
+                    void *PrivData)
+{  MrIpcLoopEntryType *Entry;
+   struct epoll_event Event;
+   int Op;
+
+   if ((Fd < 0) || ((Fd >= Loop->NumEntries) && !GrowEntries(Loop, Fd)))
+   {
+      return(FALSE);
+   }
+   Entry = Loop->Entries[Fd];
+   if (Entry == (MrIpcLoopEntryType *)NULL)
+   {
+      Entry = (MrIpcLoopEntryType *)malloc(sizeof(MrIpcLoopEntryType));
+      if (Entry == (MrIpcLoopEntryType *)NULL)
+      {
+         return(FALSE);
+      }
+      Entry->IsTimer = FALSE;
+      Entry->WriteFkt = (MrIpcLoopFktType)NULL;
+      Op = EPOLL_CTL_ADD;
+   }
+   else
+   {
+      Op = EPOLL_CTL_MOD;
+   }
+   Entry->Fkt = Fkt;
+   Entry->PrivData = PrivData;
+   Entry->Serial = ++Loop->Serial;
+   Entry->Mark = Loop->Mark;
+   /* the serial drops events of a closed fd whose number was reused
+      before the events were dispatched */
+   memset(&Event, 0, sizeof(Event));
+   Event.events = MrIpcLoopEvents(Entry);
+   Event.data.u64 = ((unsigned long long)Entry->Serial << 32) | (unsigned)Fd;
+   if (epoll_ctl(Loop->EpollFd, Op, Fd, &Event) < 0)
+   {
+      if (Op == EPOLL_CTL_ADD)
+         free(Entry);
+      else
+         MrIpcLoopRemoveFd(Loop, Fd);
+      return(FALSE);
+   }
+   Loop->Entries[Fd] = Entry;
+   return(TRUE);
+}
+
+/**
+* @brief Filedescriptor von der Ereignisschleife abmelden
+*
+* Mu&szlig; vor dem Schlie&szlig;en des Filedescriptors aufgerufen werden.
+* Darf auch aus einer Funktion der Schleife heraus aufgerufen werden.
+*
+* @param[in] Loop Zeiger auf die Schleife
+* @param[in] Fd Filedescriptor
+*/
+void MrIpcLoopRemoveFd(MrIpcLoopType *Loop, int Fd)
+{
+   if ((Fd >= 0) && (Fd < Loop->NumEntries) &&
+       (Loop->Entries[Fd] != (MrIpcLoopEntryType *)NULL))
+   {
+      epoll_ctl(Loop->EpollFd, EPOLL_CTL_DEL, Fd, (struct epoll_event *)NULL);
+      free(Loop->Entries[Fd]);
+      Loop->Entries[Fd] = (MrIpcLoopEntryType *)NULL;
+   }
+}
+
+/**
+* @brief Auf Schreibbarkeit eines Filedescriptors warten
+*
+* Solange WriteFkt gesetzt ist, ruft MrIpcLoopRunOnce() sie auf, sobald der
+* Filedescriptor schreibbar ist. Damit wird ein Sendepuffer geleert, ohne
+* die Schleife zu blockieren. Mit NULL wird das Warten beendet.
+*
+* @param[in] Loop Zeiger auf die Schleife
+* @param[in] Fd angemeldeter Filedescriptor
+* @param[in] WriteFkt Funktion, die bei Schreibbarkeit aufgerufen wird,
+*                     oder NULL
+*
+* @return TRUE, wenn epoll ge&auml;ndert wurde
+*/
+BOOL MrIpcLoopSetWriteFkt(MrIpcLoopType *Loop, int Fd,
+                          MrIpcLoopFktType WriteFkt)
+{  MrIpcLoopEntryType *Entry;
+   struct epoll_event Event;
+
+   if ((Fd < 0) || (Fd >= Loop->NumEntries) ||
+       (Loop->Entries[Fd] == (MrIpcLoopEntryType *)NULL))
+   {
+      return(FALSE);
+   }
+   Entry = Loop->Entries[Fd];
+   if (Entry->WriteFkt == WriteFkt)
+   {
+      return(TRUE);
+   }
+   Entry->WriteFkt = WriteFkt;
+   memset(&Event, 0, sizeof(Event));
+   Event.events = MrIpcLoopEvents(Entry);
+   Event.data.u64 = ((unsigned long long)Entry->Serial << 32) | (unsigned)Fd;
+   return(epoll_ctl(Loop->EpollFd, EPOLL_CTL_MOD, Fd, &Event) == 0);
+}
+
+/**
+* @brief Einmal auf Ereignisse warten und sie verteilen
+*
+* Ersatz f&uuml;r den Aufbau des fd_set und den Aufruf von select() in der
+* Hauptschleife. Der Aufwand h&auml;ngt nur von der Zahl der Ereignisse ab,
+* nicht von der Zahl der angemeldeten Filedescriptoren.
+*
+* @param[in] Loop Zeiger auf die Schleife
+* @param[in] TimeoutMs maximale Wartezeit in ms oder MR_IPC_LOOP_NO_TIMEOUT
+*
+* @return Anzahl der Ereignisse, 0 bei Timeout und -1 bei einem Fehler. Bei
+*         einem Signal ist errno EINTR.
+*/
+int MrIpcLoopRunOnce(MrIpcLoopType *Loop, int TimeoutMs)
+{  struct epoll_event Events[MR_IPC_LOOP_MAX_EVENTS];
+   MrIpcLoopEntryType *Entry;
+   unsigned long long Expired;
+   int NumEvents, i, Fd;
+
+   NumEvents = epoll_wait(Loop->EpollFd, Events, MR_IPC_LOOP_MAX_EVENTS,
+                          TimeoutMs);
+   for (i = 0; i < NumEvents; i++)
+   {
+      Fd = (int)(Events[i].data.u64 & 0xffffffff);
+      if (Fd >= Loop->NumEntries)
+         continue;
+      Entry = Loop->Entries[Fd];
+      if ((Entry == (MrIpcLoopEntryType *)NULL) ||
+          (Entry->Serial != (unsigned int)(Events[i].data.u64 >> 32)))
+         continue;
+      if (Entry->IsTimer &&
+          (read(Fd, &Expired, sizeof(Expired)) != sizeof(Expired)))
+         continue;
+      if ((Events[i].events & EPOLLOUT) &&
+          (Entry->WriteFkt != (MrIpcLoopFktType)NULL))
+      {
+         Entry->WriteFkt(Entry->PrivData, Fd);
+         /* the write function may have removed the fd */
+         if ((Loop->Entries[Fd] != Entry) ||
+             (Entry->Serial != (unsigned int)(Events[i].data.u64 >> 32)))
+            continue;
+      }
+      if (Events[i].events & ~EPOLLOUT)
+         Entry->Fkt(Entry->PrivData, Fd);
+   }
+   return(NumEvents);
+}
@@ -0,0 +1,68 @@
+#include <string.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <boolean.h>
+#include "mr_ipc.h"
+
+/** @file */
+
+static void Rearm(MrIpcLoopType *Loop, int Fd, MrIpcLoopEntryType *Entry)
+{  struct epoll_event Event;
+
+   memset(&Event, 0, sizeof(Event));
+   Event.events = (Entry->WriteFkt != (MrIpcLoopFktType)NULL) ?
+                  EPOLLIN | EPOLLOUT : EPOLLIN;
+   Event.data.u64 = ((unsigned long long)Entry->Serial << 32) | (unsigned)Fd;
+   /* the fd may have been closed and reopened with the same number, then
+      epoll has already forgotten it */
+   if ((epoll_ctl(Loop->EpollFd, EPOLL_CTL_MOD, Fd, &Event) < 0) &&
+       (errno == ENOENT))
+      epoll_ctl(Loop->EpollFd, EPOLL_CTL_ADD, Fd, &Event);
+}
+
+/**
+* @brief Filedescriptoren aus einem Iterator an der Schleife abgleichen
+*
+* F&uuml;r Clients, deren Filedescriptoren nach au&szlig;en sich zur
+* Laufzeit &auml;ndern (z.B. TCP Verbindungen in cs2eth). Alle Werte von
+* GetFd() bis IOFKT_INVALID_FD bzw. -1 werden mit Fkt angemeldet, alle
+* fr&uuml;her so angemeldeten, die GetFd() nicht mehr liefert, werden
+* abgemeldet. Statt das fd_set vor jedem select() neu aufzubauen, wird
+* diese Funktion nur aufgerufen, wenn sich die Verbindungen ge&auml;ndert
+* haben k&ouml;nnen, also nach dem Lesen von au&szlig;en.
+*
+* @param[in] Loop Zeiger auf die Schleife
+* @param[in] GetFd Iterator &uuml;ber die Filedescriptoren
+* @param[in] GetFdData Daten f&uuml;r den Iterator
+* @param[in] Fkt Funktion, die bei Daten aufgerufen wird
+* @param[in] PrivData Daten f&uuml;r die Funktion
+*/
+void MrIpcLoopSyncFds(MrIpcLoopType *Loop, MrIpcLoopGetFdFktType GetFd,
+                      void *GetFdData, MrIpcLoopFktType Fkt, void *PrivData)
+{  int Fd;
+   MrIpcLoopEntryType *Entry;
+
+   Loop->Mark++;
+   while ((Fd = GetFd(GetFdData)) >= 0)
+   {
+      Entry = Fd < Loop->NumEntries ? Loop->Entries[Fd] :
+                                      (MrIpcLoopEntryType *)NULL;
+      if ((Entry != (MrIpcLoopEntryType *)NULL) && (Entry->Fkt == Fkt) &&
+          (Entry->PrivData == PrivData))
+      {
+         Entry->Mark = Loop->Mark;
+         Rearm(Loop, Fd, Entry);
+      }
+      else
+      {
+         MrIpcLoopAddFd(Loop, Fd, Fkt, PrivData);
+      }
+   }
+   for (Fd = 0; Fd < Loop->NumEntries; Fd++)
+   {
+      Entry = Loop->Entries[Fd];
+      if ((Entry != (MrIpcLoopEntryType *)NULL) && (Entry->Fkt == Fkt) &&
+          (Entry->PrivData == PrivData) && (Entry->Mark != Loop->Mark))
+         MrIpcLoopRemoveFd(Loop, Fd);
+   }
+}
@@ -0,0 +1,58 @@
+#include <string.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include <boolean.h>
+#include "mr_ipc.h"
+
+/** @file */
+
+/**
+* @brief Timer an der Ereignisschleife anlegen
+*
+* Der Timer ist zun&auml;chst aus und wird mit MrIpcLoopSetTimer()
+* gestartet. Er wird mit MrIpcLoopRemoveFd() abgemeldet und von der
+* Schleife geschlossen.
+*
+* @param[in] Loop Zeiger auf die Schleife
+* @param[in] Fkt Funktion, die beim Ablauf aufgerufen wird
+* @param[in] PrivData Daten f&uuml;r die Funktion
+*
+* @return Filedescriptor des Timers oder -1 bei einem Fehler
+*/
+int MrIpcLoopAddTimer(MrIpcLoopType *Loop, MrIpcLoopFktType Fkt,
+                      void *PrivData)
+{  int Timer;
+
+   Timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+   if (Timer < 0)
+   {
+      return(-1);
+   }
+   if (!MrIpcLoopAddFd(Loop, Timer, Fkt, PrivData))
+   {
+      close(Timer);
+      return(-1);
+   }
+   Loop->Entries[Timer]->IsTimer = TRUE;
+   return(Timer);
+}
+
+/**
+* @brief Timer starten oder anhalten
+*
+* @param[in] Loop Zeiger auf die Schleife
+* @param[in] Timer Filedescriptor des Timers von MrIpcLoopAddTimer()
+* @param[in] Ms Zeit bis zum Ablauf in ms, 0 h&auml;lt den Timer an
+* @param[in] Periodic TRUE, wenn der Timer danach alle Ms abl&auml;uft
+*/
+void MrIpcLoopSetTimer(MrIpcLoopType *Loop, int Timer, unsigned long Ms,
+                       BOOL Periodic)
+{  struct itimerspec Value;
+
+   memset(&Value, 0, sizeof(Value));
+   Value.it_value.tv_sec = Ms / 1000;
+   Value.it_value.tv_nsec = (Ms % 1000) * 1000000;
+   if (Periodic)
+      Value.it_interval = Value.it_value;
+   timerfd_settime(Timer, 0, &Value, (struct itimerspec *)NULL);
+}
@@ -24,6 +24,7 @@
 
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <cs2.h>
 #include <mr_cs2ms2.h>
 
@@ -35,6 +36,8 @@
 #define MR_IPC_RCV_ERROR  -1
 #define MR_IPC_RCV_CLOSED 0
 #define MR_IPC_RCV_OK     1
+/** Rest liegt noch im Sendepuffer, siehe MrIpcOutputSendv() */
+#define MR_IPC_RCV_PENDING 2
 
 /** Konstanten f&uuml;r Broadcast als Ziel-/Sendersocket */
 #define MR_IPC_SOCKET_ALL -1
@@ -142,7 +145,177 @@ typedef struct {
 #define MrIpcGetRawData(Dat)        (Dat)->Parms.Raws.Data
 #define MrIpcGetRawDataI(Dat,i)     (Dat)->Parms.Raws.Data[i]
 
-#define MrIpcInternalPollMs2 0x0001
+#define MrIpcInternalPollMs2     0x0001
+#define MrIpcInternalShmAttach   0x0002
+#define MrIpcInternalShmAck      0x0003
+#define MrIpcInternalShmDoorbell 0x0004
+#define MrIpcInternalSubscribe   0x0005
+
+/**
+* @brief Abonnement eines Clients bei der drehscheibe
+*
+* Ohne Abonnement bekommt ein Client alle Kommandos. Mit MrIpcSubscribe()
+* meldet er, welche Kommandos er haben m&ouml;chte. Rohe CAN Nachrichten
+* (MrIpcCmdNull) werden zus&auml;tzlich nach dem CAN Kommando gefiltert. Die
+* Maske wird in Worten zu 32 Bit &uuml;bertragen, Wort 0 enth&auml;lt die
+* Kommandos, ab Wort 1 folgen die CAN Kommandos.
+*/
+#define MR_IPC_NUM_COMMANDS          (MrIpcCmdIntern + 1)
+#define MR_IPC_NUM_CAN_COMMANDS      256
+#define MR_IPC_SUBSCRIPTION_CAN_WORDS (MR_IPC_NUM_CAN_COMMANDS / 32)
+
+typedef struct {
+   unsigned int Commands;
+   unsigned int CanCommands[MR_IPC_SUBSCRIPTION_CAN_WORDS];
+} MrIpcSubscriptionType;
+
+#define MrIpcSubscriptionSetCmd(Sub,c)    (Sub)->Commands|=(1U<<(c))
+#define MrIpcSubscriptionClrCmd(Sub,c)    (Sub)->Commands&=~(1U<<(c))
+#define MrIpcSubscriptionSetCanCmd(Sub,c) (Sub)->CanCommands[(c)/32]|=(1U<<((c)%32))
+#define MrIpcSubscriptionClrCanCmd(Sub,c) (Sub)->CanCommands[(c)/32]&=~(1U<<((c)%32))
+
+#define MrIpcSubscriptionGetCmd(Sub,c)    (((Sub)->Commands>>(c))&1)
+#define MrIpcSubscriptionGetCanCmd(Sub,c) ((((Sub)->CanCommands[(c)/32])>>((c)%32))&1)
+
+/**
+* @brief Konstanten f&uuml;r den Shared Memory Ring der drehscheibe
+*
+* Die drehscheibe legt pro Port einen Ring im Shared Memory an, in den jedes
+* Kommando nur einmal geschrieben wird. Clients auf dem gleichen Rechner
+* k&ouml;nnen sich mit MrIpcShmAttach() daran anmelden und lesen die
+* Kommandos dann direkt aus dem Ring. Der Socket zur drehscheibe bleibt
+* bestehen: er wird zum Senden benutzt und als T&uuml;rklingel, wenn ein
+* wartender Client neue Daten im Ring hat.
+*/
+#define MR_IPC_SHM_NAME         "/mrsystem_ipc_%d"
+#define MR_IPC_SHM_MAGIC        0x4d524951
+#define MR_IPC_SHM_NUM_SLOTS    1024
+#define MR_IPC_SHM_MAX_CONSUMER 16
+#define MR_IPC_SHM_NO_CONSUMER  -1
+
+/**
+* @brief Ein Eintrag im Ring
+*/
+typedef struct {
+   int Origin;
+   MrIpcCmdType Cmd;
+} MrIpcShmSlotType;
+
+/**
+* @brief Verwaltung eines angemeldeten Clients im Ring
+*
+* ReadPos ist die n&auml;chste Position, die der Client liest. Die
+* drehscheibe &uuml;berschreibt keinen Eintrag, den ein Client mit Reading
+* noch nicht gelesen hat. Kommt ein Client nicht hinterher, stoppt sie ihn
+* mit MrIpcShmStop() und schickt ihm alles weitere &uuml;ber den Socket.
+*/
+typedef struct {
+   volatile int Pid;
+   volatile unsigned int Token;
+   volatile unsigned int StartPos;
+   volatile unsigned int ReadPos;
+   volatile int Reading;
+   volatile int Waiting;
+   MrIpcSubscriptionType Subscription;
+} MrIpcShmConsumerType;
+
+/**
+* @brief Der Ring im Shared Memory, geschrieben nur von der drehscheibe
+*/
+typedef struct {
+   unsigned int Magic;
+   unsigned int NumSlots;
+   volatile unsigned int WritePos;
+   MrIpcShmConsumerType Consumer[MR_IPC_SHM_MAX_CONSUMER];
+   MrIpcShmSlotType Slots[MR_IPC_SHM_NUM_SLOTS];
+} MrIpcShmRingType;
+
+/**
+* @brief Sicht eines Clients auf den Ring
+*/
+typedef enum { MrIpcShmPending, MrIpcShmActive, MrIpcShmOff, MrIpcShmStopped } MrIpcShmStateType;
+
+typedef struct {
+   MrIpcShmRingType *Ring;
+   MrIpcShmStateType State;
+   int Consumer;
+   unsigned int ReadPos;
+} MrIpcShmType;
+
+#define MrIpcShmGetStopped(Shm) ((Shm)->State == MrIpcShmStopped)
+
+/**
+* @brief Puffer f&uuml;r mehrere Kommandos auf einem Stream Socket
+*
+* Der Socket kennt keine Nachrichtengrenzen, Kommandos k&ouml;nnen
+* zusammengefa&szlig;t oder geteilt ankommen. Jedes Kommando ist genau
+* sizeof(MrIpcCmdType) lang, der Puffer sammelt die Bytes von mehreren
+* Kommandos mit einem recv() und liefert mit MrIpcBufferGet() nur
+* vollst&auml;ndige Kommandos.
+*/
+#define MR_IPC_BUFFER_CMDS 32
+
+typedef struct {
+   unsigned int Len;
+   unsigned int Pos;
+   char Buf[MR_IPC_BUFFER_CMDS * sizeof(MrIpcCmdType)];
+} MrIpcBufferType;
+
+#define MrIpcBufferGetCount(Buffer) \
+   (((Buffer)->Len - (Buffer)->Pos) / sizeof(MrIpcCmdType))
+
+/**
+* @brief Sendepuffer f&uuml;r einen nicht blockierenden Stream Socket
+*
+* Was der Socket nicht sofort annimmt, bleibt als Bytestrom im Ring und
+* wird verschickt, sobald der Socket wieder schreibbar ist. Ein
+* angefangenes Kommando wird so immer vervollst&auml;ndigt. Der Ring
+* mu&szlig; den ganzen Shared Memory Ring eines gestoppten Clients und
+* einen Stapel Kommandos aufnehmen k&ouml;nnen.
+*/
+#define MR_IPC_OUTPUT_SIZE 0x10000 /* power of 2 */
+
+typedef struct {
+   unsigned int Head;
+   unsigned int Tail;
+   char Buf[MR_IPC_OUTPUT_SIZE];
+} MrIpcOutputType;
+
+#define MrIpcOutputIsEmpty(Output) ((Output)->Head == (Output)->Tail)
+#define MrIpcOutputGetFree(Output) \
+   (MR_IPC_OUTPUT_SIZE - ((Output)->Head - (Output)->Tail))
+
+/**
+* @brief Ereignisschleife mit epoll
+*
+* Die drehscheibe und die Clients melden ihre Sockets einmal mit einer
+* Funktion an, die aufgerufen wird, wenn der Socket Daten hat. Es mu&szlig;
+* also nicht vor jedem select() ein fd_set mit allen Sockets aufgebaut
+* werden. Timer sind ebenfalls Filedescriptoren (timerfd) und werden genauso
+* behandelt, damit entf&auml;llt das Pollen mit einem Timeout.
+*/
+#define MR_IPC_LOOP_MAX_EVENTS 32
+#define MR_IPC_LOOP_NO_TIMEOUT -1
+
+typedef void (*MrIpcLoopFktType)(void *PrivData, int Fd);
+typedef int (*MrIpcLoopGetFdFktType)(void *PrivData);
+
+typedef struct {
+   MrIpcLoopFktType Fkt;
+   MrIpcLoopFktType WriteFkt;
+   void *PrivData;
+   BOOL IsTimer;
+   unsigned int Serial;
+   unsigned int Mark;
+} MrIpcLoopEntryType;
+
+typedef struct {
+   int EpollFd;
+   int NumEntries;
+   MrIpcLoopEntryType **Entries;
+   unsigned int Serial;
+   unsigned int Mark;
+} MrIpcLoopType;
 
 /**
 * @brief Makros um Funktionen auf andere zu mappen
@@ -161,6 +334,55 @@ int MrIpcStartServerIf(char *Interface, int Port);
 int MrIpcAccept(int ServerSock);
 int MrIpcSend(int socket, MrIpcCmdType *Data);
 int MrIpcRecv(int socket, MrIpcCmdType *Data);
+int MrIpcSendv(int socket, struct iovec *Iov, int Count);
+void MrIpcWaitWritable(int socket);
+void MrIpcBufferInit(MrIpcBufferType *Buffer);
+int MrIpcBufferFill(int socket, MrIpcBufferType *Buffer);
+BOOL MrIpcBufferGet(MrIpcBufferType *Buffer, MrIpcCmdType *Data);
+void MrIpcOutputInit(MrIpcOutputType *Output);
+int MrIpcOutputSendv(int socket, MrIpcOutputType *Output, struct iovec *Iov,
+                     int Count);
+int MrIpcOutputFlush(int socket, MrIpcOutputType *Output);
+
+MrIpcLoopType *MrIpcLoopCreate(void);
+void MrIpcLoopDestroy(MrIpcLoopType *Loop);
+BOOL MrIpcLoopAddFd(MrIpcLoopType *Loop, int Fd, MrIpcLoopFktType Fkt,
+                    void *PrivData);
+void MrIpcLoopRemoveFd(MrIpcLoopType *Loop, int Fd);
+BOOL MrIpcLoopSetWriteFkt(MrIpcLoopType *Loop, int Fd,
+                          MrIpcLoopFktType WriteFkt);
+int MrIpcLoopRunOnce(MrIpcLoopType *Loop, int TimeoutMs);
+int MrIpcLoopAddTimer(MrIpcLoopType *Loop, MrIpcLoopFktType Fkt,
+                      void *PrivData);
+void MrIpcLoopSetTimer(MrIpcLoopType *Loop, int Timer, unsigned long Ms,
+                       BOOL Periodic);
+void MrIpcLoopSyncFds(MrIpcLoopType *Loop, MrIpcLoopGetFdFktType GetFd,
+                      void *GetFdData, MrIpcLoopFktType Fkt, void *PrivData);
+
+void MrIpcSubscriptionInit(MrIpcSubscriptionType *Sub, BOOL All);
+BOOL MrIpcSubscriptionMatch(MrIpcSubscriptionType *Sub, MrIpcCmdType *Data);
+void MrIpcSubscriptionUpdate(MrIpcSubscriptionType *Sub,
+                             MrIpcCmdType *Request);
+int MrIpcSubscribe(int socket, MrIpcSubscriptionType *Sub);
+
+MrIpcShmRingType *MrIpcShmServerCreate(int Port);
+void MrIpcShmServerDestroy(MrIpcShmRingType *Ring, int Port);
+int MrIpcShmRegister(MrIpcShmRingType *Ring, MrIpcCmdType *Request);
+void MrIpcShmUnregister(MrIpcShmRingType *Ring, int Consumer);
+void MrIpcShmSetSubscription(MrIpcShmRingType *Ring, int Consumer,
+                             MrIpcSubscriptionType *Sub);
+void MrIpcShmPublish(MrIpcShmRingType *Ring, MrIpcCmdType *Data, int Origin);
+int MrIpcShmNextLagging(MrIpcShmRingType *Ring);
+unsigned int MrIpcShmStop(MrIpcShmRingType *Ring, int Consumer);
+int MrIpcShmBacklog(MrIpcShmRingType *Ring, int Consumer, unsigned int *Pos,
+                    struct iovec *Iov, int Max);
+BOOL MrIpcShmIsReading(MrIpcShmRingType *Ring, int Consumer);
+BOOL MrIpcShmWakeup(MrIpcShmRingType *Ring, int Consumer);
+void MrIpcShmInitDoorbell(MrIpcCmdType *Doorbell);
+int MrIpcShmSendDoorbell(int socket);
+MrIpcShmType *MrIpcShmAttach(int socket, int Port);
+void MrIpcShmDetach(MrIpcShmType *Shm);
+int MrIpcShmRecv(MrIpcShmType *Shm, int socket, MrIpcCmdType *Data);
 
 void MrIpcEncodeFromCan(MrIpcCmdType *Data, MrCs2CanDataType *CanMsg);
 void MrIpcDecodeToCan(MrIpcCmdType *Data, MrCs2CanDataType *CanMsg);
@@ -0,0 +1,146 @@
+#include <string.h>
+#include <errno.h>
+#include <sys/uio.h>
+#include <boolean.h>
+#include "mr_ipc.h"
+
+/** @file */
+
+/* the backlog of a stopped shared memory client and one batch must fit */
+typedef char MrIpcOutputSizeCheck[(MR_IPC_OUTPUT_SIZE >=
+                                   (MR_IPC_SHM_NUM_SLOTS + MR_IPC_BUFFER_CMDS) *
+                                   sizeof(MrIpcCmdType)) ? 1 : -1];
+
+/**
+* @brief Sendepuffer leeren
+*
+* @param[in] Output Zeiger auf den Puffer
+*/
+void MrIpcOutputInit(MrIpcOutputType *Output)
+{
+   Output->Head = 0;
+   Output->Tail = 0;
+}
+
+static void Append(MrIpcOutputType *Output, char *Data, unsigned int Len)
+{  unsigned int Pos, Part;
+
+   Pos = Output->Head & (MR_IPC_OUTPUT_SIZE - 1);
+   Part = MR_IPC_OUTPUT_SIZE - Pos;
+   if (Part > Len)
+      Part = Len;
+   memcpy(Output->Buf + Pos, Data, Part);
+   memcpy(Output->Buf, Data + Part, Len - Part);
+   Output->Head += Len;
+}
+
+/**
+* @brief Mehrere IPC Nachrichten &uuml;ber einen nicht blockierenden Socket
+*        senden
+*
+* Ist der Puffer leer, wird mit einem writev() gesendet. Was der Socket
+* nicht annimmt, auch der Rest eines angefangenen Kommandos, wird in den
+* Puffer kopiert. Liegt schon etwas im Puffer, werden die Kommandos
+* dahinter geh&auml;ngt, damit die Reihenfolge erhalten bleibt. Der Puffer
+* wird mit MrIpcOutputFlush() geleert, sobald der Socket schreibbar ist.
+*
+* @param[in] socket Socket zum Client
+* @param[in] Output Zeiger auf den Sendepuffer des Sockets
+* @param[in] Iov Zeiger auf die Kommandos
+* @param[in] Count Anzahl der Kommandos
+*
+* @return MR_IPC_RCV_OK, wenn alles gesendet wurde, MR_IPC_RCV_PENDING,
+*         wenn noch etwas im Puffer liegt, und MR_IPC_RCV_ERROR bei einem
+*         Fehler des Sockets oder wenn der Puffer voll ist. Im Fehlerfall
+*         wurde kein Byte der Kommandos gesendet oder gepuffert.
+*/
+int MrIpcOutputSendv(int socket, MrIpcOutputType *Output, struct iovec *Iov,
+                     int Count)
+{  ssize_t BytesSend;
+   size_t Len;
+   int i;
+
+   Len = 0;
+   for (i = 0; i < Count; i++)
+      Len += Iov[i].iov_len;
+   if (Len > MrIpcOutputGetFree(Output))
+   {
+      return MR_IPC_RCV_ERROR;
+   }
+   BytesSend = 0;
+   if (MrIpcOutputIsEmpty(Output) && (Count > 0))
+   {
+      do {
+         BytesSend = writev(socket, Iov, Count);
+      } while ((BytesSend < 0) && (errno == EINTR));
+      if (BytesSend < 0)
+      {
+         if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+            return MR_IPC_RCV_ERROR;
+         BytesSend = 0;
+      }
+   }
+   for (i = 0; i < Count; i++)
+   {
+      if (BytesSend >= (ssize_t)Iov[i].iov_len)
+      {
+         BytesSend -= Iov[i].iov_len;
+      }
+      else
+      {
+         Append(Output, (char *)Iov[i].iov_base + BytesSend,
+                Iov[i].iov_len - BytesSend);
+         BytesSend = 0;
+      }
+   }
+   return MrIpcOutputIsEmpty(Output) ? MR_IPC_RCV_OK : MR_IPC_RCV_PENDING;
+}
+
+/**
+* @brief Sendepuffer weiter senden
+*
+* Wird aufgerufen, wenn der Socket wieder schreibbar ist.
+*
+* @param[in] socket Socket zum Client
+* @param[in] Output Zeiger auf den Sendepuffer des Sockets
+*
+* @return MR_IPC_RCV_OK, wenn der Puffer leer ist, MR_IPC_RCV_PENDING, wenn
+*         noch etwas darin liegt, und MR_IPC_RCV_ERROR bei einem Fehler
+*/
+int MrIpcOutputFlush(int socket, MrIpcOutputType *Output)
+{  struct iovec Iov[2];
+   unsigned int Pos, Len;
+   ssize_t BytesSend;
+   int Count;
+
+   while (!MrIpcOutputIsEmpty(Output))
+   {
+      Pos = Output->Tail & (MR_IPC_OUTPUT_SIZE - 1);
+      Len = Output->Head - Output->Tail;
+      Iov[0].iov_base = Output->Buf + Pos;
+      if (Pos + Len > MR_IPC_OUTPUT_SIZE)
+      {
+         /* wrapped around the end of the ring */
+         Iov[0].iov_len = MR_IPC_OUTPUT_SIZE - Pos;
+         Iov[1].iov_base = Output->Buf;
+         Iov[1].iov_len = Len - Iov[0].iov_len;
+         Count = 2;
+      }
+      else
+      {
+         Iov[0].iov_len = Len;
+         Count = 1;
+      }
+      BytesSend = writev(socket, Iov, Count);
+      if (BytesSend < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            return MR_IPC_RCV_PENDING;
+         return MR_IPC_RCV_ERROR;
+      }
+      Output->Tail += BytesSend;
+   }
+   return MR_IPC_RCV_OK;
+}
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <sys/socket.h>
 #include "mr_ipc.h"
 
@@ -8,30 +9,41 @@
 /**
 * @brief IPC Nachricht empfangen
 *
-* Diese Funktion empf&auml;ngt ein IPC Paket
+* Diese Funktion empf&auml;ngt ein IPC Paket. Da der Socket keine
+* Nachrichtengrenzen kennt, wird gewartet, bis das Paket vollst&auml;ndig
+* ist.
 *
 * @param[in] socket Socket zur drehscheibe
 * @param[in] Data Zeiger auf die IPC Struktur
 *
-* @return Fehler oder OK (MR_IPC_RCV_OK, MR_IPC_RCV_ERROR)
+* @return Fehler oder OK (MR_IPC_RCV_OK, MR_IPC_RCV_CLOSED, MR_IPC_RCV_ERROR)
 */
 int MrIpcRecv(int socket, MrIpcCmdType *Data)
 {  int RecvBytes;
+   unsigned int Done;
 
-   RecvBytes = recv(socket, Data, sizeof(MrIpcCmdType), 0);
-   if (RecvBytes < 0)
+   Done = 0;
+   while (Done < sizeof(MrIpcCmdType))
    {
-      /* Error in read, maybe no data left */
-      return MR_IPC_RCV_ERROR;
-   }
-   else if (RecvBytes == 0)
-   {
-      /* socket was closed at remote side */
-      return MR_IPC_RCV_CLOSED;
-   }
-   else
-   {
-      /* we have one complete message */
-      return MR_IPC_RCV_OK;
+      RecvBytes = recv(socket, (char *)Data + Done,
+                       sizeof(MrIpcCmdType) - Done, MSG_WAITALL);
+      if (RecvBytes == 0)
+      {
+         /* socket was closed at remote side */
+         return MR_IPC_RCV_CLOSED;
+      }
+      else if (RecvBytes < 0)
+      {
+         if ((Done > 0) && (errno == EINTR))
+         {
+            /* do not lose the rest of a started message */
+            continue;
+         }
+         /* Error in read, maybe no data left */
+         return MR_IPC_RCV_ERROR;
+      }
+      Done += RecvBytes;
    }
+   /* we have one complete message */
+   return MR_IPC_RCV_OK;
 }
@@ -1,4 +1,5 @@
 #include <string.h>
+#include <errno.h>
 #include <sys/socket.h>
 #include "mr_ipc.h"
 
@@ -7,7 +8,11 @@
 /**
 * @brief IPC Nachricht senden
 *
-* Diese Funktion versendet ein IPC Paket
+* Diese Funktion versendet ein IPC Paket. Schreibt send() nur einen Teil,
+* wird der Rest nachgeschickt, damit der Empf&auml;nger keine halben
+* Kommandos sieht. Bei einem nicht blockierenden Socket wird dazu gewartet,
+* bis er wieder schreibbar ist. Die drehscheibe, die nicht warten darf,
+* benutzt MrIpcOutputSendv().
 *
 * @param[in] socket Socket zur drehscheibe
 * @param[in] Data Zeiger auf die IPC Struktur
@@ -16,18 +21,34 @@
 */
 int MrIpcSend(int socket, MrIpcCmdType *Data)
 {  int BytesSend;
+   unsigned int Done;
 
    if (Data != (MrIpcCmdType *)NULL)
    {
-      BytesSend = send(socket, Data, sizeof(MrIpcCmdType), 0);
-      if (BytesSend == sizeof(MrIpcCmdType))
+      Done = 0;
+      while (Done < sizeof(MrIpcCmdType))
       {
-         return MR_IPC_RCV_OK;
-      }
-      else
-      {
-         return MR_IPC_RCV_ERROR;
+         BytesSend = send(socket, (char *)Data + Done,
+                          sizeof(MrIpcCmdType) - Done, 0);
+         if (BytesSend > 0)
+         {
+            Done += BytesSend;
+         }
+         else if ((BytesSend < 0) && (errno == EINTR))
+         {
+            continue;
+         }
+         else if ((BytesSend < 0) &&
+                  ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+         {
+            MrIpcWaitWritable(socket);
+         }
+         else
+         {
+            return MR_IPC_RCV_ERROR;
+         }
       }
+      return MR_IPC_RCV_OK;
    }
    else
    {
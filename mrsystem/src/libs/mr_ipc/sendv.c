@@ -0,0 +1,68 @@
+#include <errno.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include "mr_ipc.h"
+
+/** @file */
+
+/**
+* @brief Warten, bis ein nicht blockierender Socket schreibbar ist
+*
+* @param[in] socket Socket
+*/
+void MrIpcWaitWritable(int socket)
+{  struct pollfd Poll;
+
+   Poll.fd = socket;
+   Poll.events = POLLOUT;
+   while ((poll(&Poll, 1, -1) < 0) && (errno == EINTR))
+      ;
+}
+
+/**
+* @brief Mehrere IPC Nachrichten mit einem Aufruf senden
+*
+* Ein Client schickt mehrere Kommandos mit einem writev(). Schreibt writev()
+* nur einen Teil, wird der Rest nachgeschickt, bei einem nicht blockierenden
+* Socket nachdem er wieder schreibbar ist. Es wird also nie mit einem
+* halben Kommando zur&uuml;ckgekehrt. Die drehscheibe, die nicht warten darf,
+* benutzt MrIpcOutputSendv().
+*
+* @param[in] socket Socket zum Client
+* @param[in] Iov Zeiger auf die Kommandos, wird beim Nachschicken
+*                ver&auml;ndert
+* @param[in] Count Anzahl der Kommandos
+*
+* @return Fehler oder OK (MR_IPC_RCV_OK, MR_IPC_RCV_ERROR)
+*/
+int MrIpcSendv(int socket, struct iovec *Iov, int Count)
+{  ssize_t BytesSend;
+
+   while (Count > 0)
+   {
+      BytesSend = writev(socket, Iov, Count);
+      if (BytesSend < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+         {
+            MrIpcWaitWritable(socket);
+            continue;
+         }
+         return MR_IPC_RCV_ERROR;
+      }
+      while ((Count > 0) && (BytesSend >= (ssize_t)Iov->iov_len))
+      {
+         BytesSend -= Iov->iov_len;
+         Iov++;
+         Count--;
+      }
+      if (Count > 0)
+      {
+         Iov->iov_base = (char *)Iov->iov_base + BytesSend;
+         Iov->iov_len -= BytesSend;
+      }
+   }
+   return MR_IPC_RCV_OK;
+}
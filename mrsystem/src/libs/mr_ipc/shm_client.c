@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include "mr_ipc.h"
+
+/** @file */
+
+static BOOL ClaimConsumer(MrIpcShmRingType *Ring, int Consumer)
+{  int Pid;
+
+   Pid = __atomic_load_n(&Ring->Consumer[Consumer].Pid, __ATOMIC_ACQUIRE);
+   if ((Pid != 0) && ((kill(Pid, 0) == 0) || (errno != ESRCH)))
+   {
+      return(FALSE);
+   }
+   return(__atomic_compare_exchange_n(&Ring->Consumer[Consumer].Pid, &Pid,
+                                      getpid(), FALSE, __ATOMIC_ACQ_REL,
+                                      __ATOMIC_ACQUIRE));
+}
+
+/**
+* @brief Am Shared Memory Ring der drehscheibe anmelden
+*
+* Diese Funktion reserviert einen Verwaltungseintrag im Ring und schickt die
+* Anmeldung &uuml;ber den Socket. Bis die Best&auml;tigung der drehscheibe
+* mit MrIpcShmRecv() gelesen wurde, kommen die Kommandos weiter &uuml;ber den
+* Socket. Lehnt die drehscheibe ab, bleibt es beim Socket.
+*
+* @param[in] socket Socket zur drehscheibe
+* @param[in] Port Portnummer der drehscheibe
+*
+* @return Zeiger auf die Verwaltung oder NULL, wenn kein Ring vorhanden ist
+*/
+MrIpcShmType *MrIpcShmAttach(int socket, int Port)
+{  char Name[32];
+   int Fd, Consumer;
+   MrIpcShmRingType *Ring;
+   MrIpcShmType *Shm;
+   MrIpcCmdType Request;
+   struct timespec Now;
+   unsigned int Token;
+
+   sprintf(Name, MR_IPC_SHM_NAME, Port);
+   Fd = shm_open(Name, O_RDWR, 0);
+   if (Fd < 0)
+   {
+      return((MrIpcShmType *)NULL);
+   }
+   Ring = (MrIpcShmRingType *)mmap(NULL, sizeof(MrIpcShmRingType),
+                                   PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+   close(Fd);
+   if (Ring == (MrIpcShmRingType *)MAP_FAILED)
+   {
+      return((MrIpcShmType *)NULL);
+   }
+   if ((__atomic_load_n(&Ring->Magic, __ATOMIC_ACQUIRE) != MR_IPC_SHM_MAGIC) ||
+       (Ring->NumSlots != MR_IPC_SHM_NUM_SLOTS))
+   {
+      munmap(Ring, sizeof(MrIpcShmRingType));
+      return((MrIpcShmType *)NULL);
+   }
+   Consumer = 0;
+   while ((Consumer < MR_IPC_SHM_MAX_CONSUMER) &&
+          !ClaimConsumer(Ring, Consumer))
+   {
+      Consumer++;
+   }
+   Shm = (MrIpcShmType *)malloc(sizeof(MrIpcShmType));
+   if ((Consumer == MR_IPC_SHM_MAX_CONSUMER) || (Shm == (MrIpcShmType *)NULL))
+   {
+      if (Consumer < MR_IPC_SHM_MAX_CONSUMER)
+         __atomic_store_n(&Ring->Consumer[Consumer].Pid, 0, __ATOMIC_RELEASE);
+      munmap(Ring, sizeof(MrIpcShmRingType));
+      free(Shm);
+      return((MrIpcShmType *)NULL);
+   }
+   /* the token proves that the drehscheibe behind the socket owns this ring */
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+   Token = ((unsigned int)Now.tv_nsec ^ ((unsigned int)getpid() << 16)) | 1;
+   Ring->Consumer[Consumer].Token = Token;
+   Shm->Ring = Ring;
+   Shm->State = MrIpcShmPending;
+   Shm->Consumer = Consumer;
+   Shm->ReadPos = 0;
+   memset(&Request, 0, sizeof(MrIpcCmdType));
+   MrIpcSetCommand(&Request, MrIpcCmdIntern);
+   MrIpcSetIntIp1(&Request, MrIpcInternalShmAttach);
+   MrIpcSetIntIp2(&Request, Consumer);
+   MrIpcSetIntLp1(&Request, Token);
+   if (MrIpcSend(socket, &Request) != MR_IPC_RCV_OK)
+   {
+      MrIpcShmDetach(Shm);
+      return((MrIpcShmType *)NULL);
+   }
+   return(Shm);
+}
+
+/**
+* @brief Vom Shared Memory Ring abmelden
+*
+* Der Verwaltungseintrag wird von der drehscheibe freigegeben, wenn sie den
+* Socket schlie&szlig;t. Nur eine noch nicht beantwortete Anmeldung gibt der
+* Client selbst frei, eine abgelehnte hat er schon freigegeben.
+*
+* @param[in] Shm Zeiger auf die Verwaltung, darf NULL sein
+*/
+void MrIpcShmDetach(MrIpcShmType *Shm)
+{
+   if (Shm != (MrIpcShmType *)NULL)
+   {
+      if (Shm->State == MrIpcShmPending)
+      {
+         __atomic_store_n(&Shm->Ring->Consumer[Shm->Consumer].Pid, 0,
+                          __ATOMIC_RELEASE);
+      }
+      munmap(Shm->Ring, sizeof(MrIpcShmRingType));
+      free(Shm);
+   }
+}
+
+static BOOL ReadRing(MrIpcShmType *Shm, MrIpcCmdType *Data)
+{  MrIpcShmRingType *Ring;
+   MrIpcShmSlotType *Slot;
+   unsigned int WritePos, ReadPos;
+   int Origin;
+
+   Ring = Shm->Ring;
+   WritePos = __atomic_load_n(&Ring->WritePos, __ATOMIC_SEQ_CST);
+   while (Shm->ReadPos != WritePos)
+   {
+      /* the drehscheibe does not overwrite the slot before ReadPos moves on,
+         unless the slot is not for us */
+      Slot = &(Ring->Slots[Shm->ReadPos % MR_IPC_SHM_NUM_SLOTS]);
+      Origin = Slot->Origin;
+      memcpy(Data, &Slot->Cmd, sizeof(MrIpcCmdType));
+      ReadPos = Shm->ReadPos;
+      if (!__atomic_compare_exchange_n(&Ring->Consumer[Shm->Consumer].ReadPos,
+                                       &ReadPos, ReadPos + 1, FALSE,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+      {
+         if (__atomic_load_n(&Ring->Consumer[Shm->Consumer].Reading,
+                             __ATOMIC_SEQ_CST))
+         {
+            /* the drehscheibe skipped commands we don't subscribe */
+            Shm->ReadPos = ReadPos;
+            continue;
+         }
+         /* the drehscheibe has stopped us, it resends this and all further
+            commands over the socket */
+         Shm->State = MrIpcShmStopped;
+         return(FALSE);
+      }
+      Shm->ReadPos++;
+      if ((Origin != Shm->Consumer) &&
+          MrIpcSubscriptionMatch(&Ring->Consumer[Shm->Consumer].Subscription,
+                                 Data))
+      {
+         return(TRUE);
+      }
+   }
+   return(FALSE);
+}
+
+static BOOL IsInternal(MrIpcCmdType *Data, unsigned int Internal)
+{
+   return((MrIpcGetCommand(Data) == MrIpcCmdIntern) &&
+          (MrIpcGetIntIp1(Data) == Internal));
+}
+
+static int WaitForDoorbell(MrIpcShmType *Shm, int socket, MrIpcCmdType *Data)
+{  unsigned int WritePos;
+
+   /* ring and socket are empty, ask for the doorbell and look again */
+   __atomic_store_n(&Shm->Ring->Consumer[Shm->Consumer].Waiting, 1,
+                    __ATOMIC_SEQ_CST);
+   if (!ReadRing(Shm, Data))
+   {
+      return(MR_IPC_RCV_ERROR);
+   }
+   WritePos = __atomic_load_n(&Shm->Ring->WritePos, __ATOMIC_SEQ_CST);
+   if ((Shm->ReadPos != WritePos) &&
+       __atomic_exchange_n(&Shm->Ring->Consumer[Shm->Consumer].Waiting, 0,
+                           __ATOMIC_SEQ_CST))
+   {
+      /* more data was written before the drehscheibe saw us waiting, so
+         nobody rings for it. Ask for a doorbell to come back to select(). */
+      MrIpcShmSendDoorbell(socket);
+   }
+   return(MR_IPC_RCV_OK);
+}
+
+/**
+* @brief IPC Nachricht aus dem Ring oder vom Socket empfangen
+*
+* Ersatz f&uuml;r MrIpcRecv() f&uuml;r Clients, die sich mit MrIpcShmAttach()
+* am Ring angemeldet haben. Sie wird wie MrIpcRecv() aufgerufen, wenn
+* select() Daten auf dem Socket meldet. Die T&uuml;rklingel wird erst aus dem
+* Socket gelesen, wenn der Ring leer ist, so da&szlig; select() bis dahin
+* immer wieder zur&uuml;ckkehrt. Ist der Ring leer, markiert sich der Client
+* als wartend und liefert MR_IPC_RCV_ERROR wie ein leerer Socket. Kommt der
+* Client mit dem Lesen nicht hinterher, nimmt ihn die drehscheibe vom Ring
+* und schickt alle nicht gelesenen und weiteren Kommandos &uuml;ber den
+* Socket.
+*
+* @param[in] Shm Zeiger auf die Verwaltung, bei NULL wird nur der Socket
+*                benutzt
+* @param[in] socket Socket zur drehscheibe
+* @param[in] Data Zeiger auf die IPC Struktur
+*
+* @return Fehler oder OK (MR_IPC_RCV_OK, MR_IPC_RCV_CLOSED, MR_IPC_RCV_ERROR)
+*/
+int MrIpcShmRecv(MrIpcShmType *Shm, int socket, MrIpcCmdType *Data)
+{  int RecvBytes;
+
+   if ((Shm == (MrIpcShmType *)NULL) || (Shm->State == MrIpcShmOff))
+   {
+      return(MrIpcRecv(socket, Data));
+   }
+   if ((Shm->State == MrIpcShmActive) && ReadRing(Shm, Data))
+   {
+      return(MR_IPC_RCV_OK);
+   }
+   while (TRUE)
+   {
+      RecvBytes = recv(socket, Data, sizeof(MrIpcCmdType), MSG_DONTWAIT);
+      if (RecvBytes == 0)
+      {
+         return(MR_IPC_RCV_CLOSED);
+      }
+      else if (RecvBytes < 0)
+      {
+         if ((Shm->State != MrIpcShmActive) ||
+             ((errno != EAGAIN) && (errno != EWOULDBLOCK)))
+         {
+            return(MR_IPC_RCV_ERROR);
+         }
+         return(WaitForDoorbell(Shm, socket, Data));
+      }
+      else if ((RecvBytes < (int)sizeof(MrIpcCmdType)) &&
+               (recv(socket, (char *)Data + RecvBytes,
+                     sizeof(MrIpcCmdType) - RecvBytes, MSG_WAITALL) !=
+                (int)sizeof(MrIpcCmdType) - RecvBytes))
+      {
+         /* the rest of a split message did not come */
+         return(MR_IPC_RCV_ERROR);
+      }
+      else if (IsInternal(Data, MrIpcInternalShmAck))
+      {
+         if (MrIpcGetIntIp2(Data))
+         {
+            Shm->ReadPos = Shm->Ring->Consumer[Shm->Consumer].StartPos;
+            if (__atomic_load_n(&Shm->Ring->Consumer[Shm->Consumer].Reading,
+                                __ATOMIC_SEQ_CST))
+               Shm->State = MrIpcShmActive;
+            else
+               Shm->State = MrIpcShmStopped;
+         }
+         else
+         {
+            __atomic_store_n(&Shm->Ring->Consumer[Shm->Consumer].Pid, 0,
+                             __ATOMIC_RELEASE);
+            Shm->State = MrIpcShmOff;
+         }
+      }
+      else if (!IsInternal(Data, MrIpcInternalShmDoorbell))
+      {
+         return(MR_IPC_RCV_OK);
+      }
+   }
+}
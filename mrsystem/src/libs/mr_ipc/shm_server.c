@@ -0,0 +1,341 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mr_ipc.h"
+
+/** @file */
+
+/**
+* @brief Shared Memory Ring der drehscheibe anlegen
+*
+* Diese Funktion legt den Ring f&uuml;r den Port der drehscheibe an. Ein
+* &uuml;briggebliebener Ring einer vorherigen Instanz wird dabei ersetzt.
+*
+* @param[in] Port Portnummer der drehscheibe
+*
+* @return Zeiger auf den Ring oder NULL, wenn kein Shared Memory m&ouml;glich
+*         ist. Dann laufen alle Clients &uuml;ber den Socket.
+*/
+MrIpcShmRingType *MrIpcShmServerCreate(int Port)
+{  char Name[32];
+   int Fd;
+   MrIpcShmRingType *Ring;
+
+   sprintf(Name, MR_IPC_SHM_NAME, Port);
+   shm_unlink(Name);
+   Fd = shm_open(Name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+   if (Fd < 0)
+   {
+      return((MrIpcShmRingType *)NULL);
+   }
+   if (ftruncate(Fd, sizeof(MrIpcShmRingType)) < 0)
+   {
+      close(Fd);
+      shm_unlink(Name);
+      return((MrIpcShmRingType *)NULL);
+   }
+   Ring = (MrIpcShmRingType *)mmap(NULL, sizeof(MrIpcShmRingType),
+                                   PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+   close(Fd);
+   if (Ring == (MrIpcShmRingType *)MAP_FAILED)
+   {
+      shm_unlink(Name);
+      return((MrIpcShmRingType *)NULL);
+   }
+   memset(Ring, 0, sizeof(MrIpcShmRingType));
+   Ring->NumSlots = MR_IPC_SHM_NUM_SLOTS;
+   __atomic_store_n(&Ring->Magic, MR_IPC_SHM_MAGIC, __ATOMIC_RELEASE);
+   return(Ring);
+}
+
+/**
+* @brief Shared Memory Ring der drehscheibe freigeben
+*
+* @param[in] Ring Zeiger auf den Ring
+* @param[in] Port Portnummer der drehscheibe
+*/
+void MrIpcShmServerDestroy(MrIpcShmRingType *Ring, int Port)
+{  char Name[32];
+
+   if (Ring != (MrIpcShmRingType *)NULL)
+   {
+      Ring->Magic = 0;
+      munmap(Ring, sizeof(MrIpcShmRingType));
+      sprintf(Name, MR_IPC_SHM_NAME, Port);
+      shm_unlink(Name);
+   }
+}
+
+/**
+* @brief Anmeldung eines Clients am Ring pr&uuml;fen
+*
+* Der Client hat sich bereits einen Verwaltungseintrag reserviert und dessen
+* Nummer und Token in der Anmeldung &uuml;ber den Socket geschickt. Stimmt das
+* Token, liest der Client ab der aktuellen Schreibposition.
+*
+* @param[in] Ring Zeiger auf den Ring
+* @param[in] Request Anmeldung (MrIpcInternalShmAttach) des Clients
+*
+* @return Nummer des Clients im Ring oder MR_IPC_SHM_NO_CONSUMER
+*/
+int MrIpcShmRegister(MrIpcShmRingType *Ring, MrIpcCmdType *Request)
+{  int Consumer;
+
+   Consumer = MrIpcGetIntIp2(Request);
+   if ((Ring == (MrIpcShmRingType *)NULL) ||
+       (Consumer >= MR_IPC_SHM_MAX_CONSUMER) ||
+       (Ring->Consumer[Consumer].Pid == 0) ||
+       (Ring->Consumer[Consumer].Token != MrIpcGetIntLp1(Request)))
+   {
+      return(MR_IPC_SHM_NO_CONSUMER);
+   }
+   Ring->Consumer[Consumer].Waiting = 0;
+   Ring->Consumer[Consumer].StartPos = Ring->WritePos;
+   Ring->Consumer[Consumer].ReadPos = Ring->WritePos;
+   __atomic_store_n(&Ring->Consumer[Consumer].Reading, 1, __ATOMIC_SEQ_CST);
+   return(Consumer);
+}
+
+/**
+* @brief Verwaltungseintrag eines Clients freigeben
+*
+* Wird von der drehscheibe aufgerufen, wenn der Socket des Clients
+* geschlossen wurde.
+*
+* @param[in] Ring Zeiger auf den Ring
+* @param[in] Consumer Nummer des Clients im Ring
+*/
+void MrIpcShmUnregister(MrIpcShmRingType *Ring, int Consumer)
+{
+   if ((Ring != (MrIpcShmRingType *)NULL) &&
+       (Consumer != MR_IPC_SHM_NO_CONSUMER))
+   {
+      Ring->Consumer[Consumer].Waiting = 0;
+      Ring->Consumer[Consumer].Reading = 0;
+      Ring->Consumer[Consumer].Token = 0;
+      __atomic_store_n(&Ring->Consumer[Consumer].Pid, 0, __ATOMIC_RELEASE);
+   }
+}
+
+/**
+* @brief Abonnement eines Clients in den Ring eintragen
+*
+* Der Client &uuml;berspringt beim Lesen alle Kommandos, die nicht zu
+* seinem Abonnement passen.
+*
+* @param[in] Ring Zeiger auf den Ring
+* @param[in] Consumer Nummer des Clients im Ring
+* @param[in] Sub Zeiger auf das Abonnement
+*/
+void MrIpcShmSetSubscription(MrIpcShmRingType *Ring, int Consumer,
+                             MrIpcSubscriptionType *Sub)
+{
+   if ((Ring != (MrIpcShmRingType *)NULL) &&
+       (Consumer != MR_IPC_SHM_NO_CONSUMER))
+   {
+      memcpy(&Ring->Consumer[Consumer].Subscription, Sub,
+             sizeof(MrIpcSubscriptionType));
+   }
+}
+
+/**
+* @brief Kommando in den Ring schreiben
+*
+* Vorher mu&szlig; mit MrIpcShmNextLagging() jeder Client gestoppt sein, dessen
+* ungelesenen Eintrag das &uuml;berschreiben w&uuml;rde.
+*
+* @param[in] Ring Zeiger auf den Ring
+* @param[in] Data Zeiger auf die IPC Struktur
+* @param[in] Origin Nummer des sendenden Clients im Ring, dieser bekommt das
+*                   Kommando nicht zur&uuml;ck
+*/
+void MrIpcShmPublish(MrIpcShmRingType *Ring, MrIpcCmdType *Data, int Origin)
+{  unsigned int Pos;
+   MrIpcShmSlotType *Slot;
+
+   Pos = Ring->WritePos;
+   Slot = &(Ring->Slots[Pos % MR_IPC_SHM_NUM_SLOTS]);
+   Slot->Origin = Origin;
+   memcpy(&Slot->Cmd, Data, sizeof(MrIpcCmdType));
+   __atomic_store_n(&Ring->WritePos, Pos + 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+* @brief Client suchen, der beim n&auml;chsten Schreiben Kommandos verlieren
+*        w&uuml;rde
+*
+* Wird vor MrIpcShmPublish() aufgerufen, solange sie einen Client liefert.
+* Dieser wird mit MrIpcShmStop() vom Ring genommen. Kommandos, die ein
+* Client ohnehin &uuml;berspringen w&uuml;rde, &uuml;berspringt die
+* drehscheibe f&uuml;r ihn. So bleibt ein Client, der nur selten etwas
+* abonniert hat und schl&auml;ft, am Ring.
+*
+* @param[in] Ring Zeiger auf den Ring
+*
+* @return Nummer des Clients im Ring oder MR_IPC_SHM_NO_CONSUMER
+*/
+int MrIpcShmNextLagging(MrIpcShmRingType *Ring)
+{  MrIpcShmConsumerType *Entry;
+   MrIpcShmSlotType *Slot;
+   unsigned int ReadPos, Expected;
+   int Consumer;
+
+   for (Consumer = 0; Consumer < MR_IPC_SHM_MAX_CONSUMER; Consumer++)
+   {
+      Entry = &(Ring->Consumer[Consumer]);
+      if (!Entry->Reading)
+         continue;
+      ReadPos = __atomic_load_n(&Entry->ReadPos, __ATOMIC_SEQ_CST);
+      while (Ring->WritePos - ReadPos >= MR_IPC_SHM_NUM_SLOTS)
+      {
+         Slot = &(Ring->Slots[ReadPos % MR_IPC_SHM_NUM_SLOTS]);
+         if ((Slot->Origin != Consumer) &&
+             MrIpcSubscriptionMatch(&Entry->Subscription, &Slot->Cmd))
+         {
+            return(Consumer);
+         }
+         Expected = ReadPos;
+         if (__atomic_compare_exchange_n(&Entry->ReadPos, &Expected,
+                                         ReadPos + 1, FALSE,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+            ReadPos++;
+         else
+            ReadPos = Expected;
+      }
+   }
+   return(MR_IPC_SHM_NO_CONSUMER);
+}
+
+/**
+* @brief Client vom Ring nehmen
+*
+* Der Client r&uuml;ckt ReadPos erst nach dem Kopieren eines Eintrags mit
+* compare and swap weiter. Die drehscheibe ver&auml;ndert ReadPos ebenso,
+* danach schl&auml;gt das Weiterr&uuml;cken des Clients fehl und er liest
+* nur noch vom Socket. Alle Kommandos ab der gelieferten Position hat er
+* nicht gelesen, sie m&uuml;ssen mit MrIpcShmBacklog() &uuml;ber den Socket
+* nachgeschickt werden.
+*
+* @param[in] Ring Zeiger auf den Ring
+* @param[in] Consumer Nummer des Clients im Ring
+*
+* @return erste nicht gelesene Position
+*/
+unsigned int MrIpcShmStop(MrIpcShmRingType *Ring, int Consumer)
+{  unsigned int ReadPos;
+
+   __atomic_store_n(&Ring->Consumer[Consumer].Reading, 0, __ATOMIC_SEQ_CST);
+   __atomic_store_n(&Ring->Consumer[Consumer].Waiting, 0, __ATOMIC_SEQ_CST);
+   ReadPos = __atomic_load_n(&Ring->Consumer[Consumer].ReadPos, __ATOMIC_SEQ_CST);
+   /* any other value lets the compare and swap of the client fail */
+   while (!__atomic_compare_exchange_n(&Ring->Consumer[Consumer].ReadPos,
+                                       &ReadPos, ReadPos - 1, FALSE,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+      ;
+   return(ReadPos);
+}
+
+/**
+* @brief Nicht gelesene Kommandos eines gestoppten Clients sammeln
+*
+* Liefert wie der Client beim Lesen nur die Kommandos, die zu seinem
+* Abonnement passen und nicht von ihm selbst kommen. Die Iov zeigen in den
+* Ring und m&uuml;ssen vor dem n&auml;chsten MrIpcShmPublish() gesendet
+* sein.
+*
+* @param[in] Ring Zeiger auf den Ring
+* @param[in] Consumer Nummer des Clients im Ring
+* @param[in,out] Pos Position ab der gesammelt wird, von MrIpcShmStop()
+* @param[out] Iov Zeiger auf die Kommandos
+* @param[in] Max Anzahl der Iov
+*
+* @return Anzahl der Kommandos, 0 wenn alle gesammelt sind
+*/
+int MrIpcShmBacklog(MrIpcShmRingType *Ring, int Consumer, unsigned int *Pos,
+                    struct iovec *Iov, int Max)
+{  MrIpcShmSlotType *Slot;
+   int Count;
+
+   Count = 0;
+   while ((*Pos != Ring->WritePos) && (Count < Max))
+   {
+      Slot = &(Ring->Slots[*Pos % MR_IPC_SHM_NUM_SLOTS]);
+      (*Pos)++;
+      if ((Slot->Origin != Consumer) &&
+          MrIpcSubscriptionMatch(&Ring->Consumer[Consumer].Subscription,
+                                 &Slot->Cmd))
+      {
+         Iov[Count].iov_base = &Slot->Cmd;
+         Iov[Count].iov_len = sizeof(MrIpcCmdType);
+         Count++;
+      }
+   }
+   return(Count);
+}
+
+/**
+* @brief Pr&uuml;fen, ob ein Client seine Kommandos aus dem Ring liest
+*
+* @param[in] Ring Zeiger auf den Ring, darf NULL sein
+* @param[in] Consumer Nummer des Clients im Ring
+*
+* @return TRUE, wenn der Client nicht &uuml;ber den Socket bedient wird
+*/
+BOOL MrIpcShmIsReading(MrIpcShmRingType *Ring, int Consumer)
+{
+   return((Ring != (MrIpcShmRingType *)NULL) &&
+          (Consumer != MR_IPC_SHM_NO_CONSUMER) &&
+          Ring->Consumer[Consumer].Reading);
+}
+
+/**
+* @brief Wartenden Client wecken
+*
+* Ein Client, der den Ring leer gelesen hat, markiert sich als wartend und
+* schl&auml;ft dann im select() auf seinem Socket. Nur dann mu&szlig; ihm
+* eine T&uuml;rklingel &uuml;ber den Socket geschickt werden, bei vielen
+* Kommandos hintereinander also nur eine f&uuml;r alle. Die drehscheibe
+* schickt sie &uuml;ber den Sendepuffer des Clients.
+*
+* @param[in] Ring Zeiger auf den Ring
+* @param[in] Consumer Nummer des Clients im Ring
+*
+* @return TRUE, wenn der Client eine T&uuml;rklingel braucht
+*/
+BOOL MrIpcShmWakeup(MrIpcShmRingType *Ring, int Consumer)
+{
+   return(__atomic_exchange_n(&Ring->Consumer[Consumer].Waiting, 0,
+                              __ATOMIC_SEQ_CST) != 0);
+}
+
+/**
+* @brief T&uuml;rklingel aufbauen
+*
+* @param[out] Doorbell Zeiger auf die IPC Struktur
+*/
+void MrIpcShmInitDoorbell(MrIpcCmdType *Doorbell)
+{
+   memset(Doorbell, 0, sizeof(MrIpcCmdType));
+   MrIpcSetCommand(Doorbell, MrIpcCmdIntern);
+   MrIpcSetIntIp1(Doorbell, MrIpcInternalShmDoorbell);
+}
+
+/**
+* @brief T&uuml;rklingel senden
+*
+* Ein Client, der Daten im Ring hat, f&uuml;r die niemand klingelt, bittet
+* damit die drehscheibe um eine T&uuml;rklingel.
+*
+* @param[in] socket Socket zur drehscheibe
+*
+* @return Fehler oder OK (MR_IPC_RCV_OK, MR_IPC_RCV_ERROR)
+*/
+int MrIpcShmSendDoorbell(int socket)
+{  MrIpcCmdType Doorbell;
+
+   MrIpcShmInitDoorbell(&Doorbell);
+   return(MrIpcSend(socket, &Doorbell));
+}
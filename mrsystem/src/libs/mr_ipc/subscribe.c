@@ -0,0 +1,100 @@
+#include <string.h>
+#include <boolean.h>
+#include "mr_ipc.h"
+
+/** @file */
+
+/**
+* @brief Abonnement vorbelegen
+*
+* @param[in] Sub Zeiger auf das Abonnement
+* @param[in] All TRUE f&uuml;r alle Kommandos, FALSE f&uuml;r keines
+*/
+void MrIpcSubscriptionInit(MrIpcSubscriptionType *Sub, BOOL All)
+{
+   memset(Sub, All ? 0xff : 0, sizeof(MrIpcSubscriptionType));
+}
+
+/**
+* @brief Pr&uuml;fen, ob ein Kommando zum Abonnement pa&szlig;t
+*
+* @param[in] Sub Zeiger auf das Abonnement
+* @param[in] Data Zeiger auf die IPC Struktur
+*
+* @return TRUE, wenn der Client das Kommando bekommen soll
+*/
+BOOL MrIpcSubscriptionMatch(MrIpcSubscriptionType *Sub, MrIpcCmdType *Data)
+{  unsigned int Command;
+
+   Command = MrIpcGetCommand(Data);
+   if ((Command >= MR_IPC_NUM_COMMANDS) ||
+       !MrIpcSubscriptionGetCmd(Sub, Command))
+   {
+      return(FALSE);
+   }
+   else if (Command == MrIpcCmdNull)
+   {
+      return(MrIpcSubscriptionGetCanCmd(Sub, MrIpcGetCanCommand(Data) %
+                                             MR_IPC_NUM_CAN_COMMANDS));
+   }
+   else
+   {
+      return(TRUE);
+   }
+}
+
+/**
+* @brief Abonnement aus einer Anmeldung &uuml;bernehmen
+*
+* Wird von der drehscheibe f&uuml;r jedes empfangene MrIpcInternalSubscribe
+* aufgerufen.
+*
+* @param[in] Sub Zeiger auf das Abonnement des Clients
+* @param[in] Request Anmeldung (MrIpcInternalSubscribe) des Clients
+*/
+void MrIpcSubscriptionUpdate(MrIpcSubscriptionType *Sub,
+                             MrIpcCmdType *Request)
+{  unsigned int Word;
+
+   Word = MrIpcGetIntIp2(Request);
+   if (Word == 0)
+   {
+      Sub->Commands = MrIpcGetIntLp1(Request);
+   }
+   else if (Word <= MR_IPC_SUBSCRIPTION_CAN_WORDS)
+   {
+      Sub->CanCommands[Word - 1] = MrIpcGetIntLp1(Request);
+   }
+}
+
+/**
+* @brief Abonnement an die drehscheibe schicken
+*
+* Der Client bekommt danach nur noch die abonnierten Kommandos. Die
+* drehscheibe weckt ihn auch nur noch f&uuml;r diese, das gilt ebenso
+* f&uuml;r den Shared Memory Ring.
+*
+* @param[in] socket Socket zur drehscheibe
+* @param[in] Sub Zeiger auf das Abonnement
+*
+* @return Fehler oder OK (MR_IPC_RCV_OK, MR_IPC_RCV_ERROR)
+*/
+int MrIpcSubscribe(int socket, MrIpcSubscriptionType *Sub)
+{  MrIpcCmdType Request;
+   unsigned int Word;
+
+   for (Word = 0; Word <= MR_IPC_SUBSCRIPTION_CAN_WORDS; Word++)
+   {
+      memset(&Request, 0, sizeof(MrIpcCmdType));
+      MrIpcSetCommand(&Request, MrIpcCmdIntern);
+      MrIpcSetIntIp1(&Request, MrIpcInternalSubscribe);
+      MrIpcSetIntIp2(&Request, Word);
+      MrIpcSetIntLp1(&Request, Word == 0 ? Sub->Commands :
+                                           Sub->CanCommands[Word - 1]);
+      if (MrIpcSend(socket, &Request) != MR_IPC_RCV_OK)
+      {
+         return(MR_IPC_RCV_ERROR);
+      }
+   }
+   return(MR_IPC_RCV_OK);
+}
@@ -120,6 +120,12 @@ class ControlInterface
 			return Hardware::CapabilityNone;
 		}
 
+		// a simulated layout runs faster than real time, so its locos have to look more often
+		virtual unsigned int GetAutoModeInterval() const
+		{
+			return DefaultAutoModeInterval;
+		}
+
 		inline bool CanHandle(const Hardware::Capabilities capability) const
 		{
 			Hardware::Capabilities hardwareCapabilities = GetCapabilities();
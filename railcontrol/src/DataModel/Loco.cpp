@@ -405,8 +405,7 @@ namespace DataModel
 						break;
 				}
 			}
-			// FIXME: make configurable
-			Utils::Utils::SleepForSeconds(1);
+			Utils::Utils::SleepForMilliseconds(manager->GetAutoModeInterval(GetControlID()));
 		}
 	}
 
@@ -760,6 +759,25 @@ namespace DataModel
 		}
 	}
 
+	void Loco::GetFeedbacksAhead(vector<FeedbackID>& feedbacks) const
+	{
+		std::lock_guard<std::mutex> Guard(stateMutex);
+		for (const Route* route : { routeFirst, routeSecond })
+		{
+			if (route == nullptr)
+			{
+				continue;
+			}
+			for (const FeedbackID feedbackId : { route->GetFeedbackIdReduced(), route->GetFeedbackIdCreep(), route->GetFeedbackIdStop() })
+			{
+				if (feedbackId != FeedbackNone)
+				{
+					feedbacks.push_back(feedbackId);
+				}
+			}
+		}
+	}
+
 	void Loco::SetSpeed(const Speed speed, const bool withSlaves)
 	{
 		this->speed = speed;
@@ -139,6 +139,9 @@ namespace DataModel
 
 			void LocationReached(const FeedbackID feedbackID);
 
+			// feedbacks of the reserved routes in the order the loco passes them
+			void GetFeedbacksAhead(std::vector<FeedbackID>& feedbacks) const;
+
 			void SetSpeed(const Speed speed, const bool withSlaves);
 
 			inline Speed GetSpeed() const
@@ -270,6 +270,20 @@ namespace DataModel
 
 			static std::string GetLocoFunctionIcon(const LocoFunctionNr nr, const LocoFunctionIcon icon);
 
+			inline bool HasSameConfiguration(const LocoFunctions& other) const
+			{
+				for (LocoFunctionNr nr = 0; nr < NumberOfLocoFunctions; ++nr)
+				{
+					const LocoFunctionEntry& entry = entries[nr];
+					const LocoFunctionEntry& otherEntry = other.entries[nr];
+					if (entry.type != otherEntry.type || entry.icon != otherEntry.icon || entry.timer != otherEntry.timer)
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+
 		private:
 			bool DeserializeNew(const std::string& serialized);
 
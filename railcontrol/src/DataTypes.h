@@ -89,6 +89,8 @@ static const Speed DefaultReducedSpeed = 400;
 static const Speed DefaultCreepingSpeed = 100;
 static const Speed MinSpeed = 0;
 
+static const unsigned int DefaultAutoModeInterval = 1000; // ms
+
 enum ControlType : uint8_t
 {
 	ControlTypeHardware = 0,
@@ -156,7 +158,10 @@ enum ArgumentType : uint8_t
 {
 	ArgumentTypeIpAddress = 1,
 	ArgumentTypeSerialPort = 2,
-	ArgumentTypeS88Modules = 3
+	ArgumentTypeS88Modules = 3,
+	ArgumentTypeSimulationTimeFactor = 4,
+	ArgumentTypeFeedbackDistance = 5,
+	ArgumentTypeMaxVelocity = 6
 };
 
 enum HardwareType : uint8_t
@@ -0,0 +1,214 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "DataTypes.h"
+
+namespace Hardware
+{
+	// Address indexed cache for the protocol state of locos and accessories.
+	//
+	// The entries are stored in pages of PageSize entries which are allocated
+	// on first write and never freed while the cache exists. Readers (usually the
+	// receiver threads) do not lock. They read lock-free and retry if a writer
+	// modified the page meanwhile (seqlock). Writers are serialized by a mutex.
+	//
+	// T must be trivially copyable and default constructible.
+	template<class T>
+	class AddressCache
+	{
+		public:
+			AddressCache(const AddressCache&) = delete;
+			AddressCache& operator=(const AddressCache&) = delete;
+
+			inline AddressCache()
+			:	hits(0),
+				misses(0)
+			{
+				for (auto& page : pages)
+				{
+					page.store(nullptr, std::memory_order_relaxed);
+				}
+			}
+
+			inline ~AddressCache()
+			{
+				for (auto& page : pages)
+				{
+					delete page.load(std::memory_order_relaxed);
+				}
+			}
+
+			// Returns defaultEntry if address has never been written
+			inline T Get(const Address address, const T& defaultEntry = T()) const
+			{
+				T entry;
+				if (Get(address, entry))
+				{
+					return entry;
+				}
+				return defaultEntry;
+			}
+
+			bool Get(const Address address, T& entry) const
+			{
+				const Page* page = GetPage(address);
+				if (page == nullptr)
+				{
+					misses.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				const Address index = address & PageMask;
+				bool valid = false;
+				unsigned int sequenceBefore;
+				unsigned int sequenceAfter;
+				do
+				{
+					sequenceBefore = page->sequence.load(std::memory_order_acquire);
+					if (sequenceBefore & 0x01)
+					{
+						// writer active
+						continue;
+					}
+					entry = page->entries[index];
+					valid = page->valid[index];
+					std::atomic_thread_fence(std::memory_order_acquire);
+					sequenceAfter = page->sequence.load(std::memory_order_relaxed);
+				} while ((sequenceBefore & 0x01) || sequenceBefore != sequenceAfter);
+
+				if (valid)
+				{
+					hits.fetch_add(1, std::memory_order_relaxed);
+				}
+				else
+				{
+					misses.fetch_add(1, std::memory_order_relaxed);
+				}
+				return valid;
+			}
+
+			// Calls function with a reference to the entry of address.
+			// An entry that has never been written is passed as defaultEntry.
+			template<typename Function>
+			void Update(const Address address, Function function, const T& defaultEntry = T())
+			{
+				if (address > MaxAddress)
+				{
+					return;
+				}
+				std::lock_guard<std::mutex> guard(writeMutex);
+				std::atomic<Page*>& pageAtomic = pages[address >> PageShift];
+				Page* page = pageAtomic.load(std::memory_order_relaxed);
+				if (page == nullptr)
+				{
+					page = new Page();
+					pageAtomic.store(page, std::memory_order_release);
+				}
+				const Address index = address & PageMask;
+				page->sequence.fetch_add(1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				if (!page->valid[index])
+				{
+					page->entries[index] = defaultEntry;
+					page->valid[index] = true;
+				}
+				function(page->entries[index]);
+				page->sequence.fetch_add(1, std::memory_order_release);
+			}
+
+			inline void Set(const Address address, const T& entry)
+			{
+				Update(address, [&entry] (T& cacheEntry) { cacheEntry = entry; });
+			}
+
+			// Returns all addresses that have been written at least once
+			std::vector<Address> GetAddresses()
+			{
+				std::vector<Address> addresses;
+				std::lock_guard<std::mutex> guard(writeMutex);
+				for (Address pageNr = 0; pageNr < NumberOfPages; ++pageNr)
+				{
+					const Page* page = pages[pageNr].load(std::memory_order_relaxed);
+					if (page == nullptr)
+					{
+						continue;
+					}
+					for (Address index = 0; index < PageSize; ++index)
+					{
+						if (page->valid[index])
+						{
+							addresses.push_back((pageNr << PageShift) | index);
+						}
+					}
+				}
+				return addresses;
+			}
+
+			inline unsigned long GetHits() const
+			{
+				return hits.load(std::memory_order_relaxed);
+			}
+
+			inline unsigned long GetMisses() const
+			{
+				return misses.load(std::memory_order_relaxed);
+			}
+
+		private:
+			static const Address MaxAddress = 0x3FFF;
+			static const unsigned char PageShift = 6;
+			static const Address PageSize = 1 << PageShift;
+			static const Address PageMask = PageSize - 1;
+			static const Address NumberOfPages = (MaxAddress >> PageShift) + 1;
+
+			struct Page
+			{
+				inline Page()
+				:	sequence(0),
+					entries(),
+					valid()
+				{
+				}
+
+				std::atomic<unsigned int> sequence;
+				T entries[PageSize];
+				bool valid[PageSize];
+			};
+
+			inline const Page* GetPage(const Address address) const
+			{
+				if (address > MaxAddress)
+				{
+					return nullptr;
+				}
+				return pages[address >> PageShift].load(std::memory_order_acquire);
+			}
+
+			std::atomic<Page*> pages[NumberOfPages];
+			std::mutex writeMutex;
+			mutable std::atomic<unsigned long> hits;
+			mutable std::atomic<unsigned long> misses;
+	};
+} // namespace Hardware
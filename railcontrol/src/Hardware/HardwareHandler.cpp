@@ -174,6 +174,16 @@ namespace Hardware
 		return instance->GetCapabilities();
 	}
 
+	unsigned int HardwareHandler::GetAutoModeInterval() const
+	{
+		if (instance == nullptr)
+		{
+			return DefaultAutoModeInterval;
+		}
+
+		return instance->GetAutoModeInterval();
+	}
+
 	void HardwareHandler::LocoProtocols(std::vector<Protocol>& protocols) const
 	{
 		if (instance == nullptr)
@@ -696,7 +706,7 @@ namespace Hardware
 				return;
 
 			case HardwareTypeVirtual:
-				Hardware::Virtual::GetHint(hint);
+				Hardware::Virtual::GetArgumentTypesAndHint(arguments, hint);
 				return;
 
 			case HardwareTypeCS2Udp:
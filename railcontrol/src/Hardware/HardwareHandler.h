@@ -73,6 +73,7 @@ namespace Hardware
 
 			void Booster(const ControlType controlType, BoosterState status) override;
 			Hardware::Capabilities GetCapabilities() const override;
+			unsigned int GetAutoModeInterval() const override;
 			void LocoOrientation(const ControlType controlType,
 				const DataModel::Loco* loco,
 				const Orientation orientation) override;
@@ -77,6 +77,12 @@ namespace Hardware
 				return Hardware::CapabilityNone;
 			}
 
+			// get interval in ms the auto mode of the locos of this hardware looks for new routes
+			virtual unsigned int GetAutoModeInterval() const
+			{
+				return DefaultAutoModeInterval;
+			}
+
 			// get available loco protocols of this control
 			virtual void GetLocoProtocols(__attribute__((unused)) std::vector<Protocol>& protocols) const
 			{
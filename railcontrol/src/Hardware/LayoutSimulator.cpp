@@ -0,0 +1,262 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "DataModel/Loco.h"
+#include "Hardware/LayoutSimulator.h"
+#include "Manager.h"
+#include "Utils/Utils.h"
+
+using std::pair;
+using std::vector;
+
+namespace Hardware
+{
+	LayoutSimulator::LayoutSimulator(Manager* manager,
+		Logger::Logger* logger,
+		const ControlID controlID,
+		const unsigned int timeFactor,
+		const unsigned int feedbackDistance,
+		const unsigned int maxVelocity)
+	:	manager(manager),
+		logger(logger),
+		controlID(controlID),
+		timeFactor(timeFactor),
+		feedbackDistance(feedbackDistance),
+		maxVelocity(maxVelocity),
+		boosterOn(false),
+		departures(0),
+		feedbacks(0),
+		run(true)
+	{
+		simulatorThread = std::thread(&Hardware::LayoutSimulator::Simulator, this);
+	}
+
+	LayoutSimulator::~LayoutSimulator()
+	{
+		run = false;
+		simulatorThread.join();
+	}
+
+	void LayoutSimulator::Booster(const BoosterState status)
+	{
+		std::lock_guard<std::mutex> guard(trainMutex);
+		boosterOn = (status == BoosterStateGo);
+	}
+
+	void LayoutSimulator::LocoSpeed(const Protocol protocol, const Address address, const Speed speed)
+	{
+		std::lock_guard<std::mutex> guard(trainMutex);
+		Train& train = trains[address];
+		train.protocol = protocol;
+		if (train.speed == MinSpeed && speed != MinSpeed)
+		{
+			++departures;
+			if (train.stopped)
+			{
+				const Clock::duration decision = Clock::now() - train.stoppedAt;
+				decisionLatencies.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(decision).count());
+				train.stopped = false;
+			}
+		}
+		else if (train.speed != MinSpeed && speed == MinSpeed)
+		{
+			train.stopped = true;
+			train.stoppedAt = Clock::now();
+		}
+		train.speed = speed;
+	}
+
+	void LayoutSimulator::Simulator()
+	{
+		Utils::Utils::SetThreadName("Simulator");
+		logger->Info(Languages::TextSimulationStarted, timeFactor);
+		Clock::time_point lastStep = Clock::now();
+		Clock::time_point lastReport = lastStep;
+		while (run)
+		{
+			Utils::Utils::SleepForMilliseconds(TickMs);
+			const Clock::time_point now = Clock::now();
+			Step(std::chrono::duration<double>(now - lastStep).count() * timeFactor);
+			lastStep = now;
+			if (now - lastReport < std::chrono::milliseconds(ReportIntervalMs))
+			{
+				continue;
+			}
+			Report(std::chrono::duration<double>(now - lastReport).count());
+			lastReport = now;
+		}
+	}
+
+	void LayoutSimulator::Step(const double seconds)
+	{
+		vector<pair<FeedbackID,DataModel::Feedback::FeedbackState>> events;
+		vector<Address> withoutTarget;
+		{
+			std::lock_guard<std::mutex> guard(trainMutex);
+			if (boosterOn == false)
+			{
+				return;
+			}
+			for (auto& addressAndTrain : trains)
+			{
+				Train& train = addressAndTrain.second;
+				if (train.speed == MinSpeed)
+				{
+					continue;
+				}
+				const double distance = static_cast<double>(train.speed) * maxVelocity / MaxSpeed * seconds;
+				train.odometer += distance;
+
+				// the end of the train has left the feedback
+				for (auto occupied = train.occupied.begin(); occupied != train.occupied.end(); )
+				{
+					if (train.odometer - occupied->second < train.length)
+					{
+						++occupied;
+						continue;
+					}
+					events.emplace_back(occupied->first, DataModel::Feedback::FeedbackStateFree);
+					occupied = train.occupied.erase(occupied);
+				}
+
+				if (train.target == FeedbackNone)
+				{
+					withoutTarget.push_back(addressAndTrain.first);
+					continue;
+				}
+
+				train.distanceToTarget -= distance;
+				if (train.distanceToTarget > 0)
+				{
+					continue;
+				}
+				events.emplace_back(train.target, DataModel::Feedback::FeedbackStateOccupied);
+				train.occupied.emplace_back(train.target, train.odometer + train.distanceToTarget);
+				train.passed.insert(train.target);
+				train.target = FeedbackNone;
+				withoutTarget.push_back(addressAndTrain.first);
+			}
+		}
+
+		// the locos react on the feedbacks and call LocoSpeed, so the trains must not be locked here
+		for (auto& event : events)
+		{
+			const Clock::time_point start = Clock::now();
+			manager->FeedbackState(event.first, event.second);
+			if (event.second == DataModel::Feedback::FeedbackStateFree)
+			{
+				continue;
+			}
+			++feedbacks;
+			feedbackLatencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+		}
+
+		UpdateTargets(withoutTarget);
+	}
+
+	void LayoutSimulator::UpdateTargets(const vector<Address>& addresses)
+	{
+		for (const Address address : addresses)
+		{
+			Protocol protocol;
+			{
+				std::lock_guard<std::mutex> guard(trainMutex);
+				protocol = trains[address].protocol;
+			}
+
+			vector<FeedbackID> ahead;
+			Length length = DefaultTrainLength;
+			const DataModel::Loco* loco = manager->GetLoco(controlID, protocol, address);
+			if (loco != nullptr)
+			{
+				loco->GetFeedbacksAhead(ahead);
+				if (loco->GetLength() > 0)
+				{
+					length = loco->GetLength();
+				}
+			}
+
+			std::lock_guard<std::mutex> guard(trainMutex);
+			Train& train = trains[address];
+			train.length = length;
+
+			// forget the feedbacks of released routes
+			for (auto passed = train.passed.begin(); passed != train.passed.end(); )
+			{
+				if (std::find(ahead.begin(), ahead.end(), *passed) == ahead.end())
+				{
+					passed = train.passed.erase(passed);
+					continue;
+				}
+				++passed;
+			}
+
+			for (const FeedbackID feedbackID : ahead)
+			{
+				if (train.passed.count(feedbackID) == 1)
+				{
+					continue;
+				}
+				train.target = feedbackID;
+				train.distanceToTarget += feedbackDistance;
+				break;
+			}
+		}
+	}
+
+	void LayoutSimulator::Report(const double seconds)
+	{
+		unsigned int running = 0;
+		unsigned int departuresInInterval;
+		vector<unsigned int> decisions;
+		{
+			std::lock_guard<std::mutex> guard(trainMutex);
+			for (auto& addressAndTrain : trains)
+			{
+				running += (addressAndTrain.second.speed != MinSpeed);
+			}
+			departuresInInterval = departures;
+			departures = 0;
+			decisions.swap(decisionLatencies);
+		}
+		logger->Info(Languages::TextSimulationReport,
+			running,
+			feedbacks,
+			departuresInInterval,
+			static_cast<unsigned int>(seconds + 0.5),
+			Percentile99(feedbackLatencies),
+			Percentile99(decisions));
+		feedbacks = 0;
+		feedbackLatencies.clear();
+	}
+
+	unsigned int LayoutSimulator::Percentile99(vector<unsigned int>& values)
+	{
+		if (values.size() == 0)
+		{
+			return 0;
+		}
+		const size_t index = std::min(values.size() - 1, values.size() * 99 / 100);
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		return values[index];
+	}
+} // namespace
@@ -0,0 +1,134 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "DataModel/Feedback.h"
+#include "DataTypes.h"
+#include "Logger/Logger.h"
+
+class Manager;
+
+namespace Hardware
+{
+	// Moves the locos of the virtual control along their reserved routes and
+	// triggers the feedbacks of the routes when a loco reaches them. The simulated
+	// time runs timeFactor times faster than the real time.
+	class LayoutSimulator
+	{
+		public:
+			LayoutSimulator() = delete;
+			LayoutSimulator(const LayoutSimulator&) = delete;
+			LayoutSimulator& operator=(const LayoutSimulator&) = delete;
+
+			LayoutSimulator(Manager* manager,
+				Logger::Logger* logger,
+				const ControlID controlID,
+				const unsigned int timeFactor,
+				const unsigned int feedbackDistance,
+				const unsigned int maxVelocity);
+
+			~LayoutSimulator();
+
+			// the simulated time runs faster, so the auto mode has to look more often
+			inline unsigned int GetAutoModeInterval() const
+			{
+				return std::max(DefaultAutoModeInterval / timeFactor, 1U);
+			}
+
+			void Booster(const BoosterState status);
+
+			void LocoSpeed(const Protocol protocol, const Address address, const Speed speed);
+
+			static const unsigned int DefaultFeedbackDistance = 100; // cm
+			static const unsigned int DefaultMaxVelocity = 50; // cm/s
+
+		private:
+			typedef std::chrono::steady_clock Clock;
+
+			class Train
+			{
+				public:
+					Train()
+					:	protocol(ProtocolNone),
+						speed(MinSpeed),
+						length(DefaultTrainLength),
+						target(FeedbackNone),
+						distanceToTarget(0),
+						odometer(0),
+						stopped(false)
+					{
+					}
+
+					Protocol protocol;
+					Speed speed;
+					Length length;
+					FeedbackID target;
+					double distanceToTarget;
+					double odometer;
+					// feedbacks of the reserved routes that have already been triggered
+					std::set<FeedbackID> passed;
+					// feedbacks under the train with the odometer value when they were reached
+					std::vector<std::pair<FeedbackID,double>> occupied;
+					bool stopped;
+					Clock::time_point stoppedAt;
+			};
+
+			void Simulator();
+			void Step(const double seconds);
+			void UpdateTargets(const std::vector<Address>& addresses);
+			void Report(const double seconds);
+
+			static unsigned int Percentile99(std::vector<unsigned int>& values);
+
+			static const unsigned int TickMs = 10;
+			static const unsigned int ReportIntervalMs = 10000;
+			static const Length DefaultTrainLength = 20; // cm
+
+			Manager* manager;
+			Logger::Logger* logger;
+			const ControlID controlID;
+			const unsigned int timeFactor;
+			const unsigned int feedbackDistance;
+			const unsigned int maxVelocity;
+
+			std::mutex trainMutex;
+			std::map<Address,Train> trains;
+			bool boosterOn;
+			unsigned int departures;
+			std::vector<unsigned int> decisionLatencies;
+
+			// only used by the simulator thread
+			unsigned int feedbacks;
+			std::vector<unsigned int> feedbackLatencies;
+
+			volatile bool run;
+			std::thread simulatorThread;
+	};
+} // namespace
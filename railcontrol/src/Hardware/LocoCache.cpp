@@ -29,6 +29,14 @@ namespace Hardware
 		DataModel::Loco* loco = nullptr;
 
 		const bool matchKeyChanged = matchKey.compare(oldMatchKey) != 0;
+		auto cacheEntry = entries.find(matchKey);
+		if (!matchKeyChanged && cacheEntry != entries.end() && cacheEntry->second.HasSameConfiguration(entry))
+		{
+			// nothing changed, so we do not touch the loco
+			entry.SetLocoID(cacheEntry->second.GetLocoID());
+			return;
+		}
+
 		if (matchKeyChanged)
 		{
 			const LocoID locoId = Delete(oldMatchKey);
@@ -50,6 +58,7 @@ namespace Hardware
 			entry.SetLocoID(loco->GetID());
 			*loco = entry;
 		}
+		entries.erase(matchKey);
 		entries.emplace(matchKey, entry);
 	}
 
@@ -123,6 +123,25 @@ namespace Hardware
 				this->matchKey = std::to_string(matchKey);
 			}
 
+			inline void Clear()
+			{
+				locoId = LocoNone;
+				name.clear();
+				protocol = ProtocolNone;
+				address = AddressNone;
+				matchKey.clear();
+				functions = DataModel::LocoFunctions();
+			}
+
+			inline bool HasSameConfiguration(const LocoCacheEntry& other) const
+			{
+				return name.compare(other.name) == 0
+					&& protocol == other.protocol
+					&& address == other.address
+					&& matchKey.compare(other.matchKey) == 0
+					&& functions.HasSameConfiguration(other.functions);
+			}
+
 		private:
 			const ControlID controlId;
 			LocoID locoId;
@@ -116,6 +116,7 @@ namespace Hardware
 				{
 					run = false;
 					receiverThread.join();
+					logger->Debug(Languages::TextCacheStatistics, "Loco", locoCache.GetHits(), locoCache.GetMisses());
 				}
 
 			private:
@@ -20,9 +20,8 @@ along with RailControl; see the file LICENCE. If not see
 
 #pragma once
 
-#include <map>
-
 #include "DataTypes.h"
+#include "Hardware/AddressCache.h"
 
 namespace Hardware
 {
@@ -47,55 +46,33 @@ namespace Hardware
 				Orientation orientation;
 		};
 
-		class DccPpExLocoCache
+		class DccPpExLocoCache : public AddressCache<DccPpExLocoCacheEntry>
 		{
 			public:
-				DccPpExLocoCache& operator=(const DccPpExLocoCache&) = delete;
-
-				DccPpExLocoCacheEntry GetData(const Address address)
+				inline DccPpExLocoCacheEntry GetData(const Address address) const
 				{
-					if (cache.count(address) == 1)
-					{
-						return cache[address];
-					}
-					DccPpExLocoCacheEntry entry;
-					return entry;
+					return Get(address);
 				}
 
-				void SetSpeed(const Address address, const Speed speed)
+				inline void SetSpeed(const Address address, const Speed speed)
 				{
-					DccPpExLocoCacheEntry entry = GetData(address);
-					entry.speed = speed;
-					cache[address] = entry;
+					Update(address, [speed] (DccPpExLocoCacheEntry& entry) { entry.speed = speed; });
 				}
 
-				Speed GetSpeed(const Address address)
+				inline Speed GetSpeed(const Address address) const
 				{
-					if (cache.count(address) == 0)
-					{
-						return MinSpeed;
-					}
-					return cache[address].speed;
+					return Get(address).speed;
 				}
 
-				void SetOrientation(const Address address, const Orientation orientation)
+				inline void SetOrientation(const Address address, const Orientation orientation)
 				{
-					DccPpExLocoCacheEntry entry = GetData(address);
-					entry.orientation = orientation;
-					cache[address] = entry;
+					Update(address, [orientation] (DccPpExLocoCacheEntry& entry) { entry.orientation = orientation; });
 				}
 
-				Orientation GetOrientation(const Address address)
+				inline Orientation GetOrientation(const Address address) const
 				{
-					if (cache.count(address) == 0)
-					{
-						return OrientationRight;
-					}
-					return cache[address].orientation;
+					return Get(address).orientation;
 				}
-
-			private:
-				std::map<Address, DccPpExLocoCacheEntry> cache;
 		};
 	} // namespace
 } // namespace
@@ -18,12 +18,8 @@ along with RailControl; see the file LICENCE. If not see
 <http://www.gnu.org/licenses/>.
 */
 
-#include <deque>
-
 #include "Hardware/Protocols/MaerklinCAN.h"
-#include "Hardware/ZLib.h"
 
-using std::deque;
 using std::string;
 using std::vector;
 
@@ -35,6 +31,7 @@ namespace Hardware
 		{
 			receiverThread = std::thread(&MaerklinCAN::Receiver, this);
 			cs2MasterThread = std::thread(&MaerklinCAN::Cs2MasterThread, this);
+			configDataParserThread = std::thread(&MaerklinCAN::ConfigDataParser, this);
 		}
 
 		MaerklinCAN::~MaerklinCAN()
@@ -42,11 +39,8 @@ namespace Hardware
 			run = false;
 			receiverThread.join();
 			cs2MasterThread.join();
-			if (canFileData != nullptr)
-			{
-				free(canFileData);
-				canFileData = nullptr;
-			}
+			configDataQueue.Terminate();
+			configDataParserThread.join();
 		}
 
 		void MaerklinCAN::Wait(const unsigned int duration) const
@@ -74,6 +68,17 @@ namespace Hardware
 			}
 		}
 
+		void MaerklinCAN::ConfigDataParser()
+		{
+			Utils::Utils::SetThreadName("CS2 Config Data");
+			while (run)
+			{
+				ConfigDataQueueEntry entry = configDataQueue.Dequeue();
+				// an empty entry (length 0) is in queue when we should quit
+				ParseCommandConfigData(entry.buffer);
+			}
+		}
+
 		void MaerklinCAN::CreateCommandHeader(unsigned char* const buffer, const CanCommand command,
 			const CanResponse response, const CanLength length)
 		{
@@ -402,8 +407,12 @@ namespace Hardware
 					return;
 
 				case CanCommandConfigData:
-					ParseCommandConfigData(buffer);
+				{
+					ConfigDataQueueEntry entry;
+					memcpy(entry.buffer, buffer, sizeof(entry.buffer));
+					configDataQueue.Enqueue(entry);
 					return;
+				}
 
 				case CanCommandPing:
 					ParseCommandPing(buffer);
@@ -537,46 +546,59 @@ namespace Hardware
 
 		void MaerklinCAN::ParseCommandConfigDataFirst(const unsigned char* const buffer)
 		{
-			if (canFileData != nullptr)
-			{
-				free(canFileData);
-			}
 			canFileDataSize = Utils::Utils::DataBigEndianToInt(buffer + 5);
+			canFileDataReceived = 0;
 			canFileCrc = Utils::Utils::DataBigEndianToShort(buffer + 9);
-			canFileData = reinterpret_cast<unsigned char*>(malloc(canFileDataSize + 8));
-			canFileDataPointer = canFileData;
+			canFileUncompressedSize = 0;
+			canFileLines.clear();
+			cs2FileSection = Cs2FileSectionNone;
+			if (canFileUnCompressor.Start() == false)
+			{
+				canFileDataSize = 0;
+			}
 		}
 
 		void MaerklinCAN::ParseCommandConfigDataNext(const unsigned char* const buffer)
 		{
-			if (canFileData == nullptr)
+			if (canFileDataReceived >= canFileDataSize)
 			{
 				return;
 			}
 
-			Utils::Utils::Copy8Bytes(buffer + 5, canFileDataPointer);
-			canFileDataPointer += 8;
-			if (canFileDataSize > static_cast<size_t>(canFileDataPointer - canFileData))
+			const char* data = reinterpret_cast<const char*>(buffer + 5);
+			size_t dataSize = 8;
+			if (canFileDataReceived == 0)
 			{
+				// the first 4 bytes contain the uncompressed size
+				canFileUncompressedSize = Utils::Utils::DataBigEndianToInt(buffer + 5);
+				data += 4;
+				dataSize -= 4;
+			}
+			canFileDataReceived += 8;
+
+			if (canFileUnCompressor.UnCompress(data, dataSize, canFileLines) == false)
+			{
+				logger->Error(Languages::TextInvalidDataReceived);
+				canFileDataSize = 0;
+				canFileLines.clear();
 				return;
 			}
+			ParseCs2FileLines();
 
-			size_t canFileUncompressedSize = Utils::Utils::DataBigEndianToInt(canFileData);
-			logger->Info(Languages::TextConfigFileReceivedWithSize, canFileUncompressedSize);
-			string file = ZLib::UnCompress(reinterpret_cast<char*>(canFileData + 4), canFileDataSize,
-				canFileUncompressedSize);
-			deque<string> lines;
-			Utils::Utils::SplitString(file, "\n", lines);
-			for (std::string& line : lines)
+			if (canFileDataSize > canFileDataReceived)
 			{
-				logger->Debug(line);
+				return;
 			}
-			ParseCs2File(lines);
 
-			free(canFileData);
+			logger->Info(Languages::TextConfigFileReceivedWithSize, canFileUncompressedSize);
+			if (canFileLines.size() > 0)
+			{
+				ParseCs2FileLine(canFileLines);
+				canFileLines.clear();
+			}
+			// an empty line closes all open sections
+			ParseCs2FileLine("");
 			canFileDataSize = 0;
-			canFileData = nullptr;
-			canFileDataPointer = nullptr;
 		}
 
 		void MaerklinCAN::ParseResponseS88Event(const unsigned char* const buffer)
@@ -690,211 +712,245 @@ namespace Hardware
 			return (key.compare(stripedLine) != 0);
 		}
 
-		void MaerklinCAN::ParseCs2FileLocomotiveFunction(deque<string>& lines, LocoCacheEntry& cacheEntry)
+		void MaerklinCAN::ParseCs2FileLines()
 		{
-			lines.pop_front();
-			DataModel::LocoFunctionNr nr = 0;
-			DataModel::LocoFunctionType type = DataModel::LocoFunctionTypeNone;
-			DataModel::LocoFunctionIcon icon = DataModel::LocoFunctionIconNone;
-			DataModel::LocoFunctionTimer timer = 0;
-			while (lines.size())
+			size_t lineStart = 0;
+			while (true)
 			{
-				string& line = lines.front();
-				string key;
-				string value;
-				bool ok = ParseCs2FileSubkeyValue(line, key, value);
-				if (ok == false)
+				const size_t lineEnd = canFileLines.find('\n', lineStart);
+				if (lineEnd == string::npos)
 				{
 					break;
 				}
-				if (key.compare("nr") == 0)
-				{
-					nr = Utils::Utils::StringToInteger(value);
-				}
-				else if (key.compare("typ") == 0 || key.compare("typ2") == 0)
+				ParseCs2FileLine(canFileLines.substr(lineStart, lineEnd - lineStart));
+				lineStart = lineEnd + 1;
+			}
+			canFileLines.erase(0, lineStart);
+		}
+
+		void MaerklinCAN::ParseCs2FileLine(const string& line)
+		{
+			logger->Debug(line);
+			while (true)
+			{
+				bool parsed;
+				switch (cs2FileSection)
 				{
-					uint8_t valueInt = Utils::Utils::StringToInteger(value);
-					icon = MapLocoFunctionCs2ToRailControl(static_cast<LocoFunctionCs2Icon>(valueInt & 0x7F));
-					type = static_cast<DataModel::LocoFunctionType>((valueInt >> 7) + 1); // CS2: 1 = permanent, 2 = once
+					case Cs2FileSectionNone:
+						parsed = ParseCs2File(line);
+						break;
+
+					case Cs2FileSectionLocomotives:
+						parsed = ParseCs2FileLocomotives(line);
+						break;
+
+					case Cs2FileSectionLocomotivesVersion:
+						parsed = ParseCs2FileLocomotivesVersion(line);
+						break;
+
+					case Cs2FileSectionLocomotivesSession:
+						parsed = ParseCs2FileLocomotivesSession(line);
+						break;
+
+					case Cs2FileSectionLocomotive:
+						parsed = ParseCs2FileLocomotive(line);
+						break;
+
+					case Cs2FileSectionLocomotiveFunction:
+						parsed = ParseCs2FileLocomotiveFunction(line);
+						break;
+
+					case Cs2FileSectionEnd:
+					default:
+						return;
 				}
-				else if (key.compare("dauer") == 0 || key.compare("dauer2") == 0)
+				if (parsed)
 				{
-					type = DataModel::LocoFunctionTypeTimer;
-					timer = Utils::Utils::StringToInteger(value);
+					return;
 				}
-				lines.pop_front();
 			}
-			if (type == DataModel::LocoFunctionTypeNone)
+		}
+
+		bool MaerklinCAN::ParseCs2FileLocomotiveFunction(const string& line)
+		{
+			string key;
+			string value;
+			bool ok = ParseCs2FileSubkeyValue(line, key, value);
+			if (ok == false)
+			{
+				SaveCs2FileLocomotiveFunction();
+				cs2FileSection = Cs2FileSectionLocomotive;
+				return false;
+			}
+			if (key.compare("nr") == 0)
+			{
+				cs2FileFunctionNr = Utils::Utils::StringToInteger(value);
+			}
+			else if (key.compare("typ") == 0 || key.compare("typ2") == 0)
+			{
+				uint8_t valueInt = Utils::Utils::StringToInteger(value);
+				cs2FileFunctionIcon = MapLocoFunctionCs2ToRailControl(static_cast<LocoFunctionCs2Icon>(valueInt & 0x7F));
+				cs2FileFunctionType = static_cast<DataModel::LocoFunctionType>((valueInt >> 7) + 1); // CS2: 1 = permanent, 2 = once
+			}
+			else if (key.compare("dauer") == 0 || key.compare("dauer2") == 0)
+			{
+				cs2FileFunctionType = DataModel::LocoFunctionTypeTimer;
+				cs2FileFunctionTimer = Utils::Utils::StringToInteger(value);
+			}
+			return true;
+		}
+
+		void MaerklinCAN::SaveCs2FileLocomotiveFunction()
+		{
+			if (cs2FileFunctionType == DataModel::LocoFunctionTypeNone)
 			{
-				icon = DataModel::LocoFunctionIconNone;
-				timer = 0;
-				cacheEntry.ClearFunction(nr);
+				cs2FileLoco.ClearFunction(cs2FileFunctionNr);
 				return;
 			}
-			cacheEntry.SetFunction(nr, type, icon, timer);
-			if (type == DataModel::LocoFunctionTypeTimer)
+			cs2FileLoco.SetFunction(cs2FileFunctionNr, cs2FileFunctionType, cs2FileFunctionIcon, cs2FileFunctionTimer);
+			if (cs2FileFunctionType == DataModel::LocoFunctionTypeTimer)
 			{
-				logger->Info(Languages::TextCs2MasterLocoFunctionIconTypeTimer, nr, icon, timer);
+				logger->Info(Languages::TextCs2MasterLocoFunctionIconTypeTimer, cs2FileFunctionNr, cs2FileFunctionIcon, cs2FileFunctionTimer);
 			}
 			else
 			{
-				logger->Info(Languages::TextCs2MasterLocoFunctionIconType, nr, icon, type);
+				logger->Info(Languages::TextCs2MasterLocoFunctionIconType, cs2FileFunctionNr, cs2FileFunctionIcon, cs2FileFunctionType);
 			}
 		}
 
-		void MaerklinCAN::ParseCs2FileLocomotive(deque<string>& lines)
+		bool MaerklinCAN::ParseCs2FileLocomotive(const string& line)
 		{
-			lines.pop_front();
-			LocoCacheEntry cacheEntry(locoCache.GetControlId());
-			std::string name;
-			std::string oldName;
-			bool remove = false;
-			while (lines.size())
+			if (line.length() == 0 || line[0] != ' ')
 			{
-				string& line = lines.front();
-				if (line.length() == 0 || line[0] != ' ')
-				{
-					break;
-				}
-				string key;
-				string value;
-				ParseCs2FileKeyValue(line, key, value);
-				if (key.compare("name") == 0)
-				{
-					name = value;
-					cacheEntry.SetName(value);
-					cacheEntry.SetMatchKey(value);
-					logger->Info(Languages::TextCs2MasterLocoName, value);
-				}
-				else if (key.compare("vorname") == 0)
-				{
-					oldName = value;
-					logger->Info(Languages::TextCs2MasterLocoOldName, value);
-				}
-				else if (key.compare("toRemove") == 0)
-				{
-					remove = true;
-				}
-				else if (key.compare("uid") == 0)
-				{
-					Address input = Utils::Utils::HexToInteger(value);
-					Address address = AddressNone;
-					Protocol protocol = ProtocolNone;
-					ParseAddressProtocol(input, address, protocol);
-					cacheEntry.SetAddress(address);
-					cacheEntry.SetProtocol(protocol);
-					logger->Info(Languages::TextCs2MasterLocoAddressProtocol, address, protocol);
-				}
-				else if (key.compare("funktionen") == 0
-					|| key.compare("funktionen_2") == 0
-					|| key.compare("fkt") == 0
-					|| key.compare("fkt2") == 0)
-				{
-					ParseCs2FileLocomotiveFunction(lines, cacheEntry);
-					continue;
-				}
-				lines.pop_front();
+				SaveCs2FileLocomotive();
+				cs2FileSection = Cs2FileSectionLocomotives;
+				return false;
+			}
+			string key;
+			string value;
+			ParseCs2FileKeyValue(line, key, value);
+			if (key.compare("name") == 0)
+			{
+				cs2FileLoco.SetName(value);
+				cs2FileLoco.SetMatchKey(value);
+				logger->Info(Languages::TextCs2MasterLocoName, value);
+			}
+			else if (key.compare("vorname") == 0)
+			{
+				cs2FileLocoOldName = value;
+				logger->Info(Languages::TextCs2MasterLocoOldName, value);
+			}
+			else if (key.compare("toRemove") == 0)
+			{
+				cs2FileLocoRemove = true;
+			}
+			else if (key.compare("uid") == 0)
+			{
+				Address input = Utils::Utils::HexToInteger(value);
+				Address address = AddressNone;
+				Protocol protocol = ProtocolNone;
+				ParseAddressProtocol(input, address, protocol);
+				cs2FileLoco.SetAddress(address);
+				cs2FileLoco.SetProtocol(protocol);
+				logger->Info(Languages::TextCs2MasterLocoAddressProtocol, address, protocol);
+			}
+			else if (key.compare("funktionen") == 0
+				|| key.compare("funktionen_2") == 0
+				|| key.compare("fkt") == 0
+				|| key.compare("fkt2") == 0)
+			{
+				cs2FileFunctionNr = 0;
+				cs2FileFunctionType = DataModel::LocoFunctionTypeNone;
+				cs2FileFunctionIcon = DataModel::LocoFunctionIconNone;
+				cs2FileFunctionTimer = 0;
+				cs2FileSection = Cs2FileSectionLocomotiveFunction;
 			}
-			if (remove)
+			return true;
+		}
+
+		void MaerklinCAN::SaveCs2FileLocomotive()
+		{
+			const string& name = cs2FileLoco.GetName();
+			if (cs2FileLocoRemove)
 			{
 				logger->Info(Languages::TextCs2MasterLocoRemove, name);
 				LocoID locoId = locoCache.Delete(name);
 				manager->LocoDelete(locoId);
 			}
-			else if (oldName.size() > 0)
+			else if (cs2FileLocoOldName.size() > 0)
 			{
-				locoCache.Save(cacheEntry, oldName);
+				locoCache.Save(cs2FileLoco, cs2FileLocoOldName);
 			}
 			else
 			{
-				locoCache.Save(cacheEntry);
+				locoCache.Save(cs2FileLoco);
 			}
 		}
 
-		void MaerklinCAN::ParseCs2FileLocomotivesSession(deque<string>& lines)
+		bool MaerklinCAN::ParseCs2FileLocomotivesSession(const string& line)
 		{
-			lines.pop_front();
-			while (lines.size())
+			string key;
+			string value;
+			bool ok = ParseCs2FileKeyValue(line, key, value);
+			if (ok == false)
 			{
-				string& line = lines.front();
-				string key;
-				string value;
-				bool ok = ParseCs2FileKeyValue(line, key, value);
-				if (ok == false)
-				{
-					return;
-				}
-				// we do not parse any data in session
-				lines.pop_front();
+				cs2FileSection = Cs2FileSectionLocomotives;
+				return false;
 			}
+			// we do not parse any data in session
+			return true;
 		}
 
-		void MaerklinCAN::ParseCs2FileLocomotivesVersion(deque<string>& lines)
+		bool MaerklinCAN::ParseCs2FileLocomotivesVersion(const string& line)
 		{
-			lines.pop_front();
-			while (lines.size())
+			string key;
+			string value;
+			bool ok = ParseCs2FileKeyValue(line, key, value);
+			if (ok == false)
 			{
-				string& line = lines.front();
-				string key;
-				string value;
-				bool ok = ParseCs2FileKeyValue(line, key, value);
-				if (ok == false)
-				{
-					return;
-				}
-				if (key.compare("minor") == 0 && value.compare("3") != 0 && value.compare("4"))
-				{
-					logger->Warning(Languages::TextCs2MinorVersionIsUnknown);
-				}
-				lines.pop_front();
+				cs2FileSection = Cs2FileSectionLocomotives;
+				return false;
+			}
+			if (key.compare("minor") == 0 && value.compare("3") != 0 && value.compare("4"))
+			{
+				logger->Warning(Languages::TextCs2MinorVersionIsUnknown);
 			}
+			return true;
 		}
 
-		void MaerklinCAN::ParseCs2FileLocomotives(deque<string>& lines)
+		bool MaerklinCAN::ParseCs2FileLocomotives(const string& line)
 		{
-			lines.pop_front();
-			while (lines.size())
+			if (line.compare("version") == 0)
 			{
-				string& line = lines.front();
-				if (line.length() == 0)
-				{
-					return;
-				}
-				if (line.compare("version") == 0)
-				{
-					ParseCs2FileLocomotivesVersion(lines);
-					continue;
-				}
-				else if (line.compare("session") == 0)
-				{
-					ParseCs2FileLocomotivesSession(lines);
-					continue;
-				}
-				else if (line.compare("lokomotive") == 0)
-				{
-					ParseCs2FileLocomotive(lines);
-					continue;
-				}
-				return;
+				cs2FileSection = Cs2FileSectionLocomotivesVersion;
+				return true;
+			}
+			if (line.compare("session") == 0)
+			{
+				cs2FileSection = Cs2FileSectionLocomotivesSession;
+				return true;
+			}
+			if (line.compare("lokomotive") == 0)
+			{
+				cs2FileLoco.Clear();
+				cs2FileLocoOldName.clear();
+				cs2FileLocoRemove = false;
+				cs2FileSection = Cs2FileSectionLocomotive;
+				return true;
 			}
+			cs2FileSection = line.length() == 0 ? Cs2FileSectionEnd : Cs2FileSectionNone;
+			return false;
 		}
 
-		void MaerklinCAN::ParseCs2File(deque<string>& lines)
+		bool MaerklinCAN::ParseCs2File(const string& line)
 		{
-			while (lines.size())
+			if (line.compare("[lokomotive]") == 0)
 			{
-				string& line = lines.front();
-				if (line.length() == 0 || line[0] != '[')
-				{
-					return;
-				}
-				if (line.compare("[lokomotive]") == 0)
-				{
-					ParseCs2FileLocomotives(lines);
-					continue;
-				}
-				return;
+				cs2FileSection = Cs2FileSectionLocomotives;
+				return true;
 			}
+			cs2FileSection = Cs2FileSectionEnd;
+			return true;
 		}
 
 		const DataModel::LocoFunctionIcon MaerklinCAN::LocoFunctionMapCs2ToRailControl[MaxNrOfCs2FunctionIcons] =
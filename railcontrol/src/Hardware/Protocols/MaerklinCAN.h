@@ -26,7 +26,9 @@ along with RailControl; see the file LICENCE. If not see
 #include "Hardware/HardwareInterface.h"
 #include "Hardware/HardwareParams.h"
 #include "Hardware/LocoCache.h"
+#include "Hardware/ZLib.h"
 #include "Logger/Logger.h"
+#include "Utils/ThreadSafeQueue.h"
 #include "Utils/Utils.h"
 
 // CAN protocol specification at http://streaming.maerklin.de/public-media/cs2/cs2CAN-Protokoll-2_0.pdf
@@ -125,8 +127,16 @@ namespace Hardware
 					uid(Utils::Utils::HexToInteger(params->GetArg5(), 0)),
 					hasCs2Master(false),
 					canFileDataSize(0),
-					canFileData(nullptr),
-					canFileDataPointer(nullptr),
+					canFileDataReceived(0),
+					canFileCrc(0),
+					canFileUncompressedSize(0),
+					cs2FileSection(Cs2FileSectionEnd),
+					cs2FileLoco(params->GetControlID()),
+					cs2FileLocoRemove(false),
+					cs2FileFunctionNr(0),
+					cs2FileFunctionType(DataModel::LocoFunctionTypeNone),
+					cs2FileFunctionIcon(DataModel::LocoFunctionIconNone),
+					cs2FileFunctionTimer(0),
 					locoCache(params->GetControlID(), params->GetManager())
 				{
 					if (uid == 0)
@@ -200,6 +210,22 @@ namespace Hardware
 					CanDeviceCs2Master = 0xffff
 				};
 
+				enum Cs2FileSection : uint8_t
+				{
+					Cs2FileSectionNone,
+					Cs2FileSectionLocomotives,
+					Cs2FileSectionLocomotivesVersion,
+					Cs2FileSectionLocomotivesSession,
+					Cs2FileSectionLocomotive,
+					Cs2FileSectionLocomotiveFunction,
+					Cs2FileSectionEnd
+				};
+
+				struct ConfigDataQueueEntry
+				{
+					unsigned char buffer[CANCommandBufferLength];
+				};
+
 //				enum CanFileType : uint8_t
 //				{
 //					CanFileTypeNone,
@@ -382,12 +408,19 @@ namespace Hardware
 
 				bool ParseCs2FileKeyValue(const std::string& line, std::string& key, std::string& value);
 				bool ParseCs2FileSubkeyValue(const std::string& line, std::string& key, std::string& value);
-				void ParseCs2FileLocomotiveFunction(std::deque<std::string>& lines, LocoCacheEntry& cacheEntry);
-				void ParseCs2FileLocomotive(std::deque<std::string>& lines);
-				void ParseCs2FileLocomotivesSession(std::deque<std::string>& lines);
-				void ParseCs2FileLocomotivesVersion(std::deque<std::string>& lines);
-				void ParseCs2FileLocomotives(std::deque<std::string>& lines);
-				void ParseCs2File(std::deque<std::string>& lines);
+
+				// The parse functions return false if the line does not belong to their section.
+				// In that case they have switched cs2FileSection and the line has to be parsed again.
+				void ParseCs2FileLines();
+				void ParseCs2FileLine(const std::string& line);
+				bool ParseCs2FileLocomotiveFunction(const std::string& line);
+				bool ParseCs2FileLocomotive(const std::string& line);
+				bool ParseCs2FileLocomotivesSession(const std::string& line);
+				bool ParseCs2FileLocomotivesVersion(const std::string& line);
+				bool ParseCs2FileLocomotives(const std::string& line);
+				bool ParseCs2File(const std::string& line);
+				void SaveCs2FileLocomotiveFunction();
+				void SaveCs2FileLocomotive();
 
 				static inline DataModel::LocoFunctionIcon MapLocoFunctionCs2ToRailControl(
 				    const LocoFunctionCs2Icon input)
@@ -414,6 +447,7 @@ namespace Hardware
 
 				void Wait(const unsigned int duration) const;
 				void Cs2MasterThread();
+				void ConfigDataParser();
 
 				inline void SendInternal(const unsigned char* buffer)
 				{
@@ -427,11 +461,27 @@ namespace Hardware
 				bool hasCs2Master;
 				std::thread receiverThread;
 				std::thread cs2MasterThread;
+				std::thread configDataParserThread;
+
+				// config data is uncompressed and parsed in configDataParserThread,
+				// so the receiver thread is not blocked by large files
+				Utils::ThreadSafeQueue<ConfigDataQueueEntry> configDataQueue;
 
 				size_t canFileDataSize;
+				size_t canFileDataReceived;
 				CanFileCrc canFileCrc;
-				unsigned char* canFileData;
-				unsigned char* canFileDataPointer;
+				size_t canFileUncompressedSize;
+				ZLib::UnCompressor canFileUnCompressor;
+				std::string canFileLines;
+
+				Cs2FileSection cs2FileSection;
+				LocoCacheEntry cs2FileLoco;
+				std::string cs2FileLocoOldName;
+				bool cs2FileLocoRemove;
+				DataModel::LocoFunctionNr cs2FileFunctionNr;
+				DataModel::LocoFunctionType cs2FileFunctionType;
+				DataModel::LocoFunctionIcon cs2FileFunctionIcon;
+				DataModel::LocoFunctionTimer cs2FileFunctionTimer;
 
 				LocoCache locoCache;
 
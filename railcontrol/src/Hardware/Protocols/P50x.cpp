@@ -51,6 +51,7 @@ namespace Hardware
 			}
 			run = false;
 			checkEventsThread.join();
+			logger->Debug(Languages::TextCacheStatistics, "Loco", cache.GetHits(), cache.GetMisses());
 		}
 
 		void P50x::Init()
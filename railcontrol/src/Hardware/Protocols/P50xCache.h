@@ -20,6 +20,10 @@ along with RailControl; see the file LICENCE. If not see
 
 #pragma once
 
+#include "DataTypes.h"
+#include "DataModel/LocoFunctions.h"
+#include "Hardware/AddressCache.h"
+
 namespace Hardware
 {
 	namespace Protocols
@@ -43,44 +47,35 @@ namespace Hardware
 				};
 		};
 
-		class P50xCache
+		class P50xCache : public AddressCache<P50xCacheEntry>
 		{
 			public:
-				P50xCache(const P50xCache&) = delete;
-				P50xCache& operator=(const P50xCache&) = delete;
-
-				inline P50xCache()
-				{
-				}
-
 				void SetSpeed(const Address address, const Speed speed)
 				{
-					P50xCacheEntry entry = GetData(address);
-
+					unsigned char speedInternal;
 					if (speed == 0)
 					{
-						entry.speed = 0;
+						speedInternal = 0;
 					}
 					else if (speed > 1000)
 					{
-						entry.speed = 127;
+						speedInternal = 127;
 					}
 					else
 					{
-						entry.speed = (speed >> 3) + 2;
+						speedInternal = (speed >> 3) + 2;
 					}
 
-					cache[address] = entry;
+					Update(address, [speedInternal] (P50xCacheEntry& entry) { entry.speed = speedInternal; });
 				}
 
 				void SetOrientation(const Address address, const Orientation orientation)
 				{
-					P50xCacheEntry entry = GetData(address);
-
-					entry.orientationF0 &= ~(1 << 5);
-					entry.orientationF0 |= static_cast<unsigned char>(orientation) << 5;
-
-					cache[address] = entry;
+					Update(address, [orientation] (P50xCacheEntry& entry)
+						{
+							entry.orientationF0 &= ~(1 << 5);
+							entry.orientationF0 |= static_cast<unsigned char>(orientation) << 5;
+						});
 				}
 
 				void SetFunction(const Address address,
@@ -88,30 +83,26 @@ namespace Hardware
 				    const DataModel::LocoFunctionState on)
 				{
 					bool onInternal = static_cast<bool>(on);
-					P50xCacheEntry entry = GetData(address);
-
-					if (function == 0)
-					{
-						entry.orientationF0 &= ~(1 << 4);
-						entry.orientationF0 |= static_cast<unsigned char>(onInternal) << 4;
-					}
-					else
-					{
-						unsigned char shift = function - 1;
-						entry.functions &= ~(1 << shift);
-						entry.functions |= static_cast<uint32_t>(onInternal) << shift;
-					}
-
-					cache[address] = entry;
+					Update(address, [function, onInternal] (P50xCacheEntry& entry)
+						{
+							if (function == 0)
+							{
+								entry.orientationF0 &= ~(1 << 4);
+								entry.orientationF0 |= static_cast<unsigned char>(onInternal) << 4;
+							}
+							else
+							{
+								unsigned char shift = function - 1;
+								entry.functions &= ~(1 << shift);
+								entry.functions |= static_cast<uint32_t>(onInternal) << shift;
+							}
+						});
 				}
 
 				inline P50xCacheEntry GetData(const Address address) const
 				{
-					return cache.count(address) == 0 ? P50xCacheEntry() : cache.at(address);
+					return Get(address);
 				}
-
-			private:
-				std::map<Address, P50xCacheEntry> cache;
 		};
 	} // namespace
 } // namespace
@@ -41,7 +41,9 @@ namespace Hardware
 			run(true),
 			connection(logger, params->GetArg1(), Z21Port),
 			lastProgramMode(ProgramModeMm),
-			connected(false)
+			connected(false),
+			resyncNeeded(false),
+			resyncStart(false)
 		{
 			logger->Info(Languages::TextStarting, GetFullName());
 
@@ -56,6 +58,7 @@ namespace Hardware
 			receiverThread = std::thread(&Hardware::Protocols::Z21::Receiver, this);
 			heartBeatThread = std::thread(&Hardware::Protocols::Z21::HeartBeatSender, this);
 			accessorySenderThread = std::thread(&Hardware::Protocols::Z21::AccessorySender, this);
+			resyncThread = std::thread(&Hardware::Protocols::Z21::ResyncSender, this);
 		}
 
 		Z21::~Z21()
@@ -63,11 +66,18 @@ namespace Hardware
 			run = false;
 			SendLogOff();
 			accessoryQueue.Terminate();
+			{
+				std::lock_guard<std::mutex> guard(resyncMutex);
+			}
+			resyncSignal.notify_all();
+			resyncThread.join();
 			connection.Terminate();
 			accessorySenderThread.join();
 			heartBeatThread.join();
 			receiverThread.join();
 			logger->Info(Languages::TextTerminatingSenderSocket);
+			logger->Debug(Languages::TextCacheStatistics, "Loco", locoCache.GetHits(), locoCache.GetMisses());
+			logger->Debug(Languages::TextCacheStatistics, "Turnout", turnoutCache.GetHits(), turnoutCache.GetMisses());
 		}
 
 		void Z21::Booster(const BoosterState status)
@@ -431,6 +441,118 @@ namespace Hardware
 			        | BroadCastFlagAllLoco
 			        | BroadCastFlagCanDetector));
 			SendGetDetectorState();
+			// loco and turnout changes are broadcasted to us, but changes done while
+			// we were not connected have to be requested once the connection is up again
+			resyncNeeded = true;
+		}
+
+		void Z21::Resync()
+		{
+			const std::vector<Address> locoAddresses = locoCache.GetAddresses();
+			const std::vector<Address> turnoutAddresses = turnoutCache.GetAddresses();
+			if (locoAddresses.size() == 0 && turnoutAddresses.size() == 0)
+			{
+				return;
+			}
+
+			logger->Info(Languages::TextResynchronizing, locoAddresses.size(), turnoutAddresses.size());
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			{
+				std::lock_guard<std::mutex> guard(resyncMutex);
+				resyncLocos.clear();
+				resyncTurnouts.clear();
+			}
+			for (const Address address : locoAddresses)
+			{
+				if (WaitForResyncWindow(ResyncWindow - 1) == false)
+				{
+					return;
+				}
+				{
+					std::lock_guard<std::mutex> guard(resyncMutex);
+					resyncLocos[address] = std::chrono::steady_clock::now();
+				}
+				SendGetLocoInfo(address);
+			}
+			for (const Address address : turnoutAddresses)
+			{
+				if (WaitForResyncWindow(ResyncWindow - 1) == false)
+				{
+					return;
+				}
+				{
+					std::lock_guard<std::mutex> guard(resyncMutex);
+					resyncTurnouts[address] = std::chrono::steady_clock::now();
+				}
+				SendGetTurnoutInfo(address);
+			}
+			if (WaitForResyncWindow(0) == false)
+			{
+				return;
+			}
+			const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			logger->Info(Languages::TextResynchronizationFinished,
+				std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+		}
+
+		bool Z21::WaitForResyncWindow(const size_t maxInFlight)
+		{
+			std::unique_lock<std::mutex> lock(resyncMutex);
+			while (run && resyncLocos.size() + resyncTurnouts.size() > maxInFlight)
+			{
+				// the oldest request or its answer may have got lost
+				std::map<Address,std::chrono::steady_clock::time_point>* oldestRequests = &resyncLocos;
+				std::map<Address,std::chrono::steady_clock::time_point>::iterator oldest = resyncLocos.end();
+				for (auto requests : { &resyncLocos, &resyncTurnouts })
+				{
+					for (auto request = requests->begin(); request != requests->end(); ++request)
+					{
+						if (oldest == oldestRequests->end() || request->second < oldest->second)
+						{
+							oldestRequests = requests;
+							oldest = request;
+						}
+					}
+				}
+				const std::chrono::steady_clock::time_point timeout = oldest->second + std::chrono::milliseconds(ResyncTimeoutMs);
+				if (std::chrono::steady_clock::now() >= timeout)
+				{
+					oldestRequests->erase(oldest);
+					continue;
+				}
+				resyncSignal.wait_until(lock, timeout);
+			}
+			return run;
+		}
+
+		void Z21::ResyncAnswerReceived(std::map<Address,std::chrono::steady_clock::time_point>& requests, const Address address)
+		{
+			// broadcasts of other throttles do not open the window, only answers to our requests
+			std::lock_guard<std::mutex> guard(resyncMutex);
+			if (requests.erase(address) == 0)
+			{
+				return;
+			}
+			resyncSignal.notify_all();
+		}
+
+		void Z21::ResyncSender()
+		{
+			Utils::Utils::SetMinThreadPriority();
+			Utils::Utils::SetThreadName("Z21 Resync Sender");
+			while (run)
+			{
+				{
+					std::unique_lock<std::mutex> lock(resyncMutex);
+					resyncSignal.wait(lock, [this] { return run == false || resyncStart; });
+					if (run == false)
+					{
+						return;
+					}
+					resyncStart = false;
+				}
+				Resync();
+			}
 		}
 
 		void Z21::HeartBeatSender()
@@ -451,6 +573,16 @@ namespace Hardware
 				}
 				if (connected)
 				{
+					if (resyncNeeded)
+					{
+						// the resync waits for answers, it must not delay the heartbeat
+						resyncNeeded = false;
+						{
+							std::lock_guard<std::mutex> guard(resyncMutex);
+							resyncStart = true;
+						}
+						resyncSignal.notify_all();
+					}
 					connected = false;
 				}
 				else
@@ -735,6 +867,9 @@ namespace Hardware
 
 		void Z21::ParseTurnoutData(const unsigned char* buffer)
 		{
+			const Address zeroBasedAddress = Utils::Utils::DataBigEndianToShort(buffer + 5);
+			const Address address = zeroBasedAddress + 1;
+			ResyncAnswerReceived(resyncTurnouts, address);
 			DataModel::AccessoryState state;
 			switch (buffer[7])
 			{
@@ -749,8 +884,6 @@ namespace Hardware
 				default:
 					return;
 			}
-			const Address zeroBasedAddress = Utils::Utils::DataBigEndianToShort(buffer + 5);
-			const Address address = zeroBasedAddress + 1;
 			const Protocol protocol = turnoutCache.GetProtocol(address);
 			manager->AccessoryState(ControlTypeHardware, controlID, protocol, address, state);
 		}
@@ -758,6 +891,7 @@ namespace Hardware
 		void Z21::ParseLocoData(const unsigned char* buffer)
 		{
 			const Address address = Utils::Utils::DataBigEndianToShort(buffer + 5) & 0x3FFF;
+			ResyncAnswerReceived(resyncLocos, address);
 			const unsigned char protocolType = buffer[7] & 0x07;
 			Protocol protocol;
 			const unsigned char speedData = buffer[8] & 0x7F;
@@ -984,6 +1118,23 @@ namespace Hardware
 			Send(buffer, sizeof(buffer));
 		}
 
+		void Z21::SendGetLocoInfo(const Address address)
+		{
+			unsigned char buffer[9] = { 0x09, 0x00, 0x40, 0x00, 0xE3, 0xF0 };
+			Utils::Utils::ShortToDataBigEndian(address >= 128 ? address | 0xC000 : address, buffer + 6);
+			buffer[8] = buffer[4] ^ buffer[5] ^ buffer[6] ^ buffer[7];
+			Send(buffer, sizeof(buffer));
+		}
+
+		void Z21::SendGetTurnoutInfo(const Address address)
+		{
+			const Address zeroBasedAddress = address - 1;
+			unsigned char buffer[8] = { 0x08, 0x00, 0x40, 0x00, 0x43 };
+			Utils::Utils::ShortToDataBigEndian(zeroBasedAddress, buffer + 5);
+			buffer[7] = buffer[4] ^ buffer[5] ^ buffer[6];
+			Send(buffer, sizeof(buffer));
+		}
+
 		void Z21::SendLogOff()
 		{
 			char buffer[4] = { 0x04, 0x00, 0x30, 0x00 };
@@ -21,7 +21,11 @@ along with RailControl; see the file LICENCE. If not see
 #pragma once
 
 #include <arpa/inet.h>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <map>
+#include <mutex>
 #include <string>
 #include <thread>
 
@@ -131,6 +135,8 @@ namespace Hardware
 				static const unsigned short Z21Port = 21105;
 				static const unsigned int Z21CommandBufferLength = 1472; // = Max Ethernet MTU
 				static const Address MaxMMAddress = 255;
+				static const unsigned int ResyncWindow = 8; // max requests in flight during resync
+				static const unsigned int ResyncTimeoutMs = 200; // a request without answer is considered lost
 
 				class AccessoryQueueEntry
 				{
@@ -256,11 +262,20 @@ namespace Hardware
 				std::thread receiverThread;
 				std::thread heartBeatThread;
 				std::thread accessorySenderThread;
+				std::thread resyncThread;
 				Z21LocoCache locoCache;
 				Z21TurnoutCache turnoutCache;
 				Z21FeedbackCache feedbackCache;
 				ProgramMode lastProgramMode;
 				volatile bool connected;
+				volatile bool resyncNeeded;
+
+				// resync requests that have not been answered yet, with the time they were sent
+				std::mutex resyncMutex;
+				std::condition_variable resyncSignal;
+				bool resyncStart;
+				std::map<Address,std::chrono::steady_clock::time_point> resyncLocos;
+				std::map<Address,std::chrono::steady_clock::time_point> resyncTurnouts;
 
 				Utils::ThreadSafeQueue<AccessoryQueueEntry> accessoryQueue;
 
@@ -285,11 +300,17 @@ namespace Hardware
 				void ParseDetectorData(const unsigned char* buffer);
 
 				void StartUpConnection();
+				void ResyncSender();
+				void Resync();
+				bool WaitForResyncWindow(const size_t maxInFlight);
+				void ResyncAnswerReceived(std::map<Address,std::chrono::steady_clock::time_point>& requests, const Address address);
 				void SendGetSerialNumber();
 				void SendGetHardwareInfo();
 				void SendGetStatus();
 				void SendGetCode();
 				void SendGetDetectorState();
+				void SendGetLocoInfo(const Address address);
+				void SendGetTurnoutInfo(const Address address);
 				void SendLogOff();
 				void SendBroadcastFlags();
 				void SendBroadcastFlags(const BroadCastFlag flags);
@@ -20,9 +20,9 @@ along with RailControl; see the file LICENCE. If not see
 
 #pragma once
 
-#include <map>
-
 #include "DataTypes.h"
+#include "DataModel/LocoFunctions.h"
+#include "Hardware/AddressCache.h"
 
 namespace Hardware
 {
@@ -53,98 +53,66 @@ namespace Hardware
 				Protocol protocol;
 		};
 
-		class Z21LocoCache
+		class Z21LocoCache : public AddressCache<Z21LocoCacheEntry>
 		{
 			public:
-				Z21LocoCache& operator=(const Z21LocoCache&) = delete;
-
-				Z21LocoCacheEntry GetData(const Address address)
+				inline Z21LocoCacheEntry GetData(const Address address) const
 				{
-					if (cache.count(address) == 1)
-					{
-						return cache[address];
-					}
-					Z21LocoCacheEntry entry;
-					return entry;
+					return Get(address);
 				}
 
-				void SetSpeed(const Address address, const Speed speed)
+				inline void SetSpeed(const Address address, const Speed speed)
 				{
-					Z21LocoCacheEntry entry = GetData(address);
-					entry.speed = speed;
-					cache[address] = entry;
+					Update(address, [speed] (Z21LocoCacheEntry& entry) { entry.speed = speed; });
 				}
 
-				Speed GetSpeed(const Address address)
+				inline Speed GetSpeed(const Address address) const
 				{
-					if (cache.count(address) == 0)
-					{
-						return MinSpeed;
-					}
-					return cache[address].speed;
+					return Get(address).speed;
 				}
 
-				void SetOrientation(const Address address, const Orientation orientation)
+				inline void SetOrientation(const Address address, const Orientation orientation)
 				{
-					Z21LocoCacheEntry entry = GetData(address);
-					entry.orientation = orientation;
-					cache[address] = entry;
+					Update(address, [orientation] (Z21LocoCacheEntry& entry) { entry.orientation = orientation; });
 				}
 
-				Orientation GetOrientation(const Address address)
+				inline Orientation GetOrientation(const Address address) const
 				{
-					if (cache.count(address) == 0)
-					{
-						return OrientationRight;
-					}
-					return cache[address].orientation;
+					return Get(address).orientation;
 				}
 
-				void SetSpeedOrientationProtocol(const Address address, const Speed speed,
+				inline void SetSpeedOrientationProtocol(const Address address, const Speed speed,
 				    const Orientation orientation, const Protocol protocol)
 				{
-					Z21LocoCacheEntry entry(speed, orientation, protocol);
-					cache[address] = entry;
+					Set(address, Z21LocoCacheEntry(speed, orientation, protocol));
 				}
 
-				void SetFunction(const Address address,
+				inline void SetFunction(const Address address,
 				    const DataModel::LocoFunctionNr function,
 				    const bool on)
 				{
-					Z21LocoCacheEntry entry = GetData(address);
-					uint32_t mask = ~(1 << function);
-					entry.functions &= mask;
-					entry.functions |= on << function;
-					cache[address] = entry;
+					Update(address, [function, on] (Z21LocoCacheEntry& entry)
+						{
+							uint32_t mask = ~(1 << function);
+							entry.functions &= mask;
+							entry.functions |= on << function;
+						});
 				}
 
-				uint32_t GetFunctions(const Address address)
+				inline uint32_t GetFunctions(const Address address) const
 				{
-					if (cache.count(address) == 0)
-					{
-						return 0;
-					}
-					return cache[address].functions;
+					return Get(address).functions;
 				}
 
-				void SetProtocol(const Address address, const Protocol protocol)
+				inline void SetProtocol(const Address address, const Protocol protocol)
 				{
-					Z21LocoCacheEntry entry = GetData(address);
-					entry.protocol = protocol;
-					cache[address] = entry;
+					Update(address, [protocol] (Z21LocoCacheEntry& entry) { entry.protocol = protocol; });
 				}
 
-				Protocol GetProtocol(const Address address)
+				inline Protocol GetProtocol(const Address address) const
 				{
-					if (cache.count(address) == 0)
-					{
-						return ProtocolNone;
-					}
-					return cache[address].protocol;
+					return Get(address).protocol;
 				}
-
-			private:
-				std::map<Address, Z21LocoCacheEntry> cache;
 		};
 	} // namespace
 } // namespace
@@ -20,9 +20,8 @@ along with RailControl; see the file LICENCE. If not see
 
 #pragma once
 
-#include <map>
-
 #include "DataTypes.h"
+#include "Hardware/AddressCache.h"
 
 namespace Hardware
 {
@@ -31,8 +30,6 @@ namespace Hardware
 		class Z21TurnoutCacheEntry
 		{
 			public:
-				Z21TurnoutCacheEntry(const Z21TurnoutCacheEntry&) = delete;
-
 				Z21TurnoutCacheEntry()
 					: protocol(ProtocolNone)
 				{
@@ -46,28 +43,18 @@ namespace Hardware
 				Protocol protocol;
 		};
 
-		class Z21TurnoutCache
+		class Z21TurnoutCache : public AddressCache<Z21TurnoutCacheEntry>
 		{
 			public:
-				Z21TurnoutCache& operator=(const Z21TurnoutCache&) = delete;
-
-				void SetProtocol(const Address address, const Protocol protocol)
+				inline void SetProtocol(const Address address, const Protocol protocol)
 				{
-					Z21TurnoutCacheEntry entry(protocol);
-					cache[address] = entry;
+					Set(address, Z21TurnoutCacheEntry(protocol));
 				}
 
-				Protocol GetProtocol(const Address address)
+				inline Protocol GetProtocol(const Address address) const
 				{
-					if (cache.count(address) == 0)
-					{
-						return ProtocolDCC;
-					}
-					return cache[address].protocol;
+					return Get(address, Z21TurnoutCacheEntry(ProtocolDCC)).protocol;
 				}
-
-			private:
-				std::map<Address, Z21TurnoutCacheEntry> cache;
 		};
 	} // namespace
 } // namespace
@@ -32,20 +32,50 @@ namespace Hardware
 	:	HardwareInterface(params->GetManager(),
 			params->GetControlID(),
 			"Virtual Command Station / " + params->GetName(),
-			params->GetName())
+			params->GetName()),
+		simulator(nullptr)
 	{
+		const int timeFactor = Utils::Utils::StringToInteger(params->GetArg1(), 0);
+		if (timeFactor <= 0)
+		{
+			return;
+		}
+		int feedbackDistance = Utils::Utils::StringToInteger(params->GetArg2(), LayoutSimulator::DefaultFeedbackDistance);
+		if (feedbackDistance <= 0)
+		{
+			feedbackDistance = LayoutSimulator::DefaultFeedbackDistance;
+		}
+		int maxVelocity = Utils::Utils::StringToInteger(params->GetArg3(), LayoutSimulator::DefaultMaxVelocity);
+		if (maxVelocity <= 0)
+		{
+			maxVelocity = LayoutSimulator::DefaultMaxVelocity;
+		}
+		simulator = new LayoutSimulator(manager, logger, params->GetControlID(), timeFactor, feedbackDistance, maxVelocity);
+	}
+
+	Virtual::~Virtual()
+	{
+		delete simulator;
 	}
 
 	// turn booster on or off
 	void Virtual::Booster(const BoosterState status)
 	{
 		logger->Info(status ? Languages::TextTurningBoosterOn : Languages::TextTurningBoosterOff);
+		if (simulator != nullptr)
+		{
+			simulator->Booster(status);
+		}
 	}
 
 	// set loco speed
 	void Virtual::LocoSpeed(const Protocol protocol, const Address address, const Speed speed)
 	{
 		logger->Info(Languages::TextSettingSpeedWithProtocol, protocol, address, speed);
+		if (simulator != nullptr)
+		{
+			simulator->LocoSpeed(protocol, address, speed);
+		}
 	}
 
 	// set the direction of a loco
@@ -21,9 +21,11 @@ along with RailControl; see the file LICENCE. If not see
 #pragma once
 
 #include <cstring>
+#include <map>
 
 #include "Hardware/HardwareInterface.h"
 #include "Hardware/HardwareParams.h"
+#include "Hardware/LayoutSimulator.h"
 #include "Logger/Logger.h"
 
 namespace Hardware
@@ -38,6 +40,8 @@ namespace Hardware
 
 			Virtual(const HardwareParams* params);
 
+			~Virtual();
+
 			inline Hardware::Capabilities GetCapabilities() const override
 			{
 				return Hardware::CapabilityLoco
@@ -56,8 +60,16 @@ namespace Hardware
 					| Hardware::CapabilityProgramDccPomAccessoryWrite;
 			}
 
-			static void GetHint(std::string& hint)
+			inline unsigned int GetAutoModeInterval() const override
 			{
+				return simulator == nullptr ? DefaultAutoModeInterval : simulator->GetAutoModeInterval();
+			}
+
+			static void GetArgumentTypesAndHint(std::map<unsigned char,ArgumentType>& argumentTypes, std::string& hint)
+			{
+				argumentTypes[1] = ArgumentTypeSimulationTimeFactor;
+				argumentTypes[2] = ArgumentTypeFeedbackDistance;
+				argumentTypes[3] = ArgumentTypeMaxVelocity;
 				hint = Languages::GetText(Languages::TextHintVirtual);
 			}
 
@@ -78,6 +90,9 @@ namespace Hardware
 			void AccessoryOnOrOff(const Protocol protocol, const Address address, const DataModel::AccessoryState state, const bool on) override;
 			void ProgramRead(const ProgramMode mode, const Address address, const CvNumber cv) override;
 			void ProgramWrite(const ProgramMode mode, const Address address, const CvNumber cv, const CvValue value) override;
+
+		private:
+			LayoutSimulator* simulator;
 	};
 } // namespace
 
@@ -30,13 +30,14 @@ string ZLib::Compress(const string& input)
 {
 	long inputSize = input.size();
 
-	unsigned long outputSize = inputSize + 12;
+	unsigned long outputSize = compressBound(inputSize);
 	unsigned char* outputBuffer = reinterpret_cast<unsigned char*>(malloc(outputSize));
 
 	int nResult = compress2(outputBuffer, &outputSize, reinterpret_cast<const unsigned char*>(input.c_str()), inputSize, 9);
 
 	if (nResult != Z_OK)
 	{
+		free(outputBuffer);
 		return "";
 	}
 
@@ -75,3 +76,149 @@ string ZLib::UnCompress(const char* input, const size_t inputSize, const size_t
 	free(outputBuffer);
 	return output;
 }
+
+ZLib::UnCompressor::UnCompressor()
+:	stream(nullptr),
+	finished(true)
+{
+}
+
+ZLib::UnCompressor::~UnCompressor()
+{
+	End();
+}
+
+bool ZLib::UnCompressor::Start()
+{
+	End();
+	stream = new z_stream;
+	stream->zalloc = Z_NULL;
+	stream->zfree = Z_NULL;
+	stream->opaque = Z_NULL;
+	stream->avail_in = 0;
+	stream->next_in = Z_NULL;
+	if (inflateInit(stream) != Z_OK)
+	{
+		delete stream;
+		stream = nullptr;
+		return false;
+	}
+	finished = false;
+	return true;
+}
+
+void ZLib::UnCompressor::End()
+{
+	if (stream == nullptr)
+	{
+		return;
+	}
+	inflateEnd(stream);
+	delete stream;
+	stream = nullptr;
+	finished = true;
+}
+
+bool ZLib::UnCompressor::UnCompress(const char* input, const size_t inputSize, string& output)
+{
+	if (finished)
+	{
+		return stream != nullptr;
+	}
+
+	unsigned char outputBuffer[256];
+	stream->avail_in = inputSize;
+	stream->next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(input));
+	do
+	{
+		stream->avail_out = sizeof(outputBuffer);
+		stream->next_out = outputBuffer;
+		int ret = inflate(stream, Z_NO_FLUSH);
+		output.append(reinterpret_cast<char*>(outputBuffer), sizeof(outputBuffer) - stream->avail_out);
+		if (ret == Z_STREAM_END)
+		{
+			finished = true;
+			return true;
+		}
+		if (ret != Z_OK && ret != Z_BUF_ERROR)
+		{
+			End();
+			return false;
+		}
+	} while (stream->avail_out == 0);
+	return true;
+}
+
+ZLib::Compressor::Compressor()
+:	stream(nullptr),
+	level(0),
+	gzip(false)
+{
+}
+
+ZLib::Compressor::~Compressor()
+{
+	End();
+}
+
+bool ZLib::Compressor::Start(const int level, const bool gzip)
+{
+	if (stream != nullptr && level == this->level && gzip == this->gzip)
+	{
+		return deflateReset(stream) == Z_OK;
+	}
+
+	End();
+	stream = new z_stream;
+	stream->zalloc = Z_NULL;
+	stream->zfree = Z_NULL;
+	stream->opaque = Z_NULL;
+	// window bits above 15 select the gzip format
+	if (deflateInit2(stream, level, Z_DEFLATED, gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		delete stream;
+		stream = nullptr;
+		return false;
+	}
+	this->level = level;
+	this->gzip = gzip;
+	return true;
+}
+
+void ZLib::Compressor::End()
+{
+	if (stream == nullptr)
+	{
+		return;
+	}
+	deflateEnd(stream);
+	delete stream;
+	stream = nullptr;
+}
+
+bool ZLib::Compressor::Compress(const char* input, const size_t inputSize, string& output, const bool finish)
+{
+	if (stream == nullptr)
+	{
+		return false;
+	}
+
+	unsigned char outputBuffer[4096];
+	stream->avail_in = inputSize;
+	stream->next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(input));
+	const int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+	int ret;
+	do
+	{
+		stream->avail_out = sizeof(outputBuffer);
+		stream->next_out = outputBuffer;
+		ret = deflate(stream, flush);
+		if (ret == Z_STREAM_ERROR)
+		{
+			End();
+			return false;
+		}
+		output.append(reinterpret_cast<char*>(outputBuffer), sizeof(outputBuffer) - stream->avail_out);
+	} while (stream->avail_out == 0);
+	return finish == false || ret == Z_STREAM_END;
+}
@@ -22,9 +22,66 @@ along with RailControl; see the file LICENCE. If not see
 
 #include <string>
 
+struct z_stream_s;
+
 class ZLib
 {
 	public:
+		// Inflates a zlib stream that arrives in arbitrary chunks,
+		// so the compressed data never has to be buffered completely.
+		class UnCompressor
+		{
+			public:
+				UnCompressor();
+				~UnCompressor();
+
+				UnCompressor(const UnCompressor&) = delete;
+				UnCompressor& operator=(const UnCompressor&) = delete;
+
+				bool Start();
+
+				// Appends the uncompressed data to output.
+				// Input after the end of the stream is ignored.
+				bool UnCompress(const char* input, const size_t inputSize, std::string& output);
+
+				inline bool IsFinished() const
+				{
+					return finished;
+				}
+
+			private:
+				void End();
+
+				struct z_stream_s* stream;
+				bool finished;
+		};
+
+		// Deflates data that is produced in arbitrary chunks. The compression state
+		// is kept between the streams, so starting a new stream is cheap.
+		class Compressor
+		{
+			public:
+				Compressor();
+				~Compressor();
+
+				Compressor(const Compressor&) = delete;
+				Compressor& operator=(const Compressor&) = delete;
+
+				// gzip writes a gzip header and trailer instead of the zlib ones
+				bool Start(const int level, const bool gzip);
+
+				// Appends the compressed data to output.
+				// finish ends the stream and flushes all pending output.
+				bool Compress(const char* input, const size_t inputSize, std::string& output, const bool finish);
+
+			private:
+				void End();
+
+				struct z_stream_s* stream;
+				int level;
+				bool gzip;
+		};
+
 		static std::string Compress(const std::string& input);
 		static std::string UnCompress(const char* input, const size_t inputSize, const size_t outputSize);
 };
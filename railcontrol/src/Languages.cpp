@@ -79,6 +79,7 @@ const char* Languages::languages[MaxTexts][MaxLanguages] =
 /* TextBrowserInfo */ { "Please type one of the following links in your browser to connect to RailControl:{0}{1}{2}", "Bitte einer der folgenden Links im Browser eingeben um sich mit RailControl zu verbinden:{0}{1}{2}", "Por favor conectate a RailControl con el navegador internet con una de las enlaces siguientes:{0}{1}{2}" },
 /* TextBufferStop */ { "End / Buffer Stop", "Ende / Prellbock", "Final / Tope" },
 /* TextCV */ { "CV", "CV", "CV" },
+/* TextCacheStatistics */ { "{0} cache: {1} hits, {2} misses", "{0} Cache: {1} Treffer, {2} Fehlschläge", "Cache {0}: {1} aciertos, {2} fallos" },
 /* TextCanNotStartAlreadyRunning */ { "Can not start {0} because it is already running", "Unmöglich {0} zu starten weil schon gestartet", "Imposible poner {0} en marcha porque ya está en marcha" },
 /* TextCanNotStartInErrorState */ { "Can not start {0} because it is in error state", "Unmöglich {0} zu startein weil sie im Fehlerstatus ist", "Imposible poner {0} en marcha perque está en estado error" },
 /* TextCanNotStartNotOnTrack */ { "Can not start {0} because it is not on a track", "Unmöglich {0} zu starten weil sie nicht auf einem Gleis ist", "Imposible poner {0} en marcha porque no está sobre una vía" },
@@ -93,6 +94,7 @@ const char* Languages::languages[MaxTexts][MaxLanguages] =
 /* TextClusterUpdated */ { "Cluster {0} updated", "Gruppe {0} aktualisiert", "Grupo {0} actualizado" },
 /* TextClusters */ { "Clusters", "Gruppen", "Grupos" },
 /* TextCompileDate */ { "Compile date: {0}", "Kompilierdatum: 01}", "Fetcha compilada: {0}" },
+/* TextCompressionStatistics */ { "{0} responses compressed: {1} bytes saved, {2} ms CPU time", "{0} Antworten komprimiert: {1} Bytes gespart, {2} ms CPU-Zeit", "{0} respuestas comprimidas: {1} bytes ahorrados, {2} ms tiempo de CPU" },
 /* TextConfigFileReceivedWithSize */ { "Configuration file with {0} bytes received", "Konfigurationsdatei mit {0} Bytes empfangen", "Archivo de configuración recibido con {0} bytes" },
 /* TextConfigMenu */ { "Configuration menu", "Konfigurationsmenu", "Navegación de configuración" },
 /* TextConfigureControlFirst */ { "Please configure a control first", "Bitte zuerst eine Zentrale konfigurieren", "Por favor configura un control antes" },
@@ -183,6 +185,7 @@ const char* Languages::languages[MaxTexts][MaxLanguages] =
 /* TextFeedback */ { "feedback", "Rückmelder", "retroseñal" },
 /* TextFeedbackChange */ { "State of pin {0} on S88 module {1} is {2}", "Status von Pin {0} an S88 Modul {1} ist {2}", "Estado de contacto {0} del S88 módulo {1} está {2}" },
 /* TextFeedbackDeleted */ { "Feedback {0} deleted", "Rückmelder {0} gelöscht", "Retroseñal {0} eliminado" },
+/* TextFeedbackDistance */ { "Distance between feedbacks [cm]", "Abstand zwischen Rückmeldern [cm]", "Distancia entre retroseñales [cm]" },
 /* TextFeedbackDoesNotExist */ { "Feedback does not exist", "Rückmelder existiert nicht", "Retroseñal no existe" },
 /* TextFeedbackIsUsedByTrack */ { "Feedback {0} is used by track {1}", "Rückmelder {0} wird gebraucht von Gleis {1}", "Retroseñal {0} está usado por vía {1}" },
 /* TextFeedbackSaved */ { "Feedback {0} saved", "Rückmelder {0} gespeichert", "Retroseñal {0} guardado" },
@@ -223,7 +226,7 @@ const char* Languages::languages[MaxTexts][MaxLanguages] =
 /* TextHintPositionRotate */ { "Elements can be moved by clicking on it while shift-, control or alt key is pressed (key depends on the browser).", "Elemente können mit einem Klick gedreht, während die Shift-, Ctrl- oder Alt-Taste gedrückt wird (Die Taste ist abhängig vom Browser).", "Se puede rotar elementos con un click, cuando la tecla de mayúsculas, control o alt está pulsada (La tecla depende del navegador)." },
 /* TextHintRedBox */ { "Under Linux the virtual serial port is usually /dev/ttyUSB0.<br>The RedBox does not forward very short feedbacks. It is not recommended to use the feedbacks of the RedBox for automatic train control.", "Unter Linux ist der erstellte virtuelle COM-Port üblicherweise /dev/ttyUSB0.<br>Die RedBox verschluckt sehr kurzzeitige Rückmelder. Ein Automatikbetrieb mit den Rückmeldern von RedBox ist deshalb nicht zu empfehlen.", "Sobre Linux el puerto virtual normalmente es /dev/ttyUSB0.<br>El RedBox no puede procesar las retroseñales muy cortas. No es recomendada de utilisar las retroseñales de RedBox para modo automatico." },
 /* TextHintTwinCenter */ { "Under Linux the virtual serial port is usually /dev/ttyUSB0.<br>The TwinCenter does not forward very short feedbacks. It is not recommended to use the feedbacks of the TwinCenter for automatic train control.", "Unter Linux ist der erstellte virtuelle COM-Port üblicherweise /dev/ttyUSB0.<br>Das TwinCenter verschluckt sehr kurzzeitige Rückmelder. Ein Automatikbetrieb mit den Rückmeldern vom TwinCenter ist deshalb nicht zu empfehlen.", "Sobre Linux el puerto virtual normalmente es /dev/ttyUSB0.<br>El TwinCenter no puede procesar las retroseñales muy cortas. No es recomendada de utilisar las retroseñales de TwinCenter para modo automatico." },
-/* TextHintVirtual */ { "The virtual control does not have a physical representation. It is for testing only.", "Die virtuelle Zentrale hat keine physische Repräsentation. Sie ist ausschliesslich für Tests.", "El control virtual no tiene representation physica. Es solamente para tests." },
+/* TextHintVirtual */ { "The virtual control does not have a physical representation. It is for testing only. With a simulation time factor above 0 it moves the locos along their routes and triggers the feedbacks.", "Die virtuelle Zentrale hat keine physische Repräsentation. Sie ist ausschliesslich für Tests. Mit einem Simulationszeitfaktor über 0 bewegt sie die Lokomotiven entlang ihrer Fahrstrassen und löst die Rückmelder aus.", "El control virtual no tiene representation physica. Es solamente para tests. Con un factor de tiempo de simulación mayor que 0 mueve las locomotoras por sus itinerarios y activa las retroseñales." },
 /* TextHintZ21 */ { "To connect to a control with Z21 protocol, the firewall has to allow UDP-connections from and to the remote port 21105.", "Um eine Zentrale mit Z21-Protokoll mit RailControl zu verbinden, muss die Firewall UDP-Verbindungen von und zum remote Port 21105 zulassen.", "Para conectar a un control con protocolo Z21, el cortafuego tiene que permitir UDP-conexiones del y al puerto remoto 21105." },
 /* TextHitOverrun */ { "{0} hit overrun feedback {1}", "{0} erreichte Überfahr-Rückmelder {1}", "{0} ha pasado a {1}" },
 /* TextHsi88Configured */ { "{0} ({1}/{2}/{3}) S88 modules configured.", "{0} ({1}/{2}/{3}) S88 Module konfiguriert", "{0} ({1}/{2}/{3}) S88 módulos configurado" },
@@ -232,8 +235,10 @@ const char* Languages::languages[MaxTexts][MaxLanguages] =
 /* TextHttpConnectionErrorReadingData */ { "HTTP connection {0}: {1}", "HTTP Verbindung {0}: {1}", "HTTP connectión {0}: {1}" },
 /* TextHttpConnectionNotFound */ { "HTTP connection {0}: 404 Not found: {1}", "HTTP Verbindung {0}: Nicht gefunden: {1}", "HTTP connectión {0}: no encontrado" },
 /* TextHttpConnectionNotImplemented */ { "HTTP connection {0}: HTTP method {1} not implemented", "HTTP Verbindung {0}: Methode {1} nicht implementiert", "HTTP connectión {0}: no implementado" },
+/* TextHttpConnectionNotModified */ { "HTTP connection {0}: 304 Not modified: {1}", "HTTP Verbindung {0}: Nicht verändert: {1}", "HTTP connectión {0}: no modificado: {1}" },
 /* TextHttpConnectionOpened */ { "HTTP connection {0}: opened", "HTTP Verbindung {0}: geöffnet", "HTTP connectión {0}: abierto" },
 /* TextHttpConnectionRequest */ { "HTTP connection {0}: Request: {1} {2}", "HTTP Verbindung {0}: Anfrage {1} {2}", "HTTP connectión {0}: solicitud: {1} {2}" },
+/* TextHttpConnectionUpgradedToWebSocket */ { "HTTP connection {0}: Upgraded to WebSocket", "HTTP Verbindung {0}: Auf WebSocket umgestellt", "HTTP connectión {0}: Cambiado a WebSocket" },
 /* TextIPAddress */ { "IP address", "IP Adresse", "Dirección IP" },
 /* TextImport */ { "Import", "Importieren", "Importar" },
 /* TextIndex */ { "Index", "Index", "Index" },
@@ -415,6 +420,7 @@ const char* Languages::languages[MaxTexts][MaxLanguages] =
 /* TextManager */ { "Manager", "Manager", "Manager" },
 /* TextMaxSpeed */ { "Maximum speed", "Maximale Geschwindigkeit", "Velocidad máxima" },
 /* TextMaxTrainLength */ { "Maximal train length", "Maximale Zuglänge", "Longitud de tren maxima" },
+/* TextMaxVelocity */ { "Velocity at maximum speed [cm/s]", "Geschwindigkeit bei Maximalgeschwindigkeit [cm/s]", "Velocidad a la velocidad máxima [cm/s]" },
 /* TextMembers */ { "Members", "Teilnehmer", "Miembros" },
 /* TextMinTrackLength */ { "Minimal track length", "Kürzestes Gleis", "Vía más corta" },
 /* TextMinTrainLength */ { "Minimal train length", "Minimale Zuglänge", "Longitud de tren minima" },
@@ -518,6 +524,8 @@ const char* Languages::languages[MaxTexts][MaxLanguages] =
 /* TextRemoveBackupFile */ { "Removing backup file {0}", "Lösche Sicherungskopie {0}", "Eliminando copia de respaldo {0}" },
 /* TextRenamingFromTo */ { "Renaming from {0} to {1}", "Benenne von {0} nach {1} um", "Renombrando de {0} a {1}" },
 /* TextRestarting */ { "Restarting", "Neustart", "Reiniciando" },
+/* TextResynchronizationFinished */ { "Resynchronization finished after {0} ms", "Resynchronisierung nach {0} ms beendet", "Resincronización terminada después de {0} ms" },
+/* TextResynchronizing */ { "Resynchronizing {0} locos and {1} accessories", "Resynchronisiere {0} Loks und {1} Zubehörartikel", "Resincronizando {0} locomotoras y {1} accesorios" },
 /* TextRight */ { "right", "rechts", "derecha" },
 /* TextRotation */ { "Rotation", "Drehung", "Rotación", },
 /* TextRoute*/ { "route", "Fahrstrasse", "itinerario" },
@@ -590,12 +598,16 @@ const char* Languages::languages[MaxTexts][MaxLanguages] =
 /* TextSignals */ { "Signals", "Signale", "Señales" },
 /* TextSimpleLeft */ { "simple left", "einfach links", "simple izquierda" },
 /* TextSimpleRight */ { "simple right", "einfach rechts", "simple derecha" },
+/* TextSimulationReport */ { "Simulation: {0} trains running, {1} feedbacks and {2} departures in {3} s, feedback handling p99 {4} us, departure decision p99 {5} ms", "Simulation: {0} Züge fahren, {1} Rückmeldungen und {2} Abfahrten in {3} s, Rückmelderverarbeitung p99 {4} us, Abfahrtsentscheid p99 {5} ms", "Simulación: {0} trenes circulando, {1} retroseñales y {2} salidas en {3} s, procesamiento de retroseñales p99 {4} us, decisión de salida p99 {5} ms" },
+/* TextSimulationStarted */ { "Simulating the layout {0} times faster than real time", "Simuliere die Anlage {0} mal schneller als in Echtzeit", "Simulando la maqueta {0} veces más rápido que en tiempo real" },
+/* TextSimulationTimeFactor */ { "Simulation time factor (0 = off)", "Simulationszeitfaktor (0 = aus)", "Factor de tiempo de simulación (0 = apagado)" },
 /* TextSpanish */ { "Spanisch", "Spanisch", "Español" },
 /* TextSpeed */ { "Speed", "Geschwindigkeit", "Velocidad" },
 /* TextStartLocoAutomode */ { "Start locomotive in automode", "Starte Lokomotive im Automodus", "Poner locomotora en marcha en autómodo" },
 /* TextStartLocoTimetablemode */ { "Start locomotive in timetable mode", "Starte Lokomotive im Fahrplanmodus", "Poner locomotora en marcha en modo horario" },
 /* TextStartTrack */ { "Start track", "Startgleis", "Vía de inicio" },
 /* TextStarting */ { "Starting {0}", "Starte {0}", "Encendiendo {0}" },
+/* TextStaticFilesLoaded */ { "{0} static files loaded: {1} bytes, {2} bytes compressed", "{0} statische Dateien geladen: {1} Bytes, {2} Bytes komprimiert", "{0} archivos estáticos cargados: {1} bytes, {2} bytes comprimidos" },
 /* TextStopAllLocos */ { "Stop all locomotives", "Stoppe alle Lokomotiven", "Detener todas las locomotoras" },
 /* TextStopAt */ { "Stop at", "Anhalten bei", "Parar a" },
 /* TextStopLoco */ { "Stop locomotive", "Stoppe Lokomotive", "Parar locomotora" },
@@ -738,6 +750,7 @@ const char* Languages::languages[MaxTexts][MaxLanguages] =
 /* TextWarning */ { "warning", "Warnungen", "advertencias" },
 /* TextWebServerStarted */ { "Webserver started", "Webserver wurde gestartet", "Servidor web encendido" },
 /* TextWebServerStopped */ { "Webserver stopped", "Webserver wurde beendet", "Servidor web apagado" },
+/* TextWebSocketCommandNotSupported */ { "Command {0} is not supported on WebSocket connections", "Befehl {0} wird auf WebSocket Verbindungen nicht unterstützt", "Comando {0} no es soportado en conexiones WebSocket" },
 /* TextWidth */ { "Width", "Breite", "Anchura" },
 /* TextWidthIs0 */ { "Width is zero", "Breite ist null", "Anchura está zero" },
 /* TextWrite */ { "write", "schreiben", "escribir" },
@@ -79,6 +79,7 @@ class Languages
 			TextBrowserInfo,
 			TextBufferStop,
 			TextCV,
+			TextCacheStatistics,
 			TextCanNotStartAlreadyRunning,
 			TextCanNotStartInErrorState,
 			TextCanNotStartNotOnTrack,
@@ -93,6 +94,7 @@ class Languages
 			TextClusterUpdated,
 			TextClusters,
 			TextCompileDate,
+			TextCompressionStatistics,
 			TextConfigFileReceivedWithSize,
 			TextConfigMenu,
 			TextConfigureControlFirst,
@@ -183,6 +185,7 @@ class Languages
 			TextFeedback,
 			TextFeedbackChange,
 			TextFeedbackDeleted,
+			TextFeedbackDistance,
 			TextFeedbackDoesNotExist,
 			TextFeedbackIsUsedByTrack,
 			TextFeedbackSaved,
@@ -232,8 +235,10 @@ class Languages
 			TextHttpConnectionErrorReadingData,
 			TextHttpConnectionNotFound,
 			TextHttpConnectionNotImplemented,
+			TextHttpConnectionNotModified,
 			TextHttpConnectionOpened,
 			TextHttpConnectionRequest,
+			TextHttpConnectionUpgradedToWebSocket,
 			TextIPAddress,
 			TextImport,
 			TextIndex,
@@ -415,6 +420,7 @@ class Languages
 			TextManager,
 			TextMaxSpeed,
 			TextMaxTrainLength,
+			TextMaxVelocity,
 			TextMembers,
 			TextMinTrackLength,
 			TextMinTrainLength,
@@ -518,6 +524,8 @@ class Languages
 			TextRemoveBackupFile,
 			TextRenamingFromTo,
 			TextRestarting,
+			TextResynchronizationFinished,
+			TextResynchronizing,
 			TextRight,
 			TextRotation,
 			TextRoute,
@@ -590,12 +598,16 @@ class Languages
 			TextSignals,
 			TextSimpleLeft,
 			TextSimpleRight,
+			TextSimulationReport,
+			TextSimulationStarted,
+			TextSimulationTimeFactor,
 			TextSpanish,
 			TextSpeed,
 			TextStartLocoAutomode,
 			TextStartLocoTimetablemode,
 			TextStartTrack,
 			TextStarting,
+			TextStaticFilesLoaded,
 			TextStopAllLocos,
 			TextStopAt,
 			TextStopLoco,
@@ -738,6 +750,7 @@ class Languages
 			TextWarning,
 			TextWebServerStarted,
 			TextWebServerStopped,
+			TextWebSocketCommandNotSupported,
 			TextWidth,
 			TextWidthIs0,
 			TextWrite,
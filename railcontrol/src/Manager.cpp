@@ -88,7 +88,11 @@ Manager::Manager(Config& config)
 	selectRouteApproach = static_cast<DataModel::SelectRouteApproach>(Utils::Utils::StringToInteger(storage->GetSetting("SelectRouteApproach")));
 	nrOfTracksToReserve = static_cast<DataModel::Loco::NrOfTracksToReserve>(Utils::Utils::StringToInteger(storage->GetSetting("NrOfTracksToReserve"), 2));
 
-	controls[ControlIdWebserver] = new WebServer::WebServer(*this, config.getValue("webserveraddress", "any"), config.getValue("webserverport", 8082));
+	controls[ControlIdWebserver] = new WebServer::WebServer(*this,
+		config.getValue("webserveraddress", "any"),
+		config.getValue("webserverport", 8082),
+		config.getValue("webservercompressionlevel", 6),
+		config.getValue("webservercompressionthreshold", 1024));
 
 	storage->AllHardwareParams(hardwareParams);
 	for (auto& hardwareParam : hardwareParams)
@@ -4210,6 +4214,16 @@ Hardware::Capabilities Manager::GetCapabilities(const ControlID controlID) const
 	return control->GetCapabilities();
 }
 
+unsigned int Manager::GetAutoModeInterval(const ControlID controlID) const
+{
+	ControlInterface* control = GetControl(controlID);
+	if (control == nullptr)
+	{
+		return DefaultAutoModeInterval;
+	}
+	return control->GetAutoModeInterval();
+}
+
 bool Manager::LayoutItemRotate(const DataModel::ObjectIdentifier& identifier,
 	string& result)
 {
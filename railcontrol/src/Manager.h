@@ -93,10 +93,16 @@ class Manager
 		void TrackBasePublishState(const DataModel::TrackBase* trackBase);
 
 		// loco
+		inline const std::map<LocoID,DataModel::Loco*>& LocoList() const
+		{
+			return locos;
+		}
+
 		std::string GetLocoList() const;
 		std::string GetRouteList() const;
 
 		DataModel::Loco* GetLoco(const LocoID locoID) const;
+		DataModel::Loco* GetLoco(const ControlID controlID, const Protocol protocol, const Address address) const;
 
 		DataModel::LocoConfig GetLocoOfConfigByMatchKey(const ControlID controlId, const std::string& matchKey) const;
 
@@ -550,6 +556,7 @@ class Manager
 		bool CanHandle(const Hardware::Capabilities capability) const;
 		bool CanHandle(const ControlID controlId, const Hardware::Capabilities capability) const;
 		Hardware::Capabilities GetCapabilities(const ControlID controlID) const;
+		unsigned int GetAutoModeInterval(const ControlID controlID) const;
 
 		bool LayoutItemRotate(const DataModel::ObjectIdentifier& identifier,
 			std::string& result);
@@ -563,7 +570,6 @@ class Manager
 		bool ControlIsOfHardwareType(const ControlID controlID, const HardwareType hardwareType);
 
 		ControlInterface* GetControl(const ControlID controlID) const;
-		DataModel::Loco* GetLoco(const ControlID controlID, const Protocol protocol, const Address address) const;
 		DataModel::Accessory* GetAccessory(const ControlID controlID, const Protocol protocol, const Address address) const;
 		DataModel::Switch* GetSwitch(const ControlID controlID, const Protocol protocol, const Address address) const;
 		DataModel::Feedback* GetFeedback(const ControlID controlID, const FeedbackPin pin) const;
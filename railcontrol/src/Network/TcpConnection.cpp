@@ -18,7 +18,12 @@ along with RailControl; see the file LICENCE. If not see
 <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #include <unistd.h>   // close & TEMP_FAILURE_RETRY;
 
 #include "Network/Select.h"
@@ -75,6 +80,55 @@ namespace Network
 		return ret;
 	}
 
+	bool TcpConnection::SendFile(const int fd, const size_t count) const
+	{
+		size_t sent = 0;
+		while (sent < count)
+		{
+#ifdef __linux__
+			if (connected == false)
+			{
+				return false;
+			}
+			ssize_t ret = TEMP_FAILURE_RETRY(sendfile(connectionSocket, fd, nullptr, count - sent));
+#else
+			unsigned char buffer[16384];
+			ssize_t ret = TEMP_FAILURE_RETRY(read(fd, buffer, std::min(sizeof(buffer), count - sent)));
+			if (ret > 0)
+			{
+				ret = Send(buffer, ret);
+			}
+#endif
+			if (ret <= 0)
+			{
+				return false;
+			}
+			sent += ret;
+		}
+		return true;
+	}
+
+	void TcpConnection::SetNoDelay() const
+	{
+		int on = 1;
+		setsockopt(connectionSocket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	}
+
+	bool TcpConnection::WaitForData(const unsigned int milliseconds) const
+	{
+		if (connectionSocket == 0 || connected == false)
+		{
+			return true;
+		}
+		fd_set set;
+		FD_ZERO(&set);
+		FD_SET(connectionSocket, &set);
+		struct timeval timeout;
+		timeout.tv_sec = milliseconds / 1000;
+		timeout.tv_usec = (milliseconds % 1000) * 1000;
+		return TEMP_FAILURE_RETRY(select(FD_SETSIZE, &set, NULL, NULL, &timeout)) != 0;
+	}
+
 	int TcpConnection::Receive(unsigned char* buffer, const size_t bufferLength, const int flags) const
 	{
 		if (connectionSocket == 0 || connected == false)
@@ -55,6 +55,15 @@ namespace Network
 				return Send(string.c_str(), string.size(), flags);
 			}
 
+			// sends count bytes of the open file fd without copying them to user space if possible
+			bool SendFile(const int fd, const size_t count) const;
+
+			// sends small writes immediately instead of collecting them (Nagle)
+			void SetNoDelay() const;
+
+			// returns true if data (or the end of the connection) can be read within the timeout
+			bool WaitForData(const unsigned int milliseconds) const;
+
 			int Receive(unsigned char* buffer, const size_t bufferLength, const int flags = 0) const;
 
 			inline int Receive(char* buffer, const size_t bufferLength, const int flags = 0) const
@@ -103,6 +103,8 @@ int main (int argc, char* argv[])
 	stopSignalCounter = 0;
 	signal(SIGINT, stopRailControlSignal);
 	signal(SIGTERM, stopRailControlSignal);
+	// sendfile can not suppress SIGPIPE like send with MSG_NOSIGNAL does
+	signal(SIGPIPE, SIG_IGN);
 
 	const string RailControl = "RailControl";
 	Utils::Utils::SetThreadName(RailControl);
@@ -134,6 +134,39 @@ namespace Utils
 		return modifiedValue;
 	}
 
+	string Utils::JsonEncode(const string& value)
+	{
+		string output("\"");
+		for (const char c : value)
+		{
+			switch (c)
+			{
+				case '"':
+				case '\\':
+					output += '\\';
+					output += c;
+					break;
+
+				case '\n':
+					output += "\\n";
+					break;
+
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+					{
+						char escaped[7];
+						snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+						output += escaped;
+						break;
+					}
+					output += c;
+					break;
+			}
+		}
+		output += '"';
+		return output;
+	}
+
 	const std::string& Utils::GetStringMapEntry(const std::map<std::string, std::string>& map, const std::string& key, const std::string& defaultValue)
 	{
 		if (map.count(key) == 0)
@@ -47,6 +47,8 @@ namespace Utils
 			static std::string UrlDecode(const std::string& value);
 			static std::string UrlEncode(const std::string& value);
 			static std::string HtmlEncode(const std::string& value);
+			// returns the value as quoted JSON string
+			static std::string JsonEncode(const std::string& value);
 
 			static inline bool IsMapEntrySet(const std::map<std::string,std::string>& map, const std::string& key)
 			{
@@ -0,0 +1,173 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstdio>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Hardware/ZLib.h"
+#include "WebServer/AssetCache.h"
+
+using std::string;
+
+namespace WebServer
+{
+	AssetCache::AssetCache(Logger::Logger* logger)
+	{
+		string directory;
+		char workingDir[128];
+		if (getcwd(workingDir, sizeof(workingDir)))
+		{
+			directory = workingDir;
+		}
+		directory.append("/html");
+
+		DIR* dir = opendir(directory.c_str());
+		if (dir == nullptr)
+		{
+			return;
+		}
+
+		size_t size = 0;
+		size_t deflatedSize = 0;
+		struct dirent* entry;
+		while ((entry = readdir(dir)) != nullptr)
+		{
+			if (entry->d_name[0] == '.')
+			{
+				continue;
+			}
+			const string virtualFile = string("/") + entry->d_name;
+			Asset asset;
+			if (Load(virtualFile, directory + virtualFile, asset) == false)
+			{
+				continue;
+			}
+			size += asset.size;
+			deflatedSize += asset.deflated.size() > 0 ? asset.deflated.size() : asset.size;
+			assets[virtualFile] = asset;
+		}
+		closedir(dir);
+		logger->Info(Languages::TextStaticFilesLoaded, assets.size(), size, deflatedSize);
+	}
+
+	const AssetCache::Asset* AssetCache::Get(const string& virtualFile) const
+	{
+		auto asset = assets.find(virtualFile.substr(0, virtualFile.find('?')));
+		if (asset == assets.end())
+		{
+			return nullptr;
+		}
+		return &asset->second;
+	}
+
+	bool AssetCache::Load(const string& virtualFile, const string& realFile, Asset& asset)
+	{
+		struct stat s;
+		if (stat(realFile.c_str(), &s) != 0 || S_ISREG(s.st_mode) == false)
+		{
+			return false;
+		}
+
+		FILE* f = fopen(realFile.c_str(), "r");
+		if (f == nullptr)
+		{
+			return false;
+		}
+		string content(s.st_size, 0);
+		const size_t r = fread(&content[0], 1, s.st_size, f);
+		fclose(f);
+		if (r != static_cast<size_t>(s.st_size))
+		{
+			return false;
+		}
+
+		asset.realFile = realFile;
+		asset.contentType = ContentType(virtualFile);
+		asset.etag = ETag(content);
+		asset.size = content.size();
+
+		// images are already compressed, only keep the deflated variant if it saves at least a tenth
+		const string deflated = ZLib::Compress(content);
+		if (deflated.size() > 0 && deflated.size() < content.size() - content.size() / 10)
+		{
+			asset.deflated = deflated;
+			// a strong validator belongs to exactly one representation
+			asset.etagDeflated = asset.etag.substr(0, asset.etag.size() - 1) + "-deflate\"";
+		}
+
+		if (asset.size < SendFileThreshold)
+		{
+			asset.content.swap(content);
+		}
+		return true;
+	}
+
+	const char* AssetCache::ContentType(const string& virtualFile)
+	{
+		const size_t dot = virtualFile.rfind('.');
+		if (dot == string::npos)
+		{
+			return nullptr;
+		}
+		const string extension = virtualFile.substr(dot + 1);
+		if (extension.compare("ico") == 0)
+		{
+			return "image/x-icon";
+		}
+		if (extension.compare("css") == 0)
+		{
+			return "text/css";
+		}
+		if (extension.compare("png") == 0)
+		{
+			return "image/png";
+		}
+		if (extension.compare("svg") == 0)
+		{
+			return "image/svg+xml";
+		}
+		if (extension.compare("ttf") == 0)
+		{
+			return "application/x-font-ttf";
+		}
+		if (extension.compare("js") == 0)
+		{
+			return "application/javascript";
+		}
+		return nullptr;
+	}
+
+	string AssetCache::ETag(const string& content)
+	{
+		// FNV-1a 64 bit
+		uint64_t hash = 14695981039346656037ULL;
+		for (const char c : content)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ULL;
+		}
+		char etag[19];
+		snprintf(etag, sizeof(etag), "\"%016llx\"", static_cast<unsigned long long>(hash));
+		return etag;
+	}
+} // namespace WebServer
@@ -0,0 +1,76 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Logger/Logger.h"
+
+namespace WebServer
+{
+	// Holds the files of the html directory, which are read once at startup.
+	// Every file gets a strong ETag and, if it compresses well, a deflated variant
+	// with an ETag of its own.
+	class AssetCache
+	{
+		public:
+			class Asset
+			{
+				public:
+					Asset()
+					:	contentType(nullptr),
+						size(0)
+					{
+					}
+
+					std::string realFile;
+					const char* contentType;
+					std::string etag;
+					size_t size;
+					// empty if the file is larger than SendFileThreshold and is sent from disk
+					std::string content;
+					// empty if the compression does not pay off
+					std::string deflated;
+					std::string etagDeflated;
+			};
+
+			AssetCache() = delete;
+			AssetCache(const AssetCache&) = delete;
+			AssetCache& operator=(const AssetCache&) = delete;
+
+			AssetCache(Logger::Logger* logger);
+
+			// returns nullptr if the file is not available
+			const Asset* Get(const std::string& virtualFile) const;
+
+			static const size_t SendFileThreshold = 65536;
+
+		private:
+			bool Load(const std::string& virtualFile, const std::string& realFile, Asset& asset);
+
+			static const char* ContentType(const std::string& virtualFile);
+			static std::string ETag(const std::string& content);
+
+			std::map<std::string,Asset> assets;
+	};
+} // namespace WebServer
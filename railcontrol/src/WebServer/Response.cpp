@@ -26,7 +26,9 @@ along with RailControl; see the file LICENCE. If not see
 namespace WebServer
 {
 	const Response::responseCodeMap Response::responseTexts = {
+		{ Response::SwitchingProtocols, "Switching Protocols" },
 		{ Response::OK, "OK" },
+		{ Response::NotModified, "Not Modified" },
 		{ Response::NotFound, "Not found"},
 		{ Response::NotImplemented, "Not Implemented"}
 	};
@@ -43,14 +45,28 @@ namespace WebServer
 		return reply.str();
 	}
 
-	std::ostream& operator<<(std::ostream& stream, const Response& response)
+	std::string Response::GetHead() const
 	{
-		stream << "HTTP/1.1 " << std::to_string(response.responseCode) << " " << Response::responseTexts.at(response.responseCode) << "\r\n";
-		for (auto& header : response.headers)
+		std::stringstream head;
+		head << "HTTP/1.1 " << std::to_string(responseCode) << " " << Response::responseTexts.at(responseCode) << "\r\n";
+		for (auto& header : headers)
 		{
-			stream << header.first << ": " << header.second << "\r\n";
+			head << header.first << ": " << header.second << "\r\n";
 		}
-		stream << "\r\n";
+		head << "\r\n";
+		return head.str();
+	}
+
+	std::string Response::GetBody() const
+	{
+		std::stringstream body;
+		body << content;
+		return body.str();
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const Response& response)
+	{
+		stream << response.GetHead();
 		stream << response.content;
 		return stream;
 	}
@@ -33,7 +33,9 @@ namespace WebServer
 		public:
 			enum ResponseCode : unsigned short
 			{
+				SwitchingProtocols = 101,
 				OK = 200,
+				NotModified = 304,
 				NotFound = 404,
 				NotImplemented = 501
 			};
@@ -56,6 +58,10 @@ namespace WebServer
 			void AddHeader(const std::string& key, const std::string& value);
 			operator std::string();
 
+			// status line and headers including the empty line that ends them
+			std::string GetHead() const;
+			virtual std::string GetBody() const;
+
 			friend std::ostream& operator<<(std::ostream& stream, const Response& response);
 
 			ResponseCode responseCode;
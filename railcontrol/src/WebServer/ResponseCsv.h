@@ -42,6 +42,11 @@ namespace WebServer
 
 			operator std::string();
 
+			inline std::string GetBody() const override
+			{
+				return csvContent;
+			}
+
 			friend std::ostream& operator<<(std::ostream& stream, const ResponseCsv& response);
 
 		private:
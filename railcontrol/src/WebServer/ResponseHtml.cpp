@@ -53,28 +53,32 @@ namespace WebServer
 		return reply.str();
 	}
 
-	std::ostream& operator<<(std::ostream& stream, const ResponseHtml& response)
+	std::string ResponseHtml::GetBody() const
 	{
-		stream << "HTTP/1.1 " << std::to_string(response.responseCode) << " " << ResponseHtml::responseTexts.at(response.responseCode) << "\r\n";
-		for (auto& header : response.headers)
-		{
-			stream << header.first << ": " << header.second << "\r\n";
-		}
-
 		std::stringstream body;
 		body << "<!DOCTYPE html>";
 
 		HtmlTag html("html");
-		if (response.title.length() > 0)
+		if (title.length() > 0)
 		{
 			HtmlTag head("head");
-			head.AddChildTag(HtmlTag("title").AddContent(response.title));
+			head.AddChildTag(HtmlTag("title").AddContent(title));
 			html.AddChildTag(head);
 		}
-		html.AddChildTag(response.content);
+		html.AddChildTag(content);
 		body << html;
+		return body.str();
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const ResponseHtml& response)
+	{
+		stream << "HTTP/1.1 " << std::to_string(response.responseCode) << " " << ResponseHtml::responseTexts.at(response.responseCode) << "\r\n";
+		for (auto& header : response.headers)
+		{
+			stream << header.first << ": " << header.second << "\r\n";
+		}
 
-		std::string bodyString(body.str());
+		std::string bodyString(response.GetBody());
 		stream << "Content-Length: " << bodyString.size();
 		stream << "\r\n\r\n";
 		stream << bodyString;
@@ -59,6 +59,8 @@ namespace WebServer
 			void AddChildTag(HtmlTag content);
 			operator std::string();
 
+			std::string GetBody() const override;
+
 			friend std::ostream& operator<<(std::ostream& stream, const ResponseHtml& response);
 
 		protected:
@@ -32,28 +32,32 @@ namespace WebServer
 		return reply.str();
 	}
 
-	std::ostream& operator<<(std::ostream& stream, const ResponseHtmlFull& response)
+	std::string ResponseHtmlFull::GetBody() const
 	{
-		stream << "HTTP/1.1 " << std::to_string(response.responseCode) << " " << ResponseHtml::responseTexts.at(response.responseCode) << "\r\n";
-		for (auto& header : response.headers)
-		{
-			stream << header.first << ": " << header.second << "\r\n";
-		}
-
 		std::stringstream body;
 		body << "<!DOCTYPE html>";
 
 		HtmlTag head("head");
-		head.AddChildTag(HtmlTag("title").AddId("title").AddContent(response.title));
+		head.AddChildTag(HtmlTag("title").AddId("title").AddContent(title));
 		head.AddChildTag(HtmlTag("link").AddAttribute("rel", "stylesheet").AddAttribute("type", "text/css").AddAttribute("href", "/style.css"));
 		head.AddChildTag(HtmlTag("script").AddAttribute("type", "application/javascript").AddAttribute("src", "/nosleep.js"));
 		head.AddChildTag(HtmlTag("script").AddAttribute("type", "application/javascript").AddAttribute("src", "/javascript.js"));
 		head.AddChildTag(HtmlTag("meta").AddAttribute("name", "viewport").AddAttribute("content", "width=device-width, initial-scale=1.0, minimum-scale=1.0, maximum-scale=1.0"));
 		head.AddChildTag(HtmlTag("meta").AddAttribute("name", "robots").AddAttribute("content", "noindex,nofollow"));
 
-		body << HtmlTag("html").AddChildTag(head).AddChildTag(response.content);
+		body << HtmlTag("html").AddChildTag(head).AddChildTag(content);
+		return body.str();
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const ResponseHtmlFull& response)
+	{
+		stream << "HTTP/1.1 " << std::to_string(response.responseCode) << " " << ResponseHtml::responseTexts.at(response.responseCode) << "\r\n";
+		for (auto& header : response.headers)
+		{
+			stream << header.first << ": " << header.second << "\r\n";
+		}
 
-		std::string bodyString(body.str());
+		std::string bodyString(response.GetBody());
 
 		stream << "Content-Length: " << bodyString.size();
 		stream << "\r\n\r\n";
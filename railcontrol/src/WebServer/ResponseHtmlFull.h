@@ -55,6 +55,8 @@ namespace WebServer
 
 			operator std::string();
 
+			std::string GetBody() const override;
+
 			friend std::ostream& operator<<(std::ostream& stream, const ResponseHtmlFull& response);
 	};
 } // namespace WebServer
@@ -0,0 +1,59 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+#include <string>
+
+#include "WebServer/ResponseJson.h"
+
+namespace WebServer
+{
+	ResponseJson::ResponseJson(const std::string& content)
+	:	Response(),
+		jsonContent(content)
+	{
+		AddHeader("Cache-Control", "no-cache, must-revalidate");
+		AddHeader("Pragma", "no-cache");
+		AddHeader("Expires", "Sun, 12 Feb 2016 00:00:00 GMT");
+		AddHeader("Content-Type", "application/json; charset=utf-8");
+		AddHeader("Connection", "keep-alive");
+	}
+
+	ResponseJson::operator std::string()
+	{
+		std::stringstream reply;
+		reply << *this;
+		return reply.str();
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const ResponseJson& response)
+	{
+		stream << "HTTP/1.1 " << std::to_string(response.responseCode) << " " << Response::responseTexts.at(response.responseCode) << "\r\n";
+		for (auto& header : response.headers)
+		{
+			stream << header.first << ": " << header.second << "\r\n";
+		}
+
+		stream << "Content-Length: " << response.jsonContent.size();
+		stream << "\r\n\r\n";
+		stream << response.jsonContent;
+		return stream;
+	}
+} // namespace WebServer
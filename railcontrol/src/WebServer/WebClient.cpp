@@ -20,12 +20,13 @@ along with RailControl; see the file LICENCE. If not see
 
 #include <algorithm>
 #include <cstring>		//memset
+#include <fcntl.h>
 #include <netinet/in.h>
 #include <signal.h>
 #include <sstream>
 #include <sys/socket.h>
-#include <sys/stat.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "DataModel/DataModel.h"
@@ -64,9 +65,11 @@ along with RailControl; see the file LICENCE. If not see
 #include "WebServer/ResponseHtmlFull.h"
 #include "WebServer/ResponseHtmlNotFound.h"
 #include "WebServer/ResponseHtmlNotImplemented.h"
+#include "WebServer/ResponseJson.h"
 #include "WebServer/WebClient.h"
 #include "WebServer/WebClientStatic.h"
 #include "WebServer/WebServer.h"
+#include "WebServer/WebSocket.h"
 
 using namespace DataModel;
 using LayoutPosition = DataModel::LayoutItem::LayoutPosition;
@@ -149,6 +152,18 @@ namespace WebServer
 			map<string, string> headers;
 			InterpretClientRequest(lines, method, uri, protocol, arguments, headers);
 			keepalive = (Utils::Utils::GetStringMapEntry(headers, "Connection", "close").compare("keep-alive") == 0);
+			if (AcceptsEncoding(headers, "gzip"))
+			{
+				contentEncoding = "gzip";
+			}
+			else if (AcceptsEncoding(headers, "deflate"))
+			{
+				contentEncoding = "deflate";
+			}
+			else
+			{
+				contentEncoding.clear();
+			}
 			logger->Info(Languages::TextHttpConnectionRequest, id, method, uri);
 
 			// if method is not implemented
@@ -160,489 +175,521 @@ namespace WebServer
 				return;
 			}
 
-			// handle requests
-			if (uri.compare("/") == 0)
-			{
-				PrintMainHTML();
-				if (server.UpdateAvailable())
-				{
-					server.AddUpdate("warning", Languages::TextRailControlUpdateAvailable);
-				}
-			}
-			else if (arguments["cmd"].compare("quit") == 0)
-			{
-				ReplyHtmlWithHeaderAndParagraph(Languages::TextStoppingRailControl);
-				stopRailControlWebserver();
-			}
-			else if (arguments["cmd"].compare("booster") == 0)
-			{
-				bool on = Utils::Utils::GetBoolMapEntry(arguments, "on");
-				if (on)
-				{
-					ReplyHtmlWithHeaderAndParagraph(Languages::TextTurningBoosterOn);
-					manager.Booster(ControlTypeWebserver, BoosterStateGo);
-				}
-				else
-				{
-					ReplyHtmlWithHeaderAndParagraph(Languages::TextTurningBoosterOff);
-					manager.Booster(ControlTypeWebserver, BoosterStateStop);
-				}
-			}
-			else if (arguments["cmd"].compare("layeredit") == 0)
-			{
-				HandleLayerEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("layersave") == 0)
-			{
-				HandleLayerSave(arguments);
-			}
-			else if (arguments["cmd"].compare("layerlist") == 0)
-			{
-				HandleLayerList();
-			}
-			else if (arguments["cmd"].compare("layeraskdelete") == 0)
-			{
-				HandleLayerAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("layerdelete") == 0)
-			{
-				HandleLayerDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("controledit") == 0)
-			{
-				HandleControlEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("controlsave") == 0)
-			{
-				HandleControlSave(arguments);
-			}
-			else if (arguments["cmd"].compare("controllist") == 0)
-			{
-				HandleControlList();
-			}
-			else if (arguments["cmd"].compare("controlaskdelete") == 0)
-			{
-				HandleControlAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("controldelete") == 0)
-			{
-				HandleControlDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("loco") == 0)
-			{
-				HandleLoco(arguments);
-			}
-			else if (arguments["cmd"].compare("locospeed") == 0)
-			{
-				HandleLocoSpeed(arguments);
-			}
-			else if (arguments["cmd"].compare("locoorientation") == 0)
-			{
-				HandleLocoOrientation(arguments);
-			}
-			else if (arguments["cmd"].compare("locofunction") == 0)
-			{
-				HandleLocoFunction(arguments);
-			}
-			else if (arguments["cmd"].compare("locoedit") == 0)
-			{
-				HandleLocoEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("locosave") == 0)
-			{
-				HandleLocoSave(arguments);
-			}
-			else if (arguments["cmd"].compare("locolist") == 0)
-			{
-				HandleLocoList();
-			}
-			else if (arguments["cmd"].compare("locoaskdelete") == 0)
-			{
-				HandleLocoAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("locodelete") == 0)
-			{
-				HandleLocoDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("locorelease") == 0)
-			{
-				HandleLocoRelease(arguments);
-			}
-			else if (arguments["cmd"].compare("locoaddtimetable") == 0)
-			{
-				HandleLocoAddTimeTable(arguments);
-			}
-			else if (arguments["cmd"].compare("accessoryedit") == 0)
-			{
-				HandleAccessoryEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("accessorysave") == 0)
-			{
-				HandleAccessorySave(arguments);
-			}
-			else if (arguments["cmd"].compare("accessorystate") == 0)
-			{
-				HandleAccessoryState(arguments);
-			}
-			else if (arguments["cmd"].compare("accessorylist") == 0)
-			{
-				HandleAccessoryList();
-			}
-			else if (arguments["cmd"].compare("accessoryaskdelete") == 0)
-			{
-				HandleAccessoryAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("accessorydelete") == 0)
-			{
-				HandleAccessoryDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("accessoryget") == 0)
-			{
-				HandleAccessoryGet(arguments);
-			}
-			else if (arguments["cmd"].compare("accessoryrelease") == 0)
-			{
-				HandleAccessoryRelease(arguments);
-			}
-			else if (arguments["cmd"].compare("switchedit") == 0)
-			{
-				HandleSwitchEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("switchsave") == 0)
-			{
-				HandleSwitchSave(arguments);
-			}
-			else if (arguments["cmd"].compare("switchstate") == 0)
-			{
-				HandleSwitchState(arguments);
-			}
-			else if (arguments["cmd"].compare("switchstates") == 0)
-			{
-				route.HandleRelationSwitchStates(arguments);
-			}
-			else if (arguments["cmd"].compare("switchlist") == 0)
-			{
-				HandleSwitchList();
-			}
-			else if (arguments["cmd"].compare("switchaskdelete") == 0)
-			{
-				HandleSwitchAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("switchdelete") == 0)
-			{
-				HandleSwitchDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("switchget") == 0)
-			{
-				HandleSwitchGet(arguments);
-			}
-			else if (arguments["cmd"].compare("switchrelease") == 0)
-			{
-				HandleSwitchRelease(arguments);
-			}
-			else if (arguments["cmd"].compare("signaladdresses") == 0)
-			{
-				signal.HandleSignalAddresses(arguments);
-			}
-			else if (arguments["cmd"].compare("signaledit") == 0)
-			{
-				signal.HandleSignalEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("signalsave") == 0)
-			{
-				signal.HandleSignalSave(arguments);
-			}
-			else if (arguments["cmd"].compare("signalstate") == 0)
-			{
-				signal.HandleSignalState(arguments);
-			}
-			else if (arguments["cmd"].compare("signalstates") == 0)
-			{
-				signal.HandleSignalStates(arguments);
-			}
-			else if (arguments["cmd"].compare("signallist") == 0)
-			{
-				signal.HandleSignalList();
-			}
-			else if (arguments["cmd"].compare("signalaskdelete") == 0)
-			{
-				signal.HandleSignalAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("signaldelete") == 0)
-			{
-				signal.HandleSignalDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("signalget") == 0)
-			{
-				signal.HandleSignalGet(arguments);
-			}
-			else if (arguments["cmd"].compare("signalrelease") == 0)
-			{
-				signal.HandleSignalRelease(arguments);
-			}
-			else if (arguments["cmd"].compare("routeedit") == 0)
-			{
-				route.HandleRouteEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("routesave") == 0)
-			{
-				route.HandleRouteSave(arguments);
-			}
-			else if (arguments["cmd"].compare("routelist") == 0)
-			{
-				route.HandleRouteList();
-			}
-			else if (arguments["cmd"].compare("routeaskdelete") == 0)
-			{
-				route.HandleRouteAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("routedelete") == 0)
-			{
-				route.HandleRouteDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("routeget") == 0)
-			{
-				route.HandleRouteGet(arguments);
-			}
-			else if (arguments["cmd"].compare("routeexecute") == 0)
-			{
-				route.HandleRouteExecute(arguments);
-			}
-			else if (arguments["cmd"].compare("routerelease") == 0)
-			{
-				route.HandleRouteRelease(arguments);
-			}
-			else if (arguments["cmd"].compare("textedit") == 0)
-			{
-				text.HandleTextEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("textsave") == 0)
-			{
-				text.HandleTextSave(arguments);
-			}
-			else if (arguments["cmd"].compare("textlist") == 0)
-			{
-				text.HandleTextList();
-			}
-			else if (arguments["cmd"].compare("textaskdelete") == 0)
-			{
-				text.HandleTextAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("textdelete") == 0)
-			{
-				text.HandleTextDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("textget") == 0)
-			{
-				text.HandleTextGet(arguments);
-			}
-			else if (arguments["cmd"].compare("trackedit") == 0)
-			{
-				track.HandleTrackEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("tracksave") == 0)
-			{
-				track.HandleTrackSave(arguments);
-			}
-			else if (arguments["cmd"].compare("tracklist") == 0)
+			string upgrade = Utils::Utils::GetStringMapEntry(headers, "Upgrade");
+			std::transform(upgrade.begin(), upgrade.end(), upgrade.begin(), ::tolower);
+			if (uri.compare(0, 10, "/websocket") == 0 && upgrade.compare("websocket") == 0)
 			{
-				track.HandleTrackList();
-			}
-			else if (arguments["cmd"].compare("trackaskdelete") == 0)
-			{
-				track.HandleTrackAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("trackdelete") == 0)
-			{
-				track.HandleTrackDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("trackget") == 0)
-			{
-				track.HandleTrackGet(arguments);
-			}
-			else if (arguments["cmd"].compare("tracksetloco") == 0)
-			{
-				track.HandleTrackSetLoco(arguments);
-			}
-			else if (arguments["cmd"].compare("trackrelease") == 0)
-			{
-				track.HandleTrackRelease(arguments);
-			}
-			else if (arguments["cmd"].compare("trackstartloco") == 0)
-			{
-				track.HandleTrackStartLoco(arguments);
-			}
-			else if (arguments["cmd"].compare("trackstoploco") == 0)
-			{
-				track.HandleTrackStopLoco(arguments);
-			}
-			else if (arguments["cmd"].compare("trackblock") == 0)
-			{
-				track.HandleTrackBlock(arguments);
-			}
-			else if (arguments["cmd"].compare("trackorientation") == 0)
-			{
-				track.HandleTrackOrientation(arguments);
-			}
-			else if (arguments["cmd"].compare("feedbackedit") == 0)
-			{
-				HandleFeedbackEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("feedbacksave") == 0)
-			{
-				HandleFeedbackSave(arguments);
-			}
-			else if (arguments["cmd"].compare("feedbackstate") == 0)
-			{
-				HandleFeedbackState(arguments);
-			}
-			else if (arguments["cmd"].compare("feedbacklist") == 0)
-			{
-				HandleFeedbackList();
-			}
-			else if (arguments["cmd"].compare("feedbackaskdelete") == 0)
-			{
-				HandleFeedbackAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("feedbackdelete") == 0)
-			{
-				HandleFeedbackDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("feedbackget") == 0)
-			{
-				HandleFeedbackGet(arguments);
-			}
-			else if (arguments["cmd"].compare("feedbacksoftrack") == 0)
-			{
-				route.HandleFeedbacksOfTrack(arguments);
-			}
-			else if (arguments["cmd"].compare("protocol") == 0)
-			{
-				HandleProtocol(arguments);
-			}
-			else if (arguments["cmd"].compare("feedbackadd") == 0)
-			{
-				HandleFeedbackAdd(arguments);
-			}
-			else if (arguments["cmd"].compare("relationadd") == 0)
-			{
-				route.HandleRelationAdd(arguments);
-			}
-			else if (arguments["cmd"].compare("relationobject") == 0)
-			{
-				route.HandleRelationObject(arguments);
-			}
-			else if (arguments["cmd"].compare("layout") == 0)
-			{
-				HandleLayout(arguments);
-			}
-			else if (arguments["cmd"].compare("locoselector") == 0)
-			{
-				HandleLocoSelector(arguments);
-			}
-			else if (arguments["cmd"].compare("layerselector") == 0)
-			{
-				HandleLayerSelector();
-			}
-			else if (arguments["cmd"].compare("stopallimmediately") == 0)
-			{
-				manager.StopAllLocosImmediately(ControlTypeWebserver);
-			}
-			else if (arguments["cmd"].compare("startall") == 0)
-			{
-				manager.LocoStartAll();
-			}
-			else if (arguments["cmd"].compare("stopall") == 0)
-			{
-				manager.LocoStopAll();
-			}
-			else if (arguments["cmd"].compare("settingsedit") == 0)
-			{
-				HandleSettingsEdit();
-			}
-			else if (arguments["cmd"].compare("settingssave") == 0)
-			{
-				HandleSettingsSave(arguments);
-			}
-			else if (arguments["cmd"].compare("slaveadd") == 0)
-			{
-				HandleSlaveAdd(arguments);
-			}
-			else if (arguments["cmd"].compare("timestamp") == 0)
-			{
-				HandleTimestamp(arguments);
-			}
-			else if (arguments["cmd"].compare("controlarguments") == 0)
-			{
-				HandleControlArguments(arguments);
-			}
-			else if (arguments["cmd"].compare("program") == 0)
-			{
-				HandleProgram();
-			}
-			else if (arguments["cmd"].compare("programmodeselector") == 0)
-			{
-				HandleProgramModeSelector(arguments);
-			}
-			else if (arguments["cmd"].compare("programread") == 0)
-			{
-				HandleProgramRead(arguments);
-			}
-			else if (arguments["cmd"].compare("programwrite") == 0)
-			{
-				HandleProgramWrite(arguments);
-			}
-			else if (arguments["cmd"].compare("getcvfields") == 0)
-			{
-				HandleCvFields(arguments);
-			}
-			else if (arguments["cmd"].compare("clusterlist") == 0)
-			{
-				cluster.HandleClusterList();
-			}
-			else if (arguments["cmd"].compare("clusteredit") == 0)
-			{
-				cluster.HandleClusterEdit(arguments);
-			}
-			else if (arguments["cmd"].compare("clustersave") == 0)
-			{
-				cluster.HandleClusterSave(arguments);
-			}
-			else if (arguments["cmd"].compare("clusteraskdelete") == 0)
-			{
-				cluster.HandleClusterAskDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("clusterdelete") == 0)
-			{
-				cluster.HandleClusterDelete(arguments);
-			}
-			else if (arguments["cmd"].compare("newposition") == 0)
-			{
-				HandleNewPosition(arguments);
-			}
-			else if (arguments["cmd"].compare("rotate") == 0)
-			{
-				HandleRotate(arguments);
-			}
-			else if (arguments["cmd"].compare("getlocolist") == 0)
-			{
-				string s = manager.GetLocoList();
-				connection->Send(ResponseCsv(s));
+				HandleWebSocket(arguments, headers);
+				// the client is only deleted when the next one connects, so close now
+				connection->Terminate();
+				return;
 			}
-			else if (arguments["cmd"].compare("getroutelist") == 0)
+
+			HandleRequest(uri, arguments, headers);
+		}
+	}
+
+	void WebClient::HandleRequest(const string& uri, map<string,string>& arguments, const map<string,string>& headers)
+	{
+		if (uri.compare("/") == 0)
+		{
+			PrintMainHTML();
+			if (server.UpdateAvailable())
 			{
-				string s = manager.GetRouteList();
-				connection->Send(ResponseCsv(s));
+				server.AddUpdate("warning", Languages::TextRailControlUpdateAvailable);
 			}
-			else if (arguments["cmd"].compare("updater") == 0)
+		}
+		else if (HandleCommand(arguments, headers) == false)
+		{
+			DeliverFile(uri, headers);
+		}
+	}
+
+	bool WebClient::HandleCommand(map<string,string>& arguments, const map<string,string>& headers)
+	{
+		if (arguments["cmd"].compare("quit") == 0)
+		{
+			ReplyHtmlWithHeaderAndParagraph(Languages::TextStoppingRailControl);
+			stopRailControlWebserver();
+		}
+		else if (arguments["cmd"].compare("booster") == 0)
+		{
+			bool on = Utils::Utils::GetBoolMapEntry(arguments, "on");
+			if (on)
 			{
-				HandleUpdater(headers);
+				ReplyHtmlWithHeaderAndParagraph(Languages::TextTurningBoosterOn);
+				manager.Booster(ControlTypeWebserver, BoosterStateGo);
 			}
 			else
 			{
-				DeliverFile(uri);
+				ReplyHtmlWithHeaderAndParagraph(Languages::TextTurningBoosterOff);
+				manager.Booster(ControlTypeWebserver, BoosterStateStop);
 			}
 		}
+		else if (arguments["cmd"].compare("layeredit") == 0)
+		{
+			HandleLayerEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("layersave") == 0)
+		{
+			HandleLayerSave(arguments);
+		}
+		else if (arguments["cmd"].compare("layerlist") == 0)
+		{
+			HandleLayerList();
+		}
+		else if (arguments["cmd"].compare("layeraskdelete") == 0)
+		{
+			HandleLayerAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("layerdelete") == 0)
+		{
+			HandleLayerDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("controledit") == 0)
+		{
+			HandleControlEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("controlsave") == 0)
+		{
+			HandleControlSave(arguments);
+		}
+		else if (arguments["cmd"].compare("controllist") == 0)
+		{
+			HandleControlList();
+		}
+		else if (arguments["cmd"].compare("controlaskdelete") == 0)
+		{
+			HandleControlAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("controldelete") == 0)
+		{
+			HandleControlDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("loco") == 0)
+		{
+			HandleLoco(arguments);
+		}
+		else if (arguments["cmd"].compare("locospeed") == 0)
+		{
+			HandleLocoSpeed(arguments);
+		}
+		else if (arguments["cmd"].compare("locoorientation") == 0)
+		{
+			HandleLocoOrientation(arguments);
+		}
+		else if (arguments["cmd"].compare("locofunction") == 0)
+		{
+			HandleLocoFunction(arguments);
+		}
+		else if (arguments["cmd"].compare("locoedit") == 0)
+		{
+			HandleLocoEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("locosave") == 0)
+		{
+			HandleLocoSave(arguments);
+		}
+		else if (arguments["cmd"].compare("locolist") == 0)
+		{
+			HandleLocoList();
+		}
+		else if (arguments["cmd"].compare("locoaskdelete") == 0)
+		{
+			HandleLocoAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("locodelete") == 0)
+		{
+			HandleLocoDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("locorelease") == 0)
+		{
+			HandleLocoRelease(arguments);
+		}
+		else if (arguments["cmd"].compare("locoaddtimetable") == 0)
+		{
+			HandleLocoAddTimeTable(arguments);
+		}
+		else if (arguments["cmd"].compare("accessoryedit") == 0)
+		{
+			HandleAccessoryEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("accessorysave") == 0)
+		{
+			HandleAccessorySave(arguments);
+		}
+		else if (arguments["cmd"].compare("accessorystate") == 0)
+		{
+			HandleAccessoryState(arguments);
+		}
+		else if (arguments["cmd"].compare("accessorylist") == 0)
+		{
+			HandleAccessoryList();
+		}
+		else if (arguments["cmd"].compare("accessoryaskdelete") == 0)
+		{
+			HandleAccessoryAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("accessorydelete") == 0)
+		{
+			HandleAccessoryDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("accessoryget") == 0)
+		{
+			HandleAccessoryGet(arguments);
+		}
+		else if (arguments["cmd"].compare("accessoryrelease") == 0)
+		{
+			HandleAccessoryRelease(arguments);
+		}
+		else if (arguments["cmd"].compare("switchedit") == 0)
+		{
+			HandleSwitchEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("switchsave") == 0)
+		{
+			HandleSwitchSave(arguments);
+		}
+		else if (arguments["cmd"].compare("switchstate") == 0)
+		{
+			HandleSwitchState(arguments);
+		}
+		else if (arguments["cmd"].compare("switchstates") == 0)
+		{
+			route.HandleRelationSwitchStates(arguments);
+		}
+		else if (arguments["cmd"].compare("switchlist") == 0)
+		{
+			HandleSwitchList();
+		}
+		else if (arguments["cmd"].compare("switchaskdelete") == 0)
+		{
+			HandleSwitchAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("switchdelete") == 0)
+		{
+			HandleSwitchDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("switchget") == 0)
+		{
+			HandleSwitchGet(arguments);
+		}
+		else if (arguments["cmd"].compare("switchrelease") == 0)
+		{
+			HandleSwitchRelease(arguments);
+		}
+		else if (arguments["cmd"].compare("signaladdresses") == 0)
+		{
+			signal.HandleSignalAddresses(arguments);
+		}
+		else if (arguments["cmd"].compare("signaledit") == 0)
+		{
+			signal.HandleSignalEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("signalsave") == 0)
+		{
+			signal.HandleSignalSave(arguments);
+		}
+		else if (arguments["cmd"].compare("signalstate") == 0)
+		{
+			signal.HandleSignalState(arguments);
+		}
+		else if (arguments["cmd"].compare("signalstates") == 0)
+		{
+			signal.HandleSignalStates(arguments);
+		}
+		else if (arguments["cmd"].compare("signallist") == 0)
+		{
+			signal.HandleSignalList();
+		}
+		else if (arguments["cmd"].compare("signalaskdelete") == 0)
+		{
+			signal.HandleSignalAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("signaldelete") == 0)
+		{
+			signal.HandleSignalDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("signalget") == 0)
+		{
+			signal.HandleSignalGet(arguments);
+		}
+		else if (arguments["cmd"].compare("signalrelease") == 0)
+		{
+			signal.HandleSignalRelease(arguments);
+		}
+		else if (arguments["cmd"].compare("routeedit") == 0)
+		{
+			route.HandleRouteEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("routesave") == 0)
+		{
+			route.HandleRouteSave(arguments);
+		}
+		else if (arguments["cmd"].compare("routelist") == 0)
+		{
+			route.HandleRouteList();
+		}
+		else if (arguments["cmd"].compare("routeaskdelete") == 0)
+		{
+			route.HandleRouteAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("routedelete") == 0)
+		{
+			route.HandleRouteDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("routeget") == 0)
+		{
+			route.HandleRouteGet(arguments);
+		}
+		else if (arguments["cmd"].compare("routeexecute") == 0)
+		{
+			route.HandleRouteExecute(arguments);
+		}
+		else if (arguments["cmd"].compare("routerelease") == 0)
+		{
+			route.HandleRouteRelease(arguments);
+		}
+		else if (arguments["cmd"].compare("textedit") == 0)
+		{
+			text.HandleTextEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("textsave") == 0)
+		{
+			text.HandleTextSave(arguments);
+		}
+		else if (arguments["cmd"].compare("textlist") == 0)
+		{
+			text.HandleTextList();
+		}
+		else if (arguments["cmd"].compare("textaskdelete") == 0)
+		{
+			text.HandleTextAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("textdelete") == 0)
+		{
+			text.HandleTextDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("textget") == 0)
+		{
+			text.HandleTextGet(arguments);
+		}
+		else if (arguments["cmd"].compare("trackedit") == 0)
+		{
+			track.HandleTrackEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("tracksave") == 0)
+		{
+			track.HandleTrackSave(arguments);
+		}
+		else if (arguments["cmd"].compare("tracklist") == 0)
+		{
+			track.HandleTrackList();
+		}
+		else if (arguments["cmd"].compare("trackaskdelete") == 0)
+		{
+			track.HandleTrackAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("trackdelete") == 0)
+		{
+			track.HandleTrackDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("trackget") == 0)
+		{
+			track.HandleTrackGet(arguments);
+		}
+		else if (arguments["cmd"].compare("tracksetloco") == 0)
+		{
+			track.HandleTrackSetLoco(arguments);
+		}
+		else if (arguments["cmd"].compare("trackrelease") == 0)
+		{
+			track.HandleTrackRelease(arguments);
+		}
+		else if (arguments["cmd"].compare("trackstartloco") == 0)
+		{
+			track.HandleTrackStartLoco(arguments);
+		}
+		else if (arguments["cmd"].compare("trackstoploco") == 0)
+		{
+			track.HandleTrackStopLoco(arguments);
+		}
+		else if (arguments["cmd"].compare("trackblock") == 0)
+		{
+			track.HandleTrackBlock(arguments);
+		}
+		else if (arguments["cmd"].compare("trackorientation") == 0)
+		{
+			track.HandleTrackOrientation(arguments);
+		}
+		else if (arguments["cmd"].compare("feedbackedit") == 0)
+		{
+			HandleFeedbackEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("feedbacksave") == 0)
+		{
+			HandleFeedbackSave(arguments);
+		}
+		else if (arguments["cmd"].compare("feedbackstate") == 0)
+		{
+			HandleFeedbackState(arguments);
+		}
+		else if (arguments["cmd"].compare("feedbacklist") == 0)
+		{
+			HandleFeedbackList();
+		}
+		else if (arguments["cmd"].compare("feedbackaskdelete") == 0)
+		{
+			HandleFeedbackAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("feedbackdelete") == 0)
+		{
+			HandleFeedbackDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("feedbackget") == 0)
+		{
+			HandleFeedbackGet(arguments);
+		}
+		else if (arguments["cmd"].compare("feedbacksoftrack") == 0)
+		{
+			route.HandleFeedbacksOfTrack(arguments);
+		}
+		else if (arguments["cmd"].compare("protocol") == 0)
+		{
+			HandleProtocol(arguments);
+		}
+		else if (arguments["cmd"].compare("feedbackadd") == 0)
+		{
+			HandleFeedbackAdd(arguments);
+		}
+		else if (arguments["cmd"].compare("relationadd") == 0)
+		{
+			route.HandleRelationAdd(arguments);
+		}
+		else if (arguments["cmd"].compare("relationobject") == 0)
+		{
+			route.HandleRelationObject(arguments);
+		}
+		else if (arguments["cmd"].compare("layout") == 0)
+		{
+			HandleLayout(arguments);
+		}
+		else if (arguments["cmd"].compare("locoselector") == 0)
+		{
+			HandleLocoSelector(arguments);
+		}
+		else if (arguments["cmd"].compare("layerselector") == 0)
+		{
+			HandleLayerSelector();
+		}
+		else if (arguments["cmd"].compare("stopallimmediately") == 0)
+		{
+			manager.StopAllLocosImmediately(ControlTypeWebserver);
+		}
+		else if (arguments["cmd"].compare("startall") == 0)
+		{
+			manager.LocoStartAll();
+		}
+		else if (arguments["cmd"].compare("stopall") == 0)
+		{
+			manager.LocoStopAll();
+		}
+		else if (arguments["cmd"].compare("settingsedit") == 0)
+		{
+			HandleSettingsEdit();
+		}
+		else if (arguments["cmd"].compare("settingssave") == 0)
+		{
+			HandleSettingsSave(arguments);
+		}
+		else if (arguments["cmd"].compare("slaveadd") == 0)
+		{
+			HandleSlaveAdd(arguments);
+		}
+		else if (arguments["cmd"].compare("timestamp") == 0)
+		{
+			HandleTimestamp(arguments);
+		}
+		else if (arguments["cmd"].compare("controlarguments") == 0)
+		{
+			HandleControlArguments(arguments);
+		}
+		else if (arguments["cmd"].compare("program") == 0)
+		{
+			HandleProgram();
+		}
+		else if (arguments["cmd"].compare("programmodeselector") == 0)
+		{
+			HandleProgramModeSelector(arguments);
+		}
+		else if (arguments["cmd"].compare("programread") == 0)
+		{
+			HandleProgramRead(arguments);
+		}
+		else if (arguments["cmd"].compare("programwrite") == 0)
+		{
+			HandleProgramWrite(arguments);
+		}
+		else if (arguments["cmd"].compare("getcvfields") == 0)
+		{
+			HandleCvFields(arguments);
+		}
+		else if (arguments["cmd"].compare("clusterlist") == 0)
+		{
+			cluster.HandleClusterList();
+		}
+		else if (arguments["cmd"].compare("clusteredit") == 0)
+		{
+			cluster.HandleClusterEdit(arguments);
+		}
+		else if (arguments["cmd"].compare("clustersave") == 0)
+		{
+			cluster.HandleClusterSave(arguments);
+		}
+		else if (arguments["cmd"].compare("clusteraskdelete") == 0)
+		{
+			cluster.HandleClusterAskDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("clusterdelete") == 0)
+		{
+			cluster.HandleClusterDelete(arguments);
+		}
+		else if (arguments["cmd"].compare("newposition") == 0)
+		{
+			HandleNewPosition(arguments);
+		}
+		else if (arguments["cmd"].compare("rotate") == 0)
+		{
+			HandleRotate(arguments);
+		}
+		else if (arguments["cmd"].compare("getlocolist") == 0)
+		{
+			ResponseCsv response(manager.GetLocoList());
+			ReplyCompressible(response);
+		}
+		else if (arguments["cmd"].compare("getroutelist") == 0)
+		{
+			ResponseCsv response(manager.GetRouteList());
+			ReplyCompressible(response);
+		}
+		else if (arguments["cmd"].compare("updater") == 0)
+		{
+			HandleUpdater(headers);
+		}
+		else if (arguments["cmd"].compare("jsonsnapshot") == 0)
+		{
+			ResponseJson response(server.GetJsonSnapshot());
+			ReplyCompressible(response);
+		}
+		else if (arguments["cmd"].compare("jsonupdates") == 0)
+		{
+			HandleJsonUpdates(arguments);
+		}
+		else
+		{
+			return false;
+		}
+		return true;
 	}
 
 	void WebClient::InterpretClientRequest(const deque<string>& lines, string& method, string& uri, string& protocol, map<string,string>& arguments, map<string,string>& headers)
@@ -691,88 +738,129 @@ namespace WebServer
 				continue;
 			}
 
-			deque<string> argumentStrings;
-			Utils::Utils::SplitString(uriParts[1], "&", argumentStrings);
-			for (auto& argument : argumentStrings)
-			{
-				if (argument.length() == 0)
-				{
-					continue;
-				}
-				string key;
-				string value;
-				Utils::Utils::SplitString(argument, "=", key, value);
-				arguments[key] = Utils::Utils::UrlDecode(value);
-			}
+			InterpretArguments(uriParts[1], arguments);
 		}
 	}
 
-	void WebClient::DeliverFile(const string& virtualFile)
+	void WebClient::InterpretArguments(const string& query, map<string,string>& arguments)
 	{
-		std::stringstream ss;
-		char workingDir[128];
-		if (getcwd(workingDir, sizeof(workingDir)))
-		{
-			ss << workingDir << "/html" << virtualFile;
-		}
-		string sFile = ss.str();
-		const char* realFile = sFile.c_str();
-		FILE* f = fopen(realFile, "r");
-		if (f == nullptr)
+		deque<string> argumentStrings;
+		Utils::Utils::SplitString(query, "&", argumentStrings);
+		for (auto& argument : argumentStrings)
 		{
-			ResponseHtmlNotFound response(virtualFile);
-			connection->Send(response);
-			logger->Info(Languages::TextHttpConnectionNotFound, id, virtualFile);
-			return;
+			if (argument.length() == 0)
+			{
+				continue;
+			}
+			string key;
+			string value;
+			Utils::Utils::SplitString(argument, "=", key, value);
+			arguments[key] = Utils::Utils::UrlDecode(value);
 		}
-
-		DeliverFileInternal(f, realFile, virtualFile);
-		fclose(f);
 	}
 
-	void WebClient::DeliverFileInternal(FILE* f, const char* realFile, const string& virtualFile)
+	void WebClient::ReplyCompressible(Response& response)
 	{
-		struct stat s;
-		int rc = stat(realFile, &s);
-		if (rc != 0)
+		string body = response.GetBody();
+		if (webSocket)
 		{
+			auto contentType = response.headers.find("Content-Type");
+			const bool json = contentType != response.headers.end() && contentType->second.compare(0, 16, "application/json") == 0;
+			string frame = "{\"reply\":" + to_string(webSocketReplyID);
+			frame += json ? ",\"json\":" + body : ",\"html\":" + Utils::Utils::JsonEncode(body);
+			frame += "}";
+			connection->Send(WebSocket::Frame(frame));
 			return;
 		}
 
-		size_t length = virtualFile.length();
-		const char* contentType = nullptr;
-		if (length > 4 && virtualFile[length - 4] == '.')
+		if (contentEncoding.size() > 0 && server.GetCompressionLevel() > 0 && body.size() >= server.GetCompressionThreshold())
 		{
-			if (virtualFile[length - 3] == 'i' && virtualFile[length - 2] == 'c' && virtualFile[length - 1] == 'o')
-			{
-				contentType = "image/x-icon";
-			}
-			else if (virtualFile[length - 3] == 'c' && virtualFile[length - 2] == 's' && virtualFile[length - 1] == 's')
-			{
-				contentType = "text/css";
-			}
-			else if (virtualFile[length - 3] == 'p' && virtualFile[length - 2] == 'n' && virtualFile[length - 1] == 'g')
+			struct timespec start;
+			clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+			string compressed;
+			const bool ok = compressor.Start(server.GetCompressionLevel(), contentEncoding.compare("gzip") == 0)
+				&& compressor.Compress(body.c_str(), body.size(), compressed, true);
+			struct timespec end;
+			clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+			if (ok && compressed.size() < body.size())
 			{
-				contentType = "image/png";
+				const unsigned int cpuMicroseconds = (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_nsec - start.tv_nsec) / 1000;
+				server.AddCompressionStatistics(body.size(), compressed.size(), cpuMicroseconds);
+				response.AddHeader("Content-Encoding", contentEncoding);
+				body.swap(compressed);
 			}
-			else if (virtualFile[length - 3] == 't' && virtualFile[length - 2] == 't' && virtualFile[length - 1] == 'f')
+		}
+		response.AddHeader("Vary", "Accept-Encoding");
+		response.AddHeader("Content-Length", to_string(body.size()));
+		connection->Send(response.GetHead() + body);
+	}
+
+	bool WebClient::AcceptsEncoding(const map<string,string>& headers, const string& encoding)
+	{
+		deque<string> codings;
+		Utils::Utils::SplitString(Utils::Utils::GetStringMapEntry(headers, "Accept-Encoding"), ",", codings);
+		for (auto& coding : codings)
+		{
+			string name;
+			string parameters;
+			Utils::Utils::SplitString(coding, ";", name, parameters);
+			name.erase(0, name.find_first_not_of(' '));
+			name.erase(name.find_last_not_of(' ') + 1);
+			if (name.compare(encoding) != 0)
 			{
-				contentType = "application/x-font-ttf";
+				continue;
 			}
+			// q=0 means not acceptable
+			const size_t quality = parameters.find("q=");
+			return quality == string::npos || atof(parameters.c_str() + quality + 2) > 0;
 		}
-		else if (length > 3 && virtualFile[length - 3] == '.' && virtualFile[length - 2] == 'j' && virtualFile[length - 1] == 's')
+		return false;
+	}
+
+	void WebClient::DeliverFile(const string& virtualFile, const map<string,string>& headers)
+	{
+		const AssetCache::Asset* asset = server.GetAssets().Get(virtualFile);
+		if (asset == nullptr)
 		{
-			contentType = "application/javascript";
+			ResponseHtmlNotFound response(virtualFile);
+			connection->Send(response);
+			logger->Info(Languages::TextHttpConnectionNotFound, id, virtualFile);
+			return;
 		}
 
+		const bool deflate = asset->deflated.size() > 0 && AcceptsEncoding(headers, "deflate");
+		const string& etag = deflate ? asset->etagDeflated : asset->etag;
+
 		Response response;
-		response.AddHeader("Cache-Control", "no-cache, must-revalidate");
-		response.AddHeader("Pragma", "no-cache");
-		response.AddHeader("Expires", "Sun, 12 Feb 2016 00:00:00 GMT");
-		response.AddHeader("Content-Length", to_string(s.st_size));
-		if (contentType != nullptr)
+		// the browser revalidates the file on every use, but only gets the content if the ETag changed
+		response.AddHeader("Cache-Control", "no-cache");
+		response.AddHeader("ETag", etag);
+		if (asset->contentType != nullptr)
+		{
+			response.AddHeader("Content-Type", asset->contentType);
+		}
+		if (asset->deflated.size() > 0)
+		{
+			response.AddHeader("Vary", "Accept-Encoding");
+		}
+
+		const string ifNoneMatch = Utils::Utils::GetStringMapEntry(headers, "If-None-Match");
+		if (ifNoneMatch.compare("*") == 0 || ifNoneMatch.find(etag) != string::npos)
+		{
+			response.responseCode = Response::NotModified;
+			connection->Send(response);
+			logger->Debug(Languages::TextHttpConnectionNotModified, id, virtualFile);
+			return;
+		}
+
+		if (deflate)
+		{
+			response.AddHeader("Content-Encoding", "deflate");
+			response.AddHeader("Content-Length", to_string(asset->deflated.size()));
+		}
+		else
 		{
-			response.AddHeader("Content-Type", contentType);
+			response.AddHeader("Content-Length", to_string(asset->size));
 		}
 		connection->Send(response);
 
@@ -781,15 +869,26 @@ namespace WebServer
 			return;
 		}
 
-		char* buffer = static_cast<char*>(malloc(s.st_size));
-		if (buffer == nullptr)
+		if (deflate)
+		{
+			connection->Send(asset->deflated);
+			return;
+		}
+
+		if (asset->content.size() == asset->size)
 		{
+			connection->Send(asset->content);
 			return;
 		}
 
-		size_t r = fread(buffer, 1, s.st_size, f);
-		connection->Send(buffer, r, 0);
-		free(buffer);
+		// large files are not held in memory
+		int fd = open(asset->realFile.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			return;
+		}
+		connection->SendFile(fd, asset->size);
+		close(fd);
 	}
 
 	void WebClient::HandleLayerEdit(const map<string, string>& arguments)
@@ -3127,6 +3226,110 @@ namespace WebServer
 		}
 	}
 
+	void WebClient::HandleJsonUpdates(const map<string, string>& arguments)
+	{
+		const unsigned int clientVersion = Utils::Utils::GetIntegerMapEntry(arguments, "version", 0);
+		// with wait the request is answered as soon as there is an update (long polling)
+		int wait = Utils::Utils::GetIntegerMapEntry(arguments, "wait", 0);
+		if (wait > MaxJsonUpdatesWait)
+		{
+			wait = MaxJsonUpdatesWait;
+		}
+		string json;
+		unsigned int version = clientVersion;
+		if (wait > 0)
+		{
+			server.WaitForJsonUpdates(version, json, wait, run);
+		}
+		else
+		{
+			server.GetJsonUpdates(version, json);
+		}
+		ResponseJson response(json);
+		ReplyCompressible(response);
+	}
+
+	void WebClient::HandleWebSocket(const map<string,string>& arguments, const map<string,string>& headers)
+	{
+		Response response;
+		response.responseCode = Response::SwitchingProtocols;
+		response.AddHeader("Upgrade", "websocket");
+		response.AddHeader("Connection", "Upgrade");
+		response.AddHeader("Sec-WebSocket-Accept", WebSocket::AcceptKey(Utils::Utils::GetStringMapEntry(headers, "Sec-WebSocket-Key")));
+		if (connection->Send(response.GetHead()) <= 0)
+		{
+			return;
+		}
+		logger->Debug(Languages::TextHttpConnectionUpgradedToWebSocket, id);
+		// a reply directly follows the pushed updates and must not wait for their ACK
+		connection->SetNoDelay();
+
+		// the commands are answered in frames, the updates are pushed as in jsonupdates
+		webSocket = true;
+		unsigned int version = Utils::Utils::GetIntegerMapEntry(arguments, "version", server.GetUpdateVersion());
+		while (run)
+		{
+			string updates;
+			if (server.GetJsonUpdates(version, updates) && connection->Send(WebSocket::Frame(updates)) <= 0)
+			{
+				return;
+			}
+
+			if (connection->WaitForData(WebSocketUpdateInterval) == false)
+			{
+				continue;
+			}
+
+			WebSocket::Opcode opcode;
+			string payload;
+			if (WebSocket::Receive(connection, opcode, payload) == false)
+			{
+				return;
+			}
+
+			switch (opcode)
+			{
+				case WebSocket::OpcodeText:
+					HandleWebSocketCommand(payload, headers);
+					break;
+
+				case WebSocket::OpcodePing:
+					connection->Send(WebSocket::Frame(payload, WebSocket::OpcodePong));
+					break;
+
+				case WebSocket::OpcodeClose:
+					connection->Send(WebSocket::Frame(payload.substr(0, 2), WebSocket::OpcodeClose));
+					return;
+
+				default:
+					break;
+			}
+		}
+	}
+
+	void WebClient::HandleWebSocketCommand(const string& command, const map<string,string>& headers)
+	{
+		logger->Debug(Languages::TextHttpConnectionRequest, id, "WEBSOCKET", command);
+		map<string,string> arguments;
+		InterpretArguments(command, arguments);
+		webSocketReplyID = Utils::Utils::GetIntegerMapEntry(arguments, "id", 0);
+
+		// these commands would block the connection and answer in plain HTTP, all
+		// other commands answer through ReplyCompressible which sends a frame
+		const string cmd = arguments["cmd"];
+		if (cmd.compare("updater") == 0 || cmd.compare("jsonupdates") == 0)
+		{
+			ReplyResponse(ResponseError, Languages::TextWebSocketCommandNotSupported, cmd);
+			return;
+		}
+
+		// unknown commands must not end up in DeliverFile
+		if (HandleCommand(arguments, headers) == false)
+		{
+			ReplyResponse(ResponseError, Languages::TextWebSocketCommandNotSupported, cmd);
+		}
+	}
+
 	HtmlTag WebClient::HtmlTagLocoSelector(const string& selector) const
 	{
 		map<string,LocoID> options = manager.LocoIdsByName();
@@ -3343,6 +3546,7 @@ namespace WebServer
 			.AddChildTag(HtmlTag("li").AddClass("contextentry").AddClass("real_layer_only").AddContent(Languages::GetText(Languages::TextAddText)).AddAttribute("onClick", "loadPopup('/?cmd=textedit&text=0');"))
 			));
 
-		connection->Send(ResponseHtmlFull("RailControl", body));
+		ResponseHtmlFull response("RailControl", body);
+		ReplyCompressible(response);
 	}
 } // namespace WebServer
@@ -28,6 +28,7 @@ along with RailControl; see the file LICENCE. If not see
 
 #include "DataModel/AccessoryBase.h"
 #include "DataModel/ObjectIdentifier.h"
+#include "Hardware/ZLib.h"
 #include "Languages.h"
 #include "Manager.h"
 #include "Network/TcpConnection.h"
@@ -81,6 +82,8 @@ namespace WebServer
 				route(manager, *this, logger),
 				text(manager, *this),
 				headOnly(false),
+				webSocket(false),
+				webSocketReplyID(0),
 				buttonID(0)
 			{
 			}
@@ -101,9 +104,13 @@ namespace WebServer
 
 			inline void ReplyHtmlWithHeader(const HtmlTag& tag)
 			{
-				connection->Send(ResponseHtml(tag));
+				ResponseHtml response(tag);
+				ReplyCompressible(response);
 			}
 
+			// compresses the body if the browser accepts it and the body is large enough
+			void ReplyCompressible(Response& response);
+
 			inline void ReplyResponse(const std::string& text)
 			{
 				ReplyHtmlWithHeader(HtmlTag().AddContent(text));
@@ -191,10 +198,11 @@ namespace WebServer
 
 		private:
 			void InterpretClientRequest(const std::deque<std::string>& lines, std::string& method, std::string& uri, std::string& protocol, std::map<std::string,std::string>& arguments, std::map<std::string,std::string>& headers);
+			static void InterpretArguments(const std::string& query, std::map<std::string,std::string>& arguments);
 			void HandleLoco(const std::map<std::string, std::string>& arguments);
 			void PrintMainHTML();
-			void DeliverFile(const std::string& file);
-			void DeliverFileInternal(FILE* f, const char* realFile, const std::string& file);
+			static bool AcceptsEncoding(const std::map<std::string,std::string>& headers, const std::string& encoding);
+			void DeliverFile(const std::string& file, const std::map<std::string,std::string>& headers);
 			HtmlTag HtmlTagLocoSelector(const std::string& selector) const;
 			HtmlTag HtmlTagLayerSelector() const;
 
@@ -279,6 +287,12 @@ namespace WebServer
 			void HandleNewPositionInternal(const std::map<std::string,std::string>& arguments, std::string& result);
 			void HandleRotate(const std::map<std::string,std::string>& arguments);
 			void HandleUpdater(const std::map<std::string,std::string>& headers);
+			void HandleJsonUpdates(const std::map<std::string,std::string>& arguments);
+			void HandleWebSocket(const std::map<std::string,std::string>& arguments, const std::map<std::string,std::string>& headers);
+			void HandleWebSocketCommand(const std::string& command, const std::map<std::string,std::string>& headers);
+			void HandleRequest(const std::string& uri, std::map<std::string,std::string>& arguments, const std::map<std::string,std::string>& headers);
+			// returns false if cmd is not a known command
+			bool HandleCommand(std::map<std::string,std::string>& arguments, const std::map<std::string,std::string>& headers);
 			void WorkerImpl();
 
 			Logger::Logger* logger;
@@ -295,7 +309,16 @@ namespace WebServer
 			WebClientRoute route;
 			WebClientText text;
 			bool headOnly;
+			// empty if the browser does not accept compressed responses
+			std::string contentEncoding;
+			ZLib::Compressor compressor;
+			// replies are sent as frames once the connection is upgraded
+			bool webSocket;
+			int webSocketReplyID;
 			unsigned int buttonID;
+
+			static const int MaxJsonUpdatesWait = 30000; // ms
+			static const unsigned int WebSocketUpdateInterval = 20; // ms
 	};
 
 } // namespace WebServer
@@ -23,6 +23,7 @@ along with RailControl; see the file LICENCE. If not see
 #include "DataModel/DataModel.h"
 #include "DataModel/LocoConfig.h"
 #include "Hardware/HardwareHandler.h"
+#include "Hardware/LayoutSimulator.h"
 #include "Utils/Utils.h"
 #include "WebServer/HtmlTagButton.h"
 #include "WebServer/HtmlTagInputHidden.h"
@@ -77,6 +78,27 @@ namespace WebServer
 				return HtmlTagInputIntegerWithLabel(argumentNumber, argumentName, valueInteger, 0, 62);
 			}
 
+			case ArgumentTypeSimulationTimeFactor:
+			{
+				argumentName = Languages::TextSimulationTimeFactor;
+				const int valueInteger = Utils::Utils::StringToInteger(value, 0, 1000);
+				return HtmlTagInputIntegerWithLabel(argumentNumber, argumentName, valueInteger, 0, 1000);
+			}
+
+			case ArgumentTypeFeedbackDistance:
+			{
+				argumentName = Languages::TextFeedbackDistance;
+				const int valueInteger = Utils::Utils::StringToInteger(value, Hardware::LayoutSimulator::DefaultFeedbackDistance);
+				return HtmlTagInputIntegerWithLabel(argumentNumber, argumentName, valueInteger, 1, 10000);
+			}
+
+			case ArgumentTypeMaxVelocity:
+			{
+				argumentName = Languages::TextMaxVelocity;
+				const int valueInteger = Utils::Utils::StringToInteger(value, Hardware::LayoutSimulator::DefaultMaxVelocity);
+				return HtmlTagInputIntegerWithLabel(argumentNumber, argumentName, valueInteger, 1, 1000);
+			}
+
 			default:
 				return HtmlTag();
 		}
@@ -19,8 +19,10 @@ along with RailControl; see the file LICENCE. If not see
 */
 
 #include <algorithm>
+#include <chrono>
 #include <arpa/inet.h>
 #include <cstring>		//memset
+#include <deque>
 #include <ifaddrs.h>
 #include <netinet/in.h>
 #include <signal.h>
@@ -39,6 +41,7 @@ along with RailControl; see the file LICENCE. If not see
 #include "WebServer/WebClient.h"
 #include "WebServer/WebServer.h"
 
+using std::deque;
 using std::map;
 using std::thread;
 using std::string;
@@ -52,14 +55,25 @@ using DataModel::TrackBase;
 
 namespace WebServer
 {
-	WebServer::WebServer(Manager& manager, const std::string& webserveraddress, const unsigned short port)
+	WebServer::WebServer(Manager& manager,
+		const std::string& webserveraddress,
+		const unsigned short port,
+		const int compressionLevel,
+		const size_t compressionThreshold)
 	:	ControlInterface(ControlTypeWebserver),
 		Network::TcpServer(webserveraddress, port, "WebServer"),
 		logger(Logger::Logger::GetLogger("WebServer")),
 		lastClientID(0),
 		manager(manager),
+		assets(logger),
+		compressionLevel(compressionLevel),
+		compressionThreshold(compressionThreshold),
+		compressedResponses(0),
+		compressionBytesSaved(0),
+		compressionCpuMicroseconds(0),
 		updateID(1),
-		updateAvailable(false)
+		updateAvailable(false),
+		jsonUpdatesDiscarded(0)
 	{
 		logger->Info(Languages::TextWebServerStarted);
 		AddUpdate(Languages::TextRailControlStarted);
@@ -77,9 +91,20 @@ namespace WebServer
 			clients.pop_back();
 			delete client;
 		}
+		if (compressedResponses > 0)
+		{
+			logger->Info(Languages::TextCompressionStatistics, compressedResponses.load(), compressionBytesSaved.load(), compressionCpuMicroseconds / 1000);
+		}
 		logger->Info(Languages::TextWebServerStopped);
 	}
 
+	void WebServer::AddCompressionStatistics(const size_t bytesIn, const size_t bytesOut, const unsigned int cpuMicroseconds)
+	{
+		++compressedResponses;
+		compressionBytesSaved += bytesIn - bytesOut;
+		compressionCpuMicroseconds += cpuMicroseconds;
+	}
+
 	void WebServer::Stop()
 	{
 		AddUpdate(Languages::TextStoppingRailControl);
@@ -89,6 +114,12 @@ namespace WebServer
 		{
 			client->Stop();
 		}
+		// wake up the clients waiting for json updates, the lock makes sure
+		// that they either see the stop or are already waiting
+		{
+			std::lock_guard<std::mutex> lock(updateMutex);
+		}
+		jsonUpdateSignal.notify_all();
 	}
 
 	void WebServer::LogBrowserInfo(const std::string& webserveraddress, const unsigned short port)
@@ -557,10 +588,19 @@ namespace WebServer
 
 	void WebServer::AddUpdate(const string& command, const string& status)
 	{
-		std::lock_guard<std::mutex> lock(updateMutex);
-		updates[updateID] = "data: command=" + command + ";status=" + status + "\r\n\r\n";
-		++updateID;
-		updates.erase(updateID - MaxUpdates);
+		{
+			std::lock_guard<std::mutex> lock(updateMutex);
+			updates[updateID] = "data: command=" + command + ";status=" + status + "\r\n\r\n";
+			jsonUpdates[updateID] = CommandToJson(updateID, command);
+			++updateID;
+			updates.erase(updateID - MaxUpdates);
+			if (jsonUpdates.size() > MaxJsonUpdates)
+			{
+				jsonUpdatesDiscarded = jsonUpdates.begin()->first;
+				jsonUpdates.erase(jsonUpdates.begin());
+			}
+		}
+		jsonUpdateSignal.notify_all();
 	}
 
 	void WebServer::AddUpdate(const Languages::TextSelector status)
@@ -589,4 +629,214 @@ namespace WebServer
 		return false;
 	}
 
+	string WebServer::CommandToJson(const unsigned int version, const string& command)
+	{
+		deque<string> parts;
+		Utils::Utils::SplitString(command, ";", parts);
+		string json = "{\"version\":" + to_string(version) + ",\"command\":" + Utils::Utils::JsonEncode(parts.front());
+		parts.pop_front();
+		for (auto& part : parts)
+		{
+			string key;
+			string value;
+			Utils::Utils::SplitString(part, "=", key, value);
+			json += "," + Utils::Utils::JsonEncode(key) + ":";
+			const bool isNumber = value.size() > 0
+				&& value.find_first_not_of("0123456789") == string::npos
+				&& key.find("name") == string::npos;
+			if (isNumber || value.compare("true") == 0 || value.compare("false") == 0)
+			{
+				json += value;
+			}
+			else
+			{
+				json += Utils::Utils::JsonEncode(value);
+			}
+		}
+		json += "}";
+		return json;
+	}
+
+	string WebServer::GetJsonSnapshot()
+	{
+		// updates after this version may already be contained, but applying them twice does not harm
+		string json = "{\"version\":" + to_string(GetUpdateVersion());
+		json += ",\"booster\":";
+		json += JsonBool(manager.Booster() == BoosterStateGo);
+
+		json += ",\"locos\":[";
+		const char* separator = "";
+		for (auto& locoEntry : manager.LocoList())
+		{
+			Loco* loco = locoEntry.second;
+			json += separator;
+			separator = ",";
+			json += "{\"id\":" + to_string(loco->GetID())
+				+ ",\"name\":" + Utils::Utils::JsonEncode(loco->GetName())
+				+ ",\"speed\":" + to_string(loco->GetSpeed())
+				+ ",\"orientation\":" + JsonBool(loco->GetOrientation())
+				+ ",\"automode\":" + JsonBool(loco->IsInAutoMode())
+				+ ",\"track\":" + to_string(loco->GetTrackId())
+				+ ",\"functions\":[";
+			const char* functionSeparator = "";
+			for (auto& function : loco->GetFunctionStates())
+			{
+				json += functionSeparator;
+				functionSeparator = ",";
+				json += "{\"nr\":" + to_string(function.nr) + ",\"on\":" + JsonBool(function.state) + "}";
+			}
+			json += "]}";
+		}
+
+		json += "],\"accessories\":[";
+		separator = "";
+		for (auto& accessoryEntry : manager.AccessoryList())
+		{
+			const DataModel::Accessory* accessory = accessoryEntry.second;
+			json += separator;
+			separator = ",";
+			json += "{\"id\":" + to_string(accessory->GetID())
+				+ ",\"name\":" + Utils::Utils::JsonEncode(accessory->GetName())
+				+ ",\"state\":" + (accessory->GetAccessoryState() == DataModel::AccessoryStateOn ? "\"green\"" : "\"red\"")
+				+ "}";
+		}
+
+		json += "],\"switches\":[";
+		separator = "";
+		for (auto& switchEntry : manager.SwitchList())
+		{
+			const DataModel::Switch* mySwitch = switchEntry.second;
+			const char* state;
+			switch (mySwitch->GetAccessoryState())
+			{
+				case DataModel::AccessoryState::SwitchStateTurnout:
+					state = "\"turnout\"";
+					break;
+
+				case DataModel::AccessoryState::SwitchStateThird:
+					state = "\"third\"";
+					break;
+
+				case DataModel::AccessoryState::SwitchStateStraight:
+				default:
+					state = "\"straight\"";
+					break;
+			}
+			json += separator;
+			separator = ",";
+			json += "{\"id\":" + to_string(mySwitch->GetID())
+				+ ",\"name\":" + Utils::Utils::JsonEncode(mySwitch->GetName())
+				+ ",\"state\":" + state
+				+ "}";
+		}
+
+		json += "],\"signals\":[";
+		separator = "";
+		for (auto& signalEntry : manager.SignalList())
+		{
+			const DataModel::Signal* signal = signalEntry.second;
+			const DataModel::AccessoryState state = signal->GetAccessoryState();
+			string stateText;
+			switch (state)
+			{
+				case DataModel::SignalStateClear:
+					stateText = "clear";
+					break;
+
+				case DataModel::SignalStateAspect2:
+				case DataModel::SignalStateAspect3:
+				case DataModel::SignalStateAspect4:
+				case DataModel::SignalStateAspect5:
+				case DataModel::SignalStateAspect6:
+					stateText = "aspect" + to_string(state);
+					break;
+
+				case DataModel::SignalStateStop:
+				default:
+					stateText = "stop";
+					break;
+			}
+			json += separator;
+			separator = ",";
+			json += "{\"id\":" + to_string(signal->GetID())
+				+ ",\"name\":" + Utils::Utils::JsonEncode(signal->GetName())
+				+ ",\"state\":\"" + stateText
+				+ "\"}";
+		}
+
+		json += "],\"feedbacks\":[";
+		separator = "";
+		for (auto& feedbackEntry : manager.FeedbackList())
+		{
+			const DataModel::Feedback* feedback = feedbackEntry.second;
+			json += separator;
+			separator = ",";
+			json += "{\"id\":" + to_string(feedback->GetID())
+				+ ",\"name\":" + Utils::Utils::JsonEncode(feedback->GetName())
+				+ ",\"state\":" + (feedback->GetState() == DataModel::Feedback::FeedbackStateOccupied ? "\"on\"" : "\"off\"")
+				+ "}";
+		}
+
+		json += "],\"tracks\":[";
+		separator = "";
+		for (auto& trackEntry : manager.TrackList())
+		{
+			const DataModel::Track* track = trackEntry.second;
+			json += separator;
+			separator = ",";
+			json += "{\"id\":" + to_string(track->GetID())
+				+ ",\"name\":" + Utils::Utils::JsonEncode(track->GetName())
+				+ ",\"occupied\":" + JsonBool(track->GetFeedbackStateDelayed() == DataModel::Feedback::FeedbackStateOccupied)
+				+ ",\"blocked\":" + JsonBool(track->GetBlocked())
+				+ ",\"orientation\":" + JsonBool(track->GetLocoOrientation())
+				+ ",\"loco\":" + to_string(track->GetLocoDelayed())
+				+ "}";
+		}
+		json += "]}";
+		return json;
+	}
+
+	bool WebServer::GetJsonUpdates(unsigned int& version, string& json)
+	{
+		std::lock_guard<std::mutex> lock(updateMutex);
+		return CollectJsonUpdates(version, json);
+	}
+
+	bool WebServer::WaitForJsonUpdates(unsigned int& version, string& json, const unsigned int timeout, const volatile bool& run)
+	{
+		std::unique_lock<std::mutex> lock(updateMutex);
+		const unsigned int oldVersion = version;
+		jsonUpdateSignal.wait_for(lock, std::chrono::milliseconds(timeout), [&]
+			{
+				return run == false
+					|| oldVersion < jsonUpdatesDiscarded
+					|| jsonUpdates.upper_bound(oldVersion) != jsonUpdates.end();
+			});
+		return CollectJsonUpdates(version, json);
+	}
+
+	bool WebServer::CollectJsonUpdates(unsigned int& version, string& json)
+	{
+		const unsigned int oldVersion = version;
+		version = updateID - 1;
+		json = "{\"version\":" + to_string(version);
+		if (oldVersion < jsonUpdatesDiscarded)
+		{
+			json += ",\"resync\":true}";
+			return true;
+		}
+
+		json += ",\"updates\":[";
+		const char* separator = "";
+		auto update = jsonUpdates.upper_bound(oldVersion);
+		const bool hasUpdates = update != jsonUpdates.end();
+		for (; update != jsonUpdates.end(); ++update)
+		{
+			json += separator;
+			separator = ",";
+			json += update->second;
+		}
+		json += "]}";
+		return hasUpdates;
+	}
 } // namespace WebServer
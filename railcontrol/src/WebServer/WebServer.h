@@ -20,6 +20,8 @@ along with RailControl; see the file LICENCE. If not see
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <sstream>
@@ -30,6 +32,7 @@ along with RailControl; see the file LICENCE. If not see
 #include "Logger/Logger.h"
 #include "Manager.h"
 #include "Network/TcpServer.h"
+#include "WebServer/AssetCache.h"
 
 namespace WebServer
 {
@@ -42,7 +45,11 @@ namespace WebServer
 			WebServer(const WebServer&) = delete;
 			WebServer& operator=(const WebServer&) = delete;
 
-			WebServer(Manager& manager, const std::string& webserveraddress, const unsigned short port);
+			WebServer(Manager& manager,
+				const std::string& webserveraddress,
+				const unsigned short port,
+				const int compressionLevel,
+				const size_t compressionThreshold);
 			~WebServer();
 
 			void Stop() override;
@@ -51,6 +58,24 @@ namespace WebServer
 
 			bool NextUpdate(unsigned int& updateIDClient, std::string& s);
 
+			// state of locos, accessories, switches, signals, feedbacks and tracks
+			// with the version of the last update that is contained
+			std::string GetJsonSnapshot();
+
+			// all updates after version, returns false if there is nothing to send
+			// version is set to the version of the last update that is contained
+			bool GetJsonUpdates(unsigned int& version, std::string& json);
+
+			// like GetJsonUpdates, but waits up to timeout ms for an update
+			// as long as run is true
+			bool WaitForJsonUpdates(unsigned int& version, std::string& json, const unsigned int timeout, const volatile bool& run);
+
+			inline unsigned int GetUpdateVersion()
+			{
+				std::lock_guard<std::mutex> lock(updateMutex);
+				return updateID - 1;
+			}
+
 			inline const std::string& GetName() const override
 			{
 				static const std::string WebserverName("Webserver");
@@ -103,6 +128,24 @@ namespace WebServer
 				return updateAvailable;
 			}
 
+			inline const AssetCache& GetAssets() const
+			{
+				return assets;
+			}
+
+			// 0 disables the compression of dynamic responses
+			inline int GetCompressionLevel() const
+			{
+				return compressionLevel;
+			}
+
+			inline size_t GetCompressionThreshold() const
+			{
+				return compressionThreshold;
+			}
+
+			void AddCompressionStatistics(const size_t bytesIn, const size_t bytesOut, const unsigned int cpuMicroseconds);
+
 			inline void AddUpdate(const std::string& command, const Languages::TextSelector status)
 			{
 				AddUpdate(command, Languages::GetText(status));
@@ -123,17 +166,39 @@ namespace WebServer
 
 			void LogBrowserInfo(const std::string& webserveraddress, const unsigned short port);
 
+			static std::string CommandToJson(const unsigned int version, const std::string& command);
+
+			// updateMutex has to be locked
+			bool CollectJsonUpdates(unsigned int& version, std::string& json);
+
+			static inline const char* JsonBool(const bool value)
+			{
+				return value ? "true" : "false";
+			}
+
 			Logger::Logger* logger;
 			unsigned int lastClientID;
 			std::vector<WebClient*> clients;
 			Manager& manager;
+			const AssetCache assets;
+
+			const int compressionLevel;
+			const size_t compressionThreshold;
+			std::atomic<unsigned long long> compressedResponses;
+			std::atomic<unsigned long long> compressionBytesSaved;
+			std::atomic<unsigned long long> compressionCpuMicroseconds;
 
 			std::map<unsigned int,std::string> updates;
 			std::mutex updateMutex;
 			unsigned int updateID;
 			bool updateAvailable;
+			std::map<unsigned int,std::string> jsonUpdates;
+			std::condition_variable jsonUpdateSignal;
+			// clients with an older version have to fetch a new snapshot
+			unsigned int jsonUpdatesDiscarded;
 
 			static const unsigned int MaxUpdates = 10;
+			static const unsigned int MaxJsonUpdates = 1000;
 	};
 } // namespace WebServer
 
@@ -0,0 +1,247 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstdint>
+
+#include "WebServer/WebSocket.h"
+
+using std::string;
+
+namespace WebServer
+{
+	string WebSocket::AcceptKey(const string& key)
+	{
+		return Base64Encode(Sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+	}
+
+	string WebSocket::Frame(const string& payload, const Opcode opcode)
+	{
+		string frame;
+		frame.reserve(payload.size() + 10);
+		frame += static_cast<char>(0x80 | opcode);
+		const size_t size = payload.size();
+		if (size < 126)
+		{
+			frame += static_cast<char>(size);
+		}
+		else if (size < 65536)
+		{
+			frame += static_cast<char>(126);
+			frame += static_cast<char>(size >> 8);
+			frame += static_cast<char>(size);
+		}
+		else
+		{
+			frame += static_cast<char>(127);
+			for (int shift = 56; shift >= 0; shift -= 8)
+			{
+				frame += static_cast<char>(static_cast<uint64_t>(size) >> shift);
+			}
+		}
+		frame += payload;
+		return frame;
+	}
+
+	bool WebSocket::Receive(Network::TcpConnection* connection, Opcode& opcode, string& payload)
+	{
+		payload.clear();
+		while (true)
+		{
+			unsigned char header[2];
+			if (connection->ReceiveExact(header, sizeof(header)) != sizeof(header))
+			{
+				return false;
+			}
+			const bool fin = header[0] & 0x80;
+			const Opcode frameOpcode = static_cast<Opcode>(header[0] & 0x0F);
+			const bool masked = header[1] & 0x80;
+			uint64_t size = header[1] & 0x7F;
+			if (size >= 126)
+			{
+				unsigned char extended[8];
+				const int extendedSize = size == 126 ? 2 : 8;
+				if (connection->ReceiveExact(extended, extendedSize) != extendedSize)
+				{
+					return false;
+				}
+				size = 0;
+				for (int i = 0; i < extendedSize; ++i)
+				{
+					size = (size << 8) | extended[i];
+				}
+			}
+			if (size > MaxPayloadSize - payload.size())
+			{
+				return false;
+			}
+
+			// a client must mask all its frames (RFC 6455 5.1), otherwise the connection is closed with protocol error 1002
+			if (masked == false)
+			{
+				connection->Send(Frame(string("\x03\xEA", 2), OpcodeClose));
+				return false;
+			}
+
+			unsigned char mask[4];
+			if (connection->ReceiveExact(mask, sizeof(mask)) != sizeof(mask))
+			{
+				return false;
+			}
+
+			const size_t offset = payload.size();
+			payload.resize(offset + size);
+			unsigned char* data = reinterpret_cast<unsigned char*>(&payload[offset]);
+			if (size > 0 && connection->ReceiveExact(data, size) != static_cast<int>(size))
+			{
+				return false;
+			}
+			for (size_t i = 0; i < size; ++i)
+			{
+				data[i] ^= mask[i & 3];
+			}
+
+			if (frameOpcode != OpcodeContinuation)
+			{
+				opcode = frameOpcode;
+			}
+			if (fin)
+			{
+				return true;
+			}
+		}
+	}
+
+	string WebSocket::Sha1(const string& input)
+	{
+		uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+		string message(input);
+		message += static_cast<char>(0x80);
+		while (message.size() % 64 != 56)
+		{
+			message += static_cast<char>(0);
+		}
+		const uint64_t bits = static_cast<uint64_t>(input.size()) * 8;
+		for (int shift = 56; shift >= 0; shift -= 8)
+		{
+			message += static_cast<char>(bits >> shift);
+		}
+
+		for (size_t chunk = 0; chunk < message.size(); chunk += 64)
+		{
+			uint32_t w[80];
+			for (int i = 0; i < 16; ++i)
+			{
+				const unsigned char* p = reinterpret_cast<const unsigned char*>(&message[chunk + i * 4]);
+				w[i] = (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+			}
+			for (int i = 16; i < 80; ++i)
+			{
+				const uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+				w[i] = (x << 1) | (x >> 31);
+			}
+
+			uint32_t a = h[0];
+			uint32_t b = h[1];
+			uint32_t c = h[2];
+			uint32_t d = h[3];
+			uint32_t e = h[4];
+			for (int i = 0; i < 80; ++i)
+			{
+				uint32_t f;
+				uint32_t k;
+				if (i < 20)
+				{
+					f = (b & c) | (~b & d);
+					k = 0x5A827999;
+				}
+				else if (i < 40)
+				{
+					f = b ^ c ^ d;
+					k = 0x6ED9EBA1;
+				}
+				else if (i < 60)
+				{
+					f = (b & c) | (b & d) | (c & d);
+					k = 0x8F1BBCDC;
+				}
+				else
+				{
+					f = b ^ c ^ d;
+					k = 0xCA62C1D6;
+				}
+				const uint32_t temp = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+				e = d;
+				d = c;
+				c = (b << 30) | (b >> 2);
+				b = a;
+				a = temp;
+			}
+			h[0] += a;
+			h[1] += b;
+			h[2] += c;
+			h[3] += d;
+			h[4] += e;
+		}
+
+		string digest;
+		for (int i = 0; i < 5; ++i)
+		{
+			for (int shift = 24; shift >= 0; shift -= 8)
+			{
+				digest += static_cast<char>(h[i] >> shift);
+			}
+		}
+		return digest;
+	}
+
+	string WebSocket::Base64Encode(const string& input)
+	{
+		static const char* Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		string output;
+		size_t i = 0;
+		for (; i + 2 < input.size(); i += 3)
+		{
+			const uint32_t v = (static_cast<unsigned char>(input[i]) << 16)
+				| (static_cast<unsigned char>(input[i + 1]) << 8)
+				| static_cast<unsigned char>(input[i + 2]);
+			output += Alphabet[(v >> 18) & 0x3F];
+			output += Alphabet[(v >> 12) & 0x3F];
+			output += Alphabet[(v >> 6) & 0x3F];
+			output += Alphabet[v & 0x3F];
+		}
+		const size_t rest = input.size() - i;
+		if (rest == 0)
+		{
+			return output;
+		}
+		uint32_t v = static_cast<unsigned char>(input[i]) << 16;
+		if (rest == 2)
+		{
+			v |= static_cast<unsigned char>(input[i + 1]) << 8;
+		}
+		output += Alphabet[(v >> 18) & 0x3F];
+		output += Alphabet[(v >> 12) & 0x3F];
+		output += rest == 2 ? Alphabet[(v >> 6) & 0x3F] : '=';
+		output += '=';
+		return output;
+	}
+} // namespace WebServer
@@ -0,0 +1,63 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <string>
+
+#include "Network/TcpConnection.h"
+
+namespace WebServer
+{
+	// Framing of RFC 6455 WebSocket connections on the server side
+	class WebSocket
+	{
+		public:
+			enum Opcode : unsigned char
+			{
+				OpcodeContinuation = 0x0,
+				OpcodeText = 0x1,
+				OpcodeBinary = 0x2,
+				OpcodeClose = 0x8,
+				OpcodePing = 0x9,
+				OpcodePong = 0xA
+			};
+
+			WebSocket() = delete;
+
+			// value of the Sec-WebSocket-Accept header for the Sec-WebSocket-Key of the client
+			static std::string AcceptKey(const std::string& key);
+
+			// unmasked frame with FIN set, as sent by the server
+			static std::string Frame(const std::string& payload, const Opcode opcode = OpcodeText);
+
+			// Receives one message and unmasks it. Fragmented messages are joined.
+			// Returns false if the connection failed, the message is too large or a frame
+			// is not masked.
+			static bool Receive(Network::TcpConnection* connection, Opcode& opcode, std::string& payload);
+
+			static const size_t MaxPayloadSize = 65536;
+
+		private:
+			static std::string Sha1(const std::string& input);
+			static std::string Base64Encode(const std::string& input);
+	};
+} // namespace WebServer
@@ -0,0 +1,945 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+// Replays byte streams of a Maerklin CS2 (CAN over TCP), a Z21 (UDP), an
+// ECoS (ESU CAN) and a MasterControl 2 (P50x over TCP) into the protocol
+// parsers. The controls are simulated on 127.0.0.1, the Manager is a stub that
+// only counts the callbacks.
+//
+// Every replayed frame is followed by a probe frame that sets the speed of loco
+// ProbeAddress. The frame is done when the probe reaches Manager::LocoSpeed,
+// the time between sending and that callback is the end-to-end latency.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <new>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "ArgumentHandler.h"
+#include "Config.h"
+#include "DataModel/Accessory.h"
+#include "DataModel/Feedback.h"
+#include "DataModel/Loco.h"
+#include "DataModel/Signal.h"
+#include "DataModel/Switch.h"
+#include "Hardware/CS2Tcp.h"
+#include "Hardware/Ecos.h"
+#include "Hardware/HardwareParams.h"
+#include "Hardware/MasterControl2.h"
+#include "Hardware/Z21.h"
+#include "Logger/Logger.h"
+#include "Manager.h"
+#include "Utils/Utils.h"
+
+using std::string;
+using std::vector;
+
+static std::atomic<unsigned long long> allocations(0);
+
+void* operator new(size_t size)
+{
+	++allocations;
+	void* memory = malloc(size == 0 ? 1 : size);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	static const Address ProbeAddress = 1000;
+	static const int StallTimeoutMs = 5000;
+
+	class Measurement
+	{
+		public:
+			Measurement(const size_t frames)
+			:	sendTimes(frames),
+				latencies(frames),
+				sent(0),
+				done(0),
+				callbacks(0)
+			{
+			}
+
+			vector<Clock::time_point> sendTimes;
+			vector<double> latencies;
+			std::atomic<size_t> sent;
+			std::atomic<size_t> done;
+			std::atomic<unsigned long long> callbacks;
+	};
+
+	static std::atomic<Measurement*> measurement(nullptr);
+
+	void Callback()
+	{
+		Measurement* m = measurement;
+		if (m != nullptr)
+		{
+			++m->callbacks;
+		}
+	}
+
+	void ProbeCallback(const Address address)
+	{
+		Measurement* m = measurement;
+		if (m == nullptr)
+		{
+			return;
+		}
+		++m->callbacks;
+		if (address != ProbeAddress)
+		{
+			return;
+		}
+		const size_t frame = m->done;
+		if (frame >= m->sent.load(std::memory_order_acquire))
+		{
+			return;
+		}
+		m->latencies[frame] = std::chrono::duration<double, std::micro>(Clock::now() - m->sendTimes[frame]).count();
+		m->done.store(frame + 1, std::memory_order_release);
+	}
+
+	class FakeControl
+	{
+		public:
+			FakeControl(const string& name, const unsigned short port, const int type)
+			:	name(name),
+				port(port),
+				type(type),
+				serverSocket(-1),
+				clientSocket(-1),
+				run(true)
+			{
+			}
+
+			virtual ~FakeControl()
+			{
+				run = false;
+				if (serverThread.joinable())
+				{
+					serverThread.join();
+				}
+				if (clientSocket >= 0)
+				{
+					close(clientSocket);
+				}
+				if (serverSocket >= 0)
+				{
+					close(serverSocket);
+				}
+			}
+
+			const string& GetName() const
+			{
+				return name;
+			}
+
+			virtual size_t DefaultWindow() const
+			{
+				return 16;
+			}
+
+			virtual bool Listen();
+
+			// constructs the hardware object, it connects to the fake control
+			virtual void Connect(const Hardware::HardwareParams* params) = 0;
+
+			virtual void Disconnect() = 0;
+
+			virtual bool Accept();
+
+			virtual void Send(const string& data);
+
+			virtual string Probe(const unsigned int sequence) const = 0;
+
+		protected:
+			bool WaitForInput(const int socket) const;
+
+			void Drain();
+
+			const string name;
+			const unsigned short port;
+			const int type;
+			int serverSocket;
+			int clientSocket;
+			volatile bool run;
+			std::thread serverThread;
+	};
+
+	bool FakeControl::Listen()
+	{
+		serverSocket = socket(AF_INET, type, 0);
+		if (serverSocket < 0)
+		{
+			return false;
+		}
+		int on = 1;
+		setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+		struct sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_port = htons(port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(serverSocket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+		{
+			return false;
+		}
+		return type != SOCK_STREAM || listen(serverSocket, 1) == 0;
+	}
+
+	bool FakeControl::WaitForInput(const int socket) const
+	{
+		struct pollfd pollSocket;
+		pollSocket.fd = socket;
+		pollSocket.events = POLLIN;
+		return poll(&pollSocket, 1, 100) > 0;
+	}
+
+	bool FakeControl::Accept()
+	{
+		for (int wait = 0; wait < StallTimeoutMs / 100; ++wait)
+		{
+			if (!WaitForInput(serverSocket))
+			{
+				continue;
+			}
+			clientSocket = accept(serverSocket, nullptr, nullptr);
+			if (clientSocket < 0)
+			{
+				return false;
+			}
+			serverThread = std::thread(&FakeControl::Drain, this);
+			return true;
+		}
+		return false;
+	}
+
+	void FakeControl::Drain()
+	{
+		char buffer[1024];
+		while (run)
+		{
+			if (!WaitForInput(clientSocket))
+			{
+				continue;
+			}
+			if (recv(clientSocket, buffer, sizeof(buffer), 0) <= 0)
+			{
+				return;
+			}
+		}
+	}
+
+	void FakeControl::Send(const string& data)
+	{
+		size_t position = 0;
+		while (position < data.size())
+		{
+			const ssize_t ret = send(clientSocket, data.data() + position, data.size() - position, MSG_NOSIGNAL);
+			if (ret <= 0)
+			{
+				return;
+			}
+			position += ret;
+		}
+	}
+
+	class FakeCS2 : public FakeControl
+	{
+		public:
+			FakeCS2()
+			:	FakeControl("CS2", 15731, SOCK_STREAM),
+				cs2(nullptr)
+			{
+			}
+
+			void Connect(const Hardware::HardwareParams* params) override
+			{
+				cs2 = new Hardware::CS2Tcp(params);
+			}
+
+			void Disconnect() override
+			{
+				delete cs2;
+				cs2 = nullptr;
+			}
+
+			string Probe(const unsigned int sequence) const override
+			{
+				// loco speed response, MFX address
+				const unsigned char speed = (sequence & 0x01) ? 20 : 10;
+				const unsigned char frame[13] = { 0x00, 0x09, 0x00, 0x00, 0x06,
+					0x00, 0x00, 0x40 | (ProbeAddress >> 8), ProbeAddress & 0xFF, 0x00, speed, 0x00, 0x00 };
+				return string(reinterpret_cast<const char*>(frame), sizeof(frame));
+			}
+
+		private:
+			Hardware::CS2Tcp* cs2;
+	};
+
+	class FakeEcos : public FakeControl
+	{
+		public:
+			FakeEcos()
+			:	FakeControl("ECoS", 15471, SOCK_STREAM),
+				ecos(nullptr)
+			{
+			}
+
+			void Connect(const Hardware::HardwareParams* params) override
+			{
+				ecos = new Hardware::Ecos(params);
+			}
+
+			void Disconnect() override
+			{
+				delete ecos;
+				ecos = nullptr;
+			}
+
+			string Probe(const unsigned int sequence) const override
+			{
+				// ECoS object id of a loco is address + 999
+				const string object = std::to_string(ProbeAddress + 999);
+				const string speed = (sequence & 0x01) ? "20" : "10";
+				return "<EVENT " + object + ">\r\n" + object + " speed[" + speed + "]\r\n<END 0 (OK)>\r\n";
+			}
+
+		private:
+			Hardware::Ecos* ecos;
+	};
+
+	class FakeZ21 : public FakeControl
+	{
+		public:
+			FakeZ21()
+			:	FakeControl("Z21", 21105, SOCK_DGRAM),
+				z21(nullptr),
+				clientAddressLength(0)
+			{
+			}
+
+			void Connect(const Hardware::HardwareParams* params) override
+			{
+				z21 = new Hardware::Z21(params);
+			}
+
+			void Disconnect() override
+			{
+				delete z21;
+				z21 = nullptr;
+			}
+
+			// the Z21 client is known after its first packet
+			bool Accept() override;
+
+			void Send(const string& data) override
+			{
+				sendto(serverSocket, data.data(), data.size(), 0,
+					reinterpret_cast<struct sockaddr*>(&clientAddress), clientAddressLength);
+			}
+
+			string Probe(const unsigned int sequence) const override
+			{
+				// LAN_X_LOCO_INFO, 128 speed steps, orientation right
+				const unsigned char speed = 0x80 | ((sequence & 0x01) ? 20 : 10);
+				unsigned char frame[14] = { 0x0E, 0x00, 0x40, 0x00, 0xEF,
+					0xC0 | (ProbeAddress >> 8), ProbeAddress & 0xFF, 0x04, speed, 0x00, 0x00, 0x00, 0x00, 0x00 };
+				for (unsigned char index = 4; index < sizeof(frame) - 1; ++index)
+				{
+					frame[sizeof(frame) - 1] ^= frame[index];
+				}
+				return string(reinterpret_cast<const char*>(frame), sizeof(frame));
+			}
+
+		private:
+			void DrainUdp();
+
+			Hardware::Z21* z21;
+			struct sockaddr_storage clientAddress;
+			socklen_t clientAddressLength;
+	};
+
+	bool FakeZ21::Accept()
+	{
+		char buffer[1024];
+		for (int wait = 0; wait < StallTimeoutMs / 100; ++wait)
+		{
+			if (!WaitForInput(serverSocket))
+			{
+				continue;
+			}
+			clientAddressLength = sizeof(clientAddress);
+			if (recvfrom(serverSocket, buffer, sizeof(buffer), 0,
+				reinterpret_cast<struct sockaddr*>(&clientAddress), &clientAddressLength) < 0)
+			{
+				return false;
+			}
+			serverThread = std::thread(&FakeZ21::DrainUdp, this);
+			return true;
+		}
+		return false;
+	}
+
+	void FakeZ21::DrainUdp()
+	{
+		char buffer[1024];
+		while (run)
+		{
+			if (WaitForInput(serverSocket))
+			{
+				recv(serverSocket, buffer, sizeof(buffer), 0);
+			}
+		}
+	}
+
+	class FakeMasterControl2 : public FakeControl
+	{
+		public:
+			FakeMasterControl2()
+			:	FakeControl("P50x", 8050, SOCK_STREAM),
+				masterControl(nullptr)
+			{
+			}
+
+			// the records are fetched every 50ms by the event poller
+			size_t DefaultWindow() const override
+			{
+				return 256;
+			}
+
+			// P50x is request/response, the control has to answer during Connect
+			bool Listen() override
+			{
+				if (!FakeControl::Listen())
+				{
+					return false;
+				}
+				serverThread = std::thread(&FakeMasterControl2::Serve, this);
+				return true;
+			}
+
+			void Connect(const Hardware::HardwareParams* params) override
+			{
+				masterControl = new Hardware::MasterControl2(params);
+			}
+
+			void Disconnect() override
+			{
+				delete masterControl;
+				masterControl = nullptr;
+			}
+
+			bool Accept() override
+			{
+				return clientSocket >= 0;
+			}
+
+			void Send(const string& data) override
+			{
+				std::lock_guard<std::mutex> guard(pendingMutex);
+				pending.append(data);
+			}
+
+			string Probe(const unsigned int sequence) const override
+			{
+				// XEvtLok record: speed, functions, address low, address high
+				const unsigned char frame[5] = { static_cast<unsigned char>((sequence & 0x01) ? 20 : 10), 0x00,
+					ProbeAddress & 0xFF, ProbeAddress >> 8, 0x00 };
+				return string(reinterpret_cast<const char*>(frame), sizeof(frame));
+			}
+
+		private:
+			void Serve();
+			bool ReceiveByte(unsigned char& data);
+
+			Hardware::MasterControl2* masterControl;
+			std::mutex pendingMutex;
+			string pending;
+			string sending;
+	};
+
+	bool FakeMasterControl2::ReceiveByte(unsigned char& data)
+	{
+		while (run)
+		{
+			if (WaitForInput(clientSocket))
+			{
+				return recv(clientSocket, &data, 1, 0) == 1;
+			}
+		}
+		return false;
+	}
+
+	void FakeMasterControl2::Serve()
+	{
+		while (run && clientSocket < 0)
+		{
+			if (WaitForInput(serverSocket))
+			{
+				clientSocket = accept(serverSocket, nullptr, nullptr);
+			}
+		}
+
+		sending.reserve(64 * 1024);
+		unsigned char command;
+		while (ReceiveByte(command))
+		{
+			switch (command)
+			{
+				case 'X':
+				{
+					// P50X only mode: "XZzA1\r", answered with a 34 byte text
+					for (unsigned char index = 0; index < 5; ++index)
+					{
+						ReceiveByte(command);
+					}
+					FakeControl::Send(string(34, ' '));
+					break;
+				}
+
+				case 0xC8: // XEvent
+				{
+					std::lock_guard<std::mutex> guard(pendingMutex);
+					FakeControl::Send(string(1, pending.size() ? 0x01 : 0x00));
+					break;
+				}
+
+				case 0xC9: // XEvtLok
+				{
+					{
+						std::lock_guard<std::mutex> guard(pendingMutex);
+						sending.swap(pending);
+					}
+					sending.push_back(static_cast<char>(0x80));
+					FakeControl::Send(sending);
+					sending.clear();
+					break;
+				}
+
+				default: // XNop and the rest
+					FakeControl::Send(string(1, 0x00));
+					break;
+			}
+		}
+	}
+
+	bool ReadRecording(const string& fileName, vector<string>& frames)
+	{
+		std::ifstream file(fileName);
+		if (!file.is_open())
+		{
+			return false;
+		}
+		string line;
+		while (std::getline(file, line))
+		{
+			if (line.size() == 0 || line[0] == '#')
+			{
+				continue;
+			}
+			string frame;
+			std::deque<string> bytes;
+			Utils::Utils::SplitString(line, " ", bytes);
+			for (auto& byte : bytes)
+			{
+				if (byte.size() == 0)
+				{
+					continue;
+				}
+				frame.push_back(static_cast<char>(strtoul(byte.c_str(), nullptr, 16)));
+			}
+			if (frame.size())
+			{
+				frames.push_back(frame);
+			}
+		}
+		return true;
+	}
+
+	bool Bench(FakeControl& control, const Hardware::HardwareParams& params, const vector<string>& recording,
+		const size_t frames, size_t window)
+	{
+		if (window == 0)
+		{
+			window = control.DefaultWindow();
+		}
+
+		// consecutive probes have to alternate the speed, the Z21 only reports changes
+		vector<string> units;
+		const size_t recorded = recording.size();
+		const size_t nrOfUnits = recorded == 0 ? 2 : (recorded & 0x01 ? recorded << 1 : recorded);
+		for (size_t unit = 0; unit < nrOfUnits; ++unit)
+		{
+			units.push_back((recorded == 0 ? string() : recording[unit % recorded]) + control.Probe(unit));
+		}
+
+		if (!control.Listen())
+		{
+			std::cout << control.GetName() << ": unable to listen on port" << std::endl;
+			return false;
+		}
+		control.Connect(&params);
+		if (!control.Accept())
+		{
+			std::cout << control.GetName() << ": control did not connect" << std::endl;
+			control.Disconnect();
+			return false;
+		}
+
+		// let the control finish its start up before measuring
+		Utils::Utils::SleepForMilliseconds(200);
+
+		Measurement m(frames);
+		measurement = &m;
+		const unsigned long long allocationsStart = allocations;
+		const Clock::time_point start = Clock::now();
+		Clock::time_point lastProgress = start;
+		size_t lastDone = 0;
+		bool stalled = false;
+		size_t frame = 0;
+		while (m.done < frames)
+		{
+			const size_t done = m.done;
+			const Clock::time_point now = Clock::now();
+			if (done != lastDone)
+			{
+				lastDone = done;
+				lastProgress = now;
+			}
+			else if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastProgress).count() > StallTimeoutMs)
+			{
+				stalled = true;
+				break;
+			}
+
+			if (frame >= frames || frame - done >= window)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			m.sendTimes[frame] = now;
+			m.sent.store(frame + 1, std::memory_order_release);
+			control.Send(units[frame % nrOfUnits]);
+			++frame;
+		}
+		const Clock::time_point end = Clock::now();
+		const unsigned long long allocationsEnd = allocations;
+		measurement = nullptr;
+
+		control.Disconnect();
+
+		const size_t done = m.done;
+		vector<double> latencies(m.latencies.begin(), m.latencies.begin() + done);
+		std::sort(latencies.begin(), latencies.end());
+		const double seconds = std::chrono::duration<double>(end - start).count();
+		const double p50 = done ? latencies[done / 2] : 0;
+		const double p99 = done ? latencies[std::min(done - 1, done * 99 / 100)] : 0;
+		std::cout << std::fixed << std::setprecision(1)
+			<< std::left << std::setw(6) << control.GetName() << std::right
+			<< std::setw(9) << done << " frames"
+			<< std::setw(12) << (done / seconds) << " frames/s"
+			<< std::setw(8) << std::setprecision(2) << (done ? static_cast<double>(allocationsEnd - allocationsStart) / done : 0) << " allocations/frame"
+			<< std::setw(8) << std::setprecision(2) << (done ? static_cast<double>(m.callbacks) / done : 0) << " callbacks/frame"
+			<< std::setprecision(1)
+			<< "  p50 " << std::setw(9) << p50 << " us"
+			<< "  p99 " << std::setw(9) << p99 << " us"
+			<< (stalled ? "  (stalled, frames lost)" : "")
+			<< std::endl;
+		return !stalled;
+	}
+}
+
+// Manager stub, the hardware only reports to these functions
+
+Manager::Manager(__attribute__((unused)) Config& config)
+:	logger(Logger::Logger::GetLogger("Manager")),
+	boosterState(BoosterStateStop),
+	storage(nullptr),
+	run(true),
+	debounceRun(false),
+	initLocosDone(true)
+{
+}
+
+Manager::~Manager()
+{
+}
+
+void Manager::Booster(__attribute__((unused)) const ControlType controlType,
+	__attribute__((unused)) const BoosterState status)
+{
+	Callback();
+}
+
+void Manager::LocoSpeed(__attribute__((unused)) const ControlType controlType,
+	__attribute__((unused)) const ControlID controlID,
+	__attribute__((unused)) const Protocol protocol,
+	const Address address,
+	__attribute__((unused)) const Speed speed)
+{
+	ProbeCallback(address);
+}
+
+void Manager::LocoOrientation(__attribute__((unused)) const ControlType controlType,
+	__attribute__((unused)) const ControlID controlID,
+	__attribute__((unused)) const Protocol protocol,
+	__attribute__((unused)) const Address address,
+	__attribute__((unused)) const Orientation orientation)
+{
+	Callback();
+}
+
+void Manager::LocoFunctionState(__attribute__((unused)) const ControlType controlType,
+	__attribute__((unused)) const ControlID controlID,
+	__attribute__((unused)) const Protocol protocol,
+	__attribute__((unused)) const Address address,
+	__attribute__((unused)) const DataModel::LocoFunctionNr function,
+	__attribute__((unused)) const DataModel::LocoFunctionState on)
+{
+	Callback();
+}
+
+void Manager::AccessoryState(__attribute__((unused)) const ControlType controlType,
+	__attribute__((unused)) const ControlID controlID,
+	__attribute__((unused)) const Protocol protocol,
+	__attribute__((unused)) const Address address,
+	__attribute__((unused)) const DataModel::AccessoryState state)
+{
+	Callback();
+}
+
+void Manager::FeedbackState(__attribute__((unused)) const ControlID controlID,
+	__attribute__((unused)) const FeedbackPin pin,
+	__attribute__((unused)) const DataModel::Feedback::FeedbackState state)
+{
+	Callback();
+}
+
+void Manager::ProgramValue(__attribute__((unused)) const CvNumber cv, __attribute__((unused)) const CvValue value)
+{
+	Callback();
+}
+
+bool Manager::LocoDelete(__attribute__((unused)) const LocoID locoID, __attribute__((unused)) string& result)
+{
+	return false;
+}
+
+DataModel::Loco* Manager::GetLoco(__attribute__((unused)) const LocoID locoID) const
+{
+	return nullptr;
+}
+
+DataModel::Loco* Manager::GetLocoByMatchKey(__attribute__((unused)) const ControlID controlId,
+	__attribute__((unused)) const string& matchKey) const
+{
+	return nullptr;
+}
+
+void Manager::LocoRemoveMatchKey(__attribute__((unused)) const LocoID locoId)
+{
+}
+
+DataModel::Accessory* Manager::GetAccessory(__attribute__((unused)) const AccessoryID accessoryID) const
+{
+	return nullptr;
+}
+
+DataModel::Accessory* Manager::GetAccessoryByMatchKey(__attribute__((unused)) const ControlID controlId,
+	__attribute__((unused)) const string& matchKey) const
+{
+	return nullptr;
+}
+
+void Manager::AccessoryRemoveMatchKey(__attribute__((unused)) const AccessoryID accessoryId)
+{
+}
+
+DataModel::Feedback* Manager::GetFeedback(__attribute__((unused)) const FeedbackID feedbackID) const
+{
+	return nullptr;
+}
+
+DataModel::Feedback* Manager::GetFeedbackByMatchKey(__attribute__((unused)) const ControlID controlId,
+	__attribute__((unused)) const string& matchKey) const
+{
+	return nullptr;
+}
+
+void Manager::FeedbackRemoveMatchKey(__attribute__((unused)) const FeedbackID feedbackId)
+{
+}
+
+DataModel::Switch* Manager::GetSwitch(__attribute__((unused)) const SwitchID switchID) const
+{
+	return nullptr;
+}
+
+DataModel::Switch* Manager::GetSwitchByMatchKey(__attribute__((unused)) const ControlID controlId,
+	__attribute__((unused)) const string& matchKey) const
+{
+	return nullptr;
+}
+
+void Manager::SwitchRemoveMatchKey(__attribute__((unused)) const SwitchID switchId)
+{
+}
+
+DataModel::Signal* Manager::GetSignal(__attribute__((unused)) const SignalID signalID) const
+{
+	return nullptr;
+}
+
+DataModel::Signal* Manager::GetSignalByMatchKey(__attribute__((unused)) const ControlID controlId,
+	__attribute__((unused)) const string& matchKey) const
+{
+	return nullptr;
+}
+
+void Manager::SignalRemoveMatchKey(__attribute__((unused)) const SignalID signalId)
+{
+}
+
+// the stub manager never hands out objects, so these are never called
+
+DataModel::Loco& DataModel::Loco::operator=(__attribute__((unused)) const Hardware::LocoCacheEntry& loco)
+{
+	return *this;
+}
+
+DataModel::Accessory& DataModel::Accessory::operator=(__attribute__((unused)) const Hardware::AccessoryCacheEntry& accessory)
+{
+	return *this;
+}
+
+DataModel::Feedback& DataModel::Feedback::operator=(__attribute__((unused)) const Hardware::FeedbackCacheEntry& feedback)
+{
+	return *this;
+}
+
+DataModel::Switch& DataModel::Switch::operator=(__attribute__((unused)) const Hardware::AccessoryCacheEntry& accessory)
+{
+	return *this;
+}
+
+DataModel::Signal& DataModel::Signal::operator=(__attribute__((unused)) const Hardware::AccessoryCacheEntry& accessory)
+{
+	return *this;
+}
+
+int main(int argc, char* argv[])
+{
+	std::map<string,char> argumentMap;
+	argumentMap["frames"] = 'n';
+	argumentMap["window"] = 'w';
+	argumentMap["loglevel"] = 'v';
+	argumentMap["help"] = 'h';
+	argumentMap["cs2"] = 'C';
+	argumentMap["ecos"] = 'E';
+	argumentMap["z21"] = 'Z';
+	argumentMap["p50x"] = 'P';
+	ArgumentHandler argumentHandler(argc, argv, argumentMap, 'n');
+
+	if (argumentHandler.GetArgumentBool('h'))
+	{
+		std::cout << "Usage: " << argv[0] << " <options>" << std::endl;
+		std::cout << "Options:" << std::endl;
+		std::cout << "--frames=Frames          Number of frames to replay per control (default: 20000)" << std::endl;
+		std::cout << "--window=Frames          Maximum number of frames in flight (default: 16, P50x 256)" << std::endl;
+		std::cout << "--loglevel=Level         Log level of the controls 0 (off) to 4 (debug) (default: 3 (info))" << std::endl;
+		std::cout << "--cs2[=Recording]        Replay into CS2 TCP" << std::endl;
+		std::cout << "--ecos[=Recording]       Replay into ECoS" << std::endl;
+		std::cout << "--z21[=Recording]        Replay into Z21" << std::endl;
+		std::cout << "--p50x[=Recording]       Replay into MasterControl 2 (P50x)" << std::endl;
+		std::cout << "-h --help                Show this help" << std::endl;
+		std::cout << "Without control options all controls are replayed without recording." << std::endl;
+		std::cout << "A recording has one frame per line, written as hexadecimal bytes separated by spaces." << std::endl;
+		std::cout << "P50x frames are XEvtLok records, ECoS frames are complete <EVENT> blocks." << std::endl;
+		return 0;
+	}
+
+	const size_t frames = argumentHandler.GetArgumentInt('n', 20000);
+	const size_t window = argumentHandler.GetArgumentInt('w', 0);
+	Logger::Logger::SetLogLevel(static_cast<Logger::Logger::Level>(argumentHandler.GetArgumentInt('v', Logger::Logger::LevelInfo)));
+
+	Config config("");
+	Manager manager(config);
+
+	FakeCS2 cs2;
+	FakeEcos ecos;
+	FakeZ21 z21;
+	FakeMasterControl2 masterControl;
+	const std::map<char,FakeControl*> controls = { { 'C', &cs2 }, { 'E', &ecos }, { 'Z', &z21 }, { 'P', &masterControl } };
+	bool all = true;
+	for (auto& control : controls)
+	{
+		all &= !argumentHandler.GetArgumentBool(control.first);
+	}
+
+	bool ok = true;
+	ControlID controlID = ControlIdFirstHardware;
+	for (auto& control : controls)
+	{
+		if (!all && !argumentHandler.GetArgumentBool(control.first))
+		{
+			continue;
+		}
+		vector<string> recording;
+		const string fileName = argumentHandler.GetArgumentString(control.first);
+		if (fileName.size() && !ReadRecording(fileName, recording))
+		{
+			std::cout << control.second->GetName() << ": unable to read " << fileName << std::endl;
+			ok = false;
+			continue;
+		}
+		Hardware::HardwareParams params(controlID++, HardwareTypeNone, control.second->GetName(), "127.0.0.1", "0", "", "", "");
+		params.SetManager(&manager);
+		ok &= Bench(*control.second, params, recording, frames, window);
+	}
+	return ok ? 0 : 1;
+}
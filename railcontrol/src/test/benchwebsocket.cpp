@@ -0,0 +1,328 @@
+/*
+RailControl - Model Railway Control Software
+
+Copyright (c) 2017-2021 Dominik (Teddy) Mahrer - www.railcontrol.org
+
+RailControl is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+RailControl is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with RailControl; see the file LICENCE. If not see
+<http://www.gnu.org/licenses/>.
+*/
+
+
+// Compares the round-trip latency of commands sent as HTTP GET requests on a
+// keep-alive connection with the same commands sent over the WebSocket
+// endpoint. RailControl has to be running, the commands are really executed.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <netdb.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "ArgumentHandler.h"
+
+using std::string;
+using std::vector;
+
+typedef std::chrono::steady_clock Clock;
+
+namespace
+{
+	int Connect(const string& host, const string& port)
+	{
+		struct addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		struct addrinfo* result;
+		if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0)
+		{
+			return -1;
+		}
+		int sock = -1;
+		for (struct addrinfo* address = result; address != nullptr; address = address->ai_next)
+		{
+			sock = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+			if (sock < 0)
+			{
+				continue;
+			}
+			if (connect(sock, address->ai_addr, address->ai_addrlen) == 0)
+			{
+				break;
+			}
+			close(sock);
+			sock = -1;
+		}
+		freeaddrinfo(result);
+		return sock;
+	}
+
+	bool SendAll(const int sock, const string& data)
+	{
+		size_t sent = 0;
+		while (sent < data.size())
+		{
+			const ssize_t ret = send(sock, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+			if (ret <= 0)
+			{
+				return false;
+			}
+			sent += ret;
+		}
+		return true;
+	}
+
+	bool ReceiveExact(const int sock, string& data, const size_t size)
+	{
+		const size_t offset = data.size();
+		data.resize(offset + size);
+		size_t received = 0;
+		while (received < size)
+		{
+			const ssize_t ret = recv(sock, &data[offset + received], size - received, 0);
+			if (ret <= 0)
+			{
+				return false;
+			}
+			received += ret;
+		}
+		return true;
+	}
+
+	// reads the response head and returns the remaining bytes that belong to the body
+	bool ReceiveHead(const int sock, string& head, string& rest)
+	{
+		head.clear();
+		size_t end;
+		while ((end = head.find("\r\n\r\n")) == string::npos)
+		{
+			char buffer[4096];
+			const ssize_t ret = recv(sock, buffer, sizeof(buffer), 0);
+			if (ret <= 0)
+			{
+				return false;
+			}
+			head.append(buffer, ret);
+		}
+		rest = head.substr(end + 4);
+		head.resize(end + 4);
+		return true;
+	}
+
+	bool HttpCommand(const int sock, const string& command)
+	{
+		if (!SendAll(sock, "GET /?" + command + " HTTP/1.1\r\nHost: bench\r\nConnection: keep-alive\r\n\r\n"))
+		{
+			return false;
+		}
+		string head;
+		string body;
+		if (!ReceiveHead(sock, head, body))
+		{
+			return false;
+		}
+		const size_t lengthPos = head.find("Content-Length: ");
+		if (lengthPos == string::npos)
+		{
+			return false;
+		}
+		const size_t length = std::stoul(head.substr(lengthPos + 16));
+		return body.size() >= length || ReceiveExact(sock, body, length - body.size());
+	}
+
+	bool WebSocketSend(const int sock, const string& payload)
+	{
+		string frame;
+		frame += static_cast<char>(0x81);
+		if (payload.size() < 126)
+		{
+			frame += static_cast<char>(0x80 | payload.size());
+		}
+		else
+		{
+			frame += static_cast<char>(0x80 | 126);
+			frame += static_cast<char>(payload.size() >> 8);
+			frame += static_cast<char>(payload.size());
+		}
+		const unsigned char mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+		frame.append(reinterpret_cast<const char*>(mask), sizeof(mask));
+		for (size_t i = 0; i < payload.size(); ++i)
+		{
+			frame += static_cast<char>(payload[i] ^ mask[i & 3]);
+		}
+		return SendAll(sock, frame);
+	}
+
+	bool WebSocketReceive(const int sock, string& buffered, string& payload)
+	{
+		while (true)
+		{
+			if (buffered.size() >= 2)
+			{
+				size_t size = buffered[1] & 0x7F;
+				size_t headSize = 2;
+				if (size == 126)
+				{
+					headSize = 4;
+				}
+				else if (size == 127)
+				{
+					headSize = 10;
+				}
+				if (buffered.size() >= headSize)
+				{
+					if (headSize > 2)
+					{
+						size = 0;
+						for (size_t i = 2; i < headSize; ++i)
+						{
+							size = (size << 8) | static_cast<unsigned char>(buffered[i]);
+						}
+					}
+					if (buffered.size() >= headSize + size)
+					{
+						payload = buffered.substr(headSize, size);
+						buffered.erase(0, headSize + size);
+						return true;
+					}
+				}
+			}
+			char buffer[4096];
+			const ssize_t ret = recv(sock, buffer, sizeof(buffer), 0);
+			if (ret <= 0)
+			{
+				return false;
+			}
+			buffered.append(buffer, ret);
+		}
+	}
+
+	void Print(const string& name, vector<unsigned int>& latencies)
+	{
+		if (latencies.size() == 0)
+		{
+			std::cout << std::setw(10) << std::left << name << "failed" << std::endl;
+			return;
+		}
+		std::sort(latencies.begin(), latencies.end());
+		unsigned long long sum = 0;
+		for (const unsigned int latency : latencies)
+		{
+			sum += latency;
+		}
+		std::cout << std::setw(10) << std::left << name
+			<< std::setw(10) << std::right << latencies.size()
+			<< std::setw(12) << sum / latencies.size()
+			<< std::setw(12) << latencies[latencies.size() / 2]
+			<< std::setw(12) << latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)]
+			<< std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::map<string,char> argumentMap;
+	argumentMap["host"] = 'H';
+	argumentMap["port"] = 'p';
+	argumentMap["count"] = 'n';
+	argumentMap["command"] = 'c';
+	argumentMap["help"] = 'h';
+	ArgumentHandler argumentHandler(argc, argv, argumentMap, 'n');
+
+	if (argumentHandler.GetArgumentBool('h'))
+	{
+		std::cout << "Usage: " << argv[0] << " <options>" << std::endl;
+		std::cout << "Options:" << std::endl;
+		std::cout << "--host=Host              Host of RailControl (default: localhost)" << std::endl;
+		std::cout << "--port=Port              Port of the webserver (default: 8082)" << std::endl;
+		std::cout << "--count=Commands         Number of commands per transport (default: 2000)" << std::endl;
+		std::cout << "--command=Command        Command without speed (default: cmd=locospeed&loco=1)" << std::endl;
+		std::cout << "-h --help                Show this help" << std::endl;
+		std::cout << "The speed argument toggles between 0 and 100 with every command." << std::endl;
+		return 0;
+	}
+
+	const string host = argumentHandler.GetArgumentString('H', "localhost");
+	const string port = argumentHandler.GetArgumentString('p', "8082");
+	const int count = argumentHandler.GetArgumentInt('n', 2000);
+	const string command = argumentHandler.GetArgumentString('c', "cmd=locospeed&loco=1");
+
+	vector<unsigned int> httpLatencies;
+	int sock = Connect(host, port);
+	for (int i = 0; i < count && sock >= 0; ++i)
+	{
+		const Clock::time_point start = Clock::now();
+		if (!HttpCommand(sock, command + "&speed=" + (i & 1 ? "100" : "0")))
+		{
+			break;
+		}
+		httpLatencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+	}
+	if (sock >= 0)
+	{
+		close(sock);
+	}
+
+	vector<unsigned int> webSocketLatencies;
+	sock = Connect(host, port);
+	string head;
+	string buffered;
+	if (sock >= 0
+		&& SendAll(sock, "GET /websocket HTTP/1.1\r\nHost: bench\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n")
+		&& ReceiveHead(sock, head, buffered)
+		&& head.find(" 101 ") != string::npos)
+	{
+		for (int i = 1; i <= count; ++i)
+		{
+			const Clock::time_point start = Clock::now();
+			if (!WebSocketSend(sock, "id=" + std::to_string(i) + "&" + command + "&speed=" + (i & 1 ? "100" : "0")))
+			{
+				break;
+			}
+			// skip the pushed updates until the reply of this command arrives
+			const string reply = "{\"reply\":" + std::to_string(i) + ",";
+			string payload;
+			bool ok;
+			while ((ok = WebSocketReceive(sock, buffered, payload)) && payload.compare(0, reply.size(), reply) != 0)
+			{
+			}
+			if (!ok)
+			{
+				break;
+			}
+			webSocketLatencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+		}
+	}
+	if (sock >= 0)
+	{
+		close(sock);
+	}
+
+	std::cout << std::setw(10) << std::left << "transport"
+		<< std::setw(10) << std::right << "commands"
+		<< std::setw(12) << "mean us"
+		<< std::setw(12) << "p50 us"
+		<< std::setw(12) << "p99 us"
+		<< std::endl;
+	Print("GET", httpLatencies);
+	Print("WebSocket", webSocketLatencies);
+	return httpLatencies.size() > 0 && webSocketLatencies.size() > 0 ? 0 : 1;
+}